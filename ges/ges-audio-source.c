@@ -33,8 +33,9 @@ G_DEFINE_ABSTRACT_TYPE (GESAudioSource, ges_audio_source, GES_TYPE_SOURCE);
 
 struct _GESAudioSourcePrivate
 {
-  /*  Dummy variable */
-  void *nothing;
+  /* Converts to the format the track mixes in, kept in sync with its
+   * restriction caps */
+  GstElement *capsfilter;
 };
 
 static void
@@ -64,11 +65,27 @@ _sync_element_to_layer_property_float (GESTrackElement * trksrc,
   gst_object_unref (layer);
 }
 
+static void
+_restriction_caps_cb (GESTrack * track, GParamSpec * arg G_GNUC_UNUSED,
+    GESAudioSource * self)
+{
+  GstCaps *caps;
+
+  if (self->priv->capsfilter == NULL)
+    return;
+
+  caps = ges_smart_adder_get_mixing_caps (track);
+  GST_DEBUG_OBJECT (self, "Converting to %" GST_PTR_FORMAT, caps);
+  g_object_set (self->priv->capsfilter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+}
+
 static GstElement *
 ges_audio_source_create_element (GESTrackElement * trksrc)
 {
-  GstElement *volume, *vbin;
+  GstElement *volume, *vbin, *capsfilter;
   GstElement *topbin;
+  GESTrack *track = ges_track_element_get_track (trksrc);
   GstElement *sub_element;
   GESAudioSourceClass *source_class = GES_AUDIO_SOURCE_GET_CLASS (trksrc);
   const gchar *props[] = { "volume", "mute", NULL };
@@ -81,10 +98,25 @@ ges_audio_source_create_element (GESTrackElement * trksrc)
   GST_DEBUG_OBJECT (trksrc, "Creating a bin sub_element ! volume");
   vbin =
       gst_parse_bin_from_description
-      ("audioconvert ! audioresample ! volume name=v", TRUE, NULL);
+      ("audioconvert ! audioresample ! capsfilter name=mixing-caps ! "
+      "volume name=v", TRUE, NULL);
   topbin = ges_source_create_topbin ("audiosrcbin", sub_element, vbin, NULL);
   volume = gst_bin_get_by_name (GST_BIN (vbin), "v");
 
+  /* Convert and resample once here, to the format the track mixes in */
+  if (track && ges_track_get_mixing (track)) {
+    GESAudioSource *self = GES_AUDIO_SOURCE (trksrc);
+
+    capsfilter = gst_bin_get_by_name (GST_BIN (vbin), "mixing-caps");
+    gst_object_replace ((GstObject **) & self->priv->capsfilter,
+        GST_OBJECT (capsfilter));
+    gst_object_unref (capsfilter);
+
+    _restriction_caps_cb (track, NULL, self);
+    g_signal_connect_object (track, "notify::restriction-caps",
+        G_CALLBACK (_restriction_caps_cb), self, 0);
+  }
+
   _sync_element_to_layer_property_float (trksrc, volume, GES_META_VOLUME,
       "volume");
   ges_track_element_add_children_props (trksrc, volume, NULL, NULL, props);
@@ -93,14 +125,27 @@ ges_audio_source_create_element (GESTrackElement * trksrc)
   return topbin;
 }
 
+static void
+ges_audio_source_dispose (GObject * object)
+{
+  GESAudioSource *self = GES_AUDIO_SOURCE (object);
+
+  gst_object_replace ((GstObject **) & self->priv->capsfilter, NULL);
+
+  G_OBJECT_CLASS (ges_audio_source_parent_class)->dispose (object);
+}
+
 static void
 ges_audio_source_class_init (GESAudioSourceClass * klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GESTrackElementClass *track_class = GES_TRACK_ELEMENT_CLASS (klass);
   GESAudioSourceClass *audio_source_class = GES_AUDIO_SOURCE_CLASS (klass);
 
   g_type_class_add_private (klass, sizeof (GESAudioSourcePrivate));
 
+  object_class->dispose = ges_audio_source_dispose;
+
   track_class->gnlobject_factorytype = "gnlsource";
   track_class->create_element = ges_audio_source_create_element;
   audio_source_class->create_source = NULL;
@@ -27,6 +27,7 @@
 #include "ges-internal.h"
 #include "ges-smart-adder.h"
 #include "ges-audio-track.h"
+#include "gstgapsrc.h"
 
 struct _GESAudioTrackPrivate
 {
@@ -41,12 +42,7 @@ G_DEFINE_TYPE (GESAudioTrack, ges_audio_track, GES_TYPE_TRACK);
 static GstElement *
 create_element_for_raw_audio_gap (GESTrack * track)
 {
-  GstElement *elem;
-
-  elem = gst_element_factory_make ("audiotestsrc", NULL);
-  g_object_set (elem, "wave", 4, NULL);
-
-  return elem;
+  return ges_gap_src_new (track);
 }
 
 
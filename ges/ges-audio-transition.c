@@ -26,24 +26,27 @@
 #include "ges-internal.h"
 #include "ges-track-element.h"
 #include "ges-audio-transition.h"
-
-#include <gst/controller/gstdirectcontrolbinding.h>
+#include "gstgainmixer.h"
 
 G_DEFINE_TYPE (GESAudioTransition, ges_audio_transition, GES_TYPE_TRANSITION);
 
+#define DEFAULT_CONSTANT_POWER TRUE
+
 struct _GESAudioTransitionPrivate
 {
-  /* these enable volume interpolation. Unlike video, both inputs are adjusted
-   * simultaneously */
-  GstControlSource *a_control_source;
-
-  GstControlSource *b_control_source;
+  /* The mixer pads of the two inputs. Unlike video, both inputs are adjusted
+   * simultaneously, the mixer computes the gains for every sample once per
+   * duration change */
+  GstGainMixerPad *a_pad;
+  GstGainMixerPad *b_pad;
 
+  gboolean constant_power;
 };
 
 enum
 {
   PROP_0,
+  PROP_CONSTANT_POWER,
 };
 
 
@@ -89,6 +92,17 @@ ges_audio_transition_class_init (GESAudioTransitionClass * klass)
 
   toclass->create_element = ges_audio_transition_create_element;
 
+  /**
+   * GESAudioTransition:constant-power:
+   *
+   * Whether the crossfade keeps the power of the mix constant, which
+   * avoids the volume dip of a linear crossfade between uncorrelated
+   * inputs. If %FALSE the gains of the inputs are linear ramps.
+   */
+  g_object_class_install_property (object_class, PROP_CONSTANT_POWER,
+      g_param_spec_boolean ("constant-power", "Constant power",
+          "Whether the crossfade keeps the power of the mix constant",
+          DEFAULT_CONSTANT_POWER, G_PARAM_READWRITE));
 }
 
 static void
@@ -97,6 +111,8 @@ ges_audio_transition_init (GESAudioTransition * self)
 
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
       GES_TYPE_AUDIO_TRANSITION, GESAudioTransitionPrivate);
+
+  self->priv->constant_power = DEFAULT_CONSTANT_POWER;
 }
 
 static void
@@ -106,17 +122,8 @@ ges_audio_transition_dispose (GObject * object)
 
   self = GES_AUDIO_TRANSITION (object);
 
-  if (self->priv->a_control_source) {
-    if (self->priv->a_control_source)
-      gst_object_unref (self->priv->a_control_source);
-    self->priv->a_control_source = NULL;
-  }
-
-  if (self->priv->b_control_source) {
-    if (self->priv->b_control_source)
-      gst_object_unref (self->priv->b_control_source);
-    self->priv->b_control_source = NULL;
-  }
+  gst_object_replace ((GstObject **) & self->priv->a_pad, NULL);
+  gst_object_replace ((GstObject **) & self->priv->b_pad, NULL);
 
   g_signal_handlers_disconnect_by_func (GES_TRACK_ELEMENT (self),
       duration_changed_cb, NULL);
@@ -134,7 +141,12 @@ static void
 ges_audio_transition_get_property (GObject * object,
     guint property_id, GValue * value, GParamSpec * pspec)
 {
+  GESAudioTransition *self = GES_AUDIO_TRANSITION (object);
+
   switch (property_id) {
+    case PROP_CONSTANT_POWER:
+      g_value_set_boolean (value, self->priv->constant_power);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -144,29 +156,37 @@ static void
 ges_audio_transition_set_property (GObject * object,
     guint property_id, const GValue * value, GParamSpec * pspec)
 {
+  GESAudioTransition *self = GES_AUDIO_TRANSITION (object);
+
   switch (property_id) {
+    case PROP_CONSTANT_POWER:
+      self->priv->constant_power = g_value_get_boolean (value);
+      duration_changed_cb (GES_TRACK_ELEMENT (self), NULL);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
 }
 
-static GObject *
-link_element_to_mixer_with_volume (GstBin * bin, GstElement * element,
+/* The gain is applied by the mixer, through the fade of its pads */
+static GstGainMixerPad *
+link_element_to_mixer_with_fade (GstBin * bin, GstElement * element,
     GstElement * mixer)
 {
-  GstElement *volume = gst_element_factory_make ("volume", NULL);
   GstElement *resample = gst_element_factory_make ("audioresample", NULL);
+  GstPad *srcpad, *sinkpad = gst_element_get_request_pad (mixer, "sink_%u");
 
-  gst_bin_add (bin, volume);
   gst_bin_add (bin, resample);
+  if (!fast_element_link (element, resample))
+    GST_ERROR_OBJECT (bin, "Error linking resampler");
 
-  if (!fast_element_link (element, volume) ||
-      !fast_element_link (volume, resample) ||
-      !gst_element_link_pads_full (resample, "src", mixer, "sink_%u",
-          GST_PAD_LINK_CHECK_NOTHING))
-    GST_ERROR_OBJECT (bin, "Error linking volume to mixer");
+  srcpad = gst_element_get_static_pad (resample, "src");
+  if (gst_pad_link_full (srcpad, sinkpad,
+          GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)
+    GST_ERROR_OBJECT (bin, "Error linking resampler to mixer");
+  gst_object_unref (srcpad);
 
-  return G_OBJECT (volume);
+  return GST_GAIN_MIXER_PAD (sinkpad);
 }
 
 static GstElement *
@@ -174,12 +194,9 @@ ges_audio_transition_create_element (GESTrackElement * track_element)
 {
   GESAudioTransition *self;
   GstElement *topbin, *iconva, *iconvb, *oconv;
-  GObject *atarget, *btarget = NULL;
-  const gchar *propname = "volume";
   GstElement *mixer = NULL;
   GstPad *sinka_target, *sinkb_target, *src_target, *sinka, *sinkb, *src;
   guint64 duration;
-  GstControlSource *acontrol_source, *bcontrol_source;
 
   self = GES_AUDIO_TRANSITION (track_element);
 
@@ -192,13 +209,15 @@ ges_audio_transition_create_element (GESTrackElement * track_element)
 
   gst_bin_add_many (GST_BIN (topbin), iconva, iconvb, oconv, NULL);
 
-  mixer = gst_element_factory_make ("adder", NULL);
+  mixer = g_object_new (GST_TYPE_GAIN_MIXER, NULL);
   gst_bin_add (GST_BIN (topbin), mixer);
 
-  atarget = link_element_to_mixer_with_volume (GST_BIN (topbin), iconva, mixer);
-  btarget = link_element_to_mixer_with_volume (GST_BIN (topbin), iconvb, mixer);
+  self->priv->a_pad =
+      link_element_to_mixer_with_fade (GST_BIN (topbin), iconva, mixer);
+  self->priv->b_pad =
+      link_element_to_mixer_with_fade (GST_BIN (topbin), iconvb, mixer);
 
-  g_assert (atarget && btarget);
+  g_assert (self->priv->a_pad && self->priv->b_pad);
 
   fast_element_link (mixer, oconv);
 
@@ -214,21 +233,11 @@ ges_audio_transition_create_element (GESTrackElement * track_element)
   gst_element_add_pad (topbin, sinka);
   gst_element_add_pad (topbin, sinkb);
 
-  /* set up interpolation */
-
   gst_object_unref (sinka_target);
   gst_object_unref (sinkb_target);
   gst_object_unref (src_target);
 
-  acontrol_source = gst_interpolation_control_source_new ();
-  g_object_set (acontrol_source, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
-
-  bcontrol_source = gst_interpolation_control_source_new ();
-  g_object_set (bcontrol_source, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
-
-  self->priv->a_control_source = acontrol_source;
-  self->priv->b_control_source = bcontrol_source;
-
+  /* set up the fades */
   duration =
       ges_timeline_element_get_duration (GES_TIMELINE_ELEMENT (track_element));
   ges_audio_transition_duration_changed (track_element, duration);
@@ -236,16 +245,6 @@ ges_audio_transition_create_element (GESTrackElement * track_element)
   g_signal_connect (track_element, "notify::duration",
       G_CALLBACK (duration_changed_cb), NULL);
 
-  gst_object_add_control_binding (GST_OBJECT (atarget),
-      gst_direct_control_binding_new (GST_OBJECT (atarget), propname,
-          acontrol_source));
-  gst_object_add_control_binding (GST_OBJECT (btarget),
-      gst_direct_control_binding_new (GST_OBJECT (btarget), propname,
-          bcontrol_source));
-
-  self->priv->a_control_source = acontrol_source;
-  self->priv->b_control_source = bcontrol_source;
-
   return topbin;
 }
 
@@ -255,31 +254,21 @@ ges_audio_transition_duration_changed (GESTrackElement * track_element,
 {
   GESAudioTransition *self;
   GstElement *gnlobj = ges_track_element_get_gnlobject (track_element);
-  GstTimedValueControlSource *ta, *tb;
 
   self = GES_AUDIO_TRANSITION (track_element);
 
-  GST_INFO ("updating controller: gnlobj (%p)", gnlobj);
+  GST_INFO ("updating fades: gnlobj (%p)", gnlobj);
 
-  if (G_UNLIKELY ((!self->priv->a_control_source ||
-              !self->priv->b_control_source)))
+  if (G_UNLIKELY ((!self->priv->a_pad || !self->priv->b_pad)))
     return;
 
-  GST_INFO ("setting values on controller");
-  ta = GST_TIMED_VALUE_CONTROL_SOURCE (self->priv->a_control_source);
-  tb = GST_TIMED_VALUE_CONTROL_SOURCE (self->priv->b_control_source);
-
-  gst_timed_value_control_source_unset_all (ta);
-  gst_timed_value_control_source_unset_all (tb);
-  /* The volume property goes from 0 to 10, so we want to interpolate between
-   * 0 and 0.1 */
-  gst_timed_value_control_source_set (ta, 0, 0.1);
-  gst_timed_value_control_source_set (ta, duration, 0.0);
-
-  gst_timed_value_control_source_set (tb, 0, 0.0);
-  gst_timed_value_control_source_set (tb, duration, 0.1);
+  /* The gain tables are recomputed by the mixer for its negotiated rate */
+  gst_gain_mixer_pad_set_fade (self->priv->a_pad, GST_GAIN_MIXER_FADE_OUT,
+      self->priv->constant_power, duration);
+  gst_gain_mixer_pad_set_fade (self->priv->b_pad, GST_GAIN_MIXER_FADE_IN,
+      self->priv->constant_power, duration);
 
-  GST_INFO ("done updating controller");
+  GST_INFO ("done updating fades");
 }
 
 /**
@@ -961,7 +961,7 @@ void
 ges_base_xml_formatter_add_control_binding (GESBaseXmlFormatter * self,
     const gchar * binding_type, const gchar * source_type,
     const gchar * property_name, gint mode, const gchar * track_id,
-    GSList * timed_values)
+    const GstClockTime * timestamps, const gdouble * values, guint n_values)
 {
   GESBaseXmlFormatterPrivate *priv = _GET_PRIV (self);
   GESTrackElement *element = NULL;
@@ -975,8 +975,10 @@ ges_base_xml_formatter_add_control_binding (GESBaseXmlFormatter * self,
     pbinding = g_slice_new0 (PendingBinding);
     pbinding->source = gst_interpolation_control_source_new ();
     g_object_set (pbinding->source, "mode", mode, NULL);
-    gst_timed_value_control_source_set_from_list (GST_TIMED_VALUE_CONTROL_SOURCE
-        (pbinding->source), timed_values);
+    if (!ges_control_source_set_keyframes (GST_TIMED_VALUE_CONTROL_SOURCE
+            (pbinding->source), timestamps, values, n_values))
+      GST_WARNING ("Some keyframes of %s in track element %s were invalid",
+          property_name, track_id);
     pbinding->propname = g_strdup (property_name);
     pbinding->binding_type = g_strdup (binding_type);
     pbinding->track_id = g_strdup (track_id);
@@ -998,13 +1000,20 @@ ges_base_xml_formatter_add_control_binding (GESBaseXmlFormatter * self,
     GstControlSource *source;
 
     source = gst_interpolation_control_source_new ();
-    ges_track_element_set_control_source (element, source,
-        property_name, binding_type);
+    if (!ges_track_element_set_control_source (element, source,
+            property_name, binding_type)) {
+      GST_WARNING_OBJECT (element, "Could not bind %s", property_name);
+      gst_object_unref (source);
+      return;
+    }
 
     g_object_set (source, "mode", mode, NULL);
 
-    gst_timed_value_control_source_set_from_list (GST_TIMED_VALUE_CONTROL_SOURCE
-        (source), timed_values);
+    if (!ges_control_source_set_keyframes (GST_TIMED_VALUE_CONTROL_SOURCE
+            (source), timestamps, values, n_values))
+      GST_WARNING_OBJECT (element, "Some keyframes of %s were invalid",
+          property_name);
+    gst_object_unref (source);
   } else
     GST_WARNING ("This interpolation type is not supported\n");
 }
@@ -36,6 +36,7 @@
 #include "ges-internal.h"
 
 #include <string.h>
+#include <stdlib.h>
 
 GList *ges_clip_create_track_elements_func (GESClip * clip, GESTrackType type);
 static gboolean _ripple (GESTimelineElement * element, GstClockTime start);
@@ -343,7 +344,10 @@ _child_added (GESContainer * container, GESTimelineElement * element)
 {
   g_signal_connect (G_OBJECT (element), "notify::priority",
       G_CALLBACK (_child_priority_changed_cb), container);
-  _compute_height (container);
+
+  /* Done once in _children_updated */
+  if (!_ges_container_in_batch (container))
+    _compute_height (container);
 }
 
 static void
@@ -352,6 +356,13 @@ _child_removed (GESContainer * container, GESTimelineElement * element)
   g_signal_handlers_disconnect_by_func (element, _child_priority_changed_cb,
       container);
 
+  if (!_ges_container_in_batch (container))
+    _compute_height (container);
+}
+
+static void
+_children_updated (GESContainer * container)
+{
   _compute_height (container);
 }
 
@@ -368,12 +379,16 @@ _ungroup (GESContainer * container, gboolean recursive)
   GESTrackType track_type;
   GESTrackElement *track_element;
 
+  GHashTableIter iter;
+  gpointer key, moved_elements;
   gboolean first_obj = TRUE;
   GList *tmp, *children, *ret = NULL;
   GESClip *clip = GES_CLIP (container);
   GESTimelineElement *element = GES_TIMELINE_ELEMENT (container);
   GESLayer *layer = clip->priv->layer;
   GHashTable *_tracktype_clip = g_hash_table_new (g_int_hash, g_int_equal);
+  /* New clip -> list of the track elements to move into it */
+  GHashTable *moves = g_hash_table_new (NULL, NULL);
 
   /* If there is no TrackElement, just return @container in a list */
   if (GES_CONTAINER_CHILDREN (container) == NULL) {
@@ -407,15 +422,19 @@ _ungroup (GESContainer * container, gboolean recursive)
     }
 
     /* Move trackelement to the container it is supposed to land into */
-    if (tmpclip != clip) {
-      /* We need to bump the refcount to avoid the object to be destroyed */
-      gst_object_ref (track_element);
-      ges_container_remove (container, GES_TIMELINE_ELEMENT (track_element));
-      ges_container_add (GES_CONTAINER (tmpclip),
-          GES_TIMELINE_ELEMENT (track_element));
-      gst_object_unref (track_element);
-    }
+    if (tmpclip != clip)
+      g_hash_table_insert (moves, tmpclip,
+          g_list_prepend (g_hash_table_lookup (moves, tmpclip), track_element));
   }
+
+  /* The track elements are moved all at once, @children keeps them alive */
+  g_hash_table_iter_init (&iter, moves);
+  while (g_hash_table_iter_next (&iter, &key, &moved_elements)) {
+    ges_container_remove_children (container, moved_elements);
+    ges_container_add_children (GES_CONTAINER (key), moved_elements);
+    g_list_free (moved_elements);
+  }
+  g_hash_table_unref (moves);
   g_list_free_full (children, gst_object_unref);
   g_hash_table_foreach (_tracktype_clip, (GHFunc) add_tlobj_to_list, &ret);
   g_hash_table_unref (_tracktype_clip);
@@ -550,15 +569,13 @@ _group (GList * containers)
     GESClip *cclip = tmpclip->data;
     GList *children = ges_container_get_children (GES_CONTAINER (cclip), FALSE);
 
-    for (tmpelement = children; tmpelement; tmpelement = tmpelement->next) {
-      GESTimelineElement *celement = GES_TIMELINE_ELEMENT (tmpelement->data);
-
-      ges_container_remove (GES_CONTAINER (cclip), celement);
-      ges_container_add (ret, celement);
+    ges_container_remove_children (GES_CONTAINER (cclip), children);
+    ges_container_add_children (ret, children);
 
+    for (tmpelement = children; tmpelement; tmpelement = tmpelement->next)
       supported_formats = supported_formats |
-          ges_track_element_get_track_type (GES_TRACK_ELEMENT (celement));
-    }
+          ges_track_element_get_track_type (GES_TRACK_ELEMENT
+          (tmpelement->data));
     g_list_free_full (children, gst_object_unref);
 
     ges_layer_remove_clip (layer, tmpclip->data);
@@ -712,6 +729,7 @@ ges_clip_class_init (GESClipClass * klass)
   container_class->remove_child = _remove_child;
   container_class->child_removed = _child_removed;
   container_class->child_added = _child_added;
+  container_class->children_updated = _children_updated;
   container_class->ungroup = _ungroup;
   container_class->group = _group;
   container_class->grouping_priority = G_MAXUINT;
@@ -1141,41 +1159,21 @@ ges_clip_set_top_effect_priority (GESClip * clip,
   return TRUE;
 }
 
-/**
- * ges_clip_split:
- * @clip: the #GESClip to split
- * @position: a #GstClockTime representing the position at which to split
- *
- * The function modifies @clip, and creates another #GESClip so
- * we have two clips at the end, splitted at the time specified by @position.
- * The newly created clip will be added to the same layer as @clip is in.
- * This implies that @clip must be in a #GESLayer for the operation to
- * be possible.
- *
- * Returns: (transfer none): The newly created #GESClip resulting from the
- * splitting
- */
-GESClip *
-ges_clip_split (GESClip * clip, guint64 position)
+/* Creates the clip covering [@position, end of @clip[ and shortens @clip.
+ * The new track elements get their timing, children properties values and
+ * keyframes before being added to the clip so their GstElement-s are only
+ * built once, when they get into their track */
+static GESClip *
+_split_clip (GESClip * clip, GstClockTime position)
 {
   GList *tmp;
   GESClip *new_object;
   GstClockTime start, inpoint, duration;
 
-  g_return_val_if_fail (GES_IS_CLIP (clip), NULL);
-  g_return_val_if_fail (clip->priv->layer, NULL);
-  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (position), NULL);
-
   duration = _DURATION (clip);
   start = _START (clip);
   inpoint = _INPOINT (clip);
 
-  if (position >= start + duration || position <= start) {
-    GST_WARNING_OBJECT (clip, "Can not split %" GST_TIME_FORMAT
-        " out of boundaries", GST_TIME_ARGS (position));
-    return NULL;
-  }
-
   GST_DEBUG_OBJECT (clip, "Spliting at %" GST_TIME_FORMAT,
       GST_TIME_ARGS (position));
 
@@ -1215,13 +1213,13 @@ ges_clip_split (GESClip * clip, guint64 position)
     _set_duration0 (GES_TIMELINE_ELEMENT (new_trackelement),
         duration + start - position);
 
-    ges_container_add (GES_CONTAINER (new_object),
-        GES_TIMELINE_ELEMENT (new_trackelement));
     ges_track_element_copy_properties (GES_TIMELINE_ELEMENT (trackelement),
         GES_TIMELINE_ELEMENT (new_trackelement));
-
     ges_track_element_split_bindings (trackelement, new_trackelement,
         position - start + inpoint);
+
+    ges_container_add (GES_CONTAINER (new_object),
+        GES_TIMELINE_ELEMENT (new_trackelement));
   }
 
   _set_duration0 (GES_TIMELINE_ELEMENT (clip), position - _START (clip));
@@ -1229,6 +1227,97 @@ ges_clip_split (GESClip * clip, guint64 position)
   return new_object;
 }
 
+/**
+ * ges_clip_split:
+ * @clip: the #GESClip to split
+ * @position: a #GstClockTime representing the position at which to split
+ *
+ * The function modifies @clip, and creates another #GESClip so
+ * we have two clips at the end, splitted at the time specified by @position.
+ * The newly created clip will be added to the same layer as @clip is in.
+ * This implies that @clip must be in a #GESLayer for the operation to
+ * be possible.
+ *
+ * Returns: (transfer none): The newly created #GESClip resulting from the
+ * splitting
+ */
+GESClip *
+ges_clip_split (GESClip * clip, guint64 position)
+{
+  g_return_val_if_fail (GES_IS_CLIP (clip), NULL);
+  g_return_val_if_fail (clip->priv->layer, NULL);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (position), NULL);
+
+  if (position >= _START (clip) + _DURATION (clip) ||
+      position <= _START (clip)) {
+    GST_WARNING_OBJECT (clip, "Can not split %" GST_TIME_FORMAT
+        " out of boundaries", GST_TIME_ARGS (position));
+    return NULL;
+  }
+
+  return _split_clip (clip, position);
+}
+
+static gint
+_compare_clock_times (gconstpointer a, gconstpointer b)
+{
+  GstClockTime ta = *(const GstClockTime *) a, tb = *(const GstClockTime *) b;
+
+  return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+/**
+ * ges_clip_split_at_positions:
+ * @clip: the #GESClip to split
+ * @positions: (array length=n_positions): the positions at which to split
+ * @n_positions: the number of positions
+ *
+ * Splits @clip at all the @positions that fall strictly inside it, in
+ * any order. This is equivalent to calling #ges_clip_split for each
+ * position, but the keyframes of @clip are moved only once.
+ * As with #ges_clip_split, @clip must be in a #GESLayer.
+ *
+ * Returns: (transfer container) (element-type GESClip): The newly created
+ * #GESClip-s, sorted by start
+ */
+GList *
+ges_clip_split_at_positions (GESClip * clip, const GstClockTime * positions,
+    guint n_positions)
+{
+  gint i;
+  GList *ret = NULL;
+  GstClockTime *sorted, start, end, last = GST_CLOCK_TIME_NONE;
+
+  g_return_val_if_fail (GES_IS_CLIP (clip), NULL);
+  g_return_val_if_fail (clip->priv->layer, NULL);
+  g_return_val_if_fail (n_positions == 0 || positions, NULL);
+
+  sorted = g_memdup (positions, n_positions * sizeof (GstClockTime));
+  qsort (sorted, n_positions, sizeof (GstClockTime), _compare_clock_times);
+
+  start = _START (clip);
+  end = start + _DURATION (clip);
+
+  /* Split from the end so each part of @clip is only copied once */
+  for (i = n_positions - 1; i >= 0; i--) {
+    GESClip *new_clip;
+
+    /* GST_CLOCK_TIME_NONE is always past the end */
+    if (sorted[i] >= end || sorted[i] == last)
+      continue;
+    if (sorted[i] <= start)
+      break;
+
+    last = sorted[i];
+    new_clip = _split_clip (clip, sorted[i]);
+    if (new_clip)
+      ret = g_list_prepend (ret, new_clip);
+  }
+  g_free (sorted);
+
+  return ret;
+}
+
 /**
  * ges_clip_set_supported_formats:
  * @clip: the #GESClip to set supported formats on
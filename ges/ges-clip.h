@@ -166,6 +166,8 @@ gboolean ges_clip_set_top_effect_priority   (GESClip *clip, GESBaseEffect *effec
  *                   Editing                        *
  ****************************************************/
 GESClip* ges_clip_split  (GESClip *clip, guint64  position);
+GList*   ges_clip_split_at_positions (GESClip *clip, const GstClockTime *positions,
+                                      guint n_positions);
 
 G_END_DECLS
 #endif /* _GES_CLIP */
@@ -77,6 +77,10 @@ struct _GESContainerPrivate
    */
   GHashTable *mappings;
   guint nb_effects;
+
+  /* Set while several children are added or removed at once, children
+   * are then only sorted at the end */
+  gboolean in_batch;
 };
 
 enum
@@ -451,6 +455,12 @@ _ges_container_sort_children_by_end (GESContainer * container)
       (GCompareFunc) element_end_compare);
 }
 
+gboolean
+_ges_container_in_batch (GESContainer * container)
+{
+  return container->priv->in_batch;
+}
+
 void
 _ges_container_set_height (GESContainer * container, guint32 height)
 {
@@ -535,7 +545,8 @@ ges_container_add (GESContainer * container, GESTimelineElement * child)
 
   container->children = g_list_prepend (container->children, child);
 
-  _ges_container_sort_children (container);
+  if (!priv->in_batch)
+    _ges_container_sort_children (container);
 
   /* Listen to all property changes */
   mapping->start_notifyid =
@@ -553,7 +564,8 @@ ges_container_add (GESContainer * container, GESTimelineElement * child)
 
     g_hash_table_remove (priv->mappings, child);
     container->children = g_list_remove (container->children, child);
-    _ges_container_sort_children (container);
+    if (!priv->in_batch)
+      _ges_container_sort_children (container);
 
     return FALSE;
   }
@@ -609,6 +621,89 @@ ges_container_remove (GESContainer * container, GESTimelineElement * child)
   return TRUE;
 }
 
+static void
+_end_batch (GESContainer * container)
+{
+  GESContainerClass *klass = GES_CONTAINER_GET_CLASS (container);
+
+  container->priv->in_batch = FALSE;
+  _ges_container_sort_children (container);
+
+  if (klass->children_updated)
+    klass->children_updated (container);
+
+  g_object_thaw_notify (G_OBJECT (container));
+  gst_object_unref (container);
+}
+
+/**
+ * ges_container_add_children:
+ * @container: a #GESContainer
+ * @children: (element-type GESTimelineElement): the #GESTimelineElement-s
+ * to add
+ *
+ * Adds all the @children to @container. This is equivalent to calling
+ * #ges_container_add for each of them, but @container only updates its
+ * values once, and notifies the resulting changes once.
+ *
+ * Returns: %TRUE if all the @children were added, %FALSE otherwise.
+ */
+gboolean
+ges_container_add_children (GESContainer * container, GList * children)
+{
+  GList *tmp;
+  gboolean ret = TRUE;
+
+  g_return_val_if_fail (GES_IS_CONTAINER (container), FALSE);
+  g_return_val_if_fail (!container->priv->in_batch, FALSE);
+
+  /* Subclasses might drop their last reference when updating */
+  gst_object_ref (container);
+  g_object_freeze_notify (G_OBJECT (container));
+  container->priv->in_batch = TRUE;
+  for (tmp = children; tmp; tmp = tmp->next)
+    ret &= ges_container_add (container, tmp->data);
+  _end_batch (container);
+
+  return ret;
+}
+
+/**
+ * ges_container_remove_children:
+ * @container: a #GESContainer
+ * @children: (element-type GESTimelineElement): the #GESTimelineElement-s
+ * to release
+ *
+ * Releases all the @children from the control of @container, see
+ * #ges_container_add_children.
+ *
+ * Returns: %TRUE if all the @children were released, %FALSE otherwise.
+ */
+gboolean
+ges_container_remove_children (GESContainer * container, GList * children)
+{
+  GList *tmp;
+  gboolean ret = TRUE;
+
+  g_return_val_if_fail (GES_IS_CONTAINER (container), FALSE);
+  g_return_val_if_fail (!container->priv->in_batch, FALSE);
+
+  /* @children might be our own list */
+  children = g_list_copy (children);
+
+  /* Subclasses might drop their last reference when updating */
+  gst_object_ref (container);
+  g_object_freeze_notify (G_OBJECT (container));
+  container->priv->in_batch = TRUE;
+  for (tmp = children; tmp; tmp = tmp->next)
+    ret &= ges_container_remove (container, tmp->data);
+  _end_batch (container);
+
+  g_list_free (children);
+
+  return ret;
+}
+
 static void
 _get_children_recursively (GESContainer * container, GList ** children)
 {
@@ -770,6 +865,9 @@ gboolean
 ges_container_edit (GESContainer * container, GList * layers,
     gint new_layer_priority, GESEditMode mode, GESEdge edge, guint64 position)
 {
+  gint64 trace;
+  gboolean ret;
+
   g_return_val_if_fail (GES_IS_CONTAINER (container), FALSE);
 
   if (G_UNLIKELY (GES_CONTAINER_GET_CLASS (container)->edit == NULL)) {
@@ -777,6 +875,10 @@ ges_container_edit (GESContainer * container, GList * layers,
     return FALSE;
   }
 
-  return GES_CONTAINER_GET_CLASS (container)->edit (container, layers,
+  trace = GES_TRACE_BEGIN ();
+  ret = GES_CONTAINER_GET_CLASS (container)->edit (container, layers,
       new_layer_priority, mode, edge, position);
+  GES_TRACE_END (trace, "ges_container_edit");
+
+  return ret;
 }
@@ -106,6 +106,10 @@ struct _GESContainer
  * @ungroup: Ungroups the #GESTimelineElement contained in this #GESContainer, creating new
  * @group: Groups the #GESContainers together
  * #GESContainer containing those #GESTimelineElement apropriately.
+ * @children_updated: Virtual method called once after several children have
+ * been added or removed with #ges_container_add_children or
+ * #ges_container_remove_children, subclasses can use it to update their
+ * values only once.
  */
 struct _GESContainerClass
 {
@@ -126,13 +130,15 @@ struct _GESContainerClass
                                    GESEdge edge,
                                    guint64 position);
 
-
-
   /*< private >*/
   guint grouping_priority;
 
+  /*< public >*/
+  void (*children_updated)        (GESContainer *container);
+
+  /*< private >*/
   /* Padding for API extension */
-  gpointer _ges_reserved[GES_PADDING_LARGE];
+  gpointer _ges_reserved[GES_PADDING_LARGE - 1];
 };
 
 GType ges_container_get_type (void);
@@ -141,6 +147,8 @@ GType ges_container_get_type (void);
 GList* ges_container_get_children (GESContainer *container, gboolean recursive);
 gboolean ges_container_add        (GESContainer *container, GESTimelineElement *child);
 gboolean ges_container_remove     (GESContainer *container, GESTimelineElement *child);
+gboolean ges_container_add_children    (GESContainer *container, GList *children);
+gboolean ges_container_remove_children (GESContainer *container, GList *children);
 GList * ges_container_ungroup     (GESContainer * container, gboolean recursive);
 GESContainer *ges_container_group (GList *containers);
 
@@ -31,18 +31,419 @@
 
 G_DEFINE_TYPE (GESEffectAsset, ges_effect_asset, GES_TYPE_TRACK_ELEMENT_ASSET);
 
+/* A child property of the effect, found once on the template */
+typedef struct
+{
+  gchar *element_name;
+  GParamSpec *pspec;
+} EffectChildProperty;
+
 struct _GESEffectAssetPrivate
 {
   GESTrackType track_type;
+
+  /* The parsed bin description. It is never used in a pipeline, effect bins
+   * are built by copying it, which is much cheaper than parsing the
+   * description again and introspecting the result */
+  GstElement *template;
+  gboolean cloneable;
+
+  /* The pads of the template children exposed by its ghost pads */
+  GstPad *sink_target;
+  GstPad *src_target;
+
+  GList *children_props;        /* EffectChildProperty */
 };
 
+static void
+_free_child_property (EffectChildProperty * prop)
+{
+  g_free (prop->element_name);
+  g_param_spec_unref (prop->pspec);
+  g_slice_free (EffectChildProperty, prop);
+}
+
+static GstPad *
+_ghost_target (GstElement * bin, const gchar * name)
+{
+  GstPad *target, *ghost = gst_element_get_static_pad (bin, name);
+
+  if (ghost == NULL)
+    return NULL;
+
+  target = gst_ghost_pad_get_target (GST_GHOST_PAD (ghost));
+  gst_object_unref (ghost);
+
+  if (target)
+    gst_object_unref (target);
+
+  return target;
+}
+
+/* We only know how to copy plain chains of elements with static pads, and
+ * whose properties can be set after construction */
+static gboolean
+_check_cloneable (GESEffectAsset * self)
+{
+  GList *tmp;
+  GESEffectAssetPrivate *priv = self->priv;
+
+  priv->sink_target = _ghost_target (priv->template, "sink");
+  priv->src_target = _ghost_target (priv->template, "src");
+  if (priv->sink_target == NULL || priv->src_target == NULL)
+    return FALSE;
+
+  for (tmp = GST_BIN_CHILDREN (priv->template); tmp; tmp = tmp->next) {
+    guint i, n_specs;
+    GParamSpec **specs;
+    GList *tmppad;
+    GstElement *child = tmp->data;
+
+    if (GST_IS_BIN (child) || gst_element_get_factory (child) == NULL)
+      return FALSE;
+
+    for (tmppad = GST_ELEMENT_PADS (child); tmppad; tmppad = tmppad->next) {
+      GstPadTemplate *templ = GST_PAD_PAD_TEMPLATE (tmppad->data);
+
+      if (templ == NULL || GST_PAD_TEMPLATE_PRESENCE (templ) != GST_PAD_ALWAYS)
+        return FALSE;
+    }
+
+    specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (child),
+        &n_specs);
+    for (i = 0; i < n_specs; i++) {
+      GValue value = { 0, };
+      gboolean is_default;
+
+      if (!(specs[i]->flags & G_PARAM_CONSTRUCT_ONLY) ||
+          !(specs[i]->flags & G_PARAM_READABLE))
+        continue;
+
+      g_value_init (&value, specs[i]->value_type);
+      g_object_get_property (G_OBJECT (child), specs[i]->name, &value);
+      is_default = g_param_value_defaults (specs[i], &value);
+      g_value_unset (&value);
+
+      if (!is_default) {
+        g_free (specs);
+        return FALSE;
+      }
+    }
+    g_free (specs);
+  }
+
+  return TRUE;
+}
+
+static void
+_list_children_props (GESEffectAsset * self)
+{
+  GList *tmp;
+  const gchar *wanted_category = "Effect";
+
+  /* Same selection as ges_track_element_add_children_props does */
+  for (tmp = GST_BIN_CHILDREN (self->priv->template); tmp; tmp = tmp->next) {
+    guint i, n_specs;
+    gchar **categories;
+    GParamSpec **specs;
+    GstElement *child = tmp->data;
+    const gchar *klass =
+        gst_element_factory_get_metadata (gst_element_get_factory (child),
+        GST_ELEMENT_METADATA_KLASS);
+
+    categories = g_strsplit (klass, "/", 0);
+    for (i = 0; categories[i]; i++) {
+      if (g_strcmp0 (categories[i], wanted_category) == 0)
+        break;
+    }
+
+    if (categories[i] == NULL) {
+      g_strfreev (categories);
+      continue;
+    }
+    g_strfreev (categories);
+
+    specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (child),
+        &n_specs);
+    for (i = 0; i < n_specs; i++) {
+      EffectChildProperty *prop;
+
+      if (!(specs[i]->flags & G_PARAM_WRITABLE))
+        continue;
+
+      prop = g_slice_new (EffectChildProperty);
+      prop->element_name = g_strdup (GST_OBJECT_NAME (child));
+      prop->pspec = g_param_spec_ref (specs[i]);
+      self->priv->children_props =
+          g_list_prepend (self->priv->children_props, prop);
+    }
+    g_free (specs);
+  }
+
+  self->priv->children_props = g_list_reverse (self->priv->children_props);
+}
+
+static void
+_ensure_template (GESEffectAsset * self)
+{
+  GError *error = NULL;
+  GESEffectAssetPrivate *priv = self->priv;
+
+  if (priv->template)
+    return;
+
+  priv->template =
+      gst_parse_bin_from_description (ges_asset_get_id (GES_ASSET (self)),
+      TRUE, &error);
+  if (priv->template == NULL) {
+    GST_WARNING_OBJECT (self, "Could not parse the effect description: %s",
+        error ? error->message : "unknown error");
+    g_clear_error (&error);
+
+    return;
+  }
+  gst_object_ref_sink (priv->template);
+
+  priv->cloneable = _check_cloneable (self);
+  if (priv->cloneable)
+    _list_children_props (self);
+
+  GST_DEBUG_OBJECT (self, "Effect template %s be copied",
+      priv->cloneable ? "can" : "can not");
+}
+
+static GstElement *
+_clone_element (GstElement * element)
+{
+  guint i, n_specs;
+  GParamSpec **specs;
+  GstElement *clone = gst_element_factory_create (gst_element_get_factory
+      (element), GST_OBJECT_NAME (element));
+
+  if (clone == NULL)
+    return NULL;
+
+  /* Only the properties set in the description differ from the defaults */
+  specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (element),
+      &n_specs);
+  for (i = 0; i < n_specs; i++) {
+    GValue value = { 0, };
+
+    if ((specs[i]->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE ||
+        (specs[i]->flags & G_PARAM_CONSTRUCT_ONLY) ||
+        !g_strcmp0 (specs[i]->name, "name") ||
+        !g_strcmp0 (specs[i]->name, "parent"))
+      continue;
+
+    g_value_init (&value, specs[i]->value_type);
+    g_object_get_property (G_OBJECT (element), specs[i]->name, &value);
+    if (!g_param_value_defaults (specs[i], &value))
+      g_object_set_property (G_OBJECT (clone), specs[i]->name, &value);
+    g_value_unset (&value);
+  }
+  g_free (specs);
+
+  return clone;
+}
+
+/* Borrowed reference to the child of @bin called like @element */
+static GstElement *
+_get_copy_of (GstBin * bin, GstElement * element)
+{
+  GstElement *child = gst_bin_get_by_name (bin, GST_OBJECT_NAME (element));
+
+  gst_object_unref (child);
+
+  return child;
+}
+
+/* Copies the children of the template in @bin and links them the same
+ * way, returns the pads matching the template ghost pads targets */
+static gboolean
+_clone_template (GESEffectAsset * self, GstBin * bin, GstPad ** sinkpad,
+    GstPad ** srcpad)
+{
+  GList *tmp, *tmppad;
+  GESEffectAssetPrivate *priv = self->priv;
+
+  for (tmp = GST_BIN_CHILDREN (priv->template); tmp; tmp = tmp->next) {
+    GstElement *clone = _clone_element (tmp->data);
+
+    if (clone == NULL || !gst_bin_add (bin, clone))
+      return FALSE;
+  }
+
+  for (tmp = GST_BIN_CHILDREN (priv->template); tmp; tmp = tmp->next) {
+    GstElement *child = tmp->data;
+
+    for (tmppad = GST_ELEMENT_SRCPADS (child); tmppad; tmppad = tmppad->next) {
+      GstPad *peer = GST_PAD_PEER (tmppad->data);
+
+      if (peer == NULL)
+        continue;
+
+      if (!gst_element_link_pads (_get_copy_of (bin, child),
+              GST_OBJECT_NAME (tmppad->data), _get_copy_of (bin,
+                  GST_ELEMENT (GST_OBJECT_PARENT (peer))),
+              GST_OBJECT_NAME (peer)))
+        return FALSE;
+    }
+  }
+
+  *sinkpad = gst_element_get_static_pad (_get_copy_of (bin,
+          GST_ELEMENT (GST_OBJECT_PARENT (priv->sink_target))),
+      GST_OBJECT_NAME (priv->sink_target));
+  *srcpad = gst_element_get_static_pad (_get_copy_of (bin,
+          GST_ELEMENT (GST_OBJECT_PARENT (priv->src_target))),
+      GST_OBJECT_NAME (priv->src_target));
+
+  return TRUE;
+}
+
+/* Whether the formats the track can carry all go through @pad untouched */
+static gboolean
+_accepts_track_formats (GstPad * pad, GESTrack * track)
+{
+  gboolean ret;
+  GstCaps *pad_caps, *track_caps, *restriction_caps = NULL;
+
+  g_object_get (track, "restriction-caps", &restriction_caps, NULL);
+  if (restriction_caps && !gst_caps_is_any (restriction_caps))
+    track_caps = gst_caps_intersect ((GstCaps *) ges_track_get_caps (track),
+        restriction_caps);
+  else
+    track_caps = gst_caps_ref ((GstCaps *) ges_track_get_caps (track));
+
+  pad_caps = gst_pad_get_pad_template_caps (pad);
+  ret = gst_caps_is_subset (track_caps, pad_caps);
+
+  gst_caps_unref (pad_caps);
+  gst_caps_unref (track_caps);
+  if (restriction_caps)
+    gst_caps_unref (restriction_caps);
+
+  return ret;
+}
+
+static gboolean
+_add_and_link (GstBin * bin, GstElement * element, GstPad ** srcpad)
+{
+  GstPad *sinkpad;
+  gboolean ret;
+
+  if (element == NULL || !gst_bin_add (bin, element))
+    return FALSE;
+
+  sinkpad = gst_element_get_static_pad (element, "sink");
+  ret = (gst_pad_link (*srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+  gst_object_unref (*srcpad);
+  *srcpad = gst_element_get_static_pad (element, "src");
+
+  return ret;
+}
+
+/* Creates the bin of @effect by copying the template, and sets its children
+ * properties from the list built once for the asset. Format converters are
+ * only added if the effect can not handle all the formats of the track.
+ * Returns %NULL if the template can not be copied, the description should
+ * then be parsed as usual */
+GstElement *
+ges_effect_asset_create_element (GESEffectAsset * self,
+    GESTrackElement * effect)
+{
+  GList *tmp;
+  GstElement *bin;
+  GstPad *sinkpad, *srcpad, *ghost;
+  GESEffectAssetPrivate *priv = self->priv;
+  GESTrack *track = ges_track_element_get_track (effect);
+
+  if (track->type != GES_TRACK_TYPE_VIDEO &&
+      track->type != GES_TRACK_TYPE_AUDIO)
+    return NULL;
+
+  _ensure_template (self);
+  if (!priv->cloneable)
+    return NULL;
+
+  bin = gst_bin_new (NULL);
+  if (!_clone_template (self, GST_BIN (bin), &sinkpad, &srcpad))
+    goto failed;
+
+  /* Mirror "videoconvert ! <description> ! videoconvert" and
+   * "audioconvert ! audioresample ! <description>" only when needed */
+  if (!_accepts_track_formats (sinkpad, track)) {
+    GstPad *convsrc;
+    GstElement *first;
+
+    if (track->type == GES_TRACK_TYPE_VIDEO) {
+      first = gst_element_factory_make ("videoconvert", "pre_video_convert");
+      if (first == NULL || !gst_bin_add (GST_BIN (bin), first))
+        goto failed;
+      convsrc = gst_element_get_static_pad (first, "src");
+    } else {
+      first = gst_element_factory_make ("audioconvert", NULL);
+      if (first == NULL || !gst_bin_add (GST_BIN (bin), first))
+        goto failed;
+      convsrc = gst_element_get_static_pad (first, "src");
+      if (!_add_and_link (GST_BIN (bin),
+              gst_element_factory_make ("audioresample", NULL), &convsrc))
+        goto failed;
+    }
+
+    if (gst_pad_link (convsrc, sinkpad) != GST_PAD_LINK_OK) {
+      gst_object_unref (convsrc);
+      goto failed;
+    }
+    gst_object_unref (convsrc);
+    gst_object_unref (sinkpad);
+    sinkpad = gst_element_get_static_pad (first, "sink");
+  }
+
+  if (track->type == GES_TRACK_TYPE_VIDEO &&
+      !_accepts_track_formats (srcpad, track)) {
+    if (!_add_and_link (GST_BIN (bin),
+            gst_element_factory_make ("videoconvert", "post_video_convert"),
+            &srcpad))
+      goto failed;
+  }
+
+  ghost = gst_ghost_pad_new ("sink", sinkpad);
+  gst_element_add_pad (bin, ghost);
+  ghost = gst_ghost_pad_new ("src", srcpad);
+  gst_element_add_pad (bin, ghost);
+  gst_object_unref (sinkpad);
+  gst_object_unref (srcpad);
+
+  for (tmp = priv->children_props; tmp; tmp = tmp->next) {
+    EffectChildProperty *prop = tmp->data;
+    GstElement *child = gst_bin_get_by_name (GST_BIN (bin),
+        prop->element_name);
+
+    ges_track_element_add_child_property (effect, prop->pspec, child);
+    gst_object_unref (child);
+  }
+
+  return bin;
+
+failed:
+  {
+    GST_WARNING_OBJECT (self, "Could not copy the effect template");
+    gst_object_unref (bin);
+
+    return NULL;
+  }
+}
+
 /* GESAsset virtual methods implementation */
 static void
 _fill_track_type (GESAsset * asset)
 {
   GList *tmp;
-  GstElement *effect = gst_parse_bin_from_description (ges_asset_get_id (asset),
-      TRUE, NULL);
+  GstElement *effect;
+
+  _ensure_template (GES_EFFECT_ASSET (asset));
+  effect = GES_EFFECT_ASSET (asset)->priv->template;
 
   if (effect == NULL)
     return;
@@ -64,7 +465,6 @@ _fill_track_type (GESAsset * asset)
     }
   }
 
-  gst_object_unref (effect);
   return;
 }
 
@@ -103,7 +503,12 @@ ges_effect_asset_init (GESEffectAsset * self)
 static void
 ges_effect_asset_finalize (GObject * object)
 {
-  /* TODO: Add deinitalization code here */
+  GESEffectAssetPrivate *priv = GES_EFFECT_ASSET (object)->priv;
+
+  if (priv->template)
+    gst_object_unref (priv->template);
+  g_list_free_full (priv->children_props,
+      (GDestroyNotify) _free_child_property);
 
   G_OBJECT_CLASS (ges_effect_asset_parent_class)->finalize (object);
 }
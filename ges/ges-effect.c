@@ -189,6 +189,7 @@ ges_effect_create_element (GESTrackElement * object)
   GError *error = NULL;
   GESEffect *self = GES_EFFECT (object);
   GESTrack *track = ges_track_element_get_track (object);
+  GESAsset *asset = ges_extractable_get_asset (GES_EXTRACTABLE (object));
   const gchar *wanted_categories[] = { "Effect", NULL };
 
   if (!track) {
@@ -198,6 +199,18 @@ ges_effect_create_element (GESTrackElement * object)
     return NULL;
   }
 
+  /* Copy the bin prepared once for the asset when possible */
+  if (GES_IS_EFFECT_ASSET (asset)) {
+    effect = ges_effect_asset_create_element (GES_EFFECT_ASSET (asset),
+        object);
+
+    if (effect) {
+      GST_DEBUG ("Created effect %p from its asset template", effect);
+
+      return effect;
+    }
+  }
+
   if (track->type == GES_TRACK_TYPE_VIDEO) {
     bin_desc = g_strconcat ("videoconvert name=pre_video_convert ! ",
         self->priv->bin_description, " ! videoconvert name=post_video_convert",
@@ -84,6 +84,8 @@ register_ges_pipeline_flags (GType * id)
     {C_ENUM (GES_PIPELINE_MODE_RENDER), "GES_PIPELINE_MODE_RENDER", "render"},
     {C_ENUM (GES_PIPELINE_MODE_SMART_RENDER), "GES_PIPELINE_MODE_SMART_RENDER",
         "smart_render"},
+    {C_ENUM (GES_PIPELINE_MODE_THUMBNAIL), "GES_PIPELINE_MODE_THUMBNAIL",
+        "thumbnail"},
     {0, NULL, NULL}
   };
 
@@ -330,6 +330,8 @@ GType ges_video_test_pattern_get_type (void);
  * @GES_PIPELINE_MODE_PREVIEW: output audio/video to soundcard/screen (default)
  * @GES_PIPELINE_MODE_RENDER: render timeline (forces decoding)
  * @GES_PIPELINE_MODE_SMART_RENDER: render timeline (tries to avoid decoding/reencoding)
+ * @GES_PIPELINE_MODE_THUMBNAIL: decode video to an internal sink used by
+ * ges_pipeline_get_thumbnails()
  *
  * The various modes the #GESPipeline can be configured to.
  */
@@ -338,7 +340,8 @@ typedef enum {
   GES_PIPELINE_MODE_PREVIEW_VIDEO	= 1 << 1,
   GES_PIPELINE_MODE_PREVIEW		= GES_PIPELINE_MODE_PREVIEW_AUDIO | GES_PIPELINE_MODE_PREVIEW_VIDEO,
   GES_PIPELINE_MODE_RENDER		= 1 << 2,
-  GES_PIPELINE_MODE_SMART_RENDER	= 1 << 3
+  GES_PIPELINE_MODE_SMART_RENDER	= 1 << 3,
+  GES_PIPELINE_MODE_THUMBNAIL		= 1 << 4
 } GESPipelineFlags;
 
 #define GES_TYPE_PIPELINE_FLAGS\
@@ -355,8 +355,11 @@ ges_formatter_load_from_uri (GESFormatter * formatter,
   g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
 
   if (klass->load_from_uri) {
+    gint64 trace = GES_TRACE_BEGIN ();
+
     formatter->timeline = timeline;
     ret = klass->load_from_uri (formatter, timeline, uri, error);
+    GES_TRACE_END (trace, "ges_formatter_load");
   }
 
   return ret;
@@ -386,9 +389,12 @@ ges_formatter_save_to_uri (GESFormatter * formatter, GESTimeline *
 
   GST_DEBUG_OBJECT (formatter, "Saving %" GST_PTR_FORMAT " to %s",
       timeline, uri);
-  if (klass->save_to_uri)
+  if (klass->save_to_uri) {
+    gint64 trace = GES_TRACE_BEGIN ();
+
     ret = klass->save_to_uri (formatter, timeline, uri, overwrite, &lerr);
-  else
+    GES_TRACE_END (trace, "ges_formatter_save");
+  } else
     GST_ERROR_OBJECT (formatter, "save_to_uri not implemented!");
 
   if (lerr) {
@@ -374,19 +374,15 @@ _add_child (GESContainer * group, GESTimelineElement * child)
   return TRUE;
 }
 
+/* Makes our start and duration cover all our children */
 static void
-_child_added (GESContainer * group, GESTimelineElement * child)
+_update_extents (GESContainer * group)
 {
   GList *children, *tmp;
 
   GESGroupPrivate *priv = GES_GROUP (group)->priv;
   GstClockTime last_child_end = 0, first_child_start = G_MAXUINT64;
 
-  if (!GES_TIMELINE_ELEMENT_TIMELINE (group)) {
-    timeline_add_group (GES_TIMELINE_ELEMENT_TIMELINE (child),
-        GES_GROUP (group));
-  }
-
   children = GES_CONTAINER_CHILDREN (group);
 
   for (tmp = children; tmp; tmp = tmp->next) {
@@ -409,6 +405,19 @@ _child_added (GESContainer * group, GESTimelineElement * child)
 
   group->children_control_mode = GES_CHILDREN_UPDATE;
   _update_our_values (GES_GROUP (group));
+}
+
+static void
+_child_added (GESContainer * group, GESTimelineElement * child)
+{
+  if (!GES_TIMELINE_ELEMENT_TIMELINE (group)) {
+    timeline_add_group (GES_TIMELINE_ELEMENT_TIMELINE (child),
+        GES_GROUP (group));
+  }
+
+  /* Done once in _children_updated */
+  if (!_ges_container_in_batch (group))
+    _update_extents (group);
 
   if (GES_IS_CLIP (child)) {
     g_signal_connect (child, "notify::layer",
@@ -426,10 +435,6 @@ _child_removed (GESContainer * group, GESTimelineElement * child)
   GstClockTime first_child_start;
   GESGroupPrivate *priv = GES_GROUP (group)->priv;
 
-  _ges_container_sort_children (group);
-
-  children = GES_CONTAINER_CHILDREN (group);
-
   if (GES_IS_CLIP (child))
     g_signal_handlers_disconnect_by_func (child, _child_clip_changed_layer_cb,
         group);
@@ -437,6 +442,13 @@ _child_removed (GESContainer * group, GESTimelineElement * child)
     g_signal_handlers_disconnect_by_func (child, _child_group_priority_changed,
         group);
 
+  /* Done once in _children_updated */
+  if (_ges_container_in_batch (group))
+    return;
+
+  _ges_container_sort_children (group);
+  children = GES_CONTAINER_CHILDREN (group);
+
   if (children == NULL) {
     GST_FIXME_OBJECT (group, "Auto destroy myself?");
     timeline_remove_group (GES_TIMELINE_ELEMENT_TIMELINE (group),
@@ -454,24 +466,35 @@ _child_removed (GESContainer * group, GESTimelineElement * child)
   priv->setting_value = FALSE;
 }
 
+static void
+_children_updated (GESContainer * group)
+{
+  if (GES_CONTAINER_CHILDREN (group) == NULL) {
+    if (GES_TIMELINE_ELEMENT_TIMELINE (group)) {
+      GST_FIXME_OBJECT (group, "Auto destroy myself?");
+      timeline_remove_group (GES_TIMELINE_ELEMENT_TIMELINE (group),
+          GES_GROUP (group));
+    }
+
+    return;
+  }
+
+  _update_extents (group);
+}
+
 static GList *
 _ungroup (GESContainer * group, gboolean recursive)
 {
-  GList *children, *tmp, *ret = NULL;
+  GList *children;
 
+  /* The returned list keeps the references we get here */
   children = ges_container_get_children (group, FALSE);
-  for (tmp = children; tmp; tmp = tmp->next) {
-    GESTimelineElement *child = tmp->data;
+  ges_container_remove_children (group, children);
 
-    gst_object_ref (child);
-    ges_container_remove (group, child);
-    ret = g_list_append (ret, child);
-  }
-  g_list_free_full (children, gst_object_unref);
-
-  /* No need to remove from the timeline here, this will be done in _child_removed */
+  /* No need to remove from the timeline here, this will be done in
+   * _children_updated */
 
-  return ret;
+  return children;
 }
 
 static GESContainer *
@@ -492,10 +515,10 @@ _group (GList * containers)
 
       return NULL;
     }
-
-    ges_container_add (ret, tmp->data);
   }
 
+  ges_container_add_children (ret, containers);
+
   /* No need to add to the timeline here, this will be done in _child_added */
 
   return ret;
@@ -549,6 +572,7 @@ ges_group_class_init (GESGroupClass * klass)
   container_class->add_child = _add_child;
   container_class->child_added = _child_added;
   container_class->child_removed = _child_removed;
+  container_class->children_updated = _children_updated;
   container_class->ungroup = _ungroup;
   container_class->group = _group;
   container_class->grouping_priority = 0;
@@ -0,0 +1,286 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The image cache holds, for the whole process, the still images decoded
+ * for GESImageSource, keyed by uri and by the caps they were converted to,
+ * so that an image used several times is decoded and stored once.
+ *
+ * Images are decoded by prerolling a "uridecodebin ! videoconvert !
+ * videoscale ! capsfilter ! appsink" pipeline. The cached buffers are
+ * never written to: users push references to them, or shallow copies when
+ * they need to set timestamps. Images are evicted in least recently used
+ * order when the cache uses more than IMAGE_CACHE_MAX_SIZE bytes, the ones
+ * still being pushed stay alive until their users drop them.
+ *
+ * Images are decoded without the cache lock. While an image is being
+ * decoded its key is pending, and other lookups of the same key wait for it
+ * to be published instead of decoding it again.
+ */
+
+#include "ges-internal.h"
+
+#define IMAGE_CACHE_MAX_SIZE   (64 * 1024 * 1024)
+#define IMAGE_DECODE_TIMEOUT   (5 * GST_SECOND)
+
+typedef struct
+{
+  gchar *key;
+  GstSample *sample;
+  gsize size;
+} CachedImage;
+
+static GMutex cache_lock;
+static GCond cache_cond;        /* Signalled when a decoding is done */
+static GHashTable *images = NULL;       /* key -> GList link in lru */
+static GHashTable *pending = NULL;      /* set of the keys being decoded */
+static GQueue lru = G_QUEUE_INIT;       /* CachedImage, most recent first */
+static gsize cache_size = 0;
+
+static void
+_free_image (CachedImage * image)
+{
+  g_free (image->key);
+  gst_sample_unref (image->sample);
+  g_slice_free (CachedImage, image);
+}
+
+static gchar *
+_make_key (const gchar * uri, GstCaps * caps)
+{
+  gchar *caps_str, *key;
+
+  caps_str = caps ? gst_caps_to_string (caps) : NULL;
+  key = g_strdup_printf ("%s\n%s", uri, GST_STR_NULL (caps_str));
+  g_free (caps_str);
+
+  return key;
+}
+
+static GstSample *
+_decode_image (const gchar * uri, GstCaps * caps)
+{
+  GError *err = NULL;
+  GstSample *sample = NULL;
+  GstElement *pipeline, *decoder, *filter, *sink;
+
+  pipeline = gst_parse_launch ("uridecodebin name=decoder ! videoconvert ! "
+      "videoscale add-borders=true ! capsfilter name=filter ! "
+      "appsink name=sink sync=false", &err);
+  if (pipeline == NULL) {
+    GST_WARNING ("Could not create an image decoder: %s",
+        err ? err->message : "unknown error");
+    g_clear_error (&err);
+
+    return NULL;
+  }
+
+  decoder = gst_bin_get_by_name (GST_BIN (pipeline), "decoder");
+  filter = gst_bin_get_by_name (GST_BIN (pipeline), "filter");
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+
+  g_object_set (decoder, "uri", uri, NULL);
+  if (caps)
+    g_object_set (filter, "caps", caps, NULL);
+
+  gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  switch (gst_element_get_state (pipeline, NULL, NULL, IMAGE_DECODE_TIMEOUT)) {
+    case GST_STATE_CHANGE_SUCCESS:
+      g_signal_emit_by_name (sink, "pull-preroll", &sample);
+      break;
+    case GST_STATE_CHANGE_ASYNC:
+      GST_WARNING ("Timed out decoding %s", uri);
+      break;
+    default:
+      break;
+  }
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  gst_object_unref (decoder);
+  gst_object_unref (filter);
+  gst_object_unref (sink);
+  gst_object_unref (pipeline);
+
+  return sample;
+}
+
+/* Called with the lock taken */
+static GstSample *
+_lookup (const gchar * key)
+{
+  GList *link;
+
+  if (images == NULL)
+    return NULL;
+
+  link = g_hash_table_lookup (images, key);
+  if (link == NULL)
+    return NULL;
+
+  g_queue_unlink (&lru, link);
+  g_queue_push_head_link (&lru, link);
+
+  return gst_sample_ref (((CachedImage *) link->data)->sample);
+}
+
+/* Returns the image at @uri decoded and converted to @caps, or to its own
+ * format if @caps is %NULL, decoding it if it is not cached, or %NULL if it
+ * can not be decoded. The buffer of the sample must not be modified */
+GstSample *
+ges_image_cache_lookup (const gchar * uri, GstCaps * caps)
+{
+  gchar *key;
+  CachedImage *image;
+  GstSample *sample;
+
+  g_return_val_if_fail (uri, NULL);
+
+  key = _make_key (uri, caps);
+
+  g_mutex_lock (&cache_lock);
+  if (images == NULL) {
+    images = g_hash_table_new (g_str_hash, g_str_equal);
+    pending = g_hash_table_new (g_str_hash, g_str_equal);
+  }
+
+  /* Sources starting together on the same image only decode it once */
+  while (g_hash_table_contains (pending, key))
+    g_cond_wait (&cache_cond, &cache_lock);
+
+  sample = _lookup (key);
+  if (sample) {
+    g_mutex_unlock (&cache_lock);
+    g_free (key);
+
+    return sample;
+  }
+
+  g_hash_table_add (pending, key);
+  g_mutex_unlock (&cache_lock);
+
+  sample = _decode_image (uri, caps);
+  if (sample && gst_sample_get_buffer (sample) == NULL) {
+    gst_sample_unref (sample);
+    sample = NULL;
+  }
+
+  g_mutex_lock (&cache_lock);
+  g_hash_table_remove (pending, key);
+
+  if (sample == NULL) {
+    g_cond_broadcast (&cache_cond);
+    g_mutex_unlock (&cache_lock);
+    GST_WARNING ("Could not decode %s", uri);
+    g_free (key);
+
+    return NULL;
+  }
+
+  image = g_slice_new (CachedImage);
+  image->key = key;
+  image->sample = gst_sample_ref (sample);
+  image->size = gst_buffer_get_size (gst_sample_get_buffer (sample));
+
+  g_queue_push_head (&lru, image);
+  g_hash_table_insert (images, image->key, lru.head);
+  cache_size += image->size;
+
+  /* Never evict the image we just decoded */
+  while (cache_size > IMAGE_CACHE_MAX_SIZE && lru.length > 1) {
+    CachedImage *last = g_queue_pop_tail (&lru);
+
+    GST_DEBUG ("Evicting image of %" G_GSIZE_FORMAT " bytes", last->size);
+    g_hash_table_remove (images, last->key);
+    cache_size -= last->size;
+    _free_image (last);
+  }
+  g_cond_broadcast (&cache_cond);
+  g_mutex_unlock (&cache_lock);
+
+  return sample;
+}
+
+/* Same as ges_image_cache_lookup() but never decodes anything */
+GstSample *
+ges_image_cache_peek (const gchar * uri, GstCaps * caps)
+{
+  gchar *key;
+  GstSample *sample;
+
+  g_return_val_if_fail (uri, NULL);
+
+  key = _make_key (uri, caps);
+  g_mutex_lock (&cache_lock);
+  sample = _lookup (key);
+  g_mutex_unlock (&cache_lock);
+  g_free (key);
+
+  return sample;
+}
+
+/* The caps images shown by @element are decoded to: the fields of the
+ * restriction caps of its track that are fixed, %NULL to keep the format of
+ * the images. Sources sharing decoded images must all use those caps. */
+GstCaps *
+ges_image_cache_get_target_caps (GESTrackElement * element)
+{
+  guint i;
+  GESTrack *track;
+  GstStructure *structure, *rstructure;
+  GstCaps *restriction = NULL, *caps = NULL;
+  const gchar *fields[] = { "format", "width", "height",
+    "pixel-aspect-ratio", NULL
+  };
+
+  if (element == NULL)
+    return NULL;
+
+  track = ges_track_element_get_track (element);
+  if (track)
+    g_object_get (track, "restriction-caps", &restriction, NULL);
+
+  if (restriction == NULL)
+    return NULL;
+
+  if (gst_caps_is_empty (restriction) || gst_caps_is_any (restriction)) {
+    gst_caps_unref (restriction);
+
+    return NULL;
+  }
+
+  rstructure = gst_caps_get_structure (restriction, 0);
+  structure = gst_structure_new_empty ("video/x-raw");
+  for (i = 0; fields[i]; i++) {
+    const GValue *value = gst_structure_get_value (rstructure, fields[i]);
+
+    if (value && gst_value_is_fixed (value))
+      gst_structure_set_value (structure, fields[i], value);
+  }
+  gst_caps_unref (restriction);
+
+  if (gst_structure_n_fields (structure) == 0) {
+    gst_structure_free (structure);
+
+    return NULL;
+  }
+
+  caps = gst_caps_new_empty ();
+  gst_caps_append_structure (caps, structure);
+
+  return caps;
+}
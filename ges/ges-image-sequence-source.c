@@ -32,6 +32,7 @@
 #include "ges-uri-asset.h"
 #include "ges-internal.h"
 #include "ges-uri-clip.h"
+#include "gstimagesequencereader.h"
 
 /* Extractable interface implementation */
 
@@ -225,6 +226,12 @@ ges_image_sequence_source_create_source (GESTrackElement * track_element)
 
   self = (GESImageSequenceSource *) track_element;
 
+  /* Files we know about are read and decoded ahead of time */
+  if (self->priv->filenames_list)
+    return ges_image_sequence_reader_new (track_element,
+        self->priv->filenames_list, self->priv->fps_n, self->priv->fps_d,
+        ges_image_sequence_reader_get_cache_size (track_element));
+
   bin = GST_ELEMENT (gst_bin_new ("multi-image-bin"));
   self->priv->src = gst_element_factory_make ("imagesequencesrc", NULL);
 
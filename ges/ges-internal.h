@@ -23,12 +23,15 @@
 
 #include <gst/gst.h>
 #include <gio/gio.h>
+#include <gst/video/video.h>
 
 #include "ges-timeline.h"
 #include "ges-track-element.h"
 #include "ges-timeline-element.h"
 
 #include "ges-asset.h"
+#include "ges-meta-container.h"
+#include "ges-effect-asset.h"
 #include "ges-base-xml-formatter.h"
 
 GST_DEBUG_CATEGORY_EXTERN (_ges_debug);
@@ -91,6 +94,17 @@ void
 timeline_remove_group          (GESTimeline *timeline,
                                 GESGroup *group);
 
+G_GNUC_INTERNAL void
+timeline_freeze_priorities     (GESTimeline *timeline);
+G_GNUC_INTERNAL void
+timeline_thaw_priorities       (GESTimeline *timeline);
+
+G_GNUC_INTERNAL void
+timeline_set_rendering         (GESTimeline *timeline,
+                                gboolean rendering);
+G_GNUC_INTERNAL gboolean
+timeline_get_rendering         (GESTimeline *timeline);
+
 G_GNUC_INTERNAL void
 ges_asset_cache_init (void);
 
@@ -237,7 +251,9 @@ G_GNUC_INTERNAL void ges_base_xml_formatter_add_control_binding (GESBaseXmlForma
                                                                   const gchar * property_name,
                                                                   gint mode,
                                                                   const gchar *track_id,
-                                                                  GSList * timed_values);
+                                                                  const GstClockTime *timestamps,
+                                                                  const gdouble *values,
+                                                                  guint n_values);
 
 G_GNUC_INTERNAL void set_property_foreach                       (GQuark field_id,
                                                                  const GValue * value,
@@ -253,6 +269,25 @@ G_GNUC_INTERNAL gint element_start_compare                (GESTimelineElement *
 G_GNUC_INTERNAL gint element_end_compare                  (GESTimelineElement * a,
                                                            GESTimelineElement * b);
 
+/* Durations of an operation, bucket i of the histogram counts the
+ * durations shorter than 2^i milliseconds, the last one all the others */
+#define GES_LATENCY_N_BUCKETS 11
+
+typedef struct
+{
+  guint64 count;
+  GstClockTime last;
+  GstClockTime total;
+  GstClockTime max;
+  guint64 buckets[GES_LATENCY_N_BUCKETS];
+} GESLatencyStats;
+
+G_GNUC_INTERNAL void ges_latency_stats_add                 (GESLatencyStats *stats,
+                                                           GstClockTime duration);
+G_GNUC_INTERNAL void ges_latency_stats_fill                (GESLatencyStats *stats,
+                                                           GstStructure *structure,
+                                                           const gchar *name);
+
 void
 ges_base_xml_formatter_set_timeline_properties(GESBaseXmlFormatter * self,
 					       GESTimeline *timeline,
@@ -264,6 +299,7 @@ ges_base_xml_formatter_set_timeline_properties(GESBaseXmlFormatter * self,
  ****************************************************/
 G_GNUC_INTERNAL void _ges_container_sort_children         (GESContainer *container);
 G_GNUC_INTERNAL void _ges_container_sort_children_by_end  (GESContainer *container);
+G_GNUC_INTERNAL gboolean _ges_container_in_batch         (GESContainer *container);
 
 /****************************************************
  *                  GESClip                         *
@@ -289,10 +325,32 @@ G_GNUC_INTERNAL void ges_track_element_split_bindings (GESTrackElement *element,
 						       GESTrackElement *new_element,
 						       guint64 position);
 
+G_GNUC_INTERNAL void ges_track_element_add_child_property (GESTrackElement *self,
+                                                           GParamSpec *pspec,
+                                                           GstElement *child);
+
+G_GNUC_INTERNAL gboolean ges_control_source_set_keyframes (GstTimedValueControlSource *source,
+                                                           const GstClockTime *timestamps,
+                                                           const gdouble *values,
+                                                           guint n_keyframes);
+G_GNUC_INTERNAL void ges_control_source_get_keyframes     (GstTimedValueControlSource *source,
+                                                           GstClockTime **timestamps,
+                                                           gdouble **values,
+                                                           guint *n_keyframes);
+
 G_GNUC_INTERNAL GstElement *ges_source_create_topbin (const gchar * bin_name, GstElement * sub_element, ...);
 
 G_GNUC_INTERNAL void ges_track_set_caps (GESTrack *track, const GstCaps *caps);
 
+G_GNUC_INTERNAL GstCaps * ges_smart_adder_get_mixing_caps (GESTrack *track);
+
+
+/****************************************************
+ *              GESEffectAsset                      *
+ ****************************************************/
+G_GNUC_INTERNAL GstElement * ges_effect_asset_create_element (GESEffectAsset *self,
+                                                              GESTrackElement *effect);
+
 
 /*********************************************
  *  GESTrackElement subclasses contructores  *
@@ -300,6 +358,7 @@ G_GNUC_INTERNAL void ges_track_set_caps (GESTrack *track, const GstCaps *caps);
 G_GNUC_INTERNAL GESAudioTestSource * ges_audio_test_source_new (void);
 G_GNUC_INTERNAL GESAudioUriSource  * ges_audio_uri_source_new  (gchar *uri);
 G_GNUC_INTERNAL GESVideoUriSource  * ges_video_uri_source_new  (gchar *uri);
+G_GNUC_INTERNAL void ges_video_uri_source_update_uri         (GESVideoUriSource *self);
 G_GNUC_INTERNAL GESImageSource     * ges_image_source_new      (gchar *uri);
 G_GNUC_INTERNAL GESTitleSource     * ges_title_source_new      (void);
 G_GNUC_INTERNAL GESVideoTestSource * ges_video_test_source_new (void);
@@ -316,4 +375,155 @@ typedef struct GESMultiFileURI
 
 G_GNUC_INTERNAL GESMultiFileURI * ges_multi_file_uri_new (const gchar * uri);
 
+/************************************************
+ *                                              *
+ *       GESUriClipAsset media cache            *
+ *                                              *
+ ************************************************/
+typedef struct _GESMediaCache GESMediaCache;
+typedef void (*GESMediaCacheReadyFunc) (GESMediaCache *cache, gboolean loaded,
+                                        gpointer user_data);
+
+G_GNUC_INTERNAL GESMediaCache * ges_media_cache_new            (const gchar *uri);
+G_GNUC_INTERNAL void ges_media_cache_free                      (GESMediaCache *cache);
+G_GNUC_INTERNAL gboolean ges_media_cache_load                  (GESMediaCache *cache,
+                                                                gboolean has_audio,
+                                                                gboolean has_video);
+G_GNUC_INTERNAL void ges_media_cache_populate_async            (GESMediaCache *cache,
+                                                                gboolean has_audio,
+                                                                gboolean has_video,
+                                                                GESMediaCacheReadyFunc func,
+                                                                gpointer user_data);
+G_GNUC_INTERNAL const gfloat * ges_media_cache_get_peaks       (GESMediaCache *cache,
+                                                                guint level,
+                                                                GstClockTime *interval,
+                                                                guint *n_peaks);
+G_GNUC_INTERNAL GstSample * ges_media_cache_get_thumbnail      (GESMediaCache *cache,
+                                                                GstClockTime position);
+G_GNUC_INTERNAL gboolean ges_media_cache_create_proxy_async   (GESMediaCache *cache,
+                                                                GESMediaCacheReadyFunc func,
+                                                                gpointer user_data);
+G_GNUC_INTERNAL const gchar * ges_media_cache_get_proxy_uri    (GESMediaCache *cache);
+
+/************************************************
+ *                                              *
+ *   Text rasters shared by titles and overlays *
+ *                                              *
+ ************************************************/
+G_GNUC_INTERNAL GstVideoOverlayComposition * ges_text_cache_lookup (const gchar *text,
+                                                                    const gchar *font_desc,
+                                                                    GESTextHAlign halign,
+                                                                    GESTextVAlign valign,
+                                                                    guint32 color,
+                                                                    gdouble xpos,
+                                                                    gdouble ypos,
+                                                                    gint width,
+                                                                    gint height);
+
+/************************************************
+ *                                              *
+ *   GStreamer elements of tracks and sources   *
+ *                                              *
+ ************************************************/
+G_GNUC_INTERNAL GstElement * ges_gap_src_new (GESTrack *track);
+G_GNUC_INTERNAL GstElement * ges_still_image_src_new (GESTrackElement *track_element,
+                                                      const gchar *uri);
+G_GNUC_INTERNAL GstElement * ges_image_sequence_reader_new (GESTrackElement *track_element,
+                                                            gchar **filenames,
+                                                            gint fps_n,
+                                                            gint fps_d,
+                                                            guint cache_size);
+G_GNUC_INTERNAL guint ges_image_sequence_reader_get_cache_size (GESTrackElement *element);
+
+/************************************************
+ *                                              *
+ *   Decoded still images shared by sources     *
+ *                                              *
+ ************************************************/
+G_GNUC_INTERNAL GstSample * ges_image_cache_lookup (const gchar *uri,
+                                                    GstCaps *caps);
+G_GNUC_INTERNAL GstSample * ges_image_cache_peek   (const gchar *uri,
+                                                    GstCaps *caps);
+G_GNUC_INTERNAL GstCaps   * ges_image_cache_get_target_caps (GESTrackElement *element);
+
+/************************************************
+ *                                              *
+ *   Inverted indexes over meta containers      *
+ *                                              *
+ ************************************************/
+typedef struct _GESMetaIndex GESMetaIndex;
+
+G_GNUC_INTERNAL GESMetaIndex * ges_meta_index_new   (void);
+G_GNUC_INTERNAL void ges_meta_index_free            (GESMetaIndex *index);
+G_GNUC_INTERNAL gboolean ges_meta_index_add_key     (GESMetaIndex *index,
+                                                     const gchar *meta_item);
+G_GNUC_INTERNAL gboolean ges_meta_index_has_key     (GESMetaIndex *index,
+                                                     const gchar *meta_item);
+G_GNUC_INTERNAL void ges_meta_index_add_container   (GESMetaIndex *index,
+                                                     GESMetaContainer *container);
+G_GNUC_INTERNAL void ges_meta_index_remove_container (GESMetaIndex *index,
+                                                      GESMetaContainer *container);
+G_GNUC_INTERNAL GList * ges_meta_index_find         (GESMetaIndex *index,
+                                                     const gchar *meta_item,
+                                                     const GValue *value);
+G_GNUC_INTERNAL GList * ges_meta_index_find_range   (GESMetaIndex *index,
+                                                     const gchar *meta_item,
+                                                     const GValue *min,
+                                                     const GValue *max);
+
+/************************************************
+ *                                              *
+ *   Tracing of the expensive operations        *
+ *                                              *
+ ************************************************/
+G_GNUC_INTERNAL extern gboolean _ges_tracing_enabled;
+
+G_GNUC_INTERNAL void ges_tracing_init   (void);
+G_GNUC_INTERNAL void ges_tracing_record (const gchar *name,
+                                         gint64 start,
+                                         gint64 end);
+G_GNUC_INTERNAL void ges_tracing_record_async (const gchar *name,
+                                               gconstpointer id,
+                                               gboolean begin);
+
+/* Returns the start time of a span, 0 when tracing is disabled */
+#define GES_TRACE_BEGIN()                                               \
+  (G_UNLIKELY (_ges_tracing_enabled) ? g_get_monotonic_time () : 0)
+
+/* @name has to be a static string */
+#define GES_TRACE_END(start, name) G_STMT_START {                       \
+  if (G_UNLIKELY (start))                                               \
+    ges_tracing_record (name, start, g_get_monotonic_time ());         \
+} G_STMT_END
+
+/* Spans of operations that end on another thread than the one that started
+ * them, the begin and end events are matched by @id. @name has to be a
+ * static string */
+#define GES_TRACE_ASYNC_BEGIN(name, id) G_STMT_START {                  \
+  if (G_UNLIKELY (_ges_tracing_enabled))                                \
+    ges_tracing_record_async (name, id, TRUE);                         \
+} G_STMT_END
+
+#define GES_TRACE_ASYNC_END(name, id) G_STMT_START {                    \
+  if (G_UNLIKELY (_ges_tracing_enabled))                                \
+    ges_tracing_record_async (name, id, FALSE);                        \
+} G_STMT_END
+
+/************************************************
+ *                                              *
+ *   Render cost of the track elements          *
+ *                                              *
+ ************************************************/
+typedef struct _GESRenderProfiler GESRenderProfiler;
+
+G_GNUC_INTERNAL GESRenderProfiler * ges_render_profiler_new (void);
+G_GNUC_INTERNAL void ges_render_profiler_free       (GESRenderProfiler *profiler);
+G_GNUC_INTERNAL void ges_render_profiler_start      (GESRenderProfiler *profiler,
+                                                     GESTimeline *timeline);
+G_GNUC_INTERNAL void ges_render_profiler_stop       (GESRenderProfiler *profiler);
+G_GNUC_INTERNAL gchar * ges_render_profiler_get_report (GESRenderProfiler *profiler);
+
+G_GNUC_INTERNAL const gchar * ges_uri_clip_asset_get_active_uri (GESUriClipAsset *self);
+G_GNUC_INTERNAL gboolean ges_uri_clip_asset_needs_proxy         (GESUriClipAsset *self);
+
 #endif /* __GES_INTERNAL_H__ */
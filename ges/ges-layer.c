@@ -46,8 +46,14 @@ G_DEFINE_TYPE_WITH_CODE (GESLayer, ges_layer,
 struct _GESLayerPrivate
 {
   /*< private > */
-  GList *clips_start;           /* The Clips sorted by start and
+  GSequence *clips_start;       /* The Clips sorted by start and
                                  * priority */
+  GHashTable *clips_iters;      /* {Clip: GSequenceIter in clips_start} */
+
+  /* At least the longest duration of the clips of the layer, bounds how far
+   * back we look for clips overlapping a position. Recomputed when the
+   * longest clip is removed */
+  GstClockTime max_duration;
 
   guint32 priority;             /* The priority of the layer within the
                                  * containing timeline */
@@ -122,12 +128,24 @@ ges_layer_dispose (GObject * object)
 
   GST_DEBUG ("Disposing layer");
 
-  while (priv->clips_start)
-    ges_layer_remove_clip (layer, (GESClip *) priv->clips_start->data);
+  while (g_sequence_get_length (priv->clips_start))
+    ges_layer_remove_clip (layer,
+        g_sequence_get (g_sequence_get_begin_iter (priv->clips_start)));
 
   G_OBJECT_CLASS (ges_layer_parent_class)->dispose (object);
 }
 
+static void
+ges_layer_finalize (GObject * object)
+{
+  GESLayerPrivate *priv = GES_LAYER (object)->priv;
+
+  g_sequence_free (priv->clips_start);
+  g_hash_table_unref (priv->clips_iters);
+
+  G_OBJECT_CLASS (ges_layer_parent_class)->finalize (object);
+}
+
 static gboolean
 _register_metas (GESLayer * layer)
 {
@@ -153,6 +171,7 @@ ges_layer_class_init (GESLayerClass * klass)
   object_class->get_property = ges_layer_get_property;
   object_class->set_property = ges_layer_set_property;
   object_class->dispose = ges_layer_dispose;
+  object_class->finalize = ges_layer_finalize;
 
   /**
    * GESLayer:priority:
@@ -209,6 +228,8 @@ ges_layer_init (GESLayer * self)
 
   self->priv->priority = 0;
   self->priv->auto_transition = FALSE;
+  self->priv->clips_start = g_sequence_new (NULL);
+  self->priv->clips_iters = g_hash_table_new (g_direct_hash, g_direct_equal);
   self->min_gnl_priority = MIN_GNL_PRIO;
   self->max_gnl_priority = LAYER_HEIGHT + MIN_GNL_PRIO;
 
@@ -225,23 +246,74 @@ ges_layer_init (GESLayer * self)
 static gboolean
 ges_layer_resync_priorities (GESLayer * layer)
 {
-  GList *tmp;
+  GSequenceIter *iter;
   GESTimelineElement *element;
 
   GST_DEBUG ("Resync priorities of %p", layer);
 
-  /* TODO : Inhibit composition updates while doing this.
-   * Ideally we want to do it from an even higher level, but here will
-   * do in the meantime. */
+  /* The compositions only take the new priorities into account on commit,
+   * the timeline re-sorts the TrackElement-s and commits their tracks once
+   * all of them got their new priority. When the priorities are already
+   * frozen by the caller that happens when it is done */
+  if (layer->timeline)
+    timeline_freeze_priorities (layer->timeline);
 
-  for (tmp = layer->priv->clips_start; tmp; tmp = tmp->next) {
-    element = GES_TIMELINE_ELEMENT (tmp->data);
+  for (iter = g_sequence_get_begin_iter (layer->priv->clips_start);
+      !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
+    element = GES_TIMELINE_ELEMENT (g_sequence_get (iter));
     _set_priority0 (element, _PRIORITY (element));
   }
 
+  if (layer->timeline)
+    timeline_thaw_priorities (layer->timeline);
+
   return TRUE;
 }
 
+/* Keeps @clip at its place in clips_start */
+static void
+_clip_sort_changed_cb (GESClip * clip, GParamSpec * arg, GESLayer * layer)
+{
+  GESLayerPrivate *priv = layer->priv;
+  GSequenceIter *iter = g_hash_table_lookup (priv->clips_iters, clip);
+
+  if (G_UNLIKELY (iter == NULL))
+    return;
+
+  priv->max_duration = MAX (priv->max_duration, _DURATION (clip));
+  g_sequence_sort_changed (iter, (GCompareDataFunc) element_start_compare,
+      NULL);
+}
+
+static void
+_update_max_duration (GESLayer * layer)
+{
+  GSequenceIter *iter;
+  GESLayerPrivate *priv = layer->priv;
+
+  priv->max_duration = 0;
+  for (iter = g_sequence_get_begin_iter (priv->clips_start);
+      !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter))
+    priv->max_duration = MAX (priv->max_duration,
+        _DURATION (g_sequence_get (iter)));
+}
+
+/* Used with g_sequence_search, returns an iter to the first clip starting
+ * at or after @position */
+static gint
+_compare_clip_start (GESTimelineElement * clip, GstClockTime * position,
+    gpointer unused)
+{
+  return _START (clip) < *position ? -1 : 1;
+}
+
+static GSequenceIter *
+_first_clip_from (GESLayer * layer, GstClockTime position)
+{
+  return g_sequence_search (layer->priv->clips_start, &position,
+      (GCompareDataFunc) _compare_clip_start, NULL);
+}
+
 static void
 new_asset_cb (GESAsset * source, GAsyncResult * res, NewAssetUData * udata)
 {
@@ -297,12 +369,12 @@ new_asset_cb (GESAsset * source, GAsyncResult * res, NewAssetUData * udata)
 GstClockTime
 ges_layer_get_duration (GESLayer * layer)
 {
-  GList *tmp;
+  GSequenceIter *iter;
   GstClockTime duration = 0;
 
-  for (tmp = layer->priv->clips_start; tmp; tmp = tmp->next) {
-    duration = MAX (duration, _END (tmp->data));
-  }
+  for (iter = g_sequence_get_begin_iter (layer->priv->clips_start);
+      !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter))
+    duration = MAX (duration, _END (g_sequence_get (iter)));
 
   return duration;
 }
@@ -351,7 +423,11 @@ ges_layer_remove_clip (GESLayer * layer, GESClip * clip)
   ges_timeline_element_set_timeline (GES_TIMELINE_ELEMENT (clip), NULL);
 
   /* Remove it from our list of controlled objects */
-  layer->priv->clips_start = g_list_remove (layer->priv->clips_start, clip);
+  g_signal_handlers_disconnect_by_func (clip, _clip_sort_changed_cb, layer);
+  g_sequence_remove (g_hash_table_lookup (layer->priv->clips_iters, clip));
+  g_hash_table_remove (layer->priv->clips_iters, clip);
+  if (_DURATION (clip) >= layer->priv->max_duration)
+    _update_max_duration (layer);
 
   /* Remove our reference to the clip */
   gst_object_unref (clip);
@@ -374,6 +450,11 @@ ges_layer_set_priority (GESLayer * layer, guint priority)
 
   GST_DEBUG ("layer:%p, priority:%d", layer, priority);
 
+  /* The TrackElement-s are only moved to their new layer once the timeline
+   * sorted its layers again, when it gets notified */
+  if (layer->timeline)
+    timeline_freeze_priorities (layer->timeline);
+
   if (priority != layer->priv->priority) {
     layer->priv->priority = priority;
     layer->min_gnl_priority = (priority * LAYER_HEIGHT) + MIN_GNL_PRIO;
@@ -383,6 +464,9 @@ ges_layer_set_priority (GESLayer * layer, guint priority)
   }
 
   g_object_notify (G_OBJECT (layer), "priority");
+
+  if (layer->timeline)
+    timeline_thaw_priorities (layer->timeline);
 }
 
 /**
@@ -450,6 +534,8 @@ ges_layer_get_priority (GESLayer * layer)
 GList *
 ges_layer_get_clips (GESLayer * layer)
 {
+  GList *ret = NULL;
+  GSequenceIter *iter;
   GESLayerClass *klass;
 
   g_return_val_if_fail (GES_IS_LAYER (layer), NULL);
@@ -460,9 +546,119 @@ ges_layer_get_clips (GESLayer * layer)
     return klass->get_objects (layer);
   }
 
-  return g_list_sort (g_list_copy_deep (layer->priv->clips_start,
-          (GCopyFunc) gst_object_ref, NULL),
-      (GCompareFunc) element_start_compare);
+  /* Already sorted, walk backward so we can prepend */
+  for (iter = g_sequence_get_end_iter (layer->priv->clips_start);
+      !g_sequence_iter_is_begin (iter);) {
+    iter = g_sequence_iter_prev (iter);
+    ret = g_list_prepend (ret, gst_object_ref (g_sequence_get (iter)));
+  }
+
+  return ret;
+}
+
+/**
+ * ges_layer_get_clips_in_interval:
+ * @layer: a #GESLayer
+ * @start: start of the interval
+ * @end: end of the interval, exclusive
+ *
+ * Gets the clips of @layer that overlap [@start, @end), which is what
+ * needs to be shown when only a part of the layer is visible. Only the
+ * clips around the interval are looked at.
+ *
+ * Returns: (transfer container) (element-type GESClip): The #GESClip-s
+ * overlapping the interval, sorted by start. The clips are owned by @layer,
+ * only free the list.
+ */
+GList *
+ges_layer_get_clips_in_interval (GESLayer * layer, GstClockTime start,
+    GstClockTime end)
+{
+  GList *ret = NULL;
+  GSequenceIter *iter, *first;
+  GESLayerPrivate *priv;
+
+  g_return_val_if_fail (GES_IS_LAYER (layer), NULL);
+  g_return_val_if_fail (start <= end, NULL);
+
+  priv = layer->priv;
+  first = _first_clip_from (layer, start);
+
+  /* Clips starting in the interval */
+  for (iter = first; !g_sequence_iter_is_end (iter);
+      iter = g_sequence_iter_next (iter)) {
+    GESTimelineElement *clip = g_sequence_get (iter);
+
+    if (_START (clip) >= end)
+      break;
+
+    ret = g_list_prepend (ret, clip);
+  }
+  ret = g_list_reverse (ret);
+
+  /* Clips starting before it, none can start before start - max_duration */
+  for (iter = first; !g_sequence_iter_is_begin (iter);) {
+    GESTimelineElement *clip;
+
+    iter = g_sequence_iter_prev (iter);
+    clip = g_sequence_get (iter);
+
+    if (start - _START (clip) >= priv->max_duration)
+      break;
+
+    if (_END (clip) > start)
+      ret = g_list_prepend (ret, clip);
+  }
+
+  return ret;
+}
+
+/**
+ * ges_layer_get_next_clip:
+ * @layer: a #GESLayer
+ * @position: a position in the layer
+ *
+ * Gets the first clip starting at or after @position.
+ *
+ * Returns: (transfer none) (allow-none): The #GESClip, or %NULL if there is
+ * none
+ */
+GESClip *
+ges_layer_get_next_clip (GESLayer * layer, GstClockTime position)
+{
+  GSequenceIter *iter;
+
+  g_return_val_if_fail (GES_IS_LAYER (layer), NULL);
+
+  iter = _first_clip_from (layer, position);
+  if (g_sequence_iter_is_end (iter))
+    return NULL;
+
+  return g_sequence_get (iter);
+}
+
+/**
+ * ges_layer_get_previous_clip:
+ * @layer: a #GESLayer
+ * @position: a position in the layer
+ *
+ * Gets the last clip starting before @position.
+ *
+ * Returns: (transfer none) (allow-none): The #GESClip, or %NULL if there is
+ * none
+ */
+GESClip *
+ges_layer_get_previous_clip (GESLayer * layer, GstClockTime position)
+{
+  GSequenceIter *iter;
+
+  g_return_val_if_fail (GES_IS_LAYER (layer), NULL);
+
+  iter = _first_clip_from (layer, position);
+  if (g_sequence_iter_is_begin (iter))
+    return NULL;
+
+  return g_sequence_get (g_sequence_iter_prev (iter));
 }
 
 /**
@@ -480,7 +676,7 @@ ges_layer_is_empty (GESLayer * layer)
 {
   g_return_val_if_fail (GES_IS_LAYER (layer), FALSE);
 
-  return (layer->priv->clips_start == NULL);
+  return (g_sequence_get_length (layer->priv->clips_start) == 0);
 }
 
 /**
@@ -561,8 +757,16 @@ ges_layer_add_clip (GESLayer * layer, GESClip * clip)
   gst_object_ref_sink (clip);
 
   /* Take a reference to the clip and store it stored by start/priority */
-  priv->clips_start = g_list_insert_sorted (priv->clips_start, clip,
-      (GCompareFunc) element_start_compare);
+  g_hash_table_insert (priv->clips_iters, clip,
+      g_sequence_insert_sorted (priv->clips_start, clip,
+          (GCompareDataFunc) element_start_compare, NULL));
+  priv->max_duration = MAX (priv->max_duration, _DURATION (clip));
+  g_signal_connect (clip, "notify::start", G_CALLBACK (_clip_sort_changed_cb),
+      layer);
+  g_signal_connect (clip, "notify::priority",
+      G_CALLBACK (_clip_sort_changed_cb), layer);
+  g_signal_connect (clip, "notify::duration",
+      G_CALLBACK (_clip_sort_changed_cb), layer);
 
   /* Inform the clip it's now in this layer */
   ges_clip_set_layer (clip, layer);
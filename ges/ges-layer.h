@@ -124,6 +124,13 @@ void ges_layer_set_auto_transition (GESLayer * layer,
 					     gboolean auto_transition);
 
 GList*   ges_layer_get_clips   (GESLayer * layer);
+GList*   ges_layer_get_clips_in_interval (GESLayer * layer,
+                                          GstClockTime start,
+                                          GstClockTime end);
+GESClip* ges_layer_get_next_clip     (GESLayer * layer,
+                                      GstClockTime position);
+GESClip* ges_layer_get_previous_clip (GESLayer * layer,
+                                      GstClockTime position);
 GstClockTime ges_layer_get_duration (GESLayer *layer);
 
 G_END_DECLS
@@ -0,0 +1,853 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The media cache holds, for a given media file, downsampled audio peaks
+ * at several zoom levels and small JPEG thumbnails at a fixed interval.
+ *
+ * It is stored in the user cache directory and keyed by the basename,
+ * size and modification time of the file, so that it survives across
+ * sessions and still applies when an asset is proxied to a moved file.
+ *
+ * Files layout (native endianness):
+ *
+ *   <key>.peaks:  MediaCacheHeader, then for each level a guint64
+ *                 interval, a guint64 number of peaks and the peaks
+ *                 as gfloats
+ *   <key>.thumbs: MediaCacheHeader, a guint64 interval, then for each
+ *                 thumbnail a guint64 offset and a guint64 size, followed
+ *                 by the JPEG data
+ *
+ * It can also hold a proxy of the media: a low resolution, intra-frame only
+ * (MJPEG) transcoding of its first video stream, with the same timestamps
+ * as the original one, stored as <key>.proxy.mkv.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "ges-internal.h"
+
+#define MEDIA_CACHE_MAGIC   0x47455343  /* GESC */
+#define MEDIA_CACHE_VERSION 1
+
+#define PEAKS_BASE_INTERVAL (10 * GST_MSECOND)
+#define PEAKS_LEVEL_FACTOR  4
+#define PEAKS_N_LEVELS      4
+
+#define THUMBNAILS_INTERVAL GST_SECOND
+#define THUMBNAILS_HEIGHT   90
+
+#define PROXY_HEIGHT        360
+
+/* A population run is cancelled if its position did not move for that long */
+#define POPULATE_STALL_TIMEOUT (15 * GST_SECOND)
+
+typedef struct
+{
+  guint32 magic;
+  guint32 version;
+  guint32 n_items;
+  guint32 padding;
+} MediaCacheHeader;
+
+typedef struct
+{
+  GstClockTime interval;
+  guint n_peaks;
+  const gfloat *peaks;
+} PeaksLevel;
+
+struct _GESMediaCache
+{
+  gchar *uri;
+  gchar *peaks_path;
+  gchar *thumbs_path;
+
+  GMappedFile *peaks_file;
+  PeaksLevel levels[PEAKS_N_LEVELS];
+
+  GMappedFile *thumbs_file;
+  GstClockTime thumbs_interval;
+  guint n_thumbs;
+  const guint64 *thumbs_index;
+
+  gchar *proxy_path;
+  gchar *proxy_uri;
+  /* Whether we looked for a proxy transcoded in a previous session */
+  gboolean proxy_checked;
+
+  gboolean populating;
+  gboolean proxying;
+};
+
+/* State of a population run, only touched from the worker thread and the
+ * streaming threads of its pipeline (each branch owning its fields) */
+typedef struct
+{
+  GESMediaCache *cache;
+  gchar *uri;
+  gchar *peaks_path;
+  gchar *thumbs_path;
+  gboolean has_audio;
+  gboolean has_video;
+
+  /* Transcode a proxy to proxy_path instead of computing peaks and
+   * thumbnails */
+  gboolean proxy;
+  gchar *proxy_path;
+  gboolean proxy_created;
+
+  GstElement *pipeline;
+  gboolean audio_linked;
+  gboolean video_linked;
+
+  /* Audio branch */
+  GArray *peaks;
+  gfloat current_peak;
+  guint64 window_size;
+  guint64 in_window;
+
+  /* Video branch */
+  GArray *thumbs_index;
+  GByteArray *thumbs_data;
+
+  GESMediaCacheReadyFunc func;
+  gpointer user_data;
+} PopulateJob;
+
+static GThreadPool *populate_pool = NULL;
+G_LOCK_DEFINE_STATIC (populate_pool_lock);
+
+static gchar *
+_get_cache_key (const gchar * uri)
+{
+  gchar *key;
+  GFileInfo *info;
+  GFile *file = g_file_new_for_uri (uri);
+
+  info = g_file_query_info (file, G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+      G_FILE_ATTRIBUTE_TIME_MODIFIED, G_FILE_QUERY_INFO_NONE, NULL, NULL);
+
+  if (info) {
+    gchar *basename = g_file_get_basename (file);
+    gchar *tmp = g_strdup_printf ("%s-%" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT,
+        basename, (guint64) g_file_info_get_size (info),
+        g_file_info_get_attribute_uint64 (info,
+            G_FILE_ATTRIBUTE_TIME_MODIFIED));
+
+    key = g_compute_checksum_for_string (G_CHECKSUM_SHA1, tmp, -1);
+    g_object_unref (info);
+    g_free (basename);
+    g_free (tmp);
+  } else {
+    key = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+  }
+  g_object_unref (file);
+
+  return key;
+}
+
+static gboolean
+_check_header (GMappedFile * file, guint32 * n_items)
+{
+  MediaCacheHeader header;
+
+  if (g_mapped_file_get_length (file) < sizeof (MediaCacheHeader))
+    return FALSE;
+
+  memcpy (&header, g_mapped_file_get_contents (file), sizeof (header));
+  if (header.magic != MEDIA_CACHE_MAGIC ||
+      header.version != MEDIA_CACHE_VERSION)
+    return FALSE;
+
+  *n_items = header.n_items;
+
+  return TRUE;
+}
+
+static gboolean
+_load_peaks (GESMediaCache * cache)
+{
+  guint i;
+  guint32 n_levels;
+  gsize offset = sizeof (MediaCacheHeader), len;
+  const gchar *data;
+  PeaksLevel levels[PEAKS_N_LEVELS];
+  GMappedFile *file = g_mapped_file_new (cache->peaks_path, FALSE, NULL);
+
+  if (file == NULL)
+    return FALSE;
+
+  if (!_check_header (file, &n_levels) || n_levels != PEAKS_N_LEVELS)
+    goto corrupted;
+
+  data = g_mapped_file_get_contents (file);
+  len = g_mapped_file_get_length (file);
+  for (i = 0; i < PEAKS_N_LEVELS; i++) {
+    guint64 interval, n_peaks;
+
+    if (offset > len || 2 * sizeof (guint64) > len - offset)
+      goto corrupted;
+
+    memcpy (&interval, data + offset, sizeof (guint64));
+    memcpy (&n_peaks, data + offset + sizeof (guint64), sizeof (guint64));
+    offset += 2 * sizeof (guint64);
+
+    if (n_peaks > (len - offset) / sizeof (gfloat))
+      goto corrupted;
+
+    levels[i].interval = interval;
+    levels[i].n_peaks = n_peaks;
+    levels[i].peaks = (const gfloat *) (data + offset);
+    offset += n_peaks * sizeof (gfloat);
+  }
+
+  if (cache->peaks_file)
+    g_mapped_file_unref (cache->peaks_file);
+  cache->peaks_file = file;
+  memcpy (cache->levels, levels, sizeof (levels));
+
+  return TRUE;
+
+corrupted:
+  GST_INFO ("Peaks cache %s is not usable", cache->peaks_path);
+  g_mapped_file_unref (file);
+
+  return FALSE;
+}
+
+static gboolean
+_load_thumbnails (GESMediaCache * cache)
+{
+  guint i;
+  guint32 n_thumbs;
+  const gchar *data;
+  const guint64 *index;
+  gsize offset = sizeof (MediaCacheHeader), len;
+  GMappedFile *file = g_mapped_file_new (cache->thumbs_path, FALSE, NULL);
+
+  if (file == NULL)
+    return FALSE;
+
+  if (!_check_header (file, &n_thumbs))
+    goto corrupted;
+
+  data = g_mapped_file_get_contents (file);
+  len = g_mapped_file_get_length (file);
+  if (offset > len ||
+      (1 + 2 * (guint64) n_thumbs) > (len - offset) / sizeof (guint64))
+    goto corrupted;
+
+  /* The header is 16 bytes long and the mapping page aligned */
+  index = (const guint64 *) (data + offset);
+
+  /* The interval is used as a divisor when looking thumbnails up */
+  if (index[0] == 0)
+    goto corrupted;
+
+  for (i = 0; i < n_thumbs; i++) {
+    guint64 thumb_offset = index[1 + 2 * i], size = index[2 + 2 * i];
+
+    if (thumb_offset > len || size > len - thumb_offset)
+      goto corrupted;
+  }
+
+  if (cache->thumbs_file)
+    g_mapped_file_unref (cache->thumbs_file);
+  cache->thumbs_file = file;
+  cache->thumbs_interval = index[0];
+  cache->thumbs_index = index + 1;
+  cache->n_thumbs = n_thumbs;
+
+  return TRUE;
+
+corrupted:
+  GST_INFO ("Thumbnails cache %s is not usable", cache->thumbs_path);
+  g_mapped_file_unref (file);
+
+  return FALSE;
+}
+
+/* Streaming threads */
+static GstFlowReturn
+_new_audio_sample_cb (GstElement * sink, PopulateJob * job)
+{
+  gsize i;
+  GstMapInfo map;
+  GstBuffer *buf;
+  GstSample *sample = NULL;
+
+  g_signal_emit_by_name (sink, "pull-sample", &sample);
+  if (sample == NULL)
+    return GST_FLOW_OK;
+
+  if (job->window_size == 0) {
+    gint rate = 0;
+    GstStructure *s = gst_caps_get_structure (gst_sample_get_caps (sample), 0);
+
+    gst_structure_get_int (s, "rate", &rate);
+    job->window_size = MAX (1, gst_util_uint64_scale (rate,
+            PEAKS_BASE_INTERVAL, GST_SECOND));
+  }
+
+  buf = gst_sample_get_buffer (sample);
+  if (gst_buffer_map (buf, &map, GST_MAP_READ)) {
+    const gfloat *samples = (const gfloat *) map.data;
+
+    for (i = 0; i < map.size / sizeof (gfloat); i++) {
+      gfloat value = ABS (samples[i]);
+
+      if (value > job->current_peak)
+        job->current_peak = value;
+
+      if (++job->in_window == job->window_size) {
+        g_array_append_val (job->peaks, job->current_peak);
+        job->current_peak = 0;
+        job->in_window = 0;
+      }
+    }
+    gst_buffer_unmap (buf, &map);
+  }
+
+  gst_sample_unref (sample);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+_new_video_sample_cb (GstElement * sink, PopulateJob * job)
+{
+  GstMapInfo map;
+  GstBuffer *buf;
+  GstSample *sample = NULL;
+
+  g_signal_emit_by_name (sink, "pull-sample", &sample);
+  if (sample == NULL)
+    return GST_FLOW_OK;
+
+  buf = gst_sample_get_buffer (sample);
+  if (gst_buffer_map (buf, &map, GST_MAP_READ)) {
+    guint64 offset = job->thumbs_data->len, size = map.size;
+
+    g_array_append_val (job->thumbs_index, offset);
+    g_array_append_val (job->thumbs_index, size);
+    g_byte_array_append (job->thumbs_data, map.data, map.size);
+    gst_buffer_unmap (buf, &map);
+  }
+
+  gst_sample_unref (sample);
+
+  return GST_FLOW_OK;
+}
+
+static void
+_pad_added_cb (GstElement * decodebin, GstPad * pad, PopulateJob * job)
+{
+  GstCaps *caps;
+  GstPad *sinkpad;
+  const gchar *name;
+  GCallback new_sample_cb = NULL;
+  GstElement *branch = NULL;
+  GError *err = NULL;
+
+  caps = gst_pad_query_caps (pad, NULL);
+  name = gst_structure_get_name (gst_caps_get_structure (caps, 0));
+
+  if (job->proxy) {
+    if (!job->video_linked && g_str_has_prefix (name, "video/")) {
+      gchar *desc = g_strdup_printf ("videoconvert ! videoscale ! "
+          "video/x-raw,height=%i,pixel-aspect-ratio=1/1 ! jpegenc ! "
+          "matroskamux ! filesink name=sink", PROXY_HEIGHT);
+
+      branch = gst_parse_bin_from_description (desc, TRUE, &err);
+      g_free (desc);
+      if (branch) {
+        GstElement *sink = gst_bin_get_by_name (GST_BIN (branch), "sink");
+        gchar *location = g_strdup_printf ("%s.part", job->proxy_path);
+
+        g_object_set (sink, "location", location, NULL);
+        gst_object_unref (sink);
+        g_free (location);
+        job->video_linked = TRUE;
+      }
+    }
+  } else if (job->has_audio && !job->audio_linked &&
+      g_str_has_prefix (name, "audio/")) {
+    branch = gst_parse_bin_from_description ("audioconvert ! "
+        "capsfilter name=capsfilter ! appsink name=sink sync=false", TRUE,
+        &err);
+    if (branch) {
+      GstElement *capsfilter =
+          gst_bin_get_by_name (GST_BIN (branch), "capsfilter");
+      GstCaps *fcaps = gst_caps_new_simple ("audio/x-raw", "format",
+          G_TYPE_STRING, G_BYTE_ORDER == G_LITTLE_ENDIAN ? "F32LE" : "F32BE",
+          "channels", G_TYPE_INT, 1, NULL);
+
+      g_object_set (capsfilter, "caps", fcaps, NULL);
+      gst_caps_unref (fcaps);
+      gst_object_unref (capsfilter);
+      job->audio_linked = TRUE;
+      new_sample_cb = G_CALLBACK (_new_audio_sample_cb);
+    }
+  } else if (job->has_video && !job->video_linked &&
+      g_str_has_prefix (name, "video/")) {
+    /* One frame per THUMBNAILS_INTERVAL */
+    gchar *desc = g_strdup_printf ("videorate ! video/x-raw,framerate=1/1 ! "
+        "videoconvert ! videoscale ! video/x-raw,height=%i,"
+        "pixel-aspect-ratio=1/1 ! jpegenc ! appsink name=sink sync=false",
+        THUMBNAILS_HEIGHT);
+
+    branch = gst_parse_bin_from_description (desc, TRUE, &err);
+    g_free (desc);
+    if (branch) {
+      job->video_linked = TRUE;
+      new_sample_cb = G_CALLBACK (_new_video_sample_cb);
+    }
+  }
+
+  if (err) {
+    GST_WARNING ("Could not create cache branch for %s: %s", job->uri,
+        err->message);
+    g_clear_error (&err);
+  }
+
+  if (branch && new_sample_cb) {
+    GstElement *sink = gst_bin_get_by_name (GST_BIN (branch), "sink");
+
+    g_object_set (sink, "emit-signals", TRUE, NULL);
+    g_signal_connect (sink, "new-sample", new_sample_cb, job);
+    gst_object_unref (sink);
+  } else if (branch == NULL) {
+    branch = gst_element_factory_make ("fakesink", NULL);
+    g_object_set (branch, "sync", FALSE, NULL);
+  }
+
+  gst_bin_add (GST_BIN (job->pipeline), branch);
+  sinkpad = gst_element_get_static_pad (branch, "sink");
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (sinkpad);
+  gst_element_sync_state_with_parent (branch);
+
+  gst_caps_unref (caps);
+}
+
+/* Worker thread */
+static gboolean
+_write_peaks (PopulateJob * job)
+{
+  guint i, j;
+  gboolean res;
+  GByteArray *data;
+  GArray *level = job->peaks;
+  GstClockTime interval = PEAKS_BASE_INTERVAL;
+  MediaCacheHeader header = { MEDIA_CACHE_MAGIC, MEDIA_CACHE_VERSION,
+    PEAKS_N_LEVELS, 0
+  };
+
+  if (job->in_window)
+    g_array_append_val (job->peaks, job->current_peak);
+
+  data = g_byte_array_new ();
+  g_byte_array_append (data, (guint8 *) & header, sizeof (header));
+  for (i = 0; i < PEAKS_N_LEVELS; i++) {
+    guint64 n_peaks = level->len;
+    GArray *next;
+
+    g_byte_array_append (data, (guint8 *) & interval, sizeof (guint64));
+    g_byte_array_append (data, (guint8 *) & n_peaks, sizeof (guint64));
+    g_byte_array_append (data, (guint8 *) level->data,
+        level->len * sizeof (gfloat));
+
+    /* Each level is PEAKS_LEVEL_FACTOR times coarser than the previous one */
+    next = g_array_sized_new (FALSE, TRUE, sizeof (gfloat),
+        level->len / PEAKS_LEVEL_FACTOR + 1);
+    for (j = 0; j < level->len; j += PEAKS_LEVEL_FACTOR) {
+      guint k;
+      gfloat peak = 0;
+
+      for (k = j; k < MIN (j + PEAKS_LEVEL_FACTOR, level->len); k++)
+        peak = MAX (peak, g_array_index (level, gfloat, k));
+      g_array_append_val (next, peak);
+    }
+
+    if (level != job->peaks)
+      g_array_unref (level);
+    level = next;
+    interval *= PEAKS_LEVEL_FACTOR;
+  }
+  g_array_unref (level);
+
+  res = g_file_set_contents (job->peaks_path, (gchar *) data->data,
+      data->len, NULL);
+  g_byte_array_unref (data);
+
+  return res;
+}
+
+static gboolean
+_write_thumbnails (PopulateJob * job)
+{
+  guint i;
+  gboolean res;
+  GByteArray *data;
+  guint64 interval = THUMBNAILS_INTERVAL, data_offset;
+  MediaCacheHeader header = { MEDIA_CACHE_MAGIC, MEDIA_CACHE_VERSION,
+    job->thumbs_index->len / 2, 0
+  };
+
+  /* Make offsets relative to the beginning of the file */
+  data_offset = sizeof (header) + sizeof (guint64) +
+      job->thumbs_index->len * sizeof (guint64);
+  for (i = 0; i < job->thumbs_index->len; i += 2)
+    g_array_index (job->thumbs_index, guint64, i) += data_offset;
+
+  data = g_byte_array_new ();
+  g_byte_array_append (data, (guint8 *) & header, sizeof (header));
+  g_byte_array_append (data, (guint8 *) & interval, sizeof (guint64));
+  g_byte_array_append (data, (guint8 *) job->thumbs_index->data,
+      job->thumbs_index->len * sizeof (guint64));
+  g_byte_array_append (data, job->thumbs_data->data, job->thumbs_data->len);
+
+  res = g_file_set_contents (job->thumbs_path, (gchar *) data->data,
+      data->len, NULL);
+  g_byte_array_unref (data);
+
+  return res;
+}
+
+static void
+_free_job (PopulateJob * job)
+{
+  g_free (job->uri);
+  g_free (job->peaks_path);
+  g_free (job->thumbs_path);
+  g_free (job->proxy_path);
+  g_array_unref (job->peaks);
+  g_array_unref (job->thumbs_index);
+  g_byte_array_unref (job->thumbs_data);
+  g_slice_free (PopulateJob, job);
+}
+
+/* Main thread */
+static gboolean
+_populated_in_idle (PopulateJob * job)
+{
+  gboolean loaded;
+  GESMediaCache *cache = job->cache;
+
+  if (job->proxy) {
+    cache->proxying = FALSE;
+    if (job->proxy_created && cache->proxy_uri == NULL)
+      cache->proxy_uri = gst_filename_to_uri (cache->proxy_path, NULL);
+    loaded = cache->proxy_uri != NULL;
+  } else {
+    cache->populating = FALSE;
+    loaded = ges_media_cache_load (cache, job->has_audio, job->has_video);
+  }
+
+  if (job->func)
+    job->func (cache, loaded, job->user_data);
+  _free_job (job);
+
+  return FALSE;
+}
+
+/* Decoding a whole media can legitimately take a long time, so instead of
+ * bounding the total duration of the run we give up when it stops making
+ * progress. Returns %NULL in that case */
+static GstMessage *
+_wait_for_completion (PopulateJob * job, GstBus * bus)
+{
+  GstMessage *msg;
+  gint64 position, last_position = -1;
+
+  while (!(msg = gst_bus_timed_pop_filtered (bus, POPULATE_STALL_TIMEOUT,
+              GST_MESSAGE_EOS | GST_MESSAGE_ERROR))) {
+    if (!gst_element_query_position (job->pipeline, GST_FORMAT_TIME,
+            &position))
+      position = -1;
+
+    if (position == last_position) {
+      GST_WARNING ("Giving up on %s, no progress in %" GST_TIME_FORMAT,
+          job->uri, GST_TIME_ARGS (POPULATE_STALL_TIMEOUT));
+      return NULL;
+    }
+    last_position = position;
+  }
+
+  return msg;
+}
+
+static void
+_populate (PopulateJob * job, gpointer unused)
+{
+  GstBus *bus;
+  GstMessage *msg;
+  GstElement *decodebin;
+  gboolean done;
+
+  GST_DEBUG ("%s for %s", job->proxy ? "Transcoding proxy" :
+      "Populating media cache", job->uri);
+
+  job->pipeline = gst_pipeline_new (NULL);
+  decodebin = gst_element_factory_make ("uridecodebin", NULL);
+  g_object_set (decodebin, "uri", job->uri, NULL);
+  g_signal_connect (decodebin, "pad-added", G_CALLBACK (_pad_added_cb), job);
+  gst_bin_add (GST_BIN (job->pipeline), decodebin);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (job->pipeline));
+  gst_element_set_state (job->pipeline, GST_STATE_PLAYING);
+  msg = _wait_for_completion (job, bus);
+  gst_element_set_state (job->pipeline, GST_STATE_NULL);
+
+  done = msg && GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS;
+  if (msg && GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    GError *err = NULL;
+
+    gst_message_parse_error (msg, &err, NULL);
+    GST_WARNING ("Could not %s for %s: %s", job->proxy ? "transcode proxy" :
+        "populate media cache", job->uri, err ? err->message : "unknown error");
+    g_clear_error (&err);
+  }
+
+  if (job->proxy) {
+    gchar *location = g_strdup_printf ("%s.part", job->proxy_path);
+
+    /* Never leave a partial proxy around */
+    if (done && job->video_linked) {
+      if (g_rename (location, job->proxy_path) == 0) {
+        job->proxy_created = TRUE;
+      } else {
+        GST_WARNING ("Could not move proxy to %s: %s", job->proxy_path,
+            g_strerror (errno));
+        g_unlink (location);
+      }
+    } else {
+      g_unlink (location);
+    }
+    g_free (location);
+  } else if (done) {
+    if (job->audio_linked && !_write_peaks (job))
+      GST_WARNING ("Could not write %s", job->peaks_path);
+    if (job->video_linked && !_write_thumbnails (job))
+      GST_WARNING ("Could not write %s", job->thumbs_path);
+  }
+
+  if (msg)
+    gst_message_unref (msg);
+  gst_object_unref (bus);
+  gst_object_unref (job->pipeline);
+  job->pipeline = NULL;
+
+  g_idle_add ((GSourceFunc) _populated_in_idle, job);
+}
+
+/* API */
+GESMediaCache *
+ges_media_cache_new (const gchar * uri)
+{
+  gchar *key, *dir, *tmp;
+  GESMediaCache *cache = g_slice_new0 (GESMediaCache);
+
+  dir = g_build_filename (g_get_user_cache_dir (), "gstreamer-editing-services",
+      "media-cache", NULL);
+  key = _get_cache_key (uri);
+
+  tmp = g_strdup_printf ("%s.peaks", key);
+  cache->peaks_path = g_build_filename (dir, tmp, NULL);
+  g_free (tmp);
+  tmp = g_strdup_printf ("%s.thumbs", key);
+  cache->thumbs_path = g_build_filename (dir, tmp, NULL);
+  g_free (tmp);
+  tmp = g_strdup_printf ("%s.proxy.mkv", key);
+  cache->proxy_path = g_build_filename (dir, tmp, NULL);
+  g_free (tmp);
+
+  cache->uri = g_strdup (uri);
+  g_free (key);
+  g_free (dir);
+
+  return cache;
+}
+
+void
+ges_media_cache_free (GESMediaCache * cache)
+{
+  if (cache->peaks_file)
+    g_mapped_file_unref (cache->peaks_file);
+  if (cache->thumbs_file)
+    g_mapped_file_unref (cache->thumbs_file);
+  g_free (cache->uri);
+  g_free (cache->peaks_path);
+  g_free (cache->thumbs_path);
+  g_free (cache->proxy_path);
+  g_free (cache->proxy_uri);
+  g_slice_free (GESMediaCache, cache);
+}
+
+/* Loads what is available on disk, returns %TRUE if everything
+ * requested could be loaded */
+gboolean
+ges_media_cache_load (GESMediaCache * cache, gboolean has_audio,
+    gboolean has_video)
+{
+  gboolean res = TRUE;
+
+  if (has_audio)
+    res &= _load_peaks (cache);
+  if (has_video)
+    res &= _load_thumbnails (cache);
+
+  return res;
+}
+
+/* Decodes the media in a background thread and writes the cache to disk,
+ * @func is called from the main context once it has been loaded back */
+static gboolean
+_push_job (GESMediaCache * cache, gboolean proxy, gboolean has_audio,
+    gboolean has_video, GESMediaCacheReadyFunc func, gpointer user_data)
+{
+  gchar *dir;
+  PopulateJob *job;
+
+  dir = g_path_get_dirname (cache->peaks_path);
+  if (g_mkdir_with_parents (dir, 0755) < 0) {
+    GST_WARNING ("Could not create media cache directory %s", dir);
+    g_free (dir);
+    return FALSE;
+  }
+  g_free (dir);
+
+  job = g_slice_new0 (PopulateJob);
+  job->cache = cache;
+  job->uri = g_strdup (cache->uri);
+  job->peaks_path = g_strdup (cache->peaks_path);
+  job->thumbs_path = g_strdup (cache->thumbs_path);
+  job->proxy_path = g_strdup (cache->proxy_path);
+  job->proxy = proxy;
+  job->has_audio = has_audio;
+  job->has_video = has_video;
+  job->peaks = g_array_new (FALSE, FALSE, sizeof (gfloat));
+  job->thumbs_index = g_array_new (FALSE, FALSE, sizeof (guint64));
+  job->thumbs_data = g_byte_array_new ();
+  job->func = func;
+  job->user_data = user_data;
+
+  /* Only decode one media at a time so we do not compete too much with
+   * the application */
+  G_LOCK (populate_pool_lock);
+  if (populate_pool == NULL)
+    populate_pool = g_thread_pool_new ((GFunc) _populate, NULL, 1, FALSE,
+        NULL);
+  G_UNLOCK (populate_pool_lock);
+
+  g_thread_pool_push (populate_pool, job, NULL);
+
+  return TRUE;
+}
+
+void
+ges_media_cache_populate_async (GESMediaCache * cache, gboolean has_audio,
+    gboolean has_video, GESMediaCacheReadyFunc func, gpointer user_data)
+{
+  if (cache->populating)
+    return;
+
+  cache->populating = _push_job (cache, FALSE, has_audio, has_video, func,
+      user_data);
+}
+
+/* Transcodes the proxy in the background, @func is called from the main
+ * context once done. Returns %FALSE if @func will not be called */
+gboolean
+ges_media_cache_create_proxy_async (GESMediaCache * cache,
+    GESMediaCacheReadyFunc func, gpointer user_data)
+{
+  if (cache->proxying)
+    return FALSE;
+
+  cache->proxying = _push_job (cache, TRUE, FALSE, TRUE, func, user_data);
+
+  return cache->proxying;
+}
+
+/* Returns the URI of the proxy if it has been transcoded. The disk is only
+ * looked at the first time, proxies created later are picked up when their
+ * transcoding finishes */
+const gchar *
+ges_media_cache_get_proxy_uri (GESMediaCache * cache)
+{
+  if (!cache->proxy_checked) {
+    cache->proxy_checked = TRUE;
+    if (cache->proxy_uri == NULL &&
+        g_file_test (cache->proxy_path, G_FILE_TEST_IS_REGULAR))
+      cache->proxy_uri = gst_filename_to_uri (cache->proxy_path, NULL);
+  }
+
+  return cache->proxy_uri;
+}
+
+const gfloat *
+ges_media_cache_get_peaks (GESMediaCache * cache, guint level,
+    GstClockTime * interval, guint * n_peaks)
+{
+  if (level >= PEAKS_N_LEVELS || cache->peaks_file == NULL)
+    return NULL;
+
+  if (interval)
+    *interval = cache->levels[level].interval;
+  if (n_peaks)
+    *n_peaks = cache->levels[level].n_peaks;
+
+  return cache->levels[level].peaks;
+}
+
+GstSample *
+ges_media_cache_get_thumbnail (GESMediaCache * cache, GstClockTime position)
+{
+  guint i;
+  GstCaps *caps;
+  GstBuffer *buffer;
+  GstSample *sample;
+  guint64 offset, size;
+
+  if (cache->thumbs_file == NULL || cache->n_thumbs == 0 ||
+      !GST_CLOCK_TIME_IS_VALID (position))
+    return NULL;
+
+  i = MIN (position / cache->thumbs_interval, cache->n_thumbs - 1);
+  offset = cache->thumbs_index[2 * i];
+  size = cache->thumbs_index[2 * i + 1];
+
+  /* Do not copy anything, the buffer keeps the mapping alive */
+  buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      (gpointer) (g_mapped_file_get_contents (cache->thumbs_file) + offset),
+      size, 0, size, g_mapped_file_ref (cache->thumbs_file),
+      (GDestroyNotify) g_mapped_file_unref);
+  GST_BUFFER_PTS (buffer) = i * cache->thumbs_interval;
+  GST_BUFFER_DURATION (buffer) = cache->thumbs_interval;
+
+  caps = gst_caps_new_empty_simple ("image/jpeg");
+  sample = gst_sample_new (buffer, caps, NULL, NULL);
+  gst_caps_unref (caps);
+  gst_buffer_unref (buffer);
+
+  return sample;
+}
@@ -1,4 +1,6 @@
+#include <string.h>
 #include <glib-object.h>
+#include <gobject/gvaluecollector.h>
 #include <gst/gst.h>
 
 #include "ges-meta-container.h"
@@ -24,16 +26,33 @@ enum
 
 static guint _signals[LAST_SIGNAL] = { 0 };
 
-typedef struct RegisteredMeta
+/* Metas are stored in a small array of typed values, looked up by quark,
+ * with room for a few of them inline so that most containers need a single
+ * allocation. Registered metas keep their type and flags in their item. */
+#define N_INLINE_ITEMS 4
+
+typedef struct MetaItem
 {
-  GType item_type;
+  GQuark key;
+
+  /* G_TYPE_INVALID if the meta is not registered */
+  GType registered_type;
   GESMetaFlag flags;
-} RegisteredMeta;
+
+  /* Unset if the meta has been registered but no value could be set */
+  GValue value;
+} MetaItem;
 
 typedef struct ContainerData
 {
-  GstStructure *structure;
-  GHashTable *static_items;
+  MetaItem *items;
+  guint n_items;
+  guint allocated;
+
+  /* The result of metas_to_string(), until a meta changes */
+  gchar *serialized;
+
+  MetaItem inline_items[N_INLINE_ITEMS];
 } ContainerData;
 
 static void
@@ -59,33 +78,35 @@ ges_meta_container_default_init (GESMetaContainerInterface * iface)
 static void
 _free_meta_container_data (ContainerData * data)
 {
-  gst_structure_free (data->structure);
-  g_hash_table_unref (data->static_items);
+  guint i;
 
-  g_slice_free (ContainerData, data);
-}
+  for (i = 0; i < data->n_items; i++) {
+    if (G_IS_VALUE (&data->items[i].value))
+      g_value_unset (&data->items[i].value);
+  }
 
-static void
-_free_static_item (RegisteredMeta * item)
-{
-  g_slice_free (RegisteredMeta, item);
+  if (data->items != data->inline_items)
+    g_free (data->items);
+  g_free (data->serialized);
+
+  g_slice_free (ContainerData, data);
 }
 
 static ContainerData *
 _create_container_data (GESMetaContainer * container)
 {
-  ContainerData *data = g_slice_new (ContainerData);
-  data->structure = gst_structure_new_empty ("metadatas");
-  data->static_items = g_hash_table_new_full (g_str_hash, g_str_equal,
-      g_free, (GDestroyNotify) (GDestroyNotify) _free_static_item);
+  ContainerData *data = g_slice_new0 (ContainerData);
+
+  data->items = data->inline_items;
+  data->allocated = N_INLINE_ITEMS;
   g_object_set_qdata_full (G_OBJECT (container), ges_meta_key, data,
       (GDestroyNotify) _free_meta_container_data);
 
   return data;
 }
 
-static GstStructure *
-_meta_container_get_structure (GESMetaContainer * container)
+static ContainerData *
+_get_container_data (GESMetaContainer * container)
 {
   ContainerData *data;
 
@@ -93,23 +114,152 @@ _meta_container_get_structure (GESMetaContainer * container)
   if (!data)
     data = _create_container_data (container);
 
-  return data->structure;
+  return data;
+}
+
+static MetaItem *
+_find_item (ContainerData * data, GQuark key)
+{
+  guint i;
+
+  if (data == NULL || key == 0)
+    return NULL;
+
+  for (i = 0; i < data->n_items; i++) {
+    if (data->items[i].key == key)
+      return &data->items[i];
+  }
+
+  return NULL;
+}
+
+/* Never allocates anything, a meta that has never been set does not even
+ * have a quark */
+static MetaItem *
+_lookup_item (GESMetaContainer * container, const gchar * meta_item)
+{
+  return _find_item (g_object_get_qdata (G_OBJECT (container), ges_meta_key),
+      g_quark_try_string (meta_item));
+}
+
+static const GValue *
+_get_value (GESMetaContainer * container, const gchar * meta_item)
+{
+  MetaItem *item = _lookup_item (container, meta_item);
+
+  if (item == NULL || !G_IS_VALUE (&item->value))
+    return NULL;
+
+  return &item->value;
 }
 
-typedef struct
+static MetaItem *
+_add_item (ContainerData * data, GQuark key)
 {
-  GESMetaForeachFunc func;
-  const GESMetaContainer *container;
-  gpointer data;
-} MetadataForeachData;
+  MetaItem *item;
+
+  if (data->n_items == data->allocated) {
+    data->allocated *= 2;
+    if (data->items == data->inline_items) {
+      data->items = g_new (MetaItem, data->allocated);
+      memcpy (data->items, data->inline_items,
+          N_INLINE_ITEMS * sizeof (MetaItem));
+    } else {
+      data->items = g_renew (MetaItem, data->items, data->allocated);
+    }
+  }
+
+  item = &data->items[data->n_items++];
+  memset (item, 0, sizeof (MetaItem));
+  item->key = key;
+
+  return item;
+}
+
+/* How GstStructure names the types, so that what we serialize can be parsed
+ * back with gst_structure_from_string() */
+static const gchar *
+_type_name (GType type)
+{
+  switch (type) {
+    case G_TYPE_INT:
+      return "int";
+    case G_TYPE_UINT:
+      return "uint";
+    case G_TYPE_FLOAT:
+      return "float";
+    case G_TYPE_DOUBLE:
+      return "double";
+    case G_TYPE_BOOLEAN:
+      return "boolean";
+    case G_TYPE_STRING:
+      return "string";
+    default:
+      break;
+  }
+
+  if (type == G_TYPE_DATE)
+    return "date";
+  else if (type == GST_TYPE_DATE_TIME)
+    return "datetime";
+
+  return g_type_name (type);
+}
 
 static void
-structure_foreach_wrapper (GQuark field_id, const GValue * value,
-    gpointer user_data)
+_append_value (GString * str, const GValue * value)
 {
-  MetadataForeachData *data = (MetadataForeachData *) user_data;
+  gchar *val;
+
+  switch (G_VALUE_TYPE (value)) {
+    case G_TYPE_INT:
+      g_string_append_printf (str, "%i", g_value_get_int (value));
+      return;
+    case G_TYPE_UINT:
+      g_string_append_printf (str, "%u", g_value_get_uint (value));
+      return;
+    case G_TYPE_INT64:
+      g_string_append_printf (str, "%" G_GINT64_FORMAT,
+          g_value_get_int64 (value));
+      return;
+    case G_TYPE_UINT64:
+      g_string_append_printf (str, "%" G_GUINT64_FORMAT,
+          g_value_get_uint64 (value));
+      return;
+    case G_TYPE_BOOLEAN:
+      g_string_append (str, g_value_get_boolean (value) ? "true" : "false");
+      return;
+    default:
+      break;
+  }
+
+  val = gst_value_serialize (value);
+  g_string_append (str, val ? val : "NULL");
+  g_free (val);
+}
+
+static gchar *
+_serialize (ContainerData * data)
+{
+  guint i;
+  GString *str = g_string_new ("metadatas");
+
+  for (i = 0; data && i < data->n_items; i++) {
+    MetaItem *item = &data->items[i];
+
+    if (!G_IS_VALUE (&item->value))
+      continue;
+
+    g_string_append (str, ", ");
+    g_string_append (str, g_quark_to_string (item->key));
+    g_string_append (str, "=(");
+    g_string_append (str, _type_name (G_VALUE_TYPE (&item->value)));
+    g_string_append_c (str, ')');
+    _append_value (str, &item->value);
+  }
+  g_string_append_c (str, ';');
 
-  data->func (data->container, g_quark_to_string (field_id), value, data->data);
+  return g_string_free (str, FALSE);
 }
 
 static gboolean
@@ -133,20 +283,30 @@ void
 ges_meta_container_foreach (GESMetaContainer * container,
     GESMetaForeachFunc func, gpointer user_data)
 {
-  GstStructure *structure;
-  MetadataForeachData foreach_data;
+  guint i;
+  ContainerData *data;
 
   g_return_if_fail (GES_IS_META_CONTAINER (container));
   g_return_if_fail (func != NULL);
 
-  structure = _meta_container_get_structure (container);
-
-  foreach_data.func = func;
-  foreach_data.container = container;
-  foreach_data.data = user_data;
-
-  gst_structure_foreach (structure,
-      (GstStructureForeachFunc) structure_foreach_wrapper, &foreach_data);
+  data = g_object_get_qdata (G_OBJECT (container), ges_meta_key);
+  if (data == NULL)
+    return;
+
+  /* @func might set metas, which can move the items around, so it gets a
+   * copy of each value */
+  for (i = 0; i < data->n_items; i++) {
+    GValue value = G_VALUE_INIT;
+    GQuark key = data->items[i].key;
+
+    if (!G_IS_VALUE (&data->items[i].value))
+      continue;
+
+    g_value_init (&value, G_VALUE_TYPE (&data->items[i].value));
+    g_value_copy (&data->items[i].value, &value);
+    func (container, g_quark_to_string (key), &value, user_data);
+    g_value_unset (&value);
+  }
 }
 
 /* _can_write_value should have been checked before calling */
@@ -154,51 +314,87 @@ static gboolean
 _register_meta (GESMetaContainer * container, GESMetaFlag flags,
     const gchar * meta_item, GType type)
 {
+  MetaItem *item;
   ContainerData *data;
-  RegisteredMeta *static_item;
+  GQuark key = g_quark_from_string (meta_item);
 
-  data = g_object_get_qdata (G_OBJECT (container), ges_meta_key);
-  if (!data)
-    data = _create_container_data (container);
-  else if (g_hash_table_lookup (data->static_items, meta_item)) {
+  data = _get_container_data (container);
+  item = _find_item (data, key);
+  if (item == NULL) {
+    item = _add_item (data, key);
+  } else if (item->registered_type != G_TYPE_INVALID) {
     GST_WARNING_OBJECT (container, "Static meta %s already registered",
         meta_item);
 
     return FALSE;
   }
 
-  static_item = g_slice_new0 (RegisteredMeta);
-  static_item->item_type = type;
-  static_item->flags = flags;
-  g_hash_table_insert (data->static_items, g_strdup (meta_item), static_item);
+  item->registered_type = type;
+  item->flags = flags;
 
   return TRUE;
 }
 
+/* Values of fundamental types can always be serialized, no need to try */
+static gboolean
+_can_serialize (const GValue * value)
+{
+  gchar *val;
+
+  switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value))) {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_INT64:
+    case G_TYPE_UINT64:
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+    case G_TYPE_STRING:
+      return TRUE;
+    default:
+      break;
+  }
+
+  val = gst_value_serialize (value);
+  g_free (val);
+
+  return val != NULL;
+}
+
 static gboolean
 _set_value (GESMetaContainer * container, const gchar * meta_item,
     const GValue * value)
 {
-  GstStructure *structure;
-  gchar *val = gst_value_serialize (value);
+  GQuark key;
+  MetaItem *item;
+  ContainerData *data;
 
-  if (val == NULL) {
+  if (!_can_serialize (value)) {
     GST_WARNING_OBJECT (container, "Could not set value on item: %s",
         meta_item);
 
-    g_free (val);
     return FALSE;
   }
 
-  structure = _meta_container_get_structure (container);
+  data = _get_container_data (container);
+  key = g_quark_from_string (meta_item);
+  item = _find_item (data, key);
+  if (item == NULL)
+    item = _add_item (data, key);
+  else if (G_IS_VALUE (&item->value))
+    g_value_unset (&item->value);
+
+  GST_DEBUG_OBJECT (container, "Setting meta_item %s value of type %s",
+      meta_item, G_VALUE_TYPE_NAME (value));
 
-  GST_DEBUG_OBJECT (container, "Setting meta_item %s value: %s::%s",
-      meta_item, G_VALUE_TYPE_NAME (value), val);
+  g_value_init (&item->value, G_VALUE_TYPE (value));
+  g_value_copy (value, &item->value);
+
+  g_free (data->serialized);
+  data->serialized = NULL;
 
-  gst_structure_set_value (structure, meta_item, value);
   g_signal_emit (container, _signals[NOTIFY_SIGNAL], 0, meta_item, value);
 
-  g_free (val);
   return TRUE;
 }
 
@@ -206,28 +402,19 @@ static gboolean
 _can_write_value (GESMetaContainer * container, const gchar * item_name,
     GType type)
 {
-  ContainerData *data;
-  RegisteredMeta *static_item = NULL;
-
-  data = g_object_get_qdata (G_OBJECT (container), ges_meta_key);
-  if (!data) {
-    data = _create_container_data (container);
-    return TRUE;
-  }
-
-  static_item = g_hash_table_lookup (data->static_items, item_name);
+  MetaItem *item = _lookup_item (container, item_name);
 
-  if (static_item == NULL)
+  if (item == NULL || item->registered_type == G_TYPE_INVALID)
     return TRUE;
 
-  if ((static_item->flags & GES_META_WRITABLE) == FALSE) {
+  if ((item->flags & GES_META_WRITABLE) == FALSE) {
     GST_WARNING_OBJECT (container, "Can not write %s", item_name);
     return FALSE;
   }
 
-  if (static_item->item_type != type) {
+  if (item->registered_type != type) {
     GST_WARNING_OBJECT (container, "Can not set value of type %s on %s "
-        "its type is: %s", g_type_name (static_item->item_type), item_name,
+        "its type is: %s", g_type_name (item->registered_type), item_name,
         g_type_name (type));
     return FALSE;
   }
@@ -396,6 +583,110 @@ ges_meta_container_set_meta (GESMetaContainer * container,
   return _set_value (container, meta_item, value);
 }
 
+/**
+ * ges_meta_container_set_metas:
+ * @container: Target container
+ * @first_meta_item: Name of the first meta item to set
+ * @...: the #GType of the first meta item and its value, followed by
+ * other name, type and value triplets, terminated by %NULL
+ *
+ * Sets the values of several meta items at once, the same way
+ * gst_structure_set() does. The GESMetaContainer::notify-meta signal
+ * is emitted for each of them.
+ *
+ * Return: %TRUE if all the metas could be set, %FALSE otherwize
+ */
+gboolean
+ges_meta_container_set_metas (GESMetaContainer * container,
+    const gchar * first_meta_item, ...)
+{
+  va_list args;
+  gboolean ret = TRUE;
+  const gchar *meta_item = first_meta_item;
+
+  g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);
+
+  va_start (args, first_meta_item);
+  while (meta_item) {
+    gchar *err = NULL;
+    GValue value = G_VALUE_INIT;
+    GType type = va_arg (args, GType);
+
+    G_VALUE_COLLECT_INIT (&value, type, args, 0, &err);
+    if (G_UNLIKELY (err)) {
+      g_critical ("Could not collect the value of %s: %s", meta_item, err);
+      g_free (err);
+      ret = FALSE;
+
+      /* The remaining arguments can not be trusted */
+      break;
+    }
+
+    if (!_can_write_value (container, meta_item, type) ||
+        !_set_value (container, meta_item, &value))
+      ret = FALSE;
+    g_value_unset (&value);
+
+    meta_item = va_arg (args, const gchar *);
+  }
+  va_end (args);
+
+  return ret;
+}
+
+/**
+ * ges_meta_container_get_metas:
+ * @container: Target container
+ * @first_meta_item: Name of the first meta item to get
+ * @...: the #GType of the first meta item and a location to store its
+ * value, followed by other name, type and location triplets, terminated
+ * by %NULL
+ *
+ * Gets the values of several meta items at once, the same way
+ * gst_structure_get() does. Strings and boxed values are copied and have
+ * to be freed.
+ *
+ * Return: %TRUE if all the metas were found with the given types, %FALSE
+ * otherwize
+ */
+gboolean
+ges_meta_container_get_metas (GESMetaContainer * container,
+    const gchar * first_meta_item, ...)
+{
+  va_list args;
+  gboolean ret = TRUE;
+  const gchar *meta_item = first_meta_item;
+
+  g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);
+
+  va_start (args, first_meta_item);
+  while (meta_item) {
+    gchar *err = NULL;
+    GType type = va_arg (args, GType);
+    const GValue *value = _get_value (container, meta_item);
+
+    if (value == NULL || G_VALUE_TYPE (value) != type) {
+      GST_DEBUG_OBJECT (container, "No meta %s of type %s", meta_item,
+          g_type_name (type));
+      ret = FALSE;
+      break;
+    }
+
+    G_VALUE_LCOPY (value, args, 0, &err);
+    if (G_UNLIKELY (err)) {
+      g_critical ("Could not copy the value of %s: %s", meta_item, err);
+      g_free (err);
+      ret = FALSE;
+      break;
+    }
+
+    meta_item = va_arg (args, const gchar *);
+  }
+  va_end (args);
+
+  return ret;
+}
+
 /**
  * ges_meta_container_metas_to_string:
  * @container: a #GESMetaContainer
@@ -408,13 +699,18 @@ ges_meta_container_set_meta (GESMetaContainer * container,
 gchar *
 ges_meta_container_metas_to_string (GESMetaContainer * container)
 {
-  GstStructure *structure;
+  ContainerData *data;
 
   g_return_val_if_fail (GES_IS_META_CONTAINER (container), NULL);
 
-  structure = _meta_container_get_structure (container);
+  data = g_object_get_qdata (G_OBJECT (container), ges_meta_key);
+  if (data == NULL)
+    return _serialize (NULL);
+
+  if (data->serialized == NULL)
+    data->serialized = _serialize (data);
 
-  return gst_structure_to_string (structure);
+  return g_strdup (data->serialized);
 }
 
 /**
@@ -652,15 +948,9 @@ gboolean
 ges_meta_container_check_meta_registered (GESMetaContainer * container,
     const gchar * meta_item, GESMetaFlag * flags, GType * type)
 {
-  ContainerData *data;
-  RegisteredMeta *static_item;
-
-  data = g_object_get_qdata (G_OBJECT (container), ges_meta_key);
-  if (!data)
-    return FALSE;
+  MetaItem *item = _lookup_item (container, meta_item);
 
-  static_item = g_hash_table_lookup (data->static_items, meta_item);
-  if (static_item == NULL) {
+  if (item == NULL || item->registered_type == G_TYPE_INVALID) {
     GST_WARNING_OBJECT (container, "Static meta %s already registered",
         meta_item);
 
@@ -668,10 +958,10 @@ ges_meta_container_check_meta_registered (GESMetaContainer * container,
   }
 
   if (type)
-    *type = static_item->item_type;
+    *type = item->registered_type;
 
   if (flags)
-    *flags = static_item->flags;
+    *flags = item->flags;
 
   return TRUE;
 }
@@ -679,20 +969,24 @@ ges_meta_container_check_meta_registered (GESMetaContainer * container,
 /* Copied from gsttaglist.c */
 /***** evil macros to get all the *_get_* functions right *****/
 
-#define CREATE_GETTER(name,type)                                         \
+#define CREATE_GETTER(name, type, value_gtype, getter_name)              \
 gboolean                                                                 \
-ges_meta_container_get_ ## name (GESMetaContainer *container,    \
-                           const gchar *meta_item, type value)       \
+ges_meta_container_get_ ## name (GESMetaContainer *container,            \
+                           const gchar *meta_item, type dest)            \
 {                                                                        \
-  GstStructure *structure;                                                     \
+  const GValue *value;                                                   \
+                                                                         \
+  g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);       \
+  g_return_val_if_fail (meta_item != NULL, FALSE);                       \
+  g_return_val_if_fail (dest != NULL, FALSE);                            \
                                                                          \
-  g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);   \
-  g_return_val_if_fail (meta_item != NULL, FALSE);                   \
-  g_return_val_if_fail (value != NULL, FALSE);                           \
+  value = _get_value (container, meta_item);                             \
+  if (!value || G_VALUE_TYPE (value) != value_gtype)                     \
+    return FALSE;                                                        \
                                                                          \
-  structure = _meta_container_get_structure (container);                    \
+  *dest = g_value_ ## getter_name (value);                               \
                                                                          \
-  return gst_structure_get_ ## name (structure, meta_item, value);   \
+  return TRUE;                                                           \
 }
 
 /**
@@ -703,7 +997,7 @@ ges_meta_container_get_ ## name (GESMetaContainer *container,    \
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-CREATE_GETTER (boolean, gboolean *);
+CREATE_GETTER (boolean, gboolean *, G_TYPE_BOOLEAN, get_boolean);
 /**
  * ges_meta_container_get_int:
  * @container: Target container
@@ -712,7 +1006,7 @@ CREATE_GETTER (boolean, gboolean *);
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-CREATE_GETTER (int, gint *);
+CREATE_GETTER (int, gint *, G_TYPE_INT, get_int);
 /**
  * ges_meta_container_get_uint:
  * @container: Target container
@@ -721,7 +1015,7 @@ CREATE_GETTER (int, gint *);
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-CREATE_GETTER (uint, guint *);
+CREATE_GETTER (uint, guint *, G_TYPE_UINT, get_uint);
 /**
  * ges_meta_container_get_double:
  * @container: Target container
@@ -730,7 +1024,7 @@ CREATE_GETTER (uint, guint *);
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-CREATE_GETTER (double, gdouble *);
+CREATE_GETTER (double, gdouble *, G_TYPE_DOUBLE, get_double);
 
 /**
  * ges_meta_container_get_int64:
@@ -740,27 +1034,7 @@ CREATE_GETTER (double, gdouble *);
  * Gets the value of a given meta item, returns %FALSE if @meta_item
  * can not be found.
  */
-gboolean
-ges_meta_container_get_int64 (GESMetaContainer * container,
-    const gchar * meta_item, gint64 * dest)
-{
-  GstStructure *structure;
-  const GValue *value;
-
-  g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);
-  g_return_val_if_fail (meta_item != NULL, FALSE);
-  g_return_val_if_fail (dest != NULL, FALSE);
-
-  structure = _meta_container_get_structure (container);
-
-  value = gst_structure_get_value (structure, meta_item);
-  if (!value || G_VALUE_TYPE (value) != G_TYPE_INT64)
-    return FALSE;
-
-  *dest = g_value_get_int64 (value);
-
-  return TRUE;
-}
+CREATE_GETTER (int64, gint64 *, G_TYPE_INT64, get_int64);
 
 /**
  * ges_meta_container_get_uint64:
@@ -770,27 +1044,7 @@ ges_meta_container_get_int64 (GESMetaContainer * container,
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-gboolean
-ges_meta_container_get_uint64 (GESMetaContainer * container,
-    const gchar * meta_item, guint64 * dest)
-{
-  GstStructure *structure;
-  const GValue *value;
-
-  g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);
-  g_return_val_if_fail (meta_item != NULL, FALSE);
-  g_return_val_if_fail (dest != NULL, FALSE);
-
-  structure = _meta_container_get_structure (container);
-
-  value = gst_structure_get_value (structure, meta_item);
-  if (!value || G_VALUE_TYPE (value) != G_TYPE_UINT64)
-    return FALSE;
-
-  *dest = g_value_get_uint64 (value);
-
-  return TRUE;
-}
+CREATE_GETTER (uint64, guint64 *, G_TYPE_UINT64, get_uint64);
 
 /**
  * ges_meta_container_get_float:
@@ -800,27 +1054,7 @@ ges_meta_container_get_uint64 (GESMetaContainer * container,
  * Gets the value of a given meta item, returns FALSE if @meta_item
  * can not be found.
  */
-gboolean
-ges_meta_container_get_float (GESMetaContainer * container,
-    const gchar * meta_item, gfloat * dest)
-{
-  GstStructure *structure;
-  const GValue *value;
-
-  g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);
-  g_return_val_if_fail (meta_item != NULL, FALSE);
-  g_return_val_if_fail (dest != NULL, FALSE);
-
-  structure = _meta_container_get_structure (container);
-
-  value = gst_structure_get_value (structure, meta_item);
-  if (!value || G_VALUE_TYPE (value) != G_TYPE_FLOAT)
-    return FALSE;
-
-  *dest = g_value_get_float (value);
-
-  return TRUE;
-}
+CREATE_GETTER (float, gfloat *, G_TYPE_FLOAT, get_float);
 
 /**
  * ges_meta_container_get_string:
@@ -833,14 +1067,16 @@ const gchar *
 ges_meta_container_get_string (GESMetaContainer * container,
     const gchar * meta_item)
 {
-  GstStructure *structure;
+  const GValue *value;
 
   g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);
   g_return_val_if_fail (meta_item != NULL, FALSE);
 
-  structure = _meta_container_get_structure (container);
+  value = _get_value (container, meta_item);
+  if (!value || G_VALUE_TYPE (value) != G_TYPE_STRING)
+    return NULL;
 
-  return gst_structure_get_string (structure, meta_item);
+  return g_value_get_string (value);
 }
 
 /**
@@ -856,14 +1092,10 @@ ges_meta_container_get_string (GESMetaContainer * container,
 const GValue *
 ges_meta_container_get_meta (GESMetaContainer * container, const gchar * key)
 {
-  GstStructure *structure;
-
   g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);
   g_return_val_if_fail (key != NULL, FALSE);
 
-  structure = _meta_container_get_structure (container);
-
-  return gst_structure_get_value (structure, key);
+  return _get_value (container, key);
 }
 
 /**
@@ -874,7 +1106,7 @@ ges_meta_container_get_meta (GESMetaContainer * container, const gchar * key)
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-CREATE_GETTER (date, GDate **);
+CREATE_GETTER (date, GDate **, G_TYPE_DATE, dup_boxed);
 
 /**
  * ges_meta_container_get_date_time:
@@ -884,4 +1116,5 @@ CREATE_GETTER (date, GDate **);
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-CREATE_GETTER (date_time, GstDateTime **);
+CREATE_GETTER (date_time, GstDateTime **, GST_TYPE_DATE_TIME,
+    dup_boxed);
@@ -102,6 +102,14 @@ G_BEGIN_DECLS
  */
 #define GES_META_VOLUME_DEFAULT                       1.0
 
+/**
+ * GES_META_IMAGE_SEQUENCE_CACHE_SIZE:
+ *
+ * The number of frames decoded in advance when playing an image sequence,
+ * it is registered as a uint on the asset of the sequence
+ */
+#define GES_META_IMAGE_SEQUENCE_CACHE_SIZE           "image-sequence-cache-size"
+
 typedef struct _GESMetaContainer          GESMetaContainer;
 typedef struct _GESMetaContainerInterface GESMetaContainerInterface;
 
@@ -168,6 +176,16 @@ ges_meta_container_set_meta            (GESMetaContainer * container,
                                         const gchar* meta_item,
                                         const GValue *value);
 
+gboolean
+ges_meta_container_set_metas           (GESMetaContainer * container,
+                                        const gchar * first_meta_item,
+                                        ...) G_GNUC_NULL_TERMINATED;
+
+gboolean
+ges_meta_container_get_metas           (GESMetaContainer * container,
+                                        const gchar * first_meta_item,
+                                        ...) G_GNUC_NULL_TERMINATED;
+
 gboolean
 ges_meta_container_register_meta_boolean (GESMetaContainer *container,
                                           GESMetaFlag flags,
@@ -0,0 +1,362 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* A meta index keeps, for a set of meta items, inverted indexes over the
+ * GESMetaContainer-s added to it, so that the containers having a meta set
+ * to a given value, or in a given range of numbers, can be found without
+ * iterating over all of them.
+ *
+ * For each indexed meta item we keep:
+ *  - a hash table from the value (its type and serialization) to the set
+ *    of containers that have it, for equality lookups,
+ *  - a GSequence of the containers with a numeric value sorted by value,
+ *    for range lookups.
+ *
+ * The index listens to GESMetaContainer::notify-meta on the containers it
+ * knows to stay up to date. It does not keep references on them, its owner
+ * has to remove them before dropping its own references.
+ */
+
+#include "ges-internal.h"
+
+typedef struct
+{
+  GESMetaContainer *container;
+  gchar *value_key;
+
+  /* Only set for numeric values */
+  gdouble number;
+  GSequenceIter *iter;
+} IndexEntry;
+
+typedef struct
+{
+  GHashTable *entries;          /* container -> IndexEntry */
+  GHashTable *values;           /* value_key -> set of containers */
+  GSequence *numbers;           /* IndexEntry sorted by number */
+} KeyIndex;
+
+struct _GESMetaIndex
+{
+  GHashTable *keys;             /* GQuark -> KeyIndex */
+  GHashTable *containers;       /* set of the indexed containers */
+};
+
+static void
+_free_entry (IndexEntry * entry)
+{
+  g_free (entry->value_key);
+  g_slice_free (IndexEntry, entry);
+}
+
+static void
+_free_key_index (KeyIndex * kindex)
+{
+  g_sequence_free (kindex->numbers);
+  g_hash_table_unref (kindex->values);
+  g_hash_table_unref (kindex->entries);
+  g_slice_free (KeyIndex, kindex);
+}
+
+static gint
+_compare_entries (IndexEntry * a, IndexEntry * b, gpointer unused)
+{
+  if (a->number < b->number)
+    return -1;
+  else if (a->number > b->number)
+    return 1;
+
+  /* Probes used for searching have no container and come first */
+  if (a->container == b->container)
+    return 0;
+
+  return GPOINTER_TO_SIZE (a->container) <
+      GPOINTER_TO_SIZE (b->container) ? -1 : 1;
+}
+
+static gboolean
+_get_number (const GValue * value, gdouble * number)
+{
+  switch (G_VALUE_TYPE (value)) {
+    case G_TYPE_INT:
+      *number = g_value_get_int (value);
+      return TRUE;
+    case G_TYPE_UINT:
+      *number = g_value_get_uint (value);
+      return TRUE;
+    case G_TYPE_INT64:
+      *number = g_value_get_int64 (value);
+      return TRUE;
+    case G_TYPE_UINT64:
+      *number = g_value_get_uint64 (value);
+      return TRUE;
+    case G_TYPE_FLOAT:
+      *number = g_value_get_float (value);
+      return TRUE;
+    case G_TYPE_DOUBLE:
+      *number = g_value_get_double (value);
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+/* Values of different types never compare equal, even when they serialize
+ * to the same string */
+static gchar *
+_make_value_key (const GValue * value)
+{
+  gchar *val, *key;
+
+  val = gst_value_serialize (value);
+  if (val == NULL)
+    return NULL;
+
+  key = g_strdup_printf ("%s:%s", G_VALUE_TYPE_NAME (value), val);
+  g_free (val);
+
+  return key;
+}
+
+static void
+_unindex (KeyIndex * kindex, GESMetaContainer * container)
+{
+  GHashTable *set;
+  IndexEntry *entry = g_hash_table_lookup (kindex->entries, container);
+
+  if (entry == NULL)
+    return;
+
+  set = g_hash_table_lookup (kindex->values, entry->value_key);
+  if (set) {
+    g_hash_table_remove (set, container);
+    if (g_hash_table_size (set) == 0)
+      g_hash_table_remove (kindex->values, entry->value_key);
+  }
+
+  if (entry->iter)
+    g_sequence_remove (entry->iter);
+
+  g_hash_table_remove (kindex->entries, container);
+}
+
+static void
+_index (KeyIndex * kindex, GESMetaContainer * container, const GValue * value)
+{
+  GHashTable *set;
+  IndexEntry *entry;
+  gchar *value_key;
+
+  _unindex (kindex, container);
+
+  if (value == NULL || (value_key = _make_value_key (value)) == NULL)
+    return;
+
+  entry = g_slice_new0 (IndexEntry);
+  entry->container = container;
+  entry->value_key = value_key;
+  g_hash_table_insert (kindex->entries, container, entry);
+
+  set = g_hash_table_lookup (kindex->values, value_key);
+  if (set == NULL) {
+    set = g_hash_table_new (NULL, NULL);
+    g_hash_table_insert (kindex->values, g_strdup (value_key), set);
+  }
+  g_hash_table_add (set, container);
+
+  if (_get_number (value, &entry->number))
+    entry->iter = g_sequence_insert_sorted (kindex->numbers, entry,
+        (GCompareDataFunc) _compare_entries, NULL);
+}
+
+static void
+_meta_changed_cb (GESMetaContainer * container, const gchar * meta_item,
+    const GValue * value, GESMetaIndex * index)
+{
+  KeyIndex *kindex;
+  GQuark key = g_quark_try_string (meta_item);
+
+  kindex = g_hash_table_lookup (index->keys, GUINT_TO_POINTER (key));
+  if (kindex)
+    _index (kindex, container, value);
+}
+
+GESMetaIndex *
+ges_meta_index_new (void)
+{
+  GESMetaIndex *index = g_slice_new (GESMetaIndex);
+
+  index->keys = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) _free_key_index);
+  index->containers = g_hash_table_new (NULL, NULL);
+
+  return index;
+}
+
+void
+ges_meta_index_free (GESMetaIndex * index)
+{
+  GHashTableIter iter;
+  gpointer container;
+
+  g_hash_table_iter_init (&iter, index->containers);
+  while (g_hash_table_iter_next (&iter, &container, NULL))
+    g_signal_handlers_disconnect_by_func (container, _meta_changed_cb, index);
+
+  g_hash_table_unref (index->containers);
+  g_hash_table_unref (index->keys);
+  g_slice_free (GESMetaIndex, index);
+}
+
+/* Starts indexing @meta_item, returns %FALSE if it already was */
+gboolean
+ges_meta_index_add_key (GESMetaIndex * index, const gchar * meta_item)
+{
+  KeyIndex *kindex;
+  GHashTableIter iter;
+  gpointer container;
+  GQuark key = g_quark_from_string (meta_item);
+
+  if (g_hash_table_contains (index->keys, GUINT_TO_POINTER (key)))
+    return FALSE;
+
+  kindex = g_slice_new (KeyIndex);
+  kindex->entries = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) _free_entry);
+  kindex->values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      (GDestroyNotify) g_hash_table_unref);
+  kindex->numbers = g_sequence_new (NULL);
+  g_hash_table_insert (index->keys, GUINT_TO_POINTER (key), kindex);
+
+  g_hash_table_iter_init (&iter, index->containers);
+  while (g_hash_table_iter_next (&iter, &container, NULL))
+    _index (kindex, container,
+        ges_meta_container_get_meta (container, meta_item));
+
+  return TRUE;
+}
+
+gboolean
+ges_meta_index_has_key (GESMetaIndex * index, const gchar * meta_item)
+{
+  GQuark key = g_quark_try_string (meta_item);
+
+  return key && g_hash_table_contains (index->keys, GUINT_TO_POINTER (key));
+}
+
+void
+ges_meta_index_add_container (GESMetaIndex * index,
+    GESMetaContainer * container)
+{
+  GHashTableIter iter;
+  gpointer key, kindex;
+
+  if (g_hash_table_contains (index->containers, container))
+    return;
+
+  g_hash_table_add (index->containers, container);
+  g_signal_connect (container, "notify-meta", G_CALLBACK (_meta_changed_cb),
+      index);
+
+  g_hash_table_iter_init (&iter, index->keys);
+  while (g_hash_table_iter_next (&iter, &key, &kindex))
+    _index (kindex, container, ges_meta_container_get_meta (container,
+            g_quark_to_string (GPOINTER_TO_UINT (key))));
+}
+
+void
+ges_meta_index_remove_container (GESMetaIndex * index,
+    GESMetaContainer * container)
+{
+  GHashTableIter iter;
+  gpointer kindex;
+
+  if (!g_hash_table_remove (index->containers, container))
+    return;
+
+  g_signal_handlers_disconnect_by_func (container, _meta_changed_cb, index);
+
+  g_hash_table_iter_init (&iter, index->keys);
+  while (g_hash_table_iter_next (&iter, NULL, &kindex))
+    _unindex (kindex, container);
+}
+
+/* Returns the containers whose @meta_item equals @value, %NULL if there are
+ * none or if @meta_item is not indexed. The list has to be freed but the
+ * containers are not reffed */
+GList *
+ges_meta_index_find (GESMetaIndex * index, const gchar * meta_item,
+    const GValue * value)
+{
+  GHashTable *set;
+  KeyIndex *kindex;
+  gchar *value_key;
+  GQuark key = g_quark_try_string (meta_item);
+
+  kindex = g_hash_table_lookup (index->keys, GUINT_TO_POINTER (key));
+  if (kindex == NULL || (value_key = _make_value_key (value)) == NULL)
+    return NULL;
+
+  set = g_hash_table_lookup (kindex->values, value_key);
+  g_free (value_key);
+
+  return set ? g_hash_table_get_keys (set) : NULL;
+}
+
+/* Returns the containers whose @meta_item is a number between @min and @max
+ * included, sorted by value. A %NULL bound is not checked */
+GList *
+ges_meta_index_find_range (GESMetaIndex * index, const gchar * meta_item,
+    const GValue * min, const GValue * max)
+{
+  KeyIndex *kindex;
+  GList *ret = NULL;
+  GSequenceIter *iter;
+  IndexEntry probe = { NULL, };
+  gdouble max_number = G_MAXDOUBLE;
+  GQuark key = g_quark_try_string (meta_item);
+
+  kindex = g_hash_table_lookup (index->keys, GUINT_TO_POINTER (key));
+  if (kindex == NULL)
+    return NULL;
+
+  if (min) {
+    if (!_get_number (min, &probe.number))
+      return NULL;
+
+    iter = g_sequence_search (kindex->numbers, &probe,
+        (GCompareDataFunc) _compare_entries, NULL);
+  } else {
+    iter = g_sequence_get_begin_iter (kindex->numbers);
+  }
+
+  if (max && !_get_number (max, &max_number))
+    return NULL;
+
+  for (; !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
+    IndexEntry *entry = g_sequence_get (iter);
+
+    if (entry->number > max_number)
+      break;
+
+    ret = g_list_prepend (ret, entry->container);
+  }
+
+  return g_list_reverse (ret);
+}
@@ -32,6 +32,10 @@
 #include "ges-extractable.h"
 #include "ges-uri-asset.h"
 #include "ges-internal.h"
+#include "gstimagesequencereader.h"
+
+#define DEFAULT_FPS_N 25
+#define DEFAULT_FPS_D 1
 
 /* Extractable interface implementation */
 
@@ -161,19 +165,49 @@ ges_multi_file_uri_new (const gchar * uri)
   return uri_data;
 }
 
+/* Lists the files matching the location pattern, up to the stop index or
+ * to the first missing file if there is none. Returns %NULL if there is no
+ * file, or if a file before the stop index is missing: it might be written
+ * while playing */
+static gchar **
+_list_files (GESMultiFileURI * uri_data)
+{
+  gint i;
+  gchar *filename;
+  GPtrArray *files = g_ptr_array_new ();
+
+  for (i = uri_data->start; uri_data->end < 0 || i <= uri_data->end; i++) {
+    filename = g_strdup_printf (uri_data->location, i);
+    if (!g_file_test (filename, G_FILE_TEST_IS_REGULAR)) {
+      GST_DEBUG ("%s does not exist", filename);
+      g_free (filename);
+
+      if (files->len == 0 || uri_data->end >= 0) {
+        g_ptr_array_free (files, TRUE);
+
+        return NULL;
+      }
+      break;
+    }
+
+    g_ptr_array_add (files, filename);
+  }
+  g_ptr_array_add (files, NULL);
+
+  return (gchar **) g_ptr_array_free (files, FALSE);
+}
+
+/* Reads the files one after the other while playing */
 static GstElement *
-ges_multi_file_source_create_source (GESTrackElement * track_element)
+_create_multifilesrc_bin (GESMultiFileSource * self,
+    GESMultiFileURI * uri_data)
 {
-  GESMultiFileSource *self;
   GstElement *bin, *src, *decodebin;
   GstCaps *disc_caps;
   GstDiscovererStreamInfo *stream_info;
   GValue fps = G_VALUE_INIT;
   GstCaps *caps;
   GESUriSourceAsset *asset;
-  GESMultiFileURI *uri_data;
-
-  self = (GESMultiFileSource *) track_element;
 
   asset =
       GES_URI_SOURCE_ASSET (ges_extractable_get_asset (GES_EXTRACTABLE (self)));
@@ -183,7 +217,7 @@ ges_multi_file_source_create_source (GESTrackElement * track_element)
     g_assert (stream_info);
     disc_caps = gst_discoverer_stream_info_get_caps (stream_info);
     caps = gst_caps_copy (disc_caps);
-    GST_DEBUG ("Got some nice caps %s", gst_caps_to_string (disc_caps));
+    GST_DEBUG ("Got some nice caps %" GST_PTR_FORMAT, disc_caps);
     gst_object_unref (stream_info);
     gst_caps_unref (disc_caps);
   } else {
@@ -192,16 +226,16 @@ ges_multi_file_source_create_source (GESTrackElement * track_element)
   }
 
   g_value_init (&fps, GST_TYPE_FRACTION);
-  gst_value_set_fraction (&fps, 25, 1);
+  gst_value_set_fraction (&fps, DEFAULT_FPS_N, DEFAULT_FPS_D);
   gst_caps_set_value (caps, "framerate", &fps);
+  g_value_unset (&fps);
 
   bin = GST_ELEMENT (gst_bin_new ("multi-image-bin"));
   src = gst_element_factory_make ("multifilesrc", NULL);
 
-  uri_data = ges_multi_file_uri_new (self->uri);
   g_object_set (src, "start-index", uri_data->start, "stop-index",
       uri_data->end, "caps", caps, "location", uri_data->location, NULL);
-  g_free (uri_data);
+  gst_caps_unref (caps);
 
   decodebin = gst_element_factory_make ("decodebin", NULL);
 
@@ -215,6 +249,40 @@ ges_multi_file_source_create_source (GESTrackElement * track_element)
   return bin;
 }
 
+static GstElement *
+ges_multi_file_source_create_source (GESTrackElement * track_element)
+{
+  GESMultiFileSource *self;
+  GstElement *src;
+  GESMultiFileURI *uri_data;
+  gchar **filenames;
+
+  self = (GESMultiFileSource *) track_element;
+
+  uri_data = ges_multi_file_uri_new (self->uri);
+  filenames = _list_files (uri_data);
+  if (filenames == NULL) {
+    GST_INFO_OBJECT (self, "Not all the images of %s are there yet, reading "
+        "them while playing", self->uri);
+    src = _create_multifilesrc_bin (self, uri_data);
+    g_free (uri_data);
+
+    return src;
+  }
+  g_free (uri_data);
+
+  GST_DEBUG_OBJECT (self, "Reading %u images from %s",
+      g_strv_length (filenames), self->uri);
+
+  /* The frames are read and decoded ahead of time */
+  src = ges_image_sequence_reader_new (track_element, filenames,
+      DEFAULT_FPS_N, DEFAULT_FPS_D,
+      ges_image_sequence_reader_get_cache_size (track_element));
+  g_strfreev (filenames);
+
+  return src;
+}
+
 static void
 ges_multi_file_source_class_init (GESMultiFileSourceClass * klass)
 {
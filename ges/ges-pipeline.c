@@ -39,6 +39,19 @@
 
 #define DEFAULT_TIMELINE_MODE  GES_PIPELINE_MODE_PREVIEW
 
+/* When thumbnailing a list of timestamps, we keep decoding forward instead
+ * of doing a new (flushing) seek if the next timestamp is closer than that
+ * to the last decoded frame. */
+#define THUMBNAIL_MAX_FORWARD_DECODE (2 * GST_SECOND)
+
+/* How long we wait for the pipeline to preroll before giving up on
+ * thumbnailing */
+#define THUMBNAIL_PREROLL_TIMEOUT (10 * GST_SECOND)
+
+/* How long we wait for the next frame of the thumbnailing branch before
+ * giving up on the current timestamp */
+#define THUMBNAIL_FRAME_TIMEOUT (10 * GST_SECOND)
+
 /* Structure corresponding to a timeline - sink link */
 
 typedef struct
@@ -48,6 +61,8 @@ typedef struct
   GstPad *srcpad;               /* Timeline source pad */
   GstPad *playsinkpad;
   GstPad *encodebinpad;
+  GstPad *thumbnailpad;
+  GstElement *fakesink;         /* Drains non-video tracks when thumbnailing */
   GstPad *blocked_pad;
   gulong probe_id;
 } OutputChain;
@@ -60,6 +75,17 @@ struct _GESPipelinePrivate
   GstElement *encodebin;
   /* Note : urisink is only created when a URI has been provided */
   GstElement *urisink;
+  /* queue ! videoconvert ! videoscale ! capsfilter ! appsink */
+  GstElement *thumbnailbin;
+
+  /* Lets ges_pipeline_get_thumbnails() wait for frames without blocking
+   * forever when the pipeline errors out, protected by thumbnail_lock */
+  GMutex thumbnail_lock;
+  GCond thumbnail_cond;
+  gboolean thumbnailing;
+  guint n_queued_thumbnails;
+  gboolean thumbnail_eos;
+  GError *thumbnail_error;
 
   GESPipelineFlags mode;
 
@@ -67,6 +93,10 @@ struct _GESPipelinePrivate
   GList *chains;
 
   GstEncodingProfile *profile;
+
+  /* Set when the "profiling" property is, lives until the next start */
+  gboolean profiling;
+  GESRenderProfiler *profiler;
 };
 
 enum
@@ -76,6 +106,7 @@ enum
   PROP_VIDEO_SINK,
   PROP_TIMELINE,
   PROP_MODE,
+  PROP_PROFILING,
   PROP_LAST
 };
 
@@ -164,6 +195,9 @@ ges_pipeline_get_property (GObject * object, guint property_id,
     case PROP_MODE:
       g_value_set_flags (value, self->priv->mode);
       break;
+    case PROP_PROFILING:
+      g_value_set_boolean (value, self->priv->profiling);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -191,6 +225,9 @@ ges_pipeline_set_property (GObject * object, guint property_id,
     case PROP_MODE:
       ges_pipeline_set_mode (GES_PIPELINE (object), g_value_get_flags (value));
       break;
+    case PROP_PROFILING:
+      self->priv->profiling = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -218,23 +255,68 @@ ges_pipeline_dispose (GObject * object)
     self->priv->encodebin = NULL;
   }
 
+  if (self->priv->thumbnailbin) {
+    if (self->priv->mode & GES_PIPELINE_MODE_THUMBNAIL)
+      gst_bin_remove (GST_BIN (object), self->priv->thumbnailbin);
+    else
+      gst_object_unref (self->priv->thumbnailbin);
+    self->priv->thumbnailbin = NULL;
+  }
+
   if (self->priv->profile) {
     gst_encoding_profile_unref (self->priv->profile);
     self->priv->profile = NULL;
   }
 
+  if (self->priv->profiler) {
+    ges_render_profiler_free (self->priv->profiler);
+    self->priv->profiler = NULL;
+  }
+
   G_OBJECT_CLASS (ges_pipeline_parent_class)->dispose (object);
 }
 
+static void
+ges_pipeline_finalize (GObject * object)
+{
+  GESPipeline *self = GES_PIPELINE (object);
+
+  g_mutex_clear (&self->priv->thumbnail_lock);
+  g_cond_clear (&self->priv->thumbnail_cond);
+
+  G_OBJECT_CLASS (ges_pipeline_parent_class)->finalize (object);
+}
+
+static void
+ges_pipeline_handle_message (GstBin * bin, GstMessage * message)
+{
+  GESPipeline *self = GES_PIPELINE (bin);
+
+  /* Wake up ges_pipeline_get_thumbnails(), the frame it waits for might
+   * never come */
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ERROR) {
+    g_mutex_lock (&self->priv->thumbnail_lock);
+    if (self->priv->thumbnailing && self->priv->thumbnail_error == NULL) {
+      gst_message_parse_error (message, &self->priv->thumbnail_error, NULL);
+      g_cond_broadcast (&self->priv->thumbnail_cond);
+    }
+    g_mutex_unlock (&self->priv->thumbnail_lock);
+  }
+
+  GST_BIN_CLASS (ges_pipeline_parent_class)->handle_message (bin, message);
+}
+
 static void
 ges_pipeline_class_init (GESPipelineClass * klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstBinClass *bin_class = GST_BIN_CLASS (klass);
 
   g_type_class_add_private (klass, sizeof (GESPipelinePrivate));
 
   object_class->dispose = ges_pipeline_dispose;
+  object_class->finalize = ges_pipeline_finalize;
   object_class->get_property = ges_pipeline_get_property;
   object_class->set_property = ges_pipeline_set_property;
 
@@ -286,8 +368,24 @@ ges_pipeline_class_init (GESPipelineClass * klass)
   g_object_class_install_property (object_class, PROP_MODE,
       properties[PROP_MODE]);
 
+  /**
+   * GESPipeline:profiling:
+   *
+   * Whether to measure how long each #GESTrackElement takes to process its
+   * buffers, and how many buffers it produces. It is taken into account
+   * the next time the pipeline goes from %GST_STATE_READY to
+   * %GST_STATE_PAUSED. See ges_pipeline_get_profiling_report().
+   */
+  properties[PROP_PROFILING] = g_param_spec_boolean ("profiling", "Profiling",
+      "Measure the processing time of each track element", FALSE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+  g_object_class_install_property (object_class, PROP_PROFILING,
+      properties[PROP_PROFILING]);
+
   element_class->change_state = GST_DEBUG_FUNCPTR (ges_pipeline_change_state);
 
+  bin_class->handle_message = GST_DEBUG_FUNCPTR (ges_pipeline_handle_message);
+
   /* TODO : Add state_change handlers
    * Don't change state if we don't have a timeline */
 }
@@ -299,16 +397,25 @@ ges_pipeline_init (GESPipeline * self)
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
       GES_TYPE_PIPELINE, GESPipelinePrivate);
 
+  g_mutex_init (&self->priv->thumbnail_lock);
+  g_cond_init (&self->priv->thumbnail_cond);
+
   self->priv->playsink =
       gst_element_factory_make ("playsink", "internal-sinks");
   self->priv->encodebin =
       gst_element_factory_make ("encodebin", "internal-encodebin");
   g_object_set (self->priv->encodebin, "avoid-reencoding", TRUE, NULL);
+  self->priv->thumbnailbin =
+      gst_parse_bin_from_description ("queue ! videoconvert ! videoscale ! "
+      "capsfilter name=thumbnailcaps ! appsink name=thumbnailsink sync=false "
+      "max-buffers=1 emit-signals=true", TRUE, NULL);
 
   if (G_UNLIKELY (self->priv->playsink == NULL))
     goto no_playsink;
   if (G_UNLIKELY (self->priv->encodebin == NULL))
     goto no_encodebin;
+  if (G_UNLIKELY (self->priv->thumbnailbin == NULL))
+    goto no_thumbnailbin;
 
   ges_pipeline_set_mode (self, DEFAULT_TIMELINE_MODE);
 
@@ -324,6 +431,11 @@ no_encodebin:
     GST_ERROR_OBJECT (self, "Can't create encodebin instance !");
     return;
   }
+no_thumbnailbin:
+  {
+    GST_ERROR_OBJECT (self, "Can't create thumbnailing bin !");
+    return;
+  }
 }
 
 /**
@@ -437,6 +549,17 @@ ges_pipeline_change_state (GstElement * element, GstStateChange transition)
         goto done;
       }
       /* Set caps on all tracks according to profile if present */
+
+      /* Each run is profiled from scratch */
+      if (self->priv->profiler) {
+        ges_render_profiler_free (self->priv->profiler);
+        self->priv->profiler = NULL;
+      }
+      if (self->priv->profiling) {
+        self->priv->profiler = ges_render_profiler_new ();
+        ges_render_profiler_start (self->priv->profiler,
+            self->priv->timeline);
+      }
       break;
     default:
       break;
@@ -446,6 +569,10 @@ ges_pipeline_change_state (GstElement * element, GstStateChange transition)
       GST_ELEMENT_CLASS (ges_pipeline_parent_class)->change_state
       (element, transition);
 
+  /* Streaming is stopped, keep the costs for the report */
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY && self->priv->profiler)
+    ges_render_profiler_stop (self->priv->profiler);
+
 done:
   return ret;
 }
@@ -692,6 +819,47 @@ pad_added_cb (GstElement * timeline, GstPad * pad, GESPipeline * self)
 
   }
 
+  /* Connect the thumbnailing branch */
+  if (self->priv->mode & GES_PIPELINE_MODE_THUMBNAIL) {
+    GstPad *tmppad;
+
+    if (track->type == GES_TRACK_TYPE_VIDEO) {
+      GST_DEBUG_OBJECT (self, "Connecting to the thumbnailing bin");
+
+      sinkpad = gst_element_get_static_pad (self->priv->thumbnailbin, "sink");
+      if (gst_pad_is_linked (sinkpad)) {
+        GST_WARNING_OBJECT (self, "Only one video track can be thumbnailed");
+        gst_object_unref (sinkpad);
+        sinkpad = NULL;
+      } else {
+        tmppad = gst_element_get_request_pad (chain->tee, "src_%u");
+        if (G_UNLIKELY (gst_pad_link_full (tmppad, sinkpad,
+                    GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
+          GST_ERROR_OBJECT (self, "Couldn't link track pad to thumbnailing bin");
+          gst_object_unref (tmppad);
+          goto error;
+        }
+        gst_object_unref (tmppad);
+        chain->thumbnailpad = sinkpad;
+      }
+    } else if (!(self->priv->mode & (GES_PIPELINE_MODE_PREVIEW_AUDIO |
+                GES_PIPELINE_MODE_RENDER | GES_PIPELINE_MODE_SMART_RENDER))) {
+      /* Nothing else consumes that track, make sure it does not block
+       * the video one */
+      chain->fakesink = gst_element_factory_make ("fakesink", NULL);
+      g_object_set (chain->fakesink, "sync", FALSE, "async", FALSE, NULL);
+      gst_bin_add (GST_BIN_CAST (self), chain->fakesink);
+      gst_element_sync_state_with_parent (chain->fakesink);
+
+      tmppad = gst_element_get_request_pad (chain->tee, "src_%u");
+      sinkpad = gst_element_get_static_pad (chain->fakesink, "sink");
+      gst_pad_link_full (tmppad, sinkpad, GST_PAD_LINK_CHECK_NOTHING);
+      gst_object_unref (sinkpad);
+      gst_object_unref (tmppad);
+      sinkpad = NULL;
+    }
+  }
+
   /* If chain wasn't already present, insert it in list */
   if (!get_output_chain_for_track (self, track))
     self->priv->chains = g_list_append (self->priv->chains, chain);
@@ -749,6 +917,20 @@ pad_removed_cb (GstElement * timeline, GstPad * pad, GESPipeline * self)
     gst_object_unref (chain->playsinkpad);
   }
 
+  /* Unlink thumbnailing bin */
+  if (chain->thumbnailpad) {
+    peer = gst_pad_get_peer (chain->thumbnailpad);
+    gst_pad_unlink (peer, chain->thumbnailpad);
+    gst_element_release_request_pad (chain->tee, peer);
+    gst_object_unref (peer);
+    gst_object_unref (chain->thumbnailpad);
+  }
+
+  if (chain->fakesink) {
+    gst_element_set_state (chain->fakesink, GST_STATE_NULL);
+    gst_bin_remove (GST_BIN (self), chain->fakesink);
+  }
+
   if (chain->blocked_pad) {
     GST_DEBUG_OBJECT (chain->blocked_pad, "unblocking pad");
     gst_pad_remove_probe (chain->blocked_pad, chain->probe_id);
@@ -815,6 +997,8 @@ ges_pipeline_set_timeline (GESPipeline * pipeline, GESTimeline * timeline)
     return FALSE;
   }
   pipeline->priv->timeline = timeline;
+  timeline_set_rendering (timeline, ! !(pipeline->priv->mode &
+          (GES_PIPELINE_MODE_RENDER | GES_PIPELINE_MODE_SMART_RENDER)));
 
   /* Connect to pipeline */
   g_signal_connect (timeline, "pad-added", (GCallback) pad_added_cb, pipeline);
@@ -918,6 +1102,33 @@ ges_pipeline_set_render_settings (GESPipeline * pipeline,
   return TRUE;
 }
 
+/**
+ * ges_pipeline_get_profiling_report:
+ * @pipeline: a #GESPipeline
+ *
+ * Gets a report of the processing time measured for the clips, effects
+ * and transitions of the timeline since @pipeline last started, with the
+ * #GESPipeline:profiling property set. The clips and the track elements
+ * are ranked by processing time, and the number of buffers they produced
+ * is given. Only the time spent in elements that process an input is
+ * measured, generated sources such as test patterns are not timed.
+ *
+ * The report is meant to be read by humans, its format might change.
+ *
+ * Returns: (transfer full) (allow-none): The report, or %NULL if
+ * @pipeline has not been profiled.
+ */
+gchar *
+ges_pipeline_get_profiling_report (GESPipeline * pipeline)
+{
+  g_return_val_if_fail (GES_IS_PIPELINE (pipeline), NULL);
+
+  if (pipeline->priv->profiler == NULL)
+    return NULL;
+
+  return ges_render_profiler_get_report (pipeline->priv->profiler);
+}
+
 /**
  * ges_pipeline_get_mode:
  * @pipeline: a #GESPipeline
@@ -998,6 +1209,12 @@ ges_pipeline_set_mode (GESPipeline * pipeline, GESPipelineFlags mode)
     gst_bin_remove_many (GST_BIN_CAST (pipeline),
         pipeline->priv->encodebin, pipeline->priv->urisink, NULL);
   }
+  if (pipeline->priv->mode & GES_PIPELINE_MODE_THUMBNAIL &&
+      !(mode & GES_PIPELINE_MODE_THUMBNAIL)) {
+    GST_DEBUG ("Disabling thumbnailing bin");
+    gst_object_ref (pipeline->priv->thumbnailbin);
+    gst_bin_remove (GST_BIN_CAST (pipeline), pipeline->priv->thumbnailbin);
+  }
 
   /* Add new elements */
   if (!(pipeline->priv->mode & GES_PIPELINE_MODE_PREVIEW) &&
@@ -1034,6 +1251,15 @@ ges_pipeline_set_mode (GESPipeline * pipeline, GESPipelineFlags mode)
     gst_element_link_pads_full (pipeline->priv->encodebin, "src",
         pipeline->priv->urisink, "sink", GST_PAD_LINK_CHECK_NOTHING);
   }
+  if (!(pipeline->priv->mode & GES_PIPELINE_MODE_THUMBNAIL) &&
+      (mode & GES_PIPELINE_MODE_THUMBNAIL)) {
+    GST_DEBUG ("Adding thumbnailing bin");
+
+    if (!gst_bin_add (GST_BIN_CAST (pipeline), pipeline->priv->thumbnailbin)) {
+      GST_ERROR_OBJECT (pipeline, "Couldn't add thumbnailing bin");
+      return FALSE;
+    }
+  }
 
   /* FIXUPS */
   /* FIXME
@@ -1042,6 +1268,11 @@ ges_pipeline_set_mode (GESPipeline * pipeline, GESPipelineFlags mode)
 
   pipeline->priv->mode = mode;
 
+  /* Never render from proxies */
+  if (pipeline->priv->timeline)
+    timeline_set_rendering (pipeline->priv->timeline,
+        ! !(mode & (GES_PIPELINE_MODE_RENDER | GES_PIPELINE_MODE_SMART_RENDER)));
+
   return TRUE;
 }
 
@@ -1174,6 +1405,322 @@ ges_pipeline_get_thumbnail_rgb24 (GESPipeline * self, gint width, gint height)
   return ret;
 }
 
+static gint
+_compare_clock_times (gconstpointer a, gconstpointer b, gpointer udata)
+{
+  GstClockTime ta = *((GstClockTime *) a), tb = *((GstClockTime *) b);
+
+  if (ta < tb)
+    return -1;
+  if (ta > tb)
+    return 1;
+
+  return 0;
+}
+
+/* Position of the sample in the timeline, taking the segment it was
+ * outputted in into account */
+static GstClockTime
+_sample_get_stream_time (GstSample * sample)
+{
+  GstBuffer *buf = gst_sample_get_buffer (sample);
+  GstSegment *segment = gst_sample_get_segment (sample);
+
+  if (segment && GST_BUFFER_PTS_IS_VALID (buf))
+    return gst_segment_to_stream_time (segment, GST_FORMAT_TIME,
+        GST_BUFFER_PTS (buf));
+
+  return GST_BUFFER_PTS (buf);
+}
+
+/* Whether @sample is the frame to be displayed at @timestamp, or a
+ * following one */
+static gboolean
+_sample_reaches (GstSample * sample, GstClockTime timestamp)
+{
+  GstBuffer *buf = gst_sample_get_buffer (sample);
+  GstClockTime position = _sample_get_stream_time (sample);
+
+  if (!GST_CLOCK_TIME_IS_VALID (position))
+    return TRUE;
+
+  if (GST_BUFFER_DURATION_IS_VALID (buf))
+    return timestamp < position + GST_BUFFER_DURATION (buf);
+
+  return position >= timestamp;
+}
+
+static GstFlowReturn
+_thumbnail_new_sample_cb (GstElement * appsink, GESPipeline * self)
+{
+  g_mutex_lock (&self->priv->thumbnail_lock);
+  self->priv->n_queued_thumbnails++;
+  g_cond_broadcast (&self->priv->thumbnail_cond);
+  g_mutex_unlock (&self->priv->thumbnail_lock);
+
+  return GST_FLOW_OK;
+}
+
+static GstPadProbeReturn
+_thumbnail_event_probe (GstPad * pad, GstPadProbeInfo * info,
+    GESPipeline * self)
+{
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+  g_mutex_lock (&self->priv->thumbnail_lock);
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_STOP:
+      /* appsink drops the samples it queued */
+      self->priv->n_queued_thumbnails = 0;
+      self->priv->thumbnail_eos = FALSE;
+      break;
+    case GST_EVENT_EOS:
+      self->priv->thumbnail_eos = TRUE;
+      g_cond_broadcast (&self->priv->thumbnail_cond);
+      break;
+    default:
+      break;
+  }
+  g_mutex_unlock (&self->priv->thumbnail_lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Pulls the next frame out of @appsink like its "try-pull-sample" action
+ * signal would (which is not available in the GStreamer version we depend
+ * on), also giving up as soon as an error is posted in the pipeline.
+ *
+ * Returns %NULL without setting @error when the stream is over */
+static GstSample *
+_pull_thumbnail (GESPipeline * self, GstElement * appsink, GError ** error)
+{
+  GstSample *sample = NULL;
+  GESPipelinePrivate *priv = self->priv;
+  gint64 end_time = g_get_monotonic_time () +
+      THUMBNAIL_FRAME_TIMEOUT / GST_USECOND;
+
+  g_mutex_lock (&priv->thumbnail_lock);
+  while (priv->n_queued_thumbnails == 0 && !priv->thumbnail_eos &&
+      priv->thumbnail_error == NULL) {
+    if (!g_cond_wait_until (&priv->thumbnail_cond, &priv->thumbnail_lock,
+            end_time))
+      break;
+  }
+
+  if (priv->thumbnail_error) {
+    g_propagate_error (error, g_error_copy (priv->thumbnail_error));
+    g_mutex_unlock (&priv->thumbnail_lock);
+
+    return NULL;
+  }
+
+  if (priv->n_queued_thumbnails == 0) {
+    if (!priv->thumbnail_eos) {
+      GST_ERROR_OBJECT (self, "Timed out waiting for a frame");
+      g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+          "Timed out waiting for a frame");
+    }
+    g_mutex_unlock (&priv->thumbnail_lock);
+
+    return NULL;
+  }
+
+  priv->n_queued_thumbnails--;
+  g_mutex_unlock (&priv->thumbnail_lock);
+
+  /* Only our own seeks flush appsink, so this does not block */
+  g_signal_emit_by_name (appsink, "pull-sample", &sample);
+
+  return sample;
+}
+
+/**
+ * ges_pipeline_get_thumbnails:
+ * @self: a #GESPipeline in #GES_PIPELINE_MODE_THUMBNAIL mode
+ * @timestamps: (array length=n_timestamps): the timeline positions to get
+ * thumbnails for
+ * @n_timestamps: the number of elements in @timestamps
+ * @width: the requested width or -1 for native size
+ * @height: the requested height or -1 for native size
+ * @func: (scope call): the function to call with each thumbnail
+ * @user_data: data to pass to @func
+ * @error: (out) (allow-none) (transfer full): An error to be set in case
+ * something wrong happens or %NULL
+ *
+ * Gets the frames displayed at @timestamps as 24-bit RGB samples, and passes
+ * them to @func, in increasing timestamp order.
+ *
+ * The frames are decoded in a dedicated branch of the pipeline which
+ * does not sync on the clock, so @self should only be in
+ * #GES_PIPELINE_MODE_THUMBNAIL mode for this to be as fast as possible.
+ * Timestamps close to each other are reached by decoding forward rather
+ * than by seeking, so that a full filmstrip only costs a handful of
+ * accurate seeks.
+ *
+ * The pipeline is left in %GST_STATE_PAUSED when the method returns. If it
+ * does not manage to preroll in a reasonable time, @error is set and no
+ * thumbnail is produced. If an error is posted on the pipeline, or no frame
+ * is decoded in a reasonable time, thumbnailing stops and @error is set.
+ *
+ * Returns: %TRUE if the thumbnailing could be run to the end, else %FALSE.
+ */
+gboolean
+ges_pipeline_get_thumbnails (GESPipeline * self,
+    const GstClockTime * timestamps, guint n_timestamps, gint width,
+    gint height, GESPipelineThumbnailFunc func, gpointer user_data,
+    GError ** error)
+{
+  guint i;
+  GstCaps *caps;
+  GstStateChangeReturn ret;
+  GstClockTime *sorted;
+  GstElement *capsfilter, *appsink;
+  GstSample *sample = NULL;
+  gboolean playing = FALSE, res = TRUE;
+  GstClockTime position = GST_CLOCK_TIME_NONE;
+  GstPad *sinkpad;
+  gulong sample_handler, probe_id;
+  GError *err = NULL;
+
+  g_return_val_if_fail (GES_IS_PIPELINE (self), FALSE);
+  g_return_val_if_fail (timestamps != NULL || n_timestamps == 0, FALSE);
+  g_return_val_if_fail (func, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  if (!(self->priv->mode & GES_PIPELINE_MODE_THUMBNAIL)) {
+    GST_WARNING_OBJECT (self, "Thumbnails can only be gotten in "
+        "GES_PIPELINE_MODE_THUMBNAIL mode");
+    g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_NEGOTIATION,
+        "The pipeline is not in thumbnailing mode");
+    return FALSE;
+  }
+
+  if (n_timestamps == 0)
+    return TRUE;
+
+  caps = gst_caps_new_simple ("video/x-raw", "format", G_TYPE_STRING,
+      "RGB", "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1, NULL);
+
+  if (width != -1)
+    gst_caps_set_simple (caps, "width", G_TYPE_INT, (gint) width, NULL);
+
+  if (height != -1)
+    gst_caps_set_simple (caps, "height", G_TYPE_INT, (gint) height, NULL);
+
+  capsfilter = gst_bin_get_by_name (GST_BIN (self->priv->thumbnailbin),
+      "thumbnailcaps");
+  appsink = gst_bin_get_by_name (GST_BIN (self->priv->thumbnailbin),
+      "thumbnailsink");
+  g_object_set (capsfilter, "caps", caps, NULL);
+  gst_object_unref (capsfilter);
+  gst_caps_unref (caps);
+
+  sorted = g_memdup (timestamps, n_timestamps * sizeof (GstClockTime));
+  g_qsort_with_data (sorted, n_timestamps, sizeof (GstClockTime),
+      _compare_clock_times, NULL);
+
+  ret = gst_element_set_state (GST_ELEMENT (self), GST_STATE_PAUSED);
+  if (ret != GST_STATE_CHANGE_FAILURE)
+    ret = gst_element_get_state (GST_ELEMENT (self), NULL, NULL,
+        THUMBNAIL_PREROLL_TIMEOUT);
+
+  if (ret == GST_STATE_CHANGE_FAILURE || ret == GST_STATE_CHANGE_ASYNC) {
+    GST_ERROR_OBJECT (self, "Could not preroll the pipeline");
+    g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_STATE_CHANGE,
+        ret == GST_STATE_CHANGE_ASYNC ? "Timed out prerolling the pipeline" :
+        "Could not preroll the pipeline");
+    gst_object_unref (appsink);
+    g_free (sorted);
+
+    return FALSE;
+  }
+
+  g_mutex_lock (&self->priv->thumbnail_lock);
+  self->priv->thumbnailing = TRUE;
+  self->priv->n_queued_thumbnails = 0;
+  self->priv->thumbnail_eos = FALSE;
+  g_mutex_unlock (&self->priv->thumbnail_lock);
+
+  sample_handler = g_signal_connect (appsink, "new-sample",
+      G_CALLBACK (_thumbnail_new_sample_cb), self);
+  sinkpad = gst_element_get_static_pad (appsink, "sink");
+  probe_id = gst_pad_add_probe (sinkpad,
+      GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM | GST_PAD_PROBE_TYPE_EVENT_FLUSH,
+      (GstPadProbeCallback) _thumbnail_event_probe, self, NULL);
+
+  for (i = 0; i < n_timestamps; i++) {
+    GstClockTime timestamp = sorted[i];
+
+    if (sample == NULL || (!_sample_reaches (sample, timestamp) &&
+            (!GST_CLOCK_TIME_IS_VALID (position) ||
+                timestamp - position > THUMBNAIL_MAX_FORWARD_DECODE))) {
+      GST_DEBUG_OBJECT (self, "Seeking to %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (timestamp));
+
+      if (sample) {
+        gst_sample_unref (sample);
+        sample = NULL;
+      }
+
+      if (!gst_element_seek (GST_ELEMENT (self), 1.0, GST_FORMAT_TIME,
+              GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE, GST_SEEK_TYPE_SET,
+              timestamp, GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE)) {
+        GST_WARNING_OBJECT (self, "Could not seek to %" GST_TIME_FORMAT,
+            GST_TIME_ARGS (timestamp));
+        continue;
+      }
+
+      if (!playing) {
+        gst_element_set_state (GST_ELEMENT (self), GST_STATE_PLAYING);
+        playing = TRUE;
+      }
+    }
+
+    while (sample == NULL || !_sample_reaches (sample, timestamp)) {
+      if (sample)
+        gst_sample_unref (sample);
+
+      sample = _pull_thumbnail (self, appsink, &err);
+      if (sample == NULL)
+        break;
+
+      position = _sample_get_stream_time (sample);
+    }
+
+    if (err) {
+      g_propagate_error (error, err);
+      res = FALSE;
+      break;
+    }
+
+    if (sample == NULL) {
+      GST_INFO_OBJECT (self, "No frame at %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (timestamp));
+      continue;
+    }
+
+    if (!func (self, timestamp, sample, user_data))
+      break;
+  }
+
+  if (sample)
+    gst_sample_unref (sample);
+  gst_element_set_state (GST_ELEMENT (self), GST_STATE_PAUSED);
+
+  gst_pad_remove_probe (sinkpad, probe_id);
+  gst_object_unref (sinkpad);
+  g_signal_handler_disconnect (appsink, sample_handler);
+  gst_object_unref (appsink);
+  g_free (sorted);
+
+  g_mutex_lock (&self->priv->thumbnail_lock);
+  self->priv->thumbnailing = FALSE;
+  g_clear_error (&self->priv->thumbnail_error);
+  g_mutex_unlock (&self->priv->thumbnail_lock);
+
+  return res;
+}
+
 /**
  * ges_pipeline_preview_get_video_sink:
  * @self: a #GESPipeline
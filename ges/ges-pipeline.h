@@ -46,6 +46,23 @@ G_BEGIN_DECLS
 
 typedef struct _GESPipelinePrivate GESPipelinePrivate;
 
+/**
+ * GESPipelineThumbnailFunc:
+ * @pipeline: the #GESPipeline the thumbnail has been taken from
+ * @timestamp: the requested timestamp
+ * @sample: (transfer none): the frame displayed at @timestamp
+ * @user_data: the data passed to ges_pipeline_get_thumbnails()
+ *
+ * A function called for each thumbnail produced by
+ * ges_pipeline_get_thumbnails().
+ *
+ * Returns: %FALSE to stop producing thumbnails, %TRUE otherwise
+ */
+typedef gboolean (*GESPipelineThumbnailFunc) (GESPipeline *pipeline,
+                                              GstClockTime timestamp,
+                                              GstSample *sample,
+                                              gpointer user_data);
+
 /**
  * GESPipeline:
  *
@@ -90,6 +107,8 @@ gboolean ges_pipeline_set_mode (GESPipeline *pipeline,
 
 GESPipelineFlags ges_pipeline_get_mode (GESPipeline *pipeline);
 
+gchar * ges_pipeline_get_profiling_report (GESPipeline *pipeline);
+
 GstSample *
 ges_pipeline_get_thumbnail(GESPipeline *self, GstCaps *caps);
 
@@ -97,6 +116,12 @@ GstSample *
 ges_pipeline_get_thumbnail_rgb24(GESPipeline *self,
     gint width, gint height);
 
+gboolean
+ges_pipeline_get_thumbnails(GESPipeline *self,
+    const GstClockTime *timestamps, guint n_timestamps,
+    gint width, gint height, GESPipelineThumbnailFunc func,
+    gpointer user_data, GError **error);
+
 gboolean
 ges_pipeline_save_thumbnail(GESPipeline *self,
     int width, int height, const gchar *format, const gchar *location,
@@ -64,6 +64,11 @@ struct _GESProjectPrivate
   gchar *uri;
 
   GList *encoding_profiles;
+
+  gboolean use_proxies;
+
+  /* Indexes on the metas of the assets, created on demand */
+  GESMetaIndex *meta_index;
 };
 
 typedef struct EmitLoadedInIdle
@@ -90,11 +95,27 @@ enum
 {
   PROP_0,
   PROP_URI,
+  PROP_USE_PROXIES,
   PROP_LAST,
 };
 
 static GParamSpec *_properties[LAST_SIGNAL] = { 0 };
 
+static void
+_apply_use_proxies (GESProject * project, GESAsset * asset)
+{
+  GESUriClipAsset *uriasset;
+
+  if (!GES_IS_URI_CLIP_ASSET (asset))
+    return;
+
+  uriasset = GES_URI_CLIP_ASSET (asset);
+  if (project->priv->use_proxies && ges_uri_clip_asset_needs_proxy (uriasset))
+    ges_uri_clip_asset_create_proxy (uriasset);
+
+  g_object_set (asset, "use-proxy", project->priv->use_proxies, NULL);
+}
+
 static gboolean
 _emit_loaded_in_idle (EmitLoadedInIdle * data)
 {
@@ -251,8 +272,14 @@ _dispose (GObject * object)
   GList *tmp;
   GESProjectPrivate *priv = GES_PROJECT (object)->priv;
 
-  if (priv->assets)
+  if (priv->meta_index) {
+    ges_meta_index_free (priv->meta_index);
+    priv->meta_index = NULL;
+  }
+  if (priv->assets) {
     g_hash_table_unref (priv->assets);
+    priv->assets = NULL;
+  }
   if (priv->loading_assets)
     g_hash_table_unref (priv->loading_assets);
   if (priv->loaded_with_error)
@@ -287,6 +314,9 @@ _get_property (GESProject * project, guint property_id,
     case PROP_URI:
       g_value_set_string (value, priv->uri);
       break;
+    case PROP_USE_PROXIES:
+      g_value_set_boolean (value, priv->use_proxies);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (project, property_id, pspec);
   }
@@ -300,6 +330,17 @@ _set_property (GESProject * project, guint property_id,
     case PROP_URI:
       project->priv->uri = g_value_dup_string (value);
       break;
+    case PROP_USE_PROXIES:
+    {
+      GHashTableIter iter;
+      gpointer asset;
+
+      project->priv->use_proxies = g_value_get_boolean (value);
+      g_hash_table_iter_init (&iter, project->priv->assets);
+      while (g_hash_table_iter_next (&iter, NULL, &asset))
+        _apply_use_proxies (project, asset);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (project, property_id, pspec);
   }
@@ -327,6 +368,21 @@ ges_project_class_init (GESProjectClass * klass)
   _properties[PROP_URI] = g_param_spec_string ("uri", "URI",
       "uri of the project", NULL, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
+  /**
+   * GESProject::use-proxies:
+   *
+   * Whether the #GESUriClipAsset-s of the project should be decoded from
+   * their low resolution proxy. When set, proxies are created in the
+   * background for the media that are expensive to decode or to seek in
+   * (bigger than 1080p, or not intra-frame only), and clips switch to them
+   * once they are available.
+   * Proxies are never used when the timeline is rendered by a
+   * #GESPipeline.
+   */
+  _properties[PROP_USE_PROXIES] = g_param_spec_boolean ("use-proxies",
+      "Use proxies", "Whether to decode the media from their proxy", FALSE,
+      G_PARAM_READWRITE);
+
   g_object_class_install_properties (object_class, PROP_LAST, _properties);
 
   /**
@@ -618,6 +674,11 @@ ges_project_add_asset (GESProject * project, GESAsset * asset)
       g_strdup (ges_asset_get_id (asset)), gst_object_ref (asset));
 
   g_hash_table_remove (project->priv->loading_assets, ges_asset_get_id (asset));
+  if (project->priv->use_proxies)
+    _apply_use_proxies (project, asset);
+  if (project->priv->meta_index)
+    ges_meta_index_add_container (project->priv->meta_index,
+        GES_META_CONTAINER (asset));
   GST_DEBUG_OBJECT (project, "Asset added: %s", ges_asset_get_id (asset));
   g_signal_emit (project, _signals[ASSET_ADDED_SIGNAL], 0, asset);
 
@@ -640,6 +701,9 @@ ges_project_remove_asset (GESProject * project, GESAsset * asset)
 
   g_return_val_if_fail (GES_IS_PROJECT (project), FALSE);
 
+  if (project->priv->meta_index)
+    ges_meta_index_remove_container (project->priv->meta_index,
+        GES_META_CONTAINER (asset));
   ret = g_hash_table_remove (project->priv->assets, ges_asset_get_id (asset));
   g_signal_emit (project, _signals[ASSET_REMOVED_SIGNAL], 0, asset);
 
@@ -706,6 +770,111 @@ ges_project_list_assets (GESProject * project, GType filter)
   return ret;
 }
 
+static GESMetaIndex *
+_ensure_meta_index (GESProject * project, const gchar * meta_item)
+{
+  GESProjectPrivate *priv = project->priv;
+
+  if (priv->meta_index == NULL) {
+    GHashTableIter iter;
+    gpointer asset;
+
+    priv->meta_index = ges_meta_index_new ();
+    g_hash_table_iter_init (&iter, priv->assets);
+    while (g_hash_table_iter_next (&iter, NULL, &asset))
+      ges_meta_index_add_container (priv->meta_index, asset);
+  }
+
+  if (ges_meta_index_add_key (priv->meta_index, meta_item))
+    GST_DEBUG_OBJECT (project, "Indexing meta %s", meta_item);
+
+  return priv->meta_index;
+}
+
+static GList *
+_ref_assets (GList * assets)
+{
+  GList *tmp;
+
+  for (tmp = assets; tmp; tmp = tmp->next)
+    gst_object_ref (tmp->data);
+
+  return assets;
+}
+
+/**
+ * ges_project_add_meta_index:
+ * @project: A #GESProject
+ * @meta_item: The name of the meta to index
+ *
+ * Makes @project keep an index of the values of @meta_item on its
+ * assets, so that ges_project_find_assets_by_meta() and
+ * ges_project_find_assets_by_meta_range() do not have to look at every
+ * asset. The index is kept up to date as assets are added, removed and
+ * their metas are set.
+ *
+ * Metas are indexed the first time they are queried anyway, use this
+ * function to build the index before the first query, for example right
+ * after loading the project.
+ */
+void
+ges_project_add_meta_index (GESProject * project, const gchar * meta_item)
+{
+  g_return_if_fail (GES_IS_PROJECT (project));
+  g_return_if_fail (meta_item != NULL);
+
+  _ensure_meta_index (project, meta_item);
+}
+
+/**
+ * ges_project_find_assets_by_meta:
+ * @project: A #GESProject
+ * @meta_item: The name of the meta to look for
+ * @value: The value @meta_item has to be set to
+ *
+ * Lists the assets of @project whose @meta_item is set to @value. Metas
+ * of a different type than @value never match.
+ *
+ * Returns: (transfer full) (element-type GESAsset): The list of the
+ * matching #GESAsset-s, in no particular order
+ */
+GList *
+ges_project_find_assets_by_meta (GESProject * project,
+    const gchar * meta_item, const GValue * value)
+{
+  g_return_val_if_fail (GES_IS_PROJECT (project), NULL);
+  g_return_val_if_fail (meta_item != NULL, NULL);
+  g_return_val_if_fail (G_IS_VALUE (value), NULL);
+
+  return _ref_assets (ges_meta_index_find (_ensure_meta_index (project,
+              meta_item), meta_item, value));
+}
+
+/**
+ * ges_project_find_assets_by_meta_range:
+ * @project: A #GESProject
+ * @meta_item: The name of the meta to look for
+ * @min: (allow-none): The smallest value of @meta_item, or %NULL
+ * @max: (allow-none): The biggest value of @meta_item, or %NULL
+ *
+ * Lists the assets of @project whose @meta_item is a number between
+ * @min and @max included. Numbers of all the integer and floating point
+ * types are compared by value, with the precision of a #gdouble.
+ *
+ * Returns: (transfer full) (element-type GESAsset): The list of the
+ * matching #GESAsset-s, sorted by the value of @meta_item
+ */
+GList *
+ges_project_find_assets_by_meta_range (GESProject * project,
+    const gchar * meta_item, const GValue * min, const GValue * max)
+{
+  g_return_val_if_fail (GES_IS_PROJECT (project), NULL);
+  g_return_val_if_fail (meta_item != NULL, NULL);
+
+  return _ref_assets (ges_meta_index_find_range (_ensure_meta_index (project,
+              meta_item), meta_item, min, max));
+}
+
 /**
  * ges_project_save:
  * @project: A #GESProject to save
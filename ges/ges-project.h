@@ -98,6 +98,16 @@ gboolean ges_project_create_asset  (GESProject * project,
 
 GList * ges_project_get_loading_assets          (GESProject * project);
 
+void ges_project_add_meta_index                 (GESProject * project,
+                                                 const gchar * meta_item);
+GList * ges_project_find_assets_by_meta         (GESProject * project,
+                                                 const gchar * meta_item,
+                                                 const GValue * value);
+GList * ges_project_find_assets_by_meta_range   (GESProject * project,
+                                                 const gchar * meta_item,
+                                                 const GValue * min,
+                                                 const GValue * max);
+
 gboolean ges_project_add_encoding_profile       (GESProject *project,
                                                  GstEncodingProfile *profile);
 const GList *ges_project_list_encoding_profiles (GESProject *project);
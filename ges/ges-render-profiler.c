@@ -0,0 +1,527 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The render profiler attributes the time spent processing buffers, and
+ * the number of buffers produced, to the GESTrackElement-s of a timeline.
+ *
+ * Pad probes are set on the pads of all the elements inside the
+ * GstElement of each track element, including the ones added later on, as
+ * decodebin does. The time between a buffer entering an element through
+ * one of its sink pads and the next buffer leaving it through one of its
+ * source pads, in the same thread, is the time the element took to process
+ * it. Once an element pushed a buffer, the time until its next input is
+ * spent downstream and is not counted. As a consequence, elements without
+ * sink pads, such as test sources, are not timed, only their buffers are
+ * counted. Buffers are counted on the source pads of the track element's
+ * GstElement.
+ *
+ * The probes are given the structure they update and only take its own
+ * lock, so that streaming threads never contend on the profiler lock nor
+ * look anything up while buffers flow.
+ */
+
+#include "ges.h"
+#include "ges-internal.h"
+
+/* The cost of a track element, or of a clip in reports */
+typedef struct
+{
+  GESTimelineElement *element;
+
+  /* Protects time and buffers */
+  GMutex lock;
+  GstClockTime time;
+  guint64 buffers;
+} ElementCost;
+
+/* One per profiled GstElement */
+typedef struct
+{
+  ElementCost *cost;
+
+  /* Protects thread and entry */
+  GMutex lock;
+  GThread *thread;
+  gint64 entry;
+} ElementTiming;
+
+typedef struct
+{
+  GstPad *pad;
+  gulong id;
+} Probe;
+
+typedef struct
+{
+  GESRenderProfiler *profiler;
+  ElementCost *cost;
+  GObject *object;
+  gulong id;
+
+  /* Whether the buffers leaving the pads of object are counted */
+  gboolean count;
+} Handler;
+
+struct _GESRenderProfiler
+{
+  GMutex lock;
+  GHashTable *costs;            /* GESTrackElement -> ElementCost */
+  GHashTable *timings;          /* GstElement -> ElementTiming */
+  GList *probes;                /* Probe */
+  GList *handlers;              /* Handler */
+};
+
+static void _profile_element (GESRenderProfiler * profiler, ElementCost * cost,
+    GstElement * element, gboolean count);
+
+static ElementCost *
+_new_cost (gpointer element)
+{
+  ElementCost *cost = g_slice_new0 (ElementCost);
+
+  cost->element = gst_object_ref (element);
+  g_mutex_init (&cost->lock);
+
+  return cost;
+}
+
+static void
+_free_cost (ElementCost * cost)
+{
+  g_mutex_clear (&cost->lock);
+  gst_object_unref (cost->element);
+  g_slice_free (ElementCost, cost);
+}
+
+static void
+_free_timing (ElementTiming * timing)
+{
+  g_mutex_clear (&timing->lock);
+  g_slice_free (ElementTiming, timing);
+}
+
+static guint
+_count_buffers (GstPadProbeInfo * info)
+{
+  if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    return gst_buffer_list_length (GST_PAD_PROBE_INFO_BUFFER_LIST (info));
+
+  return 1;
+}
+
+static GstPadProbeReturn
+_sink_probe_cb (GstPad * pad, GstPadProbeInfo * info, ElementTiming * timing)
+{
+  gint64 now = g_get_monotonic_time ();
+
+  g_mutex_lock (&timing->lock);
+  timing->thread = g_thread_self ();
+  timing->entry = now;
+  g_mutex_unlock (&timing->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+_src_probe_cb (GstPad * pad, GstPadProbeInfo * info, ElementTiming * timing)
+{
+  gint64 elapsed = 0;
+  gint64 now = g_get_monotonic_time ();
+
+  g_mutex_lock (&timing->lock);
+  if (timing->entry && timing->thread == g_thread_self ()) {
+    elapsed = now - timing->entry;
+    timing->entry = 0;
+  }
+  g_mutex_unlock (&timing->lock);
+
+  if (elapsed) {
+    g_mutex_lock (&timing->cost->lock);
+    timing->cost->time += elapsed * GST_USECOND;
+    g_mutex_unlock (&timing->cost->lock);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+_count_probe_cb (GstPad * pad, GstPadProbeInfo * info, ElementCost * cost)
+{
+  guint n = _count_buffers (info);
+
+  g_mutex_lock (&cost->lock);
+  cost->buffers += n;
+  g_mutex_unlock (&cost->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Called with the lock taken */
+static void
+_add_probe (GESRenderProfiler * profiler, GstPad * pad,
+    GstPadProbeCallback callback, gpointer data)
+{
+  Probe *probe = g_slice_new (Probe);
+
+  probe->pad = gst_object_ref (pad);
+  probe->id = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_BUFFER_LIST, callback, data, NULL);
+  profiler->probes = g_list_prepend (profiler->probes, probe);
+}
+
+/* Called with the lock taken */
+static void
+_profile_pad (Handler * handler, GstPad * pad)
+{
+  ElementTiming *timing;
+  GESRenderProfiler *profiler = handler->profiler;
+  GstElement *element = GST_ELEMENT (handler->object);
+
+  if (handler->count && GST_PAD_IS_SRC (pad))
+    _add_probe (profiler, pad, (GstPadProbeCallback) _count_probe_cb,
+        handler->cost);
+
+  /* The pads of bins are ghost pads, the elements inside are timed */
+  if (GST_IS_BIN (element))
+    return;
+
+  timing = g_hash_table_lookup (profiler->timings, element);
+  if (GST_PAD_IS_SINK (pad))
+    _add_probe (profiler, pad, (GstPadProbeCallback) _sink_probe_cb, timing);
+  else
+    _add_probe (profiler, pad, (GstPadProbeCallback) _src_probe_cb, timing);
+}
+
+static void
+_pad_added_cb (GstElement * element, GstPad * pad, Handler * handler)
+{
+  g_mutex_lock (&handler->profiler->lock);
+  _profile_pad (handler, pad);
+  g_mutex_unlock (&handler->profiler->lock);
+}
+
+static void
+_element_added_cb (GstBin * bin, GstElement * element, Handler * handler)
+{
+  _profile_element (handler->profiler, handler->cost, element, FALSE);
+}
+
+/* Called with the lock taken */
+static Handler *
+_connect (GESRenderProfiler * profiler, ElementCost * cost, gpointer object,
+    const gchar * signal, GCallback callback, gboolean count)
+{
+  Handler *handler = g_slice_new (Handler);
+
+  handler->profiler = profiler;
+  handler->cost = cost;
+  handler->object = gst_object_ref (object);
+  handler->count = count;
+  handler->id = g_signal_connect (object, signal, callback, handler);
+  profiler->handlers = g_list_prepend (profiler->handlers, handler);
+
+  return handler;
+}
+
+static void
+_profile_element (GESRenderProfiler * profiler, ElementCost * cost,
+    GstElement * element, gboolean count)
+{
+  GList *tmp, *children;
+  Handler *handler;
+
+  g_mutex_lock (&profiler->lock);
+  if (g_hash_table_contains (profiler->timings, element)) {
+    g_mutex_unlock (&profiler->lock);
+
+    return;
+  }
+
+  if (!GST_IS_BIN (element)) {
+    ElementTiming *timing = g_slice_new0 (ElementTiming);
+
+    timing->cost = cost;
+    g_mutex_init (&timing->lock);
+    g_hash_table_insert (profiler->timings, element, timing);
+  } else {
+    g_hash_table_insert (profiler->timings, element, NULL);
+  }
+
+  handler = _connect (profiler, cost, element, "pad-added",
+      G_CALLBACK (_pad_added_cb), count);
+
+  GST_OBJECT_LOCK (element);
+  for (tmp = element->pads; tmp; tmp = tmp->next)
+    _profile_pad (handler, tmp->data);
+  GST_OBJECT_UNLOCK (element);
+
+  if (!GST_IS_BIN (element)) {
+    g_mutex_unlock (&profiler->lock);
+
+    return;
+  }
+
+  _connect (profiler, cost, element, "element-added",
+      G_CALLBACK (_element_added_cb), FALSE);
+  g_mutex_unlock (&profiler->lock);
+
+  /* Children are profiled without the locks taken, elements added
+   * meanwhile might be seen twice but are only profiled once */
+  GST_OBJECT_LOCK (element);
+  children = g_list_copy_deep (GST_BIN_CHILDREN (element),
+      (GCopyFunc) gst_object_ref, NULL);
+  GST_OBJECT_UNLOCK (element);
+
+  for (tmp = children; tmp; tmp = tmp->next)
+    _profile_element (profiler, cost, tmp->data, FALSE);
+  g_list_free_full (children, gst_object_unref);
+}
+
+static void
+_profile_track_element (GESRenderProfiler * profiler,
+    GESTrackElement * track_element)
+{
+  ElementCost *cost;
+  GstElement *element = ges_track_element_get_element (track_element);
+
+  if (element == NULL)
+    return;
+
+  g_mutex_lock (&profiler->lock);
+  cost = g_hash_table_lookup (profiler->costs, track_element);
+  if (cost == NULL) {
+    cost = _new_cost (track_element);
+    g_hash_table_insert (profiler->costs, track_element, cost);
+  }
+  g_mutex_unlock (&profiler->lock);
+
+  _profile_element (profiler, cost, element, TRUE);
+}
+
+static void
+_track_element_added_cb (GESTrack * track, GESTrackElement * track_element,
+    Handler * handler)
+{
+  _profile_track_element (handler->profiler, track_element);
+}
+
+GESRenderProfiler *
+ges_render_profiler_new (void)
+{
+  GESRenderProfiler *profiler = g_slice_new0 (GESRenderProfiler);
+
+  g_mutex_init (&profiler->lock);
+  profiler->costs = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) _free_cost);
+  profiler->timings = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) _free_timing);
+
+  return profiler;
+}
+
+/* Starts profiling the track elements of @timeline, including the ones
+ * added to its tracks later on */
+void
+ges_render_profiler_start (GESRenderProfiler * profiler,
+    GESTimeline * timeline)
+{
+  GList *tracks, *track, *elements, *tmp;
+
+  tracks = ges_timeline_get_tracks (timeline);
+  for (track = tracks; track; track = track->next) {
+    g_mutex_lock (&profiler->lock);
+    _connect (profiler, NULL, track->data, "track-element-added",
+        G_CALLBACK (_track_element_added_cb), FALSE);
+    g_mutex_unlock (&profiler->lock);
+
+    elements = ges_track_get_elements (track->data);
+    for (tmp = elements; tmp; tmp = tmp->next)
+      _profile_track_element (profiler, tmp->data);
+    g_list_free_full (elements, gst_object_unref);
+  }
+  g_list_free_full (tracks, gst_object_unref);
+}
+
+/* Removes all the probes, the costs measured so far are kept */
+void
+ges_render_profiler_stop (GESRenderProfiler * profiler)
+{
+  GList *tmp, *probes, *handlers;
+
+  g_mutex_lock (&profiler->lock);
+  probes = profiler->probes;
+  handlers = profiler->handlers;
+  profiler->probes = NULL;
+  profiler->handlers = NULL;
+  g_mutex_unlock (&profiler->lock);
+
+  for (tmp = handlers; tmp; tmp = tmp->next) {
+    Handler *handler = tmp->data;
+
+    g_signal_handler_disconnect (handler->object, handler->id);
+    gst_object_unref (handler->object);
+    g_slice_free (Handler, handler);
+  }
+  g_list_free (handlers);
+
+  for (tmp = probes; tmp; tmp = tmp->next) {
+    Probe *probe = tmp->data;
+
+    gst_pad_remove_probe (probe->pad, probe->id);
+    gst_object_unref (probe->pad);
+    g_slice_free (Probe, probe);
+  }
+  g_list_free (probes);
+
+  g_mutex_lock (&profiler->lock);
+  g_hash_table_remove_all (profiler->timings);
+  g_mutex_unlock (&profiler->lock);
+}
+
+void
+ges_render_profiler_free (GESRenderProfiler * profiler)
+{
+  ges_render_profiler_stop (profiler);
+
+  g_hash_table_unref (profiler->timings);
+  g_hash_table_unref (profiler->costs);
+  g_mutex_clear (&profiler->lock);
+  g_slice_free (GESRenderProfiler, profiler);
+}
+
+static const gchar *
+_get_kind (GESTimelineElement * element)
+{
+  if (GES_IS_TRANSITION (element))
+    return "transition";
+  else if (GES_IS_BASE_EFFECT (element))
+    return "effect";
+  else if (GES_IS_SOURCE (element))
+    return "source";
+
+  return "operation";
+}
+
+static gint
+_compare_costs (ElementCost ** a, ElementCost ** b)
+{
+  if ((*a)->time != (*b)->time)
+    return (*a)->time > (*b)->time ? -1 : 1;
+
+  if ((*a)->buffers != (*b)->buffers)
+    return (*a)->buffers > (*b)->buffers ? -1 : 1;
+
+  return 0;
+}
+
+static void
+_append_line (GString * report, guint rank, GstClockTime time,
+    GstClockTime total, guint64 buffers, const gchar * kind,
+    const gchar * name, const gchar * clip)
+{
+  g_string_append_printf (report, "%4u %12.3f %6.1f%% %9" G_GUINT64_FORMAT
+      "  %-10s %s%s%s%s\n", rank, (gdouble) time / GST_MSECOND,
+      total ? 100.0 * time / total : 0.0, buffers, kind, GST_STR_NULL (name),
+      clip ? " (" : "", clip ? clip : "", clip ? ")" : "");
+}
+
+/* Returns a report of the costs measured so far, ranking the clips and the
+ * track elements by processing time */
+gchar *
+ges_render_profiler_get_report (GESRenderProfiler * profiler)
+{
+  guint i;
+  GString *report;
+  GPtrArray *costs, *clips;
+  GHashTable *clip_costs;
+  GHashTableIter iter;
+  gpointer value;
+  GstClockTime total = 0;
+
+  report = g_string_new (NULL);
+  costs = g_ptr_array_new_with_free_func ((GDestroyNotify) _free_cost);
+  clips = g_ptr_array_new_with_free_func ((GDestroyNotify) _free_cost);
+  clip_costs = g_hash_table_new (NULL, NULL);
+
+  g_mutex_lock (&profiler->lock);
+  g_hash_table_iter_init (&iter, profiler->costs);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    ElementCost *clip_cost, *element_cost, *cost = value;
+    GESTimelineElement *clip = GES_TIMELINE_ELEMENT_PARENT (cost->element);
+
+    /* Work on a copy, the probes keep updating the costs */
+    element_cost = _new_cost (cost->element);
+    g_mutex_lock (&cost->lock);
+    element_cost->time = cost->time;
+    element_cost->buffers = cost->buffers;
+    g_mutex_unlock (&cost->lock);
+
+    g_ptr_array_add (costs, element_cost);
+    total += element_cost->time;
+
+    /* Transitions are not part of the clips they go between */
+    if (clip == NULL || GES_IS_TRANSITION_CLIP (clip))
+      continue;
+
+    clip_cost = g_hash_table_lookup (clip_costs, clip);
+    if (clip_cost == NULL) {
+      clip_cost = _new_cost (clip);
+      g_hash_table_insert (clip_costs, clip, clip_cost);
+      g_ptr_array_add (clips, clip_cost);
+    }
+    clip_cost->time += element_cost->time;
+    if (GES_IS_SOURCE (element_cost->element))
+      clip_cost->buffers += element_cost->buffers;
+  }
+
+  g_ptr_array_sort (costs, (GCompareFunc) _compare_costs);
+  g_ptr_array_sort (clips, (GCompareFunc) _compare_costs);
+
+  g_string_append_printf (report, "Processing time: %.3f ms\n\n",
+      (gdouble) total / GST_MSECOND);
+
+  g_string_append (report, "Clips by processing time:\n"
+      "rank    time (ms)   share   buffers  type       name\n");
+  for (i = 0; i < clips->len; i++) {
+    ElementCost *clip_cost = g_ptr_array_index (clips, i);
+
+    _append_line (report, i + 1, clip_cost->time, total, clip_cost->buffers,
+        "clip", GES_TIMELINE_ELEMENT_NAME (clip_cost->element), NULL);
+  }
+
+  g_string_append (report, "\nTrack elements by processing time:\n"
+      "rank    time (ms)   share   buffers  type       name (clip)\n");
+  for (i = 0; i < costs->len; i++) {
+    ElementCost *element_cost = g_ptr_array_index (costs, i);
+    GESTimelineElement *parent =
+        GES_TIMELINE_ELEMENT_PARENT (element_cost->element);
+
+    _append_line (report, i + 1, element_cost->time, total,
+        element_cost->buffers, _get_kind (element_cost->element),
+        GES_TIMELINE_ELEMENT_NAME (element_cost->element),
+        parent ? GES_TIMELINE_ELEMENT_NAME (parent) : NULL);
+  }
+  g_mutex_unlock (&profiler->lock);
+
+  g_hash_table_unref (clip_costs);
+  g_ptr_array_unref (clips);
+  g_ptr_array_unref (costs);
+
+  return g_string_free (report, FALSE);
+}
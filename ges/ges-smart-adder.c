@@ -22,6 +22,7 @@
 #include "ges-types.h"
 #include "ges-internal.h"
 #include "ges-smart-adder.h"
+#include "gstgainmixer.h"
 
 G_DEFINE_TYPE (GESSmartAdder, ges_smart_adder, GST_TYPE_BIN);
 
@@ -41,23 +42,31 @@ static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink_%u",
     GST_STATIC_CAPS ("audio/x-raw")
     );
 
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
-#define DEFAULT_CAPS "audio/x-raw,format=(string)S32LE;"
-#else
-#define DEFAULT_CAPS "audio/x-raw,format=(string)S32BE;"
-#endif
+#define DEFAULT_CAPS "audio/x-raw,format=(string)" GST_AUDIO_NE (F32) \
+    ",layout=(string)interleaved;"
 
+/* Streams are linked straight to the adder, an audioconvert ! audioresample
+ * bin is only inserted in front of it when a stream comes in a format the
+ * adder can not take, which does not happen for sources as they already
+ * output the mixing format. The CAPS events are checked from a blocking
+ * probe on the ghost pad, so nothing flows through it while it is retargeted
+ * to the converters */
 typedef struct _PadInfos
 {
   GESSmartAdder *self;
+  GstPad *ghost;
   GstPad *adder_pad;
   GstElement *bin;
+  gulong probe_id;
 } PadInfos;
 
 static void
 destroy_pad (PadInfos * infos)
 {
-  if (G_LIKELY (infos->bin)) {
+  if (infos->probe_id)
+    gst_pad_remove_probe (infos->ghost, infos->probe_id);
+
+  if (infos->bin) {
     gst_element_set_state (infos->bin, GST_STATE_NULL);
     gst_element_unlink (infos->bin, infos->self->adder);
     gst_bin_remove (GST_BIN (infos->self), infos->bin);
@@ -70,6 +79,122 @@ destroy_pad (PadInfos * infos)
   g_slice_free (PadInfos, infos);
 }
 
+/* Called from the blocking probe of the ghost pad */
+static gboolean
+_insert_converters (PadInfos * infos)
+{
+  GstElement *audioconvert, *audioresample;
+  GstPad *audioconvert_sinkpad, *audioresample_srcpad;
+  GESSmartAdder *self = infos->self;
+
+  infos->bin = gst_bin_new (NULL);
+  audioconvert = gst_element_factory_make ("audioconvert", NULL);
+  audioresample = gst_element_factory_make ("audioresample", NULL);
+
+  gst_bin_add_many (GST_BIN (infos->bin), audioconvert, audioresample, NULL);
+  gst_element_link_many (audioconvert, audioresample, NULL);
+
+  audioconvert_sinkpad = gst_element_get_static_pad (audioconvert, "sink");
+  gst_element_add_pad (infos->bin, gst_ghost_pad_new ("sink",
+          audioconvert_sinkpad));
+  gst_object_unref (audioconvert_sinkpad);
+
+  audioresample_srcpad = gst_element_get_static_pad (audioresample, "src");
+  gst_element_add_pad (infos->bin, gst_ghost_pad_new ("src",
+          audioresample_srcpad));
+  gst_object_unref (audioresample_srcpad);
+
+  gst_bin_add (GST_BIN (self), infos->bin);
+  gst_element_sync_state_with_parent (infos->bin);
+
+  /* Retargetting unlinks the ghost pad from the adder pad */
+  audioconvert_sinkpad = gst_element_get_static_pad (infos->bin, "sink");
+  gst_ghost_pad_set_target (GST_GHOST_PAD (infos->ghost), audioconvert_sinkpad);
+  gst_object_unref (audioconvert_sinkpad);
+
+  return gst_element_link_pads (infos->bin, "src", self->adder,
+      GST_OBJECT_NAME (infos->adder_pad));
+}
+
+static GstPadProbeReturn
+_caps_probe_cb (GstPad * pad, GstPadProbeInfo * info, PadInfos * infos)
+{
+  GstCaps *caps;
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+  GESSmartAdder *self = infos->self;
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_CAPS)
+    return GST_PAD_PROBE_PASS;
+
+  gst_event_parse_caps (event, &caps);
+  if (gst_pad_query_accept_caps (infos->adder_pad, caps))
+    return GST_PAD_PROBE_PASS;
+
+  GST_INFO_OBJECT (self, "%" GST_PTR_FORMAT " is not in the mixing format, "
+      "converting it", caps);
+
+  if (!_insert_converters (infos))
+    GST_ERROR_OBJECT (self, "Could not link converters to the adder");
+
+  /* The converters take any format from now on */
+  infos->probe_id = 0;
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
+/* While linked straight to the adder, let upstream know that we can convert
+ * any format, preferring the mixing format */
+static gboolean
+_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  PadInfos *infos;
+  GESSmartAdder *self = GES_SMART_ADDER (parent);
+
+  LOCK (self);
+  infos = g_hash_table_lookup (self->pads_infos, pad);
+  UNLOCK (self);
+
+  if (infos == NULL || infos->bin)
+    return gst_pad_query_default (pad, parent, query);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    {
+      GstCaps *filter, *caps, *tmp;
+
+      gst_query_parse_caps (query, &filter);
+      caps = gst_pad_query_caps (infos->adder_pad, NULL);
+      caps = gst_caps_merge (caps, gst_static_pad_template_get_caps
+          (&sink_template));
+
+      if (filter) {
+        tmp = gst_caps_intersect_full (filter, caps, GST_CAPS_INTERSECT_FIRST);
+        gst_caps_unref (caps);
+        caps = tmp;
+      }
+
+      gst_query_set_caps_result (query, caps);
+      gst_caps_unref (caps);
+
+      return TRUE;
+    }
+    case GST_QUERY_ACCEPT_CAPS:
+    {
+      GstCaps *caps, *template_caps;
+
+      gst_query_parse_accept_caps (query, &caps);
+      template_caps = gst_static_pad_template_get_caps (&sink_template);
+      gst_query_set_accept_caps_result (query,
+          gst_caps_can_intersect (caps, template_caps));
+      gst_caps_unref (template_caps);
+
+      return TRUE;
+    }
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
 /****************************************************
  *              GstElement vmetods                  *
  ****************************************************/
@@ -77,58 +202,46 @@ static GstPad *
 _request_new_pad (GstElement * element, GstPadTemplate * templ,
     const gchar * name, const GstCaps * caps)
 {
-  GstPad *audioresample_srcpad, *audioconvert_sinkpad, *tmpghost;
   GstPad *ghost;
-  GstElement *audioconvert, *audioresample;
   PadInfos *infos = g_slice_new0 (PadInfos);
   GESSmartAdder *self = GES_SMART_ADDER (element);
 
-  infos->adder_pad = gst_element_request_pad (self->adder, templ, NULL, caps);
+  infos->adder_pad = gst_element_request_pad (self->adder,
+      gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (self->adder),
+          "sink_%u"), NULL, caps);
   if (infos->adder_pad == NULL) {
     GST_WARNING_OBJECT (element, "Could not get any pad from GstAdder");
+    g_slice_free (PadInfos, infos);
 
     return NULL;
   }
 
   infos->self = self;
 
-  infos->bin = gst_bin_new (NULL);
-  audioconvert = gst_element_factory_make ("audioconvert", NULL);
-  audioresample = gst_element_factory_make ("audioresample", NULL);
-
-  gst_bin_add_many (GST_BIN (infos->bin), audioconvert, audioresample, NULL);
-  gst_element_link_many (audioconvert, audioresample, NULL);
+  ghost = gst_ghost_pad_new_from_template (NULL, infos->adder_pad, templ);
+  gst_pad_set_query_function (ghost, GST_DEBUG_FUNCPTR (_sink_query));
+  infos->ghost = ghost;
+  infos->probe_id = gst_pad_add_probe (ghost,
+      GST_PAD_PROBE_TYPE_BLOCK | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      (GstPadProbeCallback) _caps_probe_cb, infos, NULL);
 
-  audioconvert_sinkpad = gst_element_get_static_pad (audioconvert, "sink");
-  tmpghost = GST_PAD (gst_ghost_pad_new (NULL, audioconvert_sinkpad));
-  gst_object_unref (audioconvert_sinkpad);
-  gst_pad_set_active (tmpghost, TRUE);
-  gst_element_add_pad (GST_ELEMENT (infos->bin), tmpghost);
+  LOCK (self);
+  g_hash_table_insert (self->pads_infos, ghost, infos);
+  UNLOCK (self);
 
-  gst_bin_add (GST_BIN (self), infos->bin);
-  ghost = gst_ghost_pad_new (NULL, tmpghost);
   gst_pad_set_active (ghost, TRUE);
   if (!gst_element_add_pad (GST_ELEMENT (self), ghost))
     goto could_not_add;
 
-  audioresample_srcpad = gst_element_get_static_pad (audioresample, "src");
-  tmpghost = GST_PAD (gst_ghost_pad_new (NULL, audioresample_srcpad));
-  gst_object_unref (audioresample_srcpad);
-  gst_pad_set_active (tmpghost, TRUE);
-  gst_element_add_pad (GST_ELEMENT (infos->bin), tmpghost);
-  gst_pad_link (tmpghost, infos->adder_pad);
-
-  LOCK (self);
-  g_hash_table_insert (self->pads_infos, ghost, infos);
-  UNLOCK (self);
-
   GST_DEBUG_OBJECT (self, "Returning new pad %" GST_PTR_FORMAT, ghost);
   return ghost;
 
 could_not_add:
   {
     GST_ERROR_OBJECT (self, "could not add pad");
-    destroy_pad (infos);
+    LOCK (self);
+    g_hash_table_remove (self->pads_infos, ghost);
+    UNLOCK (self);
     return NULL;
   }
 }
@@ -152,6 +265,7 @@ ges_smart_adder_finalize (GObject * object)
   GESSmartAdder *self = GES_SMART_ADDER (object);
 
   g_mutex_clear (&self->lock);
+  gst_caps_replace (&self->caps, NULL);
 
   G_OBJECT_CLASS (ges_smart_adder_parent_class)->finalize (object);
 }
@@ -184,13 +298,20 @@ static void
 ges_smart_adder_init (GESSmartAdder * self)
 {
   GstPad *pad;
+  GstElement *capsfilter;
 
   g_mutex_init (&self->lock);
 
-  self->adder = gst_element_factory_make ("adder", "smart-adder-adder");
-  gst_bin_add (GST_BIN (self), self->adder);
+  /* The gain mixer sums all the streams in float in a single pass, the
+   * capsfilter sets the mixing format */
+  self->adder = g_object_new (GST_TYPE_GAIN_MIXER, "name",
+      "smart-adder-adder", NULL);
+  capsfilter = gst_element_factory_make ("capsfilter",
+      "smart-adder-capsfilter");
+  gst_bin_add_many (GST_BIN (self), self->adder, capsfilter, NULL);
+  gst_element_link (self->adder, capsfilter);
 
-  pad = gst_element_get_static_pad (self->adder, "src");
+  pad = gst_element_get_static_pad (capsfilter, "src");
   self->srcpad = gst_ghost_pad_new ("src", pad);
   gst_pad_set_active (self->srcpad, TRUE);
   gst_object_unref (pad);
@@ -201,13 +322,62 @@ ges_smart_adder_init (GESSmartAdder * self)
       NULL, (GDestroyNotify) destroy_pad);
 }
 
+/* The format all the streams of @track are mixed in: the gain mixer
+ * format, with the rate and channels of the track restriction caps when
+ * they are set, so that sources only resample once, to that format */
+GstCaps *
+ges_smart_adder_get_mixing_caps (GESTrack * track)
+{
+  guint i;
+  GstCaps *restriction = NULL, *caps = gst_caps_from_string (DEFAULT_CAPS);
+  const gchar *fields[] = { "rate", "channels", "channel-mask" };
+
+  if (track)
+    g_object_get (track, "restriction-caps", &restriction, NULL);
+
+  if (restriction && !gst_caps_is_any (restriction) &&
+      !gst_caps_is_empty (restriction)) {
+    GstStructure *structure = gst_caps_get_structure (caps, 0);
+    const GstStructure *rstructure = gst_caps_get_structure (restriction, 0);
+
+    for (i = 0; i < G_N_ELEMENTS (fields); i++) {
+      if (gst_structure_has_field (rstructure, fields[i]))
+        gst_structure_set_value (structure, fields[i],
+            gst_structure_get_value (rstructure, fields[i]));
+    }
+  }
+
+  if (restriction)
+    gst_caps_unref (restriction);
+
+  return caps;
+}
+
+static void
+_restriction_caps_cb (GESTrack * track, GParamSpec * arg G_GNUC_UNUSED,
+    GESSmartAdder * self)
+{
+  GstCaps *caps = ges_smart_adder_get_mixing_caps (track);
+  GstElement *capsfilter = gst_bin_get_by_name (GST_BIN (self),
+      "smart-adder-capsfilter");
+
+  GST_DEBUG_OBJECT (self, "Mixing in %" GST_PTR_FORMAT, caps);
+  g_object_set (capsfilter, "caps", caps, NULL);
+  gst_caps_replace (&self->caps, caps);
+  gst_caps_unref (caps);
+  gst_object_unref (capsfilter);
+}
+
 GstElement *
 ges_smart_adder_new (GESTrack * track)
 {
   GESSmartAdder *self = g_object_new (GES_TYPE_SMART_ADDER, NULL);
   self->track = track;
 
-  /* FIXME Make adder smart and let it properly negotiate caps! */
-  g_object_set (self->adder, "caps", gst_caps_from_string (DEFAULT_CAPS), NULL);
+  _restriction_caps_cb (track, NULL, self);
+  if (track)
+    g_signal_connect_object (track, "notify::restriction-caps",
+        G_CALLBACK (_restriction_caps_cb), self, 0);
+
   return GST_ELEMENT (self);
 }
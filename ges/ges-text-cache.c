@@ -0,0 +1,398 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The text cache holds, for the whole process, the text laid out and
+ * rasterized by GESTitleSource and GESTextOverlay, so that instances
+ * showing the same text with the same style share a single raster.
+ *
+ * A raster is an overlay composition with one premultiplied ARGB rectangle
+ * covering the text only, for a given frame size. Rasters are evicted in
+ * least recently used order when they use more than TEXT_CACHE_MAX_SIZE
+ * bytes.
+ *
+ * Text is rendered by textoverlay, we do not link against Pango. A few
+ * renderers, each being a small pipeline with a textoverlay configured
+ * for a font description, are kept around so that changing the text only
+ * reuses the font setup and the glyph cache of its renderer. The text is
+ * rendered over black and over white, and the alpha is computed from the
+ * difference of the two, which does not depend on how textoverlay blends.
+ *
+ * Rendering is done without the cache lock, so that looking up a cached
+ * raster never waits for another text to be rendered. While a raster is
+ * being rendered its key is pending, and other lookups of the same key wait
+ * for it to be published instead of rendering it again. The renderers are
+ * used one at a time, under their own lock.
+ */
+
+#include <string.h>
+
+#include "ges-internal.h"
+
+#define TEXT_CACHE_MAX_SIZE      (32 * 1024 * 1024)
+#define TEXT_CACHE_MAX_RENDERERS 4
+#define TEXT_RENDER_TIMEOUT      (5 * GST_SECOND)
+
+typedef struct
+{
+  gchar *key;
+  GstVideoOverlayComposition *composition;
+  gsize size;
+} TextRaster;
+
+typedef struct
+{
+  gchar *font_desc;
+
+  GstElement *pipeline;
+  GstElement *background;
+  GstElement *text;
+  GstElement *capsfilter;
+  GstElement *sink;
+} TextRenderer;
+
+static GMutex cache_lock;
+static GCond cache_cond;        /* Signalled when a raster is published */
+static GHashTable *rasters = NULL;      /* key -> GList link in lru */
+static GHashTable *pending = NULL;      /* set of the keys being rendered */
+static GQueue lru = G_QUEUE_INIT;       /* TextRaster, most recent first */
+static gsize cache_size = 0;
+
+static GMutex render_lock;
+static GQueue renderers = G_QUEUE_INIT; /* TextRenderer, most recent first */
+
+static void
+_free_raster (TextRaster * raster)
+{
+  g_free (raster->key);
+  if (raster->composition)
+    gst_video_overlay_composition_unref (raster->composition);
+  g_slice_free (TextRaster, raster);
+}
+
+static void
+_free_renderer (TextRenderer * renderer)
+{
+  gst_element_set_state (renderer->pipeline, GST_STATE_NULL);
+  gst_object_unref (renderer->background);
+  gst_object_unref (renderer->text);
+  gst_object_unref (renderer->capsfilter);
+  gst_object_unref (renderer->sink);
+  gst_object_unref (renderer->pipeline);
+  g_free (renderer->font_desc);
+  g_slice_free (TextRenderer, renderer);
+}
+
+/* Called with the render lock */
+static TextRenderer *
+_get_renderer (const gchar * font_desc)
+{
+  GList *tmp;
+  GError *err = NULL;
+  TextRenderer *renderer;
+
+  for (tmp = renderers.head; tmp; tmp = tmp->next) {
+    renderer = tmp->data;
+
+    if (g_strcmp0 (renderer->font_desc, font_desc) == 0) {
+      g_queue_unlink (&renderers, tmp);
+      g_queue_push_head_link (&renderers, tmp);
+
+      return renderer;
+    }
+  }
+
+  renderer = g_slice_new0 (TextRenderer);
+  renderer->pipeline = gst_parse_launch ("videotestsrc name=background "
+      "num-buffers=1 ! capsfilter name=capsfilter ! textoverlay name=text ! "
+      "appsink name=sink sync=false", &err);
+  if (renderer->pipeline == NULL) {
+    GST_WARNING ("Could not create a text renderer: %s",
+        err ? err->message : "unknown error");
+    g_clear_error (&err);
+    g_slice_free (TextRenderer, renderer);
+
+    return NULL;
+  }
+
+  renderer->font_desc = g_strdup (font_desc);
+  renderer->background =
+      gst_bin_get_by_name (GST_BIN (renderer->pipeline), "background");
+  renderer->text = gst_bin_get_by_name (GST_BIN (renderer->pipeline), "text");
+  renderer->capsfilter =
+      gst_bin_get_by_name (GST_BIN (renderer->pipeline), "capsfilter");
+  renderer->sink = gst_bin_get_by_name (GST_BIN (renderer->pipeline), "sink");
+
+  g_object_set (renderer->background, "pattern",
+      (gint) GES_VIDEO_TEST_PATTERN_SOLID, NULL);
+  if (font_desc)
+    g_object_set (renderer->text, "font-desc", font_desc, NULL);
+
+  g_queue_push_head (&renderers, renderer);
+  if (renderers.length > TEXT_CACHE_MAX_RENDERERS)
+    _free_renderer (g_queue_pop_tail (&renderers));
+
+  return renderer;
+}
+
+static GstSample *
+_render_over (TextRenderer * renderer, guint32 background)
+{
+  GstSample *sample = NULL;
+
+  gst_element_set_state (renderer->pipeline, GST_STATE_READY);
+  g_object_set (renderer->background, "foreground-color", background, NULL);
+
+  gst_element_set_state (renderer->pipeline, GST_STATE_PAUSED);
+  switch (gst_element_get_state (renderer->pipeline, NULL, NULL,
+          TEXT_RENDER_TIMEOUT)) {
+    case GST_STATE_CHANGE_SUCCESS:
+      g_signal_emit_by_name (renderer->sink, "pull-preroll", &sample);
+      break;
+    case GST_STATE_CHANGE_ASYNC:
+      GST_WARNING ("Timed out rendering text");
+      break;
+    default:
+      break;
+  }
+
+  return sample;
+}
+
+/* Builds the premultiplied ARGB rectangle from the text rendered over black
+ * and over white: each color channel over black is the premultiplied
+ * color, and the difference between the two is 255 minus the alpha */
+static GstVideoOverlayComposition *
+_extract_text (GstSample * black, GstSample * white)
+{
+  gint x, y, left, right, top, bottom;
+  GstVideoFrame bframe, wframe;
+  GstVideoOverlayRectangle *rectangle;
+  GstVideoOverlayComposition *composition = NULL;
+  GstVideoInfo info;
+  GstMapInfo map;
+  GstBuffer *buffer;
+
+  if (!gst_video_info_from_caps (&info, gst_sample_get_caps (black)))
+    return NULL;
+
+  if (!gst_video_frame_map (&bframe, &info, gst_sample_get_buffer (black),
+          GST_MAP_READ))
+    return NULL;
+
+  if (!gst_video_frame_map (&wframe, &info, gst_sample_get_buffer (white),
+          GST_MAP_READ)) {
+    gst_video_frame_unmap (&bframe);
+
+    return NULL;
+  }
+
+  /* Find the bounds of the text */
+  left = info.width;
+  top = info.height;
+  right = bottom = -1;
+  for (y = 0; y < info.height; y++) {
+    const guint8 *b = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&bframe, 0) +
+        y * GST_VIDEO_FRAME_PLANE_STRIDE (&bframe, 0);
+    const guint8 *w = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&wframe, 0) +
+        y * GST_VIDEO_FRAME_PLANE_STRIDE (&wframe, 0);
+
+    for (x = 0; x < info.width; x++) {
+      if (w[4 * x + 1] != 255 || b[4 * x + 1] != 0) {
+        left = MIN (left, x);
+        right = MAX (right, x);
+        top = MIN (top, y);
+        bottom = y;
+      }
+    }
+  }
+
+  if (right < 0)
+    goto done;
+
+  buffer = gst_buffer_new_allocate (NULL,
+      (right - left + 1) * (bottom - top + 1) * 4, NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  for (y = top; y <= bottom; y++) {
+    /* BGRx */
+    const guint8 *b = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&bframe, 0) +
+        y * GST_VIDEO_FRAME_PLANE_STRIDE (&bframe, 0);
+    const guint8 *w = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&wframe, 0) +
+        y * GST_VIDEO_FRAME_PLANE_STRIDE (&wframe, 0);
+    guint32 *out = (guint32 *) map.data + (y - top) * (right - left + 1);
+
+    for (x = left; x <= right; x++) {
+      guint32 alpha = 255 - CLAMP ((w[4 * x] - b[4 * x] + w[4 * x + 1] -
+              b[4 * x + 1] + w[4 * x + 2] - b[4 * x + 2]) / 3, 0, 255);
+
+      /* GST_VIDEO_OVERLAY_COMPOSITION_FORMAT_RGB in native endianness */
+      *out++ = alpha << 24 | MIN (b[4 * x + 2], alpha) << 16 |
+          MIN (b[4 * x + 1], alpha) << 8 | MIN (b[4 * x], alpha);
+    }
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  gst_buffer_add_video_meta (buffer, GST_VIDEO_FRAME_FLAG_NONE,
+      GST_VIDEO_OVERLAY_COMPOSITION_FORMAT_RGB, right - left + 1,
+      bottom - top + 1);
+  rectangle = gst_video_overlay_rectangle_new_raw (buffer, left, top,
+      right - left + 1, bottom - top + 1,
+      GST_VIDEO_OVERLAY_FORMAT_FLAG_PREMULTIPLIED_ALPHA);
+  gst_buffer_unref (buffer);
+
+  composition = gst_video_overlay_composition_new (rectangle);
+  gst_video_overlay_rectangle_unref (rectangle);
+
+done:
+  gst_video_frame_unmap (&bframe);
+  gst_video_frame_unmap (&wframe);
+
+  return composition;
+}
+
+static GstVideoOverlayComposition *
+_render_text (const gchar * text, const gchar * font_desc,
+    GESTextHAlign halign, GESTextVAlign valign, guint32 color,
+    gdouble xpos, gdouble ypos, gint width, gint height)
+{
+  GstCaps *caps;
+  GstSample *black, *white;
+  GstVideoOverlayComposition *composition = NULL;
+  TextRenderer *renderer;
+
+  g_mutex_lock (&render_lock);
+  renderer = _get_renderer (font_desc);
+  if (renderer == NULL) {
+    g_mutex_unlock (&render_lock);
+
+    return NULL;
+  }
+
+  caps = gst_caps_new_simple ("video/x-raw", "format", G_TYPE_STRING, "BGRx",
+      "width", G_TYPE_INT, width, "height", G_TYPE_INT, height, NULL);
+  g_object_set (renderer->capsfilter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  g_object_set (renderer->text, "text", text, "halignment", (gint) halign,
+      "valignment", (gint) valign, "color", color, "xpos", xpos, "ypos", ypos,
+      NULL);
+
+  black = _render_over (renderer, 0xff000000);
+  white = _render_over (renderer, 0xffffffff);
+  gst_element_set_state (renderer->pipeline, GST_STATE_READY);
+  g_mutex_unlock (&render_lock);
+
+  if (black && white)
+    composition = _extract_text (black, white);
+  else
+    GST_WARNING ("Could not render '%s' with font '%s'", text, font_desc);
+
+  if (black)
+    gst_sample_unref (black);
+  if (white)
+    gst_sample_unref (white);
+
+  return composition;
+}
+
+/* Returns the raster of @text rendered with the given style on a
+ * @width x @height frame, rendering it if it is not cached, or %NULL if
+ * there is nothing to draw. The composition can be blended on any raw video
+ * frame of that size */
+GstVideoOverlayComposition *
+ges_text_cache_lookup (const gchar * text, const gchar * font_desc,
+    GESTextHAlign halign, GESTextVAlign valign, guint32 color,
+    gdouble xpos, gdouble ypos, gint width, gint height)
+{
+  gchar *key;
+  GList *link;
+  TextRaster *raster;
+  GstVideoOverlayComposition *composition = NULL;
+
+  if (text == NULL || *text == '\0' || width <= 0 || height <= 0)
+    return NULL;
+
+  key = g_strdup_printf ("%s\n%s\n%i %i %08x %f %f %ix%i", text,
+      GST_STR_NULL (font_desc), halign, valign, color, xpos, ypos, width,
+      height);
+
+  g_mutex_lock (&cache_lock);
+  if (rasters == NULL) {
+    rasters = g_hash_table_new (g_str_hash, g_str_equal);
+    pending = g_hash_table_new (g_str_hash, g_str_equal);
+  }
+
+  /* Another thread is rendering it */
+  while (g_hash_table_contains (pending, key))
+    g_cond_wait (&cache_cond, &cache_lock);
+
+  link = g_hash_table_lookup (rasters, key);
+  if (link) {
+    g_queue_unlink (&lru, link);
+    g_queue_push_head_link (&lru, link);
+    g_free (key);
+    raster = link->data;
+    if (raster->composition)
+      composition = gst_video_overlay_composition_ref (raster->composition);
+    g_mutex_unlock (&cache_lock);
+
+    return composition;
+  }
+
+  g_hash_table_add (pending, key);
+  g_mutex_unlock (&cache_lock);
+
+  raster = g_slice_new0 (TextRaster);
+  raster->key = key;
+  raster->composition = _render_text (text, font_desc, halign, valign,
+      color, xpos, ypos, width, height);
+  raster->size = sizeof (TextRaster) + strlen (key);
+  if (raster->composition) {
+    GstVideoOverlayRectangle *rectangle =
+        gst_video_overlay_composition_get_rectangle (raster->composition, 0);
+
+    raster->size += gst_buffer_get_size
+        (gst_video_overlay_rectangle_get_pixels_unscaled_raw (rectangle,
+            GST_VIDEO_OVERLAY_FORMAT_FLAG_PREMULTIPLIED_ALPHA));
+    composition = gst_video_overlay_composition_ref (raster->composition);
+  }
+
+  /* Publish it */
+  g_mutex_lock (&cache_lock);
+  g_hash_table_remove (pending, key);
+  g_queue_push_head (&lru, raster);
+  g_hash_table_insert (rasters, raster->key, lru.head);
+  cache_size += raster->size;
+
+  /* Never evict the raster we just rendered */
+  while (cache_size > TEXT_CACHE_MAX_SIZE && lru.length > 1) {
+    TextRaster *last = g_queue_pop_tail (&lru);
+
+    GST_DEBUG ("Evicting text raster of %" G_GSIZE_FORMAT " bytes",
+        last->size);
+    g_hash_table_remove (rasters, last->key);
+    cache_size -= last->size;
+    _free_raster (last);
+  }
+  g_cond_broadcast (&cache_cond);
+  g_mutex_unlock (&cache_lock);
+
+  return composition;
+}
+  g_mutex_unlock (&cache_lock);
+}
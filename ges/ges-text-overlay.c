@@ -40,7 +40,18 @@ struct _GESTextOverlayPrivate
   guint32 color;
   gdouble xpos;
   gdouble ypos;
-  GstElement *text_el;
+  GstElement *convert_el;
+
+  /* The text raster from the shared text cache for the current caps,
+   * blended on every frame from the streaming thread. It is rendered
+   * without the lock, generation tells whether the settings changed
+   * meanwhile. The settings above are protected by the lock too */
+  GMutex lock;
+  GstCaps *caps;
+  GstVideoInfo info;
+  GstVideoOverlayComposition *composition;
+  guint generation;
+  gulong probe_id;
 };
 
 enum
@@ -84,12 +95,13 @@ ges_text_overlay_init (GESTextOverlay * self)
 
   self->priv->text = NULL;
   self->priv->font_desc = NULL;
-  self->priv->text_el = NULL;
+  self->priv->convert_el = NULL;
   self->priv->halign = DEFAULT_HALIGNMENT;
   self->priv->valign = DEFAULT_VALIGNMENT;
   self->priv->color = G_MAXUINT32;
   self->priv->xpos = 0.5;
   self->priv->ypos = 0.5;
+  g_mutex_init (&self->priv->lock);
 }
 
 static void
@@ -104,9 +116,19 @@ ges_text_overlay_dispose (GObject * object)
     g_free (self->priv->font_desc);
   }
 
-  if (self->priv->text_el) {
-    gst_object_unref (self->priv->text_el);
-    self->priv->text_el = NULL;
+  if (self->priv->convert_el) {
+    GstPad *pad = gst_element_get_static_pad (self->priv->convert_el, "src");
+
+    gst_pad_remove_probe (pad, self->priv->probe_id);
+    gst_object_unref (pad);
+    gst_object_unref (self->priv->convert_el);
+    self->priv->convert_el = NULL;
+  }
+
+  gst_caps_replace (&self->priv->caps, NULL);
+  if (self->priv->composition) {
+    gst_video_overlay_composition_unref (self->priv->composition);
+    self->priv->composition = NULL;
   }
 
   G_OBJECT_CLASS (ges_text_overlay_parent_class)->dispose (object);
@@ -115,6 +137,8 @@ ges_text_overlay_dispose (GObject * object)
 static void
 ges_text_overlay_finalize (GObject * object)
 {
+  g_mutex_clear (&GES_TEXT_OVERLAY (object)->priv->lock);
+
   G_OBJECT_CLASS (ges_text_overlay_parent_class)->finalize (object);
 }
 
@@ -138,37 +162,135 @@ ges_text_overlay_set_property (GObject * object,
   }
 }
 
+/* Forget the text raster, it will be looked up again with the new settings
+ * for the next frame */
+static void
+_invalidate_composition (GESTextOverlay * self)
+{
+  g_mutex_lock (&self->priv->lock);
+  gst_caps_replace (&self->priv->caps, NULL);
+  if (self->priv->composition) {
+    gst_video_overlay_composition_unref (self->priv->composition);
+    self->priv->composition = NULL;
+  }
+  self->priv->generation++;
+  g_mutex_unlock (&self->priv->lock);
+}
+
+/* Looks the text raster up for @info with the current settings, without
+ * holding the lock while it is rendered */
+static GstVideoOverlayComposition *
+_lookup_composition (GESTextOverlay * self, GstCaps * caps,
+    GstVideoInfo * info)
+{
+  guint generation;
+  gchar *text, *font_desc;
+  GESTextHAlign halign;
+  GESTextVAlign valign;
+  guint32 color;
+  gdouble xpos, ypos;
+  GstVideoOverlayComposition *composition;
+  GESTextOverlayPrivate *priv = self->priv;
+
+  g_mutex_lock (&priv->lock);
+  text = g_strdup (priv->text);
+  font_desc = g_strdup (priv->font_desc);
+  halign = priv->halign;
+  valign = priv->valign;
+  color = priv->color;
+  xpos = priv->xpos;
+  ypos = priv->ypos;
+  generation = priv->generation;
+  g_mutex_unlock (&priv->lock);
+
+  composition = ges_text_cache_lookup (text, font_desc, halign, valign, color,
+      xpos, ypos, GST_VIDEO_INFO_WIDTH (info), GST_VIDEO_INFO_HEIGHT (info));
+  g_free (text);
+  g_free (font_desc);
+
+  /* Only keep it if nothing changed while it was rendered */
+  g_mutex_lock (&priv->lock);
+  if (generation == priv->generation) {
+    if (priv->composition)
+      gst_video_overlay_composition_unref (priv->composition);
+    priv->composition = composition ?
+        gst_video_overlay_composition_ref (composition) : NULL;
+    priv->info = *info;
+    gst_caps_replace (&priv->caps, caps);
+  }
+  g_mutex_unlock (&priv->lock);
+
+  return composition;
+}
+
+static GstPadProbeReturn
+_blend_text_cb (GstPad * pad, GstPadProbeInfo * info, GESTextOverlay * self)
+{
+  GstCaps *caps;
+  GstBuffer *buffer;
+  GstVideoInfo vinfo;
+  GstVideoFrame frame;
+  GstVideoOverlayComposition *composition = NULL;
+  GESTextOverlayPrivate *priv = self->priv;
+
+  caps = gst_pad_get_current_caps (pad);
+  if (caps == NULL)
+    return GST_PAD_PROBE_OK;
+
+  gst_video_info_init (&vinfo);
+  g_mutex_lock (&priv->lock);
+  if (priv->caps && gst_caps_is_equal (caps, priv->caps)) {
+    if (priv->composition) {
+      composition = gst_video_overlay_composition_ref (priv->composition);
+      vinfo = priv->info;
+    }
+    g_mutex_unlock (&priv->lock);
+  } else {
+    g_mutex_unlock (&priv->lock);
+
+    if (gst_video_info_from_caps (&vinfo, caps))
+      composition = _lookup_composition (self, caps, &vinfo);
+  }
+  gst_caps_unref (caps);
+
+  if (composition == NULL)
+    return GST_PAD_PROBE_OK;
+
+  buffer = gst_buffer_make_writable (GST_PAD_PROBE_INFO_BUFFER (info));
+  if (gst_video_frame_map (&frame, &vinfo, buffer, GST_MAP_READWRITE)) {
+    gst_video_overlay_composition_blend (composition, &frame);
+    gst_video_frame_unmap (&frame);
+  }
+  GST_PAD_PROBE_INFO_DATA (info) = buffer;
+  gst_video_overlay_composition_unref (composition);
+
+  return GST_PAD_PROBE_OK;
+}
+
 static GstElement *
 ges_text_overlay_create_element (GESTrackElement * track_element)
 {
-  GstElement *ret, *text, *iconv, *oconv;
+  GstElement *ret, *convert;
   GstPad *src_target, *sink_target;
   GstPad *src, *sink;
   GESTextOverlay *self = GES_TEXT_OVERLAY (track_element);
 
-  text = gst_element_factory_make ("textoverlay", NULL);
-  iconv = gst_element_factory_make ("videoconvert", NULL);
-  oconv = gst_element_factory_make ("videoconvert", NULL);
-  self->priv->text_el = text;
-  gst_object_ref (text);
-
-  if (self->priv->text)
-    g_object_set (text, "text", (gchar *) self->priv->text, NULL);
-  if (self->priv->font_desc)
-    g_object_set (text, "font-desc", (gchar *) self->priv->font_desc, NULL);
-
-  g_object_set (text, "halignment", (gint) self->priv->halign, "valignment",
-      (gint) self->priv->valign, NULL);
-  g_object_set (text, "color", (guint) self->priv->color, NULL);
-  g_object_set (text, "xpos", (gdouble) self->priv->xpos, NULL);
-  g_object_set (text, "ypos", (gdouble) self->priv->ypos, NULL);
+  /* The text is not laid out here but rendered once by the shared text
+   * cache, and the raster is blended on the frames going out of the
+   * converter */
+  convert = gst_element_factory_make ("videoconvert", NULL);
+  self->priv->convert_el = gst_object_ref (convert);
 
   ret = gst_bin_new ("overlay-bin");
-  gst_bin_add_many (GST_BIN (ret), text, iconv, oconv, NULL);
-  gst_element_link_many (iconv, text, oconv, NULL);
+  gst_bin_add (GST_BIN (ret), convert);
+
+  src_target = gst_element_get_static_pad (convert, "src");
+  sink_target = gst_element_get_static_pad (convert, "sink");
 
-  src_target = gst_element_get_static_pad (oconv, "src");
-  sink_target = gst_element_get_static_pad (iconv, "sink");
+  self->priv->probe_id = gst_pad_add_probe (src_target,
+      GST_PAD_PROBE_TYPE_BUFFER, (GstPadProbeCallback) _blend_text_cb, self,
+      NULL);
+  _invalidate_composition (self);
 
   src = gst_ghost_pad_new ("src", src_target);
   sink = gst_ghost_pad_new ("video_sink", sink_target);
@@ -195,12 +317,12 @@ ges_text_overlay_set_text (GESTextOverlay * self, const gchar * text)
 {
   GST_DEBUG ("self:%p, text:%s", self, text);
 
-  if (self->priv->text)
-    g_free (self->priv->text);
-
+  g_mutex_lock (&self->priv->lock);
+  g_free (self->priv->text);
   self->priv->text = g_strdup (text);
-  if (self->priv->text_el)
-    g_object_set (self->priv->text_el, "text", text, NULL);
+  g_mutex_unlock (&self->priv->lock);
+
+  _invalidate_composition (self);
 }
 
 /**
@@ -217,13 +339,13 @@ ges_text_overlay_set_font_desc (GESTextOverlay * self, const gchar * font_desc)
 {
   GST_DEBUG ("self:%p, font_desc:%s", self, font_desc);
 
-  if (self->priv->font_desc)
-    g_free (self->priv->font_desc);
-
+  g_mutex_lock (&self->priv->lock);
+  g_free (self->priv->font_desc);
   self->priv->font_desc = g_strdup (font_desc);
+  g_mutex_unlock (&self->priv->lock);
+
   GST_LOG ("setting font-desc to '%s'", font_desc);
-  if (self->priv->text_el)
-    g_object_set (self->priv->text_el, "font-desc", font_desc, NULL);
+  _invalidate_composition (self);
 }
 
 /**
@@ -240,9 +362,11 @@ ges_text_overlay_set_valignment (GESTextOverlay * self, GESTextVAlign valign)
 {
   GST_DEBUG ("self:%p, halign:%d", self, valign);
 
+  g_mutex_lock (&self->priv->lock);
   self->priv->valign = valign;
-  if (self->priv->text_el)
-    g_object_set (self->priv->text_el, "valignment", valign, NULL);
+  g_mutex_unlock (&self->priv->lock);
+
+  _invalidate_composition (self);
 }
 
 /**
@@ -259,9 +383,11 @@ ges_text_overlay_set_halignment (GESTextOverlay * self, GESTextHAlign halign)
 {
   GST_DEBUG ("self:%p, halign:%d", self, halign);
 
+  g_mutex_lock (&self->priv->lock);
   self->priv->halign = halign;
-  if (self->priv->text_el)
-    g_object_set (self->priv->text_el, "halignment", halign, NULL);
+  g_mutex_unlock (&self->priv->lock);
+
+  _invalidate_composition (self);
 }
 
 /**
@@ -276,9 +402,11 @@ ges_text_overlay_set_color (GESTextOverlay * self, guint32 color)
 {
   GST_DEBUG ("self:%p, color:%d", self, color);
 
+  g_mutex_lock (&self->priv->lock);
   self->priv->color = color;
-  if (self->priv->text_el)
-    g_object_set (self->priv->text_el, "color", color, NULL);
+  g_mutex_unlock (&self->priv->lock);
+
+  _invalidate_composition (self);
 }
 
 /**
@@ -293,9 +421,11 @@ ges_text_overlay_set_xpos (GESTextOverlay * self, gdouble position)
 {
   GST_DEBUG ("self:%p, xpos:%f", self, position);
 
+  g_mutex_lock (&self->priv->lock);
   self->priv->xpos = position;
-  if (self->priv->text_el)
-    g_object_set (self->priv->text_el, "xpos", position, NULL);
+  g_mutex_unlock (&self->priv->lock);
+
+  _invalidate_composition (self);
 }
 
 /**
@@ -310,9 +440,11 @@ ges_text_overlay_set_ypos (GESTextOverlay * self, gdouble position)
 {
   GST_DEBUG ("self:%p, ypos:%f", self, position);
 
+  g_mutex_lock (&self->priv->lock);
   self->priv->ypos = position;
-  if (self->priv->text_el)
-    g_object_set (self->priv->text_el, "ypos", position, NULL);
+  g_mutex_unlock (&self->priv->lock);
+
+  _invalidate_composition (self);
 }
 
 /**
@@ -40,6 +40,8 @@
  * into account until you call the #ges_timeline_commit method.
  */
 
+#include <string.h>
+
 #include "ges-internal.h"
 #include "ges-project.h"
 #include "ges-container.h"
@@ -54,6 +56,8 @@ typedef struct _MoveContext MoveContext;
 static GPtrArray *select_tracks_for_object_default (GESTimeline * timeline,
     GESClip * clip, GESTrackElement * tr_obj, gpointer user_data);
 static inline void init_movecontext (MoveContext * mv_ctx, gboolean first_init);
+static void update_track_element_priority (GESTimeline * timeline,
+    GESTrackElement * child);
 static void ges_extractable_interface_init (GESExtractableInterface * iface);
 static void ges_meta_container_interface_init
     (GESMetaContainerInterface * iface);
@@ -186,7 +190,22 @@ struct _GESTimelinePrivate
   GESClip *ignore_track_element_added;
   GList *groups;
 
+  /* While layers resync their priorities, the TrackElement-s whose priority
+   * changed are only re-sorted once everything has been updated */
+  guint priorities_frozen;
+  GHashTable *priority_changed; /* {TrackElement: TrackElement} */
+
   guint group_id;
+
+  /* Set while a GESPipeline renders the timeline, sources then decode the
+   * original media instead of their proxies */
+  gboolean rendering;
+
+  /* Statistics, see ges_timeline_get_statistics() */
+  GESLatencyStats commit_stats;
+  guint64 move_context_rebuilds;
+  guint64 snapping_queries;
+  guint64 transition_updates;
 };
 
 /* private structure to contain our track-related information */
@@ -342,6 +361,7 @@ ges_timeline_dispose (GObject * object)
   g_hash_table_unref (priv->by_object);
   g_hash_table_unref (priv->by_layer);
   g_hash_table_unref (priv->obj_iters);
+  g_hash_table_unref (priv->priority_changed);
   g_sequence_free (priv->starts_ends);
   g_sequence_free (priv->tracksources);
   g_list_free (priv->movecontext.moving_trackelements);
@@ -550,6 +570,7 @@ ges_timeline_init (GESTimeline * self)
       (GDestroyNotify) g_sequence_free);
   priv->obj_iters = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
       (GDestroyNotify) _destroy_obj_iters);
+  priv->priority_changed = g_hash_table_new (g_direct_hash, g_direct_equal);
   priv->starts_ends = g_sequence_new (g_free);
   priv->tracksources = g_sequence_new (gst_object_unref);
 
@@ -894,12 +915,16 @@ create_transitions (GESTimeline * timeline, GESTrackElement * track_element)
 {
   GESTrack *track;
   GList *layer_node;
+  gint64 trace;
 
   GESTimelinePrivate *priv = timeline->priv;
 
   if (!priv->needs_transitions_update)
     return;
 
+  trace = GES_TRACE_BEGIN ();
+  priv->transition_updates++;
+
   GST_DEBUG_OBJECT (timeline, "Creating transitions around %p", track_element);
 
   track = ges_track_element_get_track (track_element);
@@ -910,6 +935,7 @@ create_transitions (GESTimeline * timeline, GESTrackElement * track_element)
   _create_transitions_on_layer (timeline,
       layer_node ? layer_node->data : NULL, track, track_element,
       _find_transition_from_auto_transitions);
+  GES_TRACE_END (trace, "update_transitions");
 
   GST_DEBUG_OBJECT (timeline, "Done updating transitions");
 }
@@ -968,6 +994,7 @@ stop_tracking_track_element (GESTimeline * timeline,
     g_sequence_remove (iters->iter_obj);
     timeline_update_duration (timeline);
   }
+  g_hash_table_remove (priv->priority_changed, trackelement);
   g_hash_table_remove (priv->obj_iters, trackelement);
 }
 
@@ -1106,6 +1133,8 @@ ges_timeline_snap_position (GESTimeline * timeline,
   if (snap_distance == 0)
     return NULL;
 
+  priv->snapping_queries++;
+
   /* If we can just resnap as last snap... do it */
   if (last_snap_ts) {
     off = timecode > *last_snap_ts ?
@@ -1301,6 +1330,7 @@ ges_timeline_set_moving_context (GESTimeline * timeline, GESTrackElement * obj,
       "new: obj: %p, mode: %d, edge: %d ! Has changed %i", mv_ctx->clip,
       mv_ctx->mode, mv_ctx->edge, clip, mode, edge, mv_ctx->needs_move_ctx);
 
+  timeline->priv->move_context_rebuilds++;
   clean_movecontext (mv_ctx);
   mv_ctx->edge = edge;
   mv_ctx->mode = mode;
@@ -1869,6 +1899,56 @@ timeline_add_group (GESTimeline * timeline, GESGroup * group)
   ges_timeline_element_set_timeline (GES_TIMELINE_ELEMENT (group), timeline);
 }
 
+/* Used around batches of priority changes, such as a layer resyncing the
+ * priorities of all its clips, so each TrackElement is re-sorted once and
+ * only after all of them got their new priority.
+ *
+ * The gnlcompositions keep the new priorities of their gnlobjects pending
+ * until they are committed, so they are not updated during the batch. Each
+ * track that got new priorities is then committed once, when the outermost
+ * batch is done */
+void
+timeline_freeze_priorities (GESTimeline * timeline)
+{
+  timeline->priv->priorities_frozen++;
+}
+
+void
+timeline_thaw_priorities (GESTimeline * timeline)
+{
+  GList *tmp;
+  gpointer child;
+  GESTrack *track;
+  GHashTableIter iter;
+  GList *tracks = NULL;
+  GESTimelinePrivate *priv = timeline->priv;
+
+  g_return_if_fail (priv->priorities_frozen > 0);
+
+  if (--priv->priorities_frozen)
+    return;
+
+  if (g_hash_table_size (priv->priority_changed) == 0)
+    return;
+
+  GST_DEBUG_OBJECT (timeline, "Updating %u track elements priorities",
+      g_hash_table_size (priv->priority_changed));
+
+  g_hash_table_iter_init (&iter, priv->priority_changed);
+  while (g_hash_table_iter_next (&iter, &child, NULL)) {
+    g_hash_table_iter_remove (&iter);
+    update_track_element_priority (timeline, child);
+
+    track = ges_track_element_get_track (child);
+    if (track && !g_list_find (tracks, track))
+      tracks = g_list_prepend (tracks, track);
+  }
+
+  for (tmp = tracks; tmp; tmp = tmp->next)
+    ges_track_commit (tmp->data);
+  g_list_free (tracks);
+}
+
 void
 timeline_remove_group (GESTimeline * timeline, GESGroup * group)
 {
@@ -1881,6 +1961,34 @@ timeline_remove_group (GESTimeline * timeline, GESGroup * group)
   gst_object_unref (group);
 }
 
+void
+timeline_set_rendering (GESTimeline * timeline, gboolean rendering)
+{
+  GSequenceIter *iter;
+  GESTimelinePrivate *priv = timeline->priv;
+
+  if (priv->rendering == rendering)
+    return;
+
+  GST_DEBUG_OBJECT (timeline, "%s rendering", rendering ? "Started" :
+      "Stopped");
+  priv->rendering = rendering;
+
+  for (iter = g_sequence_get_begin_iter (priv->tracksources);
+      !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
+    GESTrackElement *source = g_sequence_get (iter);
+
+    if (GES_IS_VIDEO_URI_SOURCE (source))
+      ges_video_uri_source_update_uri (GES_VIDEO_URI_SOURCE (source));
+  }
+}
+
+gboolean
+timeline_get_rendering (GESTimeline * timeline)
+{
+  return timeline->priv->rendering;
+}
+
 static GPtrArray *
 select_tracks_for_object_default (GESTimeline * timeline,
     GESClip * clip, GESTrackElement * tr_object, gpointer user_data)
@@ -2186,8 +2294,7 @@ trackelement_start_changed_cb (GESTrackElement * child,
 }
 
 static void
-trackelement_priority_changed_cb (GESTrackElement * child,
-    GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
+update_track_element_priority (GESTimeline * timeline, GESTrackElement * child)
 {
   GESTimelinePrivate *priv = timeline->priv;
 
@@ -2231,6 +2338,19 @@ trackelement_priority_changed_cb (GESTrackElement * child,
     sort_track_elements (timeline, iters);
 }
 
+static void
+trackelement_priority_changed_cb (GESTrackElement * child,
+    GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
+{
+  if (timeline->priv->priorities_frozen) {
+    g_hash_table_insert (timeline->priv->priority_changed, child, child);
+
+    return;
+  }
+
+  update_track_element_priority (timeline, child);
+}
+
 static void
 trackelement_duration_changed_cb (GESTrackElement * child,
     GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
@@ -2890,6 +3010,59 @@ ges_timeline_get_layers (GESTimeline * timeline)
   return res;
 }
 
+/**
+ * ges_timeline_split_at_positions:
+ * @timeline: a #GESTimeline
+ * @positions: (array length=n_positions): the positions at which to split
+ * @n_positions: the number of positions
+ *
+ * Splits all the clips of @timeline at each of the @positions they
+ * contain, as #ges_clip_split_at_positions does for one clip. Transition
+ * clips are not split, the automatic transitions are updated once all the
+ * clips have been split.
+ *
+ * Returns: (transfer container) (element-type GESClip): The newly created
+ * #GESClip-s
+ */
+GList *
+ges_timeline_split_at_positions (GESTimeline * timeline,
+    const GstClockTime * positions, guint n_positions)
+{
+  GList *layers, *clips, *tmp, *tmpclip, *ret = NULL;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+  g_return_val_if_fail (n_positions == 0 || positions, NULL);
+
+  if (n_positions == 0)
+    return NULL;
+
+  /* Transitions are created for all the new clips at once afterward */
+  timeline->priv->needs_transitions_update = FALSE;
+  layers = ges_timeline_get_layers (timeline);
+  for (tmp = layers; tmp; tmp = tmp->next) {
+    clips = ges_layer_get_clips (tmp->data);
+    for (tmpclip = clips; tmpclip; tmpclip = tmpclip->next) {
+      /* Transitions follow the clips they are between */
+      if (GES_IS_TRANSITION_CLIP (tmpclip->data))
+        continue;
+
+      ret = g_list_concat (ret,
+          ges_clip_split_at_positions (tmpclip->data, positions, n_positions));
+    }
+
+    g_list_free_full (clips, gst_object_unref);
+  }
+  timeline->priv->needs_transitions_update = TRUE;
+
+  timeline->priv->transition_updates++;
+  for (tmp = layers; tmp; tmp = tmp->next)
+    _create_transitions_on_layer (timeline, tmp->data, NULL, NULL,
+        _find_transition_from_auto_transitions);
+  g_list_free_full (layers, gst_object_unref);
+
+  return ret;
+}
+
 /**
  * ges_timeline_commit:
  * @timeline: a #GESTimeline
@@ -2909,14 +3082,20 @@ gboolean
 ges_timeline_commit (GESTimeline * timeline)
 {
   GList *tmp;
+  gint64 start, trace, transitions_trace;
   gboolean res = TRUE;
 
   GST_DEBUG_OBJECT (timeline, "commiting changes");
 
+  start = g_get_monotonic_time ();
+  trace = GES_TRACE_BEGIN ();
+  transitions_trace = GES_TRACE_BEGIN ();
+  timeline->priv->transition_updates++;
   for (tmp = timeline->layers; tmp; tmp = tmp->next) {
     _create_transitions_on_layer (timeline, GES_LAYER (tmp->data),
         NULL, NULL, _find_transition_from_auto_transitions);
   }
+  GES_TRACE_END (transitions_trace, "update_transitions");
 
   for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
     if (!ges_track_commit (GES_TRACK (tmp->data)))
@@ -2925,6 +3104,9 @@ ges_timeline_commit (GESTimeline * timeline)
 
   /* Make sure we reset the context */
   timeline->priv->movecontext.needs_move_ctx = TRUE;
+  GES_TRACE_END (trace, "ges_timeline_commit");
+  ges_latency_stats_add (&timeline->priv->commit_stats,
+      (g_get_monotonic_time () - start) * GST_USECOND);
 
   if (res)
     g_signal_emit (timeline, ges_timeline_signals[COMMITED], 0);
@@ -2932,6 +3114,119 @@ ges_timeline_commit (GESTimeline * timeline)
   return res;
 }
 
+/**
+ * ges_timeline_get_statistics:
+ * @timeline: a #GESTimeline
+ *
+ * Gets statistics about @timeline, to find out how expensive it is to
+ * edit and render. They are returned in a #GstStructure named
+ * "ges-timeline-statistics" with the following fields:
+ *
+ * <itemizedlist>
+ * <listitem>"n-layers" and "n-tracks" #G_TYPE_UINT</listitem>
+ * <listitem>"n-track-sources" #G_TYPE_UINT: the number of #GESSource-s
+ * in the tracks, which are tracked for snapping and transitions</listitem>
+ * <listitem>"n-auto-transitions" #G_TYPE_UINT: the number of transitions
+ * created automatically</listitem>
+ * <listitem>"n-pending-assets" #G_TYPE_UINT: the number of assets of the
+ * project of @timeline that are still loading</listitem>
+ * <listitem>"n-gaps" and "n-composition-objects" #G_TYPE_UINT: the sum
+ * over all the tracks of the values described in
+ * ges_track_get_statistics()</listitem>
+ * <listitem>"move-context-rebuilds" #G_TYPE_UINT64: how many times the
+ * context used to move objects has been recomputed</listitem>
+ * <listitem>"snapping-queries" #G_TYPE_UINT64: how many times snapping
+ * has been checked while editing</listitem>
+ * <listitem>"transition-updates" #G_TYPE_UINT64: how many times the
+ * automatic transitions have been recomputed</listitem>
+ * <listitem>"commit-count", "commit-last", "commit-max" and
+ * "commit-average" #G_TYPE_UINT64: the number of commits and their
+ * durations in nanoseconds</listitem>
+ * <listitem>"commit-histogram" #GST_TYPE_ARRAY of #G_TYPE_UINT64: the
+ * number of commits that took less than 1, 2, 4 ... 512 milliseconds,
+ * the last value counts the longer ones</listitem>
+ * </itemizedlist>
+ *
+ * Use ges_track_get_statistics() for the details of each track. The
+ * counters are reset by ges_timeline_reset_statistics().
+ *
+ * Returns: (transfer full): The statistics of @timeline
+ */
+GstStructure *
+ges_timeline_get_statistics (GESTimeline * timeline)
+{
+  GList *tmp;
+  GESAsset *project;
+  GstStructure *stats;
+  guint n_gaps = 0, n_objects = 0, n_pending = 0;
+  GESTimelinePrivate *priv;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+
+  priv = timeline->priv;
+
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
+    guint n;
+    GstStructure *track_stats = ges_track_get_statistics (tmp->data);
+
+    if (gst_structure_get_uint (track_stats, "n-gaps", &n))
+      n_gaps += n;
+    if (gst_structure_get_uint (track_stats, "n-composition-objects", &n))
+      n_objects += n;
+    gst_structure_free (track_stats);
+  }
+
+  project = ges_extractable_get_asset (GES_EXTRACTABLE (timeline));
+  if (GES_IS_PROJECT (project)) {
+    GList *loading = ges_project_get_loading_assets (GES_PROJECT (project));
+
+    n_pending = g_list_length (loading);
+    g_list_free_full (loading, gst_object_unref);
+  }
+
+  stats = gst_structure_new ("ges-timeline-statistics",
+      "n-layers", G_TYPE_UINT, g_list_length (timeline->layers),
+      "n-tracks", G_TYPE_UINT, g_list_length (timeline->tracks),
+      "n-track-sources", G_TYPE_UINT,
+      g_sequence_get_length (priv->tracksources),
+      "n-auto-transitions", G_TYPE_UINT,
+      g_hash_table_size (priv->auto_transitions),
+      "n-pending-assets", G_TYPE_UINT, n_pending,
+      "n-gaps", G_TYPE_UINT, n_gaps,
+      "n-composition-objects", G_TYPE_UINT, n_objects,
+      "move-context-rebuilds", G_TYPE_UINT64, priv->move_context_rebuilds,
+      "snapping-queries", G_TYPE_UINT64, priv->snapping_queries,
+      "transition-updates", G_TYPE_UINT64, priv->transition_updates, NULL);
+  ges_latency_stats_fill (&priv->commit_stats, stats, "commit");
+
+  return stats;
+}
+
+/**
+ * ges_timeline_reset_statistics:
+ * @timeline: a #GESTimeline
+ *
+ * Resets the counters reported by ges_timeline_get_statistics(), and the
+ * ones of all the tracks of @timeline.
+ */
+void
+ges_timeline_reset_statistics (GESTimeline * timeline)
+{
+  GList *tmp;
+  GESTimelinePrivate *priv;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  priv = timeline->priv;
+  memset (&priv->commit_stats, 0, sizeof (GESLatencyStats));
+  priv->move_context_rebuilds = 0;
+  priv->snapping_queries = 0;
+  priv->transition_updates = 0;
+
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next)
+    ges_track_reset_statistics (tmp->data);
+}
+
 /**
  * ges_timeline_get_duration:
  * @timeline: a #GESTimeline
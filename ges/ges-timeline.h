@@ -109,6 +109,9 @@ gboolean ges_timeline_add_layer (GESTimeline *timeline, GESLayer *layer);
 GESLayer * ges_timeline_append_layer (GESTimeline * timeline);
 gboolean ges_timeline_remove_layer (GESTimeline *timeline, GESLayer *layer);
 GList* ges_timeline_get_layers (GESTimeline *timeline);
+GList* ges_timeline_split_at_positions (GESTimeline *timeline,
+                                        const GstClockTime *positions,
+                                        guint n_positions);
 
 gboolean ges_timeline_add_track (GESTimeline *timeline, GESTrack *track);
 gboolean ges_timeline_remove_track (GESTimeline *timeline, GESTrack *track);
@@ -120,6 +123,9 @@ gboolean ges_timeline_commit (GESTimeline * timeline);
 
 GstClockTime ges_timeline_get_duration (GESTimeline *timeline);
 
+GstStructure * ges_timeline_get_statistics (GESTimeline *timeline);
+void ges_timeline_reset_statistics (GESTimeline *timeline);
+
 gboolean ges_timeline_get_auto_transition (GESTimeline * timeline);
 void ges_timeline_set_auto_transition (GESTimeline * timeline, gboolean auto_transition);
 GstClockTime ges_timeline_get_snapping_distance (GESTimeline * timeline);
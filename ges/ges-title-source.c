@@ -43,6 +43,20 @@ struct _GESTitleSourcePrivate
   gdouble ypos;
   GstElement *text_el;
   GstElement *background_el;
+
+  /* Pre-rendered mode: the background and the text never change while
+   * playing, so the text raster from the shared text cache is blended once
+   * on a frame filled with the background color, and every frame produced
+   * by the background source is replaced by the result. The frame, as well as the settings
+   * it is rendered from, are protected by frame_lock as frames are replaced
+   * from the streaming thread. The frame is rendered without the lock,
+   * frame_generation tells whether the settings changed meanwhile */
+  gboolean pre_rendered;
+  GMutex frame_lock;
+  GstBuffer *frame;
+  GstCaps *frame_caps;
+  guint frame_generation;
+  gulong probe_id;
 };
 
 enum
@@ -51,6 +65,7 @@ enum
 };
 
 static void ges_title_source_dispose (GObject * object);
+static void ges_title_source_finalize (GObject * object);
 
 static void ges_title_source_get_property (GObject * object, guint
     property_id, GValue * value, GParamSpec * pspec);
@@ -71,6 +86,7 @@ ges_title_source_class_init (GESTitleSourceClass * klass)
   object_class->get_property = ges_title_source_get_property;
   object_class->set_property = ges_title_source_set_property;
   object_class->dispose = ges_title_source_dispose;
+  object_class->finalize = ges_title_source_finalize;
 
   source_class->create_source = ges_title_source_create_source;
 }
@@ -91,6 +107,8 @@ ges_title_source_init (GESTitleSource * self)
   self->priv->xpos = 0.5;
   self->priv->ypos = 0.5;
   self->priv->background_el = NULL;
+  self->priv->pre_rendered = TRUE;
+  g_mutex_init (&self->priv->frame_lock);
 }
 
 static void
@@ -111,13 +129,33 @@ ges_title_source_dispose (GObject * object)
   }
 
   if (self->priv->background_el) {
+    if (self->priv->probe_id) {
+      GstPad *pad = gst_element_get_static_pad (self->priv->background_el,
+          "src");
+
+      gst_pad_remove_probe (pad, self->priv->probe_id);
+      gst_object_unref (pad);
+      self->priv->probe_id = 0;
+    }
+
     gst_object_unref (self->priv->background_el);
     self->priv->background_el = NULL;
   }
 
+  gst_buffer_replace (&self->priv->frame, NULL);
+  gst_caps_replace (&self->priv->frame_caps, NULL);
+
   G_OBJECT_CLASS (ges_title_source_parent_class)->dispose (object);
 }
 
+static void
+ges_title_source_finalize (GObject * object)
+{
+  g_mutex_clear (&GES_TITLE_SOURCE (object)->priv->frame_lock);
+
+  G_OBJECT_CLASS (ges_title_source_parent_class)->finalize (object);
+}
+
 static void
 ges_title_source_get_property (GObject * object,
     guint property_id, GValue * value, GParamSpec * pspec)
@@ -138,18 +176,11 @@ ges_title_source_set_property (GObject * object,
   }
 }
 
-static GstElement *
-ges_title_source_create_source (GESTrackElement * object)
+static void
+_configure_text (GESTitleSource * self, GstElement * text)
 {
-  GESTitleSource *self = GES_TITLE_SOURCE (object);
   GESTitleSourcePrivate *priv = self->priv;
-  GstElement *topbin, *background, *text;
-  GstPad *src, *pad;
-
-  topbin = gst_bin_new ("titlesrc-bin");
-  background = gst_element_factory_make ("videotestsrc", "titlesrc-bg");
 
-  text = gst_element_factory_make ("textoverlay", "titlsrc-text");
   if (priv->text) {
     g_object_set (text, "text", priv->text, NULL);
   }
@@ -159,13 +190,215 @@ ges_title_source_create_source (GESTrackElement * object)
   g_object_set (text, "valignment", (gint) priv->valign, "halignment",
       (gint) priv->halign, NULL);
 
+  g_object_set (text, "color", (guint) priv->color, NULL);
+  g_object_set (text, "xpos", (gdouble) priv->xpos, NULL);
+  g_object_set (text, "ypos", (gdouble) priv->ypos, NULL);
+}
+
+static void
+_configure_background (GESTitleSource * self, GstElement * background)
+{
   g_object_set (background, "pattern", (gint) GES_VIDEO_TEST_PATTERN_SOLID,
       NULL);
   g_object_set (background, "foreground-color", (guint) self->priv->background,
       NULL);
-  g_object_set (text, "color", (guint) self->priv->color, NULL);
-  g_object_set (text, "xpos", (gdouble) self->priv->xpos, NULL);
-  g_object_set (text, "ypos", (gdouble) self->priv->ypos, NULL);
+}
+
+/* Forget the pre-rendered frame, it will be rendered again with the new
+ * settings when the next frame is produced. Called with the frame lock */
+static void
+_invalidate_frame_unlocked (GESTitleSource * self)
+{
+  gst_buffer_replace (&self->priv->frame, NULL);
+  gst_caps_replace (&self->priv->frame_caps, NULL);
+  self->priv->frame_generation++;
+}
+
+/* Fills @frame with the solid ARGB @color, the way the background source
+ * does, one group of lines at a time through the pack function */
+static void
+_fill_background (GstVideoFrame * frame, guint32 color)
+{
+  guint8 *lines;
+  gint i, y, stride, comp[4];
+  const GstVideoFormatInfo *finfo = frame->info.finfo;
+  gint width = GST_VIDEO_FRAME_WIDTH (frame);
+  gint height = GST_VIDEO_FRAME_HEIGHT (frame);
+  gint a = (color >> 24) & 0xff, r = (color >> 16) & 0xff;
+  gint g = (color >> 8) & 0xff, b = color & 0xff;
+  gboolean wide = finfo->unpack_format == GST_VIDEO_FORMAT_ARGB64 ||
+      finfo->unpack_format == GST_VIDEO_FORMAT_AYUV64;
+
+  /* Components in the order of the unpack format, AYUV or ARGB */
+  comp[0] = a;
+  if (GST_VIDEO_FORMAT_INFO_IS_YUV (finfo)) {
+    comp[1] = (((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    comp[2] = (((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    comp[3] = (((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+  } else {
+    comp[1] = r;
+    comp[2] = g;
+    comp[3] = b;
+  }
+
+  stride = width * 4 * (wide ? 2 : 1);
+  lines = g_malloc (stride * finfo->pack_lines);
+  for (i = 0; i < width * 4 * finfo->pack_lines; i++) {
+    if (wide)
+      ((guint16 *) lines)[i] = comp[i % 4] << 8 | comp[i % 4];
+    else
+      lines[i] = comp[i % 4];
+  }
+
+  for (y = 0; y < height; y += finfo->pack_lines)
+    finfo->pack_func (finfo, GST_VIDEO_PACK_FLAG_NONE, lines, stride,
+        frame->data, frame->info.stride, frame->info.chroma_site, y, width);
+
+  g_free (lines);
+}
+
+/* Renders a frame of the background color with the text blended on it,
+ * takes the frame lock only to read the settings as the text might have
+ * to be rendered. The frames produced by the background source are not
+ * used, they might have been produced before the settings changed */
+static GstBuffer *
+_compose_frame (GESTitleSource * self, GstCaps * caps)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  gchar *text, *font_desc;
+  GESTextHAlign halign;
+  GESTextVAlign valign;
+  guint32 color, background;
+  gdouble xpos, ypos;
+  GstBuffer *buffer;
+  GstVideoOverlayComposition *composition;
+  GESTitleSourcePrivate *priv = self->priv;
+
+  if (!gst_video_info_from_caps (&info, caps))
+    return NULL;
+
+  g_mutex_lock (&priv->frame_lock);
+  text = g_strdup (priv->text);
+  font_desc = g_strdup (priv->font_desc);
+  halign = priv->halign;
+  valign = priv->valign;
+  color = priv->color;
+  background = priv->background;
+  xpos = priv->xpos;
+  ypos = priv->ypos;
+  g_mutex_unlock (&priv->frame_lock);
+
+  composition = ges_text_cache_lookup (text, font_desc, halign, valign, color,
+      xpos, ypos, GST_VIDEO_INFO_WIDTH (&info), GST_VIDEO_INFO_HEIGHT (&info));
+  g_free (text);
+  g_free (font_desc);
+
+  buffer = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  if (gst_video_frame_map (&frame, &info, buffer, GST_MAP_READWRITE)) {
+    _fill_background (&frame, background);
+    if (composition)
+      gst_video_overlay_composition_blend (composition, &frame);
+    gst_video_frame_unmap (&frame);
+  } else {
+    GST_WARNING_OBJECT (self, "Could not render the title with %"
+        GST_PTR_FORMAT, caps);
+    gst_buffer_unref (buffer);
+    buffer = NULL;
+  }
+
+  if (composition)
+    gst_video_overlay_composition_unref (composition);
+
+  return buffer;
+}
+
+static GstPadProbeReturn
+_replace_frame_cb (GstPad * pad, GstPadProbeInfo * info, GESTitleSource * self)
+{
+  GstCaps *caps;
+  guint generation;
+  GstBuffer *buffer, *frame = NULL;
+  GESTitleSourcePrivate *priv = self->priv;
+
+  caps = gst_pad_get_current_caps (pad);
+  if (caps == NULL)
+    return GST_PAD_PROBE_OK;
+
+  buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+
+  g_mutex_lock (&priv->frame_lock);
+  if (priv->frame_caps && gst_caps_is_equal (caps, priv->frame_caps)) {
+    frame = gst_buffer_copy (priv->frame);
+    g_mutex_unlock (&priv->frame_lock);
+  } else {
+    generation = priv->frame_generation;
+    g_mutex_unlock (&priv->frame_lock);
+
+    frame = _compose_frame (self, caps);
+
+    /* If the settings changed while rendering, the frame is only used for
+     * this buffer and rendered again for the next one */
+    g_mutex_lock (&priv->frame_lock);
+    if (frame && generation == priv->frame_generation) {
+      gst_buffer_replace (&priv->frame, frame);
+      gst_caps_replace (&priv->frame_caps, caps);
+    }
+    g_mutex_unlock (&priv->frame_lock);
+
+    if (frame) {
+      GstBuffer *copy = gst_buffer_copy (frame);
+
+      gst_buffer_unref (frame);
+      frame = copy;
+    }
+  }
+  gst_caps_unref (caps);
+
+  if (frame == NULL)
+    return GST_PAD_PROBE_OK;
+
+  /* The memory of the rendered frame is shared by all the frames */
+  gst_buffer_copy_into (frame, buffer,
+      GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+  gst_buffer_unref (buffer);
+  GST_PAD_PROBE_INFO_DATA (info) = frame;
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstElement *
+ges_title_source_create_source (GESTrackElement * object)
+{
+  GESTitleSource *self = GES_TITLE_SOURCE (object);
+  GESTitleSourcePrivate *priv = self->priv;
+  GstElement *topbin, *background, *text;
+  GstPad *src, *pad;
+
+  topbin = gst_bin_new ("titlesrc-bin");
+  background = gst_element_factory_make ("videotestsrc", "titlesrc-bg");
+  _configure_background (self, background);
+
+  if (priv->pre_rendered) {
+    gst_bin_add (GST_BIN (topbin), background);
+
+    pad = gst_element_get_static_pad (background, "src");
+    priv->probe_id = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+        (GstPadProbeCallback) _replace_frame_cb, self, NULL);
+    src = gst_ghost_pad_new ("src", pad);
+    gst_object_unref (pad);
+    gst_element_add_pad (topbin, src);
+
+    g_mutex_lock (&priv->frame_lock);
+    _invalidate_frame_unlocked (self);
+    g_mutex_unlock (&priv->frame_lock);
+    priv->background_el = gst_object_ref (background);
+
+    return topbin;
+  }
+
+  text = gst_element_factory_make ("textoverlay", "titlsrc-text");
+  _configure_text (self, text);
 
   gst_bin_add_many (GST_BIN (topbin), background, text, NULL);
 
@@ -198,12 +431,13 @@ ges_title_source_create_source (GESTrackElement * object)
 void
 ges_title_source_set_text (GESTitleSource * self, const gchar * text)
 {
-  if (self->priv->text)
-    g_free (self->priv->text);
-
   GST_DEBUG ("self:%p, text:%s", self, text);
 
+  g_mutex_lock (&self->priv->frame_lock);
+  g_free (self->priv->text);
   self->priv->text = g_strdup (text);
+  _invalidate_frame_unlocked (self);
+  g_mutex_unlock (&self->priv->frame_lock);
   if (self->priv->text_el)
     g_object_set (self->priv->text_el, "text", text, NULL);
 }
@@ -220,12 +454,13 @@ ges_title_source_set_text (GESTitleSource * self, const gchar * text)
 void
 ges_title_source_set_font_desc (GESTitleSource * self, const gchar * font_desc)
 {
-  if (self->priv->font_desc)
-    g_free (self->priv->font_desc);
-
   GST_DEBUG ("self:%p, font_dec:%s", self, font_desc);
 
+  g_mutex_lock (&self->priv->frame_lock);
+  g_free (self->priv->font_desc);
   self->priv->font_desc = g_strdup (font_desc);
+  _invalidate_frame_unlocked (self);
+  g_mutex_unlock (&self->priv->frame_lock);
   if (self->priv->text_el)
     g_object_set (self->priv->text_el, "font-desc", font_desc, NULL);
 }
@@ -242,7 +477,10 @@ ges_title_source_set_valignment (GESTitleSource * self, GESTextVAlign valign)
 {
   GST_DEBUG ("self:%p, valign:%d", self, valign);
 
+  g_mutex_lock (&self->priv->frame_lock);
   self->priv->valign = valign;
+  _invalidate_frame_unlocked (self);
+  g_mutex_unlock (&self->priv->frame_lock);
   if (self->priv->text_el)
     g_object_set (self->priv->text_el, "valignment", valign, NULL);
 }
@@ -259,7 +497,10 @@ ges_title_source_set_halignment (GESTitleSource * self, GESTextHAlign halign)
 {
   GST_DEBUG ("self:%p, halign:%d", self, halign);
 
+  g_mutex_lock (&self->priv->frame_lock);
   self->priv->halign = halign;
+  _invalidate_frame_unlocked (self);
+  g_mutex_unlock (&self->priv->frame_lock);
   if (self->priv->text_el)
     g_object_set (self->priv->text_el, "halignment", halign, NULL);
 }
@@ -276,7 +517,10 @@ ges_title_source_set_text_color (GESTitleSource * self, guint32 color)
 {
   GST_DEBUG ("self:%p, color:%d", self, color);
 
+  g_mutex_lock (&self->priv->frame_lock);
   self->priv->color = color;
+  _invalidate_frame_unlocked (self);
+  g_mutex_unlock (&self->priv->frame_lock);
   if (self->priv->text_el)
     g_object_set (self->priv->text_el, "color", color, NULL);
 }
@@ -293,7 +537,10 @@ ges_title_source_set_background_color (GESTitleSource * self, guint32 color)
 {
   GST_DEBUG ("self:%p, background color:%d", self, color);
 
+  g_mutex_lock (&self->priv->frame_lock);
   self->priv->background = color;
+  _invalidate_frame_unlocked (self);
+  g_mutex_unlock (&self->priv->frame_lock);
   if (self->priv->background_el)
     g_object_set (self->priv->background_el, "foreground-color", color, NULL);
 }
@@ -310,7 +557,10 @@ ges_title_source_set_xpos (GESTitleSource * self, gdouble position)
 {
   GST_DEBUG ("self:%p, xpos:%f", self, position);
 
+  g_mutex_lock (&self->priv->frame_lock);
   self->priv->xpos = position;
+  _invalidate_frame_unlocked (self);
+  g_mutex_unlock (&self->priv->frame_lock);
   if (self->priv->text_el)
     g_object_set (self->priv->text_el, "xpos", position, NULL);
 }
@@ -327,11 +577,48 @@ ges_title_source_set_ypos (GESTitleSource * self, gdouble position)
 {
   GST_DEBUG ("self:%p, ypos:%f", self, position);
 
+  g_mutex_lock (&self->priv->frame_lock);
   self->priv->ypos = position;
+  _invalidate_frame_unlocked (self);
+  g_mutex_unlock (&self->priv->frame_lock);
   if (self->priv->text_el)
     g_object_set (self->priv->text_el, "ypos", position, NULL);
 }
 
+/**
+ * ges_title_source_set_pre_rendered:
+ * @self: the #GESTitleSource
+ * @pre_rendered: whether to render the title once
+ *
+ * Sets whether the title is rendered once, every time its settings or the
+ * video format change, instead of for every frame. Pre-rendering is enabled
+ * by default, the setting is only used when the element of @self is
+ * created.
+ */
+void
+ges_title_source_set_pre_rendered (GESTitleSource * self,
+    gboolean pre_rendered)
+{
+  GST_DEBUG ("self:%p, pre-rendered:%d", self, pre_rendered);
+
+  self->priv->pre_rendered = pre_rendered;
+}
+
+/**
+ * ges_title_source_get_pre_rendered:
+ * @source: a #GESTitleSource
+ *
+ * Get whether @source renders its title once.
+ *
+ * Returns: %TRUE if @source renders its title once, %FALSE if it renders
+ * it for every frame.
+ */
+gboolean
+ges_title_source_get_pre_rendered (GESTitleSource * source)
+{
+  return source->priv->pre_rendered;
+}
+
 /**
  * ges_title_source_get_text:
  * @source: a #GESTitleSource
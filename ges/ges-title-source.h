@@ -96,6 +96,8 @@ void ges_title_source_set_xpos (GESTitleSource *self,
 					   gdouble position);
 void ges_title_source_set_ypos (GESTitleSource *self,
 					   gdouble position);
+void ges_title_source_set_pre_rendered (GESTitleSource *self,
+					   gboolean pre_rendered);
 
 const gchar *ges_title_source_get_text (GESTitleSource *source);
 const gchar *ges_title_source_get_font_desc (GESTitleSource *source);
@@ -105,6 +107,7 @@ const guint32 ges_title_source_get_text_color (GESTitleSource *source);
 const guint32 ges_title_source_get_background_color (GESTitleSource *source);
 const gdouble ges_title_source_get_xpos (GESTitleSource *source);
 const gdouble ges_title_source_get_ypos (GESTitleSource *source);
+gboolean ges_title_source_get_pre_rendered (GESTitleSource *source);
 
 G_END_DECLS
 
@@ -0,0 +1,191 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Records how long the expensive GES operations take, without going
+ * through the debug log.
+ *
+ * Tracing is enabled by setting GES_TRACE_FILE to the path of a file, the
+ * spans are then kept in a ring buffer of GES_TRACE_BUFFER_SIZE events
+ * (65536 by default, the oldest ones being overwritten) and written to that
+ * file when the process exits, in the Chrome trace event JSON format that
+ * chrome://tracing and Perfetto can open.
+ *
+ * When tracing is disabled GES_TRACE_BEGIN() costs a single test of a
+ * global boolean. When it is enabled recording a span takes no lock, each
+ * thread reserves its slot in the ring with an atomic increment, fills it
+ * and only then publishes the event name, so that the writer skips the
+ * events that are still being recorded.
+ *
+ * Operations that complete on another thread than the one that started
+ * them are recorded as a pair of asynchronous begin and end events,
+ * matched by their id, see GES_TRACE_ASYNC_BEGIN().
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include "ges-internal.h"
+
+#define DEFAULT_BUFFER_SIZE (1 << 16)
+
+typedef struct
+{
+  /* NULL while the slot is being filled */
+  const gchar *name;
+  gint64 start;
+  gint64 end;
+  gconstpointer id;
+  guint thread;
+  /* 'X' for complete spans, 'b' and 'e' for asynchronous ones */
+  gchar phase;
+} TraceEvent;
+
+gboolean _ges_tracing_enabled = FALSE;
+
+static gchar *trace_file = NULL;
+static TraceEvent *events = NULL;
+static guint n_events = 0;
+static volatile gint next_event = 0;
+static volatile gint next_thread = 0;
+static gint64 origin = 0;
+static GPrivate thread_id;
+
+static guint
+_get_thread_id (void)
+{
+  guint id = GPOINTER_TO_UINT (g_private_get (&thread_id));
+
+  /* 0 means the thread has no id yet */
+  if (G_UNLIKELY (id == 0)) {
+    id = g_atomic_int_add (&next_thread, 1) + 1;
+    g_private_set (&thread_id, GUINT_TO_POINTER (id));
+  }
+
+  return id;
+}
+
+static void
+_record_event (const gchar * name, gchar phase, gconstpointer id,
+    gint64 start, gint64 end)
+{
+  TraceEvent *event;
+  guint index = (guint) g_atomic_int_add (&next_event, 1);
+
+  event = &events[index % n_events];
+  g_atomic_pointer_set (&event->name, NULL);
+  event->phase = phase;
+  event->id = id;
+  event->start = start;
+  event->end = end;
+  event->thread = _get_thread_id ();
+  g_atomic_pointer_set (&event->name, name);
+}
+
+void
+ges_tracing_record (const gchar * name, gint64 start, gint64 end)
+{
+  _record_event (name, 'X', NULL, start, end);
+}
+
+void
+ges_tracing_record_async (const gchar * name, gconstpointer id,
+    gboolean begin)
+{
+  gint64 now = g_get_monotonic_time ();
+
+  _record_event (name, begin ? 'b' : 'e', id, now, now);
+}
+
+static void
+_write_trace (void)
+{
+  FILE *file;
+  guint i, first, count, total;
+  gboolean needs_comma = FALSE;
+
+  total = (guint) g_atomic_int_get (&next_event);
+  count = MIN (total, n_events);
+  first = total - count;
+
+  file = fopen (trace_file, "w");
+  if (file == NULL) {
+    g_printerr ("GES: could not write trace to %s: %s\n", trace_file,
+        g_strerror (errno));
+    return;
+  }
+
+  fprintf (file, "{\"traceEvents\":[\n");
+  for (i = first; i < total; i++) {
+    TraceEvent *slot = &events[i % n_events];
+    const gchar *name = g_atomic_pointer_get (&slot->name);
+    TraceEvent event;
+
+    /* Other threads might still be recording, skip the events that are
+     * being filled, or that started being overwritten while we copied them */
+    if (name == NULL)
+      continue;
+    event = *slot;
+    if (g_atomic_pointer_get (&slot->name) != name)
+      continue;
+
+    fprintf (file, "%s{\"name\":\"%s\",\"cat\":\"ges\",\"ph\":\"%c\","
+        "\"ts\":%" G_GINT64_FORMAT, needs_comma ? ",\n" : "", name,
+        event.phase, event.start - origin);
+    if (event.phase == 'X')
+      fprintf (file, ",\"dur\":%" G_GINT64_FORMAT, event.end - event.start);
+    else
+      fprintf (file, ",\"id\":\"%p\"", event.id);
+    fprintf (file, ",\"pid\":1,\"tid\":%u}", event.thread);
+    needs_comma = TRUE;
+  }
+  fprintf (file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+  fclose (file);
+
+  if (total > n_events)
+    g_printerr ("GES: trace buffer full, the first %u spans were dropped\n",
+        total - n_events);
+}
+
+void
+ges_tracing_init (void)
+{
+  const gchar *env;
+
+  env = g_getenv ("GES_TRACE_FILE");
+  if (env == NULL || *env == '\0')
+    return;
+
+  n_events = DEFAULT_BUFFER_SIZE;
+  env = g_getenv ("GES_TRACE_BUFFER_SIZE");
+  if (env) {
+    guint64 size = g_ascii_strtoull (env, NULL, 10);
+
+    if (size > 0 && size <= G_MAXINT)
+      n_events = size;
+  }
+
+  trace_file = g_strdup (g_getenv ("GES_TRACE_FILE"));
+  events = g_new0 (TraceEvent, n_events);
+  origin = g_get_monotonic_time ();
+  atexit (_write_trace);
+
+  _ges_tracing_enabled = TRUE;
+  GST_INFO ("Tracing to %s, keeping up to %u spans", trace_file, n_events);
+}
@@ -36,6 +36,8 @@
 #include "ges-clip.h"
 #include "ges-meta-container.h"
 #include <gobject/gvaluecollector.h>
+#include <string.h>
+#include <math.h>
 
 G_DEFINE_ABSTRACT_TYPE (GESTrackElement, ges_track_element,
     GES_TYPE_TIMELINE_ELEMENT);
@@ -59,6 +61,11 @@ struct _GESTrackElementPrivate
    * {GParamaSpec ---> element,}*/
   GHashTable *children_props;
 
+  /* Index of children_props by name, the keys are the quarks of both the
+   * property name and "TypeName::property-name" (first child wins)
+   * {GQuark ---> GParamSpec,} */
+  GHashTable *children_props_by_name;
+
   GESTrack *track;
 
   gboolean valid;
@@ -69,6 +76,9 @@ struct _GESTrackElementPrivate
                                            and deserialize keyframes */
 
   GList *pending_bindings;
+
+  /* Children properties values to set once the gnlobject is created */
+  GList *pending_children_props;
 };
 
 typedef struct
@@ -79,6 +89,15 @@ typedef struct
   gchar *binding_type;
 } PendingBinding;
 
+typedef struct
+{
+  GParamSpec *pspec;
+  GValue value;
+} PendingChildProperty;
+
+static void _free_pending_binding (PendingBinding * pend);
+static void _free_pending_child_property (PendingChildProperty * pend);
+
 enum
 {
   PROP_0,
@@ -165,10 +184,18 @@ ges_track_element_dispose (GObject * object)
   GESTrackElement *element = GES_TRACK_ELEMENT (object);
   GESTrackElementPrivate *priv = element->priv;
 
+  g_hash_table_destroy (priv->children_props_by_name);
   g_hash_table_destroy (priv->children_props);
   if (priv->bindings_hashtable)
     g_hash_table_destroy (priv->bindings_hashtable);
 
+  g_list_free_full (priv->pending_bindings,
+      (GDestroyNotify) _free_pending_binding);
+  priv->pending_bindings = NULL;
+  g_list_free_full (priv->pending_children_props,
+      (GDestroyNotify) _free_pending_child_property);
+  priv->pending_children_props = NULL;
+
   if (priv->gnlobject) {
     GstState cstate;
 
@@ -279,7 +306,8 @@ ges_track_element_init (GESTrackElement * self)
   priv->children_props =
       g_hash_table_new_full ((GHashFunc) ges_pspec_hash, ges_pspec_equal,
       (GDestroyNotify) g_param_spec_unref, gst_object_unref);
-
+  priv->children_props_by_name = g_hash_table_new (g_direct_hash,
+      g_direct_equal);
 }
 
 static gfloat
@@ -307,92 +335,176 @@ interpolate_values_for_position (GstTimedValue * first_value,
   return value_at_pos;
 }
 
-static void
-_update_control_bindings (GESTimelineElement * element, GstClockTime inpoint,
-    GstClockTime duration)
+/* Control points are only read with the iterator API under the source lock,
+ * and only changed through the GstTimedValueControlSource methods, which
+ * take that lock themselves and keep its cached state valid */
+
+/* Returns the first control point of @source, %NULL if it has none. Must be
+ * called with the source lock taken */
+static GSequenceIter *
+_first_control_point_iter (GstTimedValueControlSource * source)
 {
-  GParamSpec **specs;
-  guint n, n_specs;
-  GstControlBinding *binding;
-  GstTimedValueControlSource *source;
-  GESTrackElement *self = GES_TRACK_ELEMENT (element);
+  GSequenceIter *first;
 
-  specs = ges_track_element_list_children_properties (self, &n_specs);
+  /* The values sequence is only created when the first point is set */
+  if (source->values == NULL)
+    return NULL;
 
-  for (n = 0; n < n_specs; ++n) {
-    GList *values, *tmp;
-    GstTimedValue *last, *first, *prev = NULL, *next = NULL;
-    gfloat value_at_pos;
+  first = g_sequence_get_begin_iter (source->values);
+  if (g_sequence_iter_is_end (first))
+    return NULL;
 
-    binding = ges_track_element_get_control_binding (self, specs[n]->name);
+  return first;
+}
 
-    if (!binding)
-      continue;
+/* Value of @source at @position, interpolated between the control points
+ * around it, or extrapolated from the first (last) ones if @position is
+ * before (after) them. @source must have control points, and the source
+ * lock must be taken */
+static gfloat
+_value_at_position (GstTimedValueControlSource * source, GstClockTime position)
+{
+  GSequenceIter *iter, *next_iter;
+  GstTimedValue *prev, *next;
+
+  iter = gst_timed_value_control_source_find_control_point_iter (source,
+      position);
+  if (iter == NULL)
+    iter = _first_control_point_iter (source);
+
+  /* Extrapolate from the two last points after the end */
+  next_iter = g_sequence_iter_next (iter);
+  if (g_sequence_iter_is_end (next_iter) && !g_sequence_iter_is_begin (iter)) {
+    next_iter = iter;
+    iter = g_sequence_iter_prev (iter);
+  }
 
-    g_object_get (binding, "control_source", &source, NULL);
+  prev = g_sequence_get (iter);
+  next = g_sequence_iter_is_end (next_iter) ? prev : g_sequence_get (next_iter);
 
-    if (duration == 0) {
-      gst_timed_value_control_source_unset_all (GST_TIMED_VALUE_CONTROL_SOURCE
-          (source));
-      continue;
-    }
+  if (prev->timestamp == next->timestamp)
+    return prev->value;
 
-    values =
-        gst_timed_value_control_source_get_all (GST_TIMED_VALUE_CONTROL_SOURCE
-        (source));
+  return interpolate_values_for_position (prev, next, position);
+}
 
-    if (g_list_length (values) == 0)
-      continue;
+/* Appends the timestamps of the control points in [@begin, @end) to
+ * @timestamps, with the source lock taken */
+static void
+_collect_control_points (GSequenceIter * begin, GSequenceIter * end,
+    GArray * timestamps)
+{
+  GSequenceIter *iter;
 
-    first = values->data;
+  for (iter = begin; iter != end; iter = g_sequence_iter_next (iter))
+    g_array_append_val (timestamps,
+        ((GstTimedValue *) g_sequence_get (iter))->timestamp);
+}
 
-    for (tmp = values->next; tmp; tmp = tmp->next) {
-      next = tmp->data;
+/* Removes the control points at @timestamps, without the source lock */
+static void
+_remove_control_points (GstTimedValueControlSource * source,
+    const GstClockTime * timestamps, guint n_timestamps)
+{
+  guint i;
 
-      if (next->timestamp > inpoint)
-        break;
-    }
+  for (i = 0; i < n_timestamps; i++)
+    gst_timed_value_control_source_unset (source, timestamps[i]);
+}
 
-    value_at_pos = interpolate_values_for_position (first, next, inpoint);
-    gst_timed_value_control_source_unset (source, first->timestamp);
-    gst_timed_value_control_source_set (source, inpoint, value_at_pos);
+/* Returns the first control point at or after @position, with the source
+ * lock taken */
+static GSequenceIter *
+_control_point_iter_from (GstTimedValueControlSource * source,
+    GstClockTime position)
+{
+  GSequenceIter *iter =
+      gst_timed_value_control_source_find_control_point_iter (source,
+      position);
 
-    values =
-        gst_timed_value_control_source_get_all (GST_TIMED_VALUE_CONTROL_SOURCE
-        (source));
+  if (iter == NULL)
+    return _first_control_point_iter (source);
 
-    if (duration != GST_CLOCK_TIME_NONE) {
-      last = g_list_last (values)->data;
+  if (((GstTimedValue *) g_sequence_get (iter))->timestamp == position)
+    return iter;
 
-      for (tmp = g_list_last (values)->prev; tmp; tmp = tmp->prev) {
-        prev = tmp->data;
+  return g_sequence_iter_next (iter);
+}
 
-        if (prev->timestamp < duration + inpoint)
-          break;
-      }
+/* Restricts the control points of @source to [inpoint, inpoint + duration],
+ * adding points at the boundaries so the automation curve is kept.
+ * Finding the boundaries is O(log n), but the k removed points are then
+ * unset one by one through the public API, so this is O(k log n) */
+static void
+_window_control_source (GstTimedValueControlSource * source,
+    GstClockTime inpoint, GstClockTime duration)
+{
+  GArray *removed;
+  GSequenceIter *first;
+  gfloat value_at_inpoint, value_at_end = 0;
+  GstClockTime end = GST_CLOCK_TIME_NONE;
+
+  g_mutex_lock (&source->lock);
+  first = _first_control_point_iter (source);
+  if (first == NULL) {
+    g_mutex_unlock (&source->lock);
+    return;
+  }
 
-      value_at_pos =
-          interpolate_values_for_position (prev, last, duration + inpoint);
+  value_at_inpoint = _value_at_position (source, inpoint);
+  if (duration != GST_CLOCK_TIME_NONE) {
+    end = inpoint + duration;
+    value_at_end = _value_at_position (source, end);
+  }
 
-      gst_timed_value_control_source_unset (source, last->timestamp);
-      gst_timed_value_control_source_set (source, duration + inpoint,
-          value_at_pos);
-      values =
-          gst_timed_value_control_source_get_all (GST_TIMED_VALUE_CONTROL_SOURCE
-          (source));
-    }
+  /* Points outside the window, as well as those on its boundaries which
+   * get replaced right after */
+  removed = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  _collect_control_points (first,
+      _control_point_iter_from (source, inpoint + 1), removed);
+  if (GST_CLOCK_TIME_IS_VALID (end))
+    _collect_control_points (_control_point_iter_from (source, end),
+        g_sequence_get_end_iter (source->values), removed);
+  g_mutex_unlock (&source->lock);
+
+  _remove_control_points (source, (GstClockTime *) removed->data,
+      removed->len);
+  g_array_free (removed, TRUE);
+
+  gst_timed_value_control_source_set (source, inpoint, value_at_inpoint);
+  if (GST_CLOCK_TIME_IS_VALID (end))
+    gst_timed_value_control_source_set (source, end, value_at_end);
+}
 
-    for (tmp = values; tmp; tmp = tmp->next) {
-      GstTimedValue *value = tmp->data;
-      if (value->timestamp < inpoint)
-        gst_timed_value_control_source_unset (source, value->timestamp);
-      else if (duration != GST_CLOCK_TIME_NONE
-          && value->timestamp > duration + inpoint)
-        gst_timed_value_control_source_unset (source, value->timestamp);
+static void
+_update_control_bindings (GESTimelineElement * element, GstClockTime inpoint,
+    GstClockTime duration)
+{
+  GHashTableIter iter;
+  gpointer binding;
+  GstControlSource *source;
+  GESTrackElement *self = GES_TRACK_ELEMENT (element);
+
+  /* Only go over the properties that are actually bound */
+  g_hash_table_iter_init (&iter, self->priv->bindings_hashtable);
+  while (g_hash_table_iter_next (&iter, NULL, &binding)) {
+    g_object_get (binding, "control_source", &source, NULL);
+
+    if (!GST_IS_TIMED_VALUE_CONTROL_SOURCE (source)) {
+      if (source)
+        gst_object_unref (source);
+      continue;
     }
-  }
 
-  g_free (specs);
+    if (duration == 0)
+      gst_timed_value_control_source_unset_all (GST_TIMED_VALUE_CONTROL_SOURCE
+          (source));
+    else
+      _window_control_source (GST_TIMED_VALUE_CONTROL_SOURCE (source),
+          inpoint, duration);
+
+    gst_object_unref (source);
+  }
 }
 
 static gboolean
@@ -698,6 +810,20 @@ ensure_gnl_object (GESTrackElement * object)
       g_object_set (object->priv->gnlobject,
           "caps", ges_track_get_caps (object->priv->track), NULL);
 
+    /* Children properties copied before the element existed */
+    if (object->priv->pending_children_props) {
+      GList *tmp;
+
+      for (tmp = object->priv->pending_children_props; tmp; tmp = tmp->next) {
+        PendingChildProperty *pend = tmp->data;
+
+        ges_track_element_set_child_property_by_pspec (object, pend->pspec,
+            &pend->value);
+      }
+      g_list_free_full (object->priv->pending_children_props,
+          (GDestroyNotify) _free_pending_child_property);
+      object->priv->pending_children_props = NULL;
+    }
   }
 
 done:
@@ -724,6 +850,75 @@ strv_find_str (const gchar ** strv, const char *str)
   return FALSE;
 }
 
+static void
+_index_child_prop (GESTrackElement * self, GQuark quark, GParamSpec * pspec)
+{
+  if (g_hash_table_lookup (self->priv->children_props_by_name,
+          GUINT_TO_POINTER (quark)) == NULL)
+    g_hash_table_insert (self->priv->children_props_by_name,
+        GUINT_TO_POINTER (quark), pspec);
+}
+
+static void
+_add_child_prop (GESTrackElement * self, GParamSpec * pspec,
+    GstElement * child)
+{
+  gchar *fullname;
+
+  g_hash_table_insert (self->priv->children_props, g_param_spec_ref (pspec),
+      gst_object_ref (child));
+
+  fullname = g_strdup_printf ("%s::%s", G_OBJECT_TYPE_NAME (child),
+      pspec->name);
+  _index_child_prop (self, g_quark_from_string (pspec->name), pspec);
+  _index_child_prop (self, g_quark_from_string (fullname), pspec);
+  g_free (fullname);
+}
+
+/* For subclasses which already know which properties of @child to expose,
+ * see ges_track_element_add_children_props */
+void
+ges_track_element_add_child_property (GESTrackElement * self,
+    GParamSpec * pspec, GstElement * child)
+{
+  _add_child_prop (self, pspec, child);
+  connect_signal (pspec, child, self);
+}
+
+/* Returns borrowed references. All known names were interned when
+ * indexing, so unknown ones are rejected right away */
+static gboolean
+_lookup_child (GESTrackElement * self, const gchar * prop_name,
+    GstElement ** element, GParamSpec ** pspec)
+{
+  GParamSpec *spec;
+  const gchar *sep, *type_name;
+  GQuark quark = g_quark_try_string (prop_name);
+
+  if (quark == 0)
+    return FALSE;
+
+  spec = g_hash_table_lookup (self->priv->children_props_by_name,
+      GUINT_TO_POINTER (quark));
+  if (spec == NULL)
+    return FALSE;
+
+  *pspec = spec;
+  *element = g_hash_table_lookup (self->priv->children_props, spec);
+
+  /* Children of different types can share a pspec (inherited properties),
+   * only the last one added is reachable */
+  sep = strstr (prop_name, "::");
+  if (sep) {
+    type_name = G_OBJECT_TYPE_NAME (*element);
+    if (strlen (type_name) != sep - prop_name ||
+        strncmp (prop_name, type_name, sep - prop_name))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
 /**
  * ges_track_element_add_children_props:
  * @self: The #GESTrackElement to set chidlren props on
@@ -770,8 +965,7 @@ ges_track_element_add_children_props (GESTrackElement * self,
       }
 
       if (pspec->flags & G_PARAM_WRITABLE) {
-        g_hash_table_insert (self->priv->children_props,
-            g_param_spec_ref (pspec), gst_object_ref (element));
+        _add_child_prop (self, pspec, element);
         GST_LOG_OBJECT (self,
             "added property %s to controllable properties successfully !",
             whitelist[i]);
@@ -821,8 +1015,7 @@ ges_track_element_add_children_props (GESTrackElement * self,
             for (i = 0; i < nb_specs; i++) {
               if ((parray[i]->flags & G_PARAM_WRITABLE) &&
                   (!whitelist || strv_find_str (whitelist, parray[i]->name))) {
-                g_hash_table_insert (self->priv->children_props,
-                    g_param_spec_ref (parray[i]), gst_object_ref (child));
+                _add_child_prop (self, parray[i], child);
               }
             }
             g_free (parray);
@@ -863,9 +1056,20 @@ ges_track_element_add_children_props (GESTrackElement * self,
 static void
 _free_pending_binding (PendingBinding * pend)
 {
+  gst_object_unref (pend->source);
+  g_free (pend->propname);
+  g_free (pend->binding_type);
   g_slice_free (PendingBinding, pend);
 }
 
+static void
+_free_pending_child_property (PendingChildProperty * pend)
+{
+  g_param_spec_unref (pend->pspec);
+  g_value_unset (&pend->value);
+  g_slice_free (PendingChildProperty, pend);
+}
+
 gboolean
 ges_track_element_set_track (GESTrackElement * object, GESTrack * track)
 {
@@ -892,8 +1096,6 @@ ges_track_element_set_track (GESTrackElement * object, GESTrack * track)
           pbinding = tmp->data;
           ges_track_element_set_control_source (pbinding->element,
               pbinding->source, pbinding->propname, pbinding->binding_type);
-          g_free (pbinding->propname);
-          g_free (pbinding->binding_type);
         }
         g_list_free_full (object->priv->pending_bindings,
             (GDestroyNotify) _free_pending_binding);
@@ -1018,41 +1220,53 @@ gboolean
 ges_track_element_lookup_child (GESTrackElement * object,
     const gchar * prop_name, GstElement ** element, GParamSpec ** pspec)
 {
-  GHashTableIter iter;
-  gpointer key, value;
-  gchar **names, *name, *classename;
-  gboolean res;
+  GstElement *child;
+  GParamSpec *spec;
 
   g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
+  g_return_val_if_fail (prop_name, FALSE);
 
-  classename = NULL;
-  res = FALSE;
+  if (!_lookup_child (object, prop_name, &child, &spec))
+    return FALSE;
 
-  names = g_strsplit (prop_name, "::", 2);
-  if (names[1] != NULL) {
-    classename = names[0];
-    name = names[1];
-  } else
-    name = names[0];
+  GST_DEBUG ("The %s property has been found", prop_name);
+  if (element)
+    *element = gst_object_ref (child);
+  if (pspec)
+    *pspec = g_param_spec_ref (spec);
 
-  g_hash_table_iter_init (&iter, object->priv->children_props);
-  while (g_hash_table_iter_next (&iter, &key, &value)) {
-    if (g_strcmp0 (G_PARAM_SPEC (key)->name, name) == 0) {
-      if (classename == NULL ||
-          g_strcmp0 (G_OBJECT_TYPE_NAME (G_OBJECT (value)), classename) == 0) {
-        GST_DEBUG ("The %s property from %s has been found", name, classename);
-        if (element)
-          *element = gst_object_ref (value);
-
-        *pspec = g_param_spec_ref (key);
-        res = TRUE;
-        break;
-      }
-    }
-  }
-  g_strfreev (names);
+  return TRUE;
+}
 
-  return res;
+/**
+ * ges_track_element_lookup_child_pspec:
+ * @object: object to lookup the property in
+ * @prop_name: name of the property to look up, see
+ *     #ges_track_element_lookup_child
+ *
+ * Resolves @prop_name once so that it can then be set and get many times
+ * with #ges_track_element_set_child_property_by_pspec and
+ * #ges_track_element_get_child_property_by_pspec without any further
+ * name lookup.
+ *
+ * Returns: (transfer none): The #GParamSpec of the child property, valid as
+ * long as @object is alive, or %NULL if no child of @object has such a
+ * property.
+ */
+GParamSpec *
+ges_track_element_lookup_child_pspec (GESTrackElement * object,
+    const gchar * prop_name)
+{
+  GstElement *child;
+  GParamSpec *spec;
+
+  g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), NULL);
+  g_return_val_if_fail (prop_name, NULL);
+
+  if (!_lookup_child (object, prop_name, &child, &spec))
+    return NULL;
+
+  return spec;
 }
 
 /**
@@ -1118,7 +1332,7 @@ ges_track_element_set_child_property_valist (GESTrackElement * object,
 
   /* iterate over pairs */
   while (name) {
-    if (!ges_track_element_lookup_child (object, name, &element, &pspec))
+    if (!_lookup_child (object, name, &element, &pspec))
       goto not_found;
 
 #if GLIB_CHECK_VERSION(2,23,3)
@@ -1134,7 +1348,6 @@ ges_track_element_set_child_property_valist (GESTrackElement * object,
 
     g_object_set_property (G_OBJECT (element), pspec->name, &value);
 
-    gst_object_unref (element);
     g_value_unset (&value);
 
     name = va_arg (var_args, gchar *);
@@ -1209,12 +1422,11 @@ ges_track_element_get_child_property_valist (GESTrackElement * object,
 
   /* This part is in big part copied from the gst_child_object_get_valist method */
   while (name) {
-    if (!ges_track_element_lookup_child (object, name, &element, &pspec))
+    if (!_lookup_child (object, name, &element, &pspec))
       goto not_found;
 
     g_value_init (&value, pspec->value_type);
     g_object_get_property (G_OBJECT (element), pspec->name, &value);
-    gst_object_unref (element);
 
     G_VALUE_LCOPY (&value, var_args, 0, &error);
     if (error)
@@ -1339,14 +1551,11 @@ ges_track_element_set_child_property (GESTrackElement * object,
 
   g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
 
-  if (!ges_track_element_lookup_child (object, property_name, &element, &pspec))
+  if (!_lookup_child (object, property_name, &element, &pspec))
     goto not_found;
 
   g_object_set_property (G_OBJECT (element), pspec->name, value);
 
-  gst_object_unref (element);
-  g_param_spec_unref (pspec);
-
   return TRUE;
 
 not_found:
@@ -1385,7 +1594,7 @@ ges_track_element_get_child_property (GESTrackElement * object,
 
   g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
 
-  if (!ges_track_element_lookup_child (object, property_name, &element, &pspec))
+  if (!_lookup_child (object, property_name, &element, &pspec))
     goto not_found;
 
   if (G_VALUE_TYPE (value) == G_TYPE_INVALID)
@@ -1393,9 +1602,6 @@ ges_track_element_get_child_property (GESTrackElement * object,
 
   g_object_get_property (G_OBJECT (element), pspec->name, value);
 
-  gst_object_unref (element);
-  g_param_spec_unref (pspec);
-
   return TRUE;
 
 not_found:
@@ -1429,6 +1635,9 @@ default_list_children_properties (GESTrackElement * object,
   return pspec;
 }
 
+/* If @elementcopy has not created its gnlobject yet, the values are only
+ * recorded and set when it gets created, so copying a track element does not
+ * force building its GstElement-s */
 void
 ges_track_element_copy_properties (GESTimelineElement * element,
     GESTimelineElement * elementcopy)
@@ -1438,92 +1647,124 @@ ges_track_element_copy_properties (GESTimelineElement * element,
   GValue val = { 0 };
   GESTrackElement *copy = GES_TRACK_ELEMENT (elementcopy);
 
-  ensure_gnl_object (copy);
   specs =
       ges_track_element_list_children_properties (GES_TRACK_ELEMENT (element),
       &n_specs);
   for (n = 0; n < n_specs; ++n) {
+    if (copy->priv->gnlobject == NULL) {
+      PendingChildProperty *pend = g_slice_new0 (PendingChildProperty);
+
+      pend->pspec = specs[n];
+      g_value_init (&pend->value, specs[n]->value_type);
+      ges_track_element_get_child_property_by_pspec (GES_TRACK_ELEMENT
+          (element), specs[n], &pend->value);
+      copy->priv->pending_children_props =
+          g_list_prepend (copy->priv->pending_children_props, pend);
+
+      continue;
+    }
+
     g_value_init (&val, specs[n]->value_type);
     ges_track_element_get_child_property_by_pspec (GES_TRACK_ELEMENT (element),
         specs[n], &val);
     ges_track_element_set_child_property_by_pspec (copy, specs[n], &val);
     g_value_unset (&val);
+    g_param_spec_unref (specs[n]);
   }
+  copy->priv->pending_children_props =
+      g_list_reverse (copy->priv->pending_children_props);
 
   g_free (specs);
 }
 
+/* Moves the control points of @source after @position to the empty
+ * @new_source, both get a control point at @position so the curve is kept.
+ * The points are moved in one pass, without sorted insertions */
+static void
+_split_control_source (GstTimedValueControlSource * source,
+    GstTimedValueControlSource * new_source, GstClockTime position)
+{
+  guint i, n_moved;
+  gdouble *values;
+  gfloat value_at_pos;
+  GstClockTime *timestamps;
+  GSequenceIter *iter, *begin;
+
+  g_mutex_lock (&source->lock);
+  if (_first_control_point_iter (source) == NULL) {
+    g_mutex_unlock (&source->lock);
+    return;
+  }
+
+  begin = _control_point_iter_from (source, position + 1);
+  n_moved = g_sequence_get_length (g_sequence_iter_get_sequence (begin)) -
+      g_sequence_iter_get_position (begin);
+  if (n_moved == 0) {
+    g_mutex_unlock (&source->lock);
+    return;
+  }
+
+  value_at_pos = _value_at_position (source, position);
+
+  timestamps = g_new (GstClockTime, n_moved + 1);
+  values = g_new (gdouble, n_moved + 1);
+  timestamps[0] = position;
+  values[0] = value_at_pos;
+  for (i = 1, iter = begin; !g_sequence_iter_is_end (iter);
+      iter = g_sequence_iter_next (iter), i++) {
+    GstControlPoint *cp = g_sequence_get (iter);
+
+    timestamps[i] = cp->timestamp;
+    values[i] = cp->value;
+  }
+  g_mutex_unlock (&source->lock);
+
+  /* All the moved points, the one at @position is replaced */
+  _remove_control_points (source, timestamps + 1, n_moved);
+  gst_timed_value_control_source_set (source, position, value_at_pos);
+  ges_control_source_set_keyframes (new_source, timestamps, values,
+      n_moved + 1);
+
+  g_free (timestamps);
+  g_free (values);
+}
+
 void
 ges_track_element_split_bindings (GESTrackElement * element,
     GESTrackElement * new_element, guint64 position)
 {
-  GParamSpec **specs;
-  guint n, n_specs;
-  GstControlBinding *binding;
-  GstTimedValueControlSource *source, *new_source;
+  GHashTableIter iter;
+  gpointer key, binding;
 
-  specs =
-      ges_track_element_list_children_properties (GES_TRACK_ELEMENT (element),
-      &n_specs);
-  for (n = 0; n < n_specs; ++n) {
-    GList *values, *tmp;
-    GstTimedValue *last_value = NULL;
-    gboolean past_position = FALSE;
+  /* Only go over the properties that are actually bound */
+  g_hash_table_iter_init (&iter, element->priv->bindings_hashtable);
+  while (g_hash_table_iter_next (&iter, &key, &binding)) {
+    GstControlSource *source, *new_source;
     GstInterpolationMode mode;
 
-    binding = ges_track_element_get_control_binding (element, specs[n]->name);
-    if (!binding)
-      continue;
-
     g_object_get (binding, "control_source", &source, NULL);
 
     /* FIXME : this should work as well with other types of control sources */
-    if (!GST_IS_TIMED_VALUE_CONTROL_SOURCE (source))
+    if (!GST_IS_TIMED_VALUE_CONTROL_SOURCE (source)) {
+      if (source)
+        gst_object_unref (source);
       continue;
+    }
 
-    new_source =
-        GST_TIMED_VALUE_CONTROL_SOURCE (gst_interpolation_control_source_new
-        ());
-
+    new_source = gst_interpolation_control_source_new ();
     g_object_get (source, "mode", &mode, NULL);
     g_object_set (new_source, "mode", mode, NULL);
 
-    values =
-        gst_timed_value_control_source_get_all (GST_TIMED_VALUE_CONTROL_SOURCE
-        (source));
-    for (tmp = values; tmp; tmp = tmp->next) {
-      GstTimedValue *value = tmp->data;
-      if (value->timestamp > position) {
-        gfloat value_at_pos;
-
-        /* FIXME We should be able to use gst_control_source_get_value so
-         * all modes are handled. Right now that method only works if the value
-         * we are looking for is between two actual keyframes which is not enough
-         * in our case. bug #706621 */
-        value_at_pos =
-            interpolate_values_for_position (last_value, value, position);
-
-        past_position = TRUE;
-
-        gst_timed_value_control_source_set (new_source, position, value_at_pos);
-        gst_timed_value_control_source_set (new_source, value->timestamp,
-            value->value);
-        gst_timed_value_control_source_unset (source, value->timestamp);
-        gst_timed_value_control_source_set (source, position, value_at_pos);
-      } else if (past_position) {
-        gst_timed_value_control_source_unset (source, value->timestamp);
-        gst_timed_value_control_source_set (new_source, value->timestamp,
-            value->value);
-      }
-      last_value = value;
-    }
+    _split_control_source (GST_TIMED_VALUE_CONTROL_SOURCE (source),
+        GST_TIMED_VALUE_CONTROL_SOURCE (new_source), position);
 
     /* We only manage direct bindings, see TODO in set_control_source */
-    ges_track_element_set_control_source (new_element,
-        GST_CONTROL_SOURCE (new_source), specs[n]->name, "direct");
-  }
+    ges_track_element_set_control_source (new_element, new_source,
+        (const gchar *) key, "direct");
 
-  g_free (specs);
+    gst_object_unref (new_source);
+    gst_object_unref (source);
+  }
 }
 
 /**
@@ -1630,7 +1871,7 @@ ges_track_element_set_control_source (GESTrackElement * object,
     GST_INFO ("Adding this source to the future bindings");
     pbinding = g_slice_new0 (PendingBinding);
     pbinding->element = object;
-    pbinding->source = source;
+    pbinding->source = gst_object_ref (source);
     pbinding->propname = g_strdup (property_name);
     pbinding->binding_type = g_strdup (binding_type);
     priv->pending_bindings = g_list_append (priv->pending_bindings, pbinding);
@@ -1694,3 +1935,173 @@ ges_track_element_get_control_binding (GESTrackElement * object,
       property_name);
   return binding;
 }
+
+/* Replaces all the control points of @source. Keyframes with an invalid
+ * timestamp or value are skipped and values out of [0, 1] are clamped, with
+ * a warning for each. Returns %FALSE if any keyframe had to be changed */
+gboolean
+ges_control_source_set_keyframes (GstTimedValueControlSource * source,
+    const GstClockTime * timestamps, const gdouble * values, guint n_keyframes)
+{
+  guint i;
+  gboolean ret = TRUE;
+
+  gst_timed_value_control_source_unset_all (source);
+
+  for (i = 0; i < n_keyframes; i++) {
+    gdouble value = values[i];
+
+    if (!GST_CLOCK_TIME_IS_VALID (timestamps[i]) || isnan (value)) {
+      GST_WARNING ("Skipping invalid keyframe %u: %" GST_TIME_FORMAT " -> %f",
+          i, GST_TIME_ARGS (timestamps[i]), value);
+      ret = FALSE;
+      continue;
+    }
+
+    if (value < 0.0 || value > 1.0) {
+      GST_WARNING ("Clamping the value of keyframe %u at %" GST_TIME_FORMAT
+          ": %f not in [0, 1]", i, GST_TIME_ARGS (timestamps[i]), value);
+      value = CLAMP (value, 0.0, 1.0);
+      ret = FALSE;
+    }
+
+    gst_timed_value_control_source_set (source, timestamps[i], value);
+  }
+
+  return ret;
+}
+
+/* Copies the control points of @source in newly allocated arrays */
+void
+ges_control_source_get_keyframes (GstTimedValueControlSource * source,
+    GstClockTime ** timestamps, gdouble ** values, guint * n_keyframes)
+{
+  guint i = 0;
+  GList *points, *tmp;
+
+  points = gst_timed_value_control_source_get_all (source);
+  *n_keyframes = g_list_length (points);
+  *timestamps = g_new (GstClockTime, *n_keyframes);
+  *values = g_new (gdouble, *n_keyframes);
+
+  for (tmp = points; tmp; tmp = tmp->next) {
+    GstTimedValue *point = tmp->data;
+
+    (*timestamps)[i] = point->timestamp;
+    (*values)[i] = point->value;
+    i++;
+  }
+  g_list_free (points);
+}
+
+/**
+ * ges_track_element_set_keyframes:
+ * @object: the #GESTrackElement on which to set the keyframes
+ * @property_name: the child property to animate
+ * @timestamps: (array length=n_keyframes): the timestamps of the keyframes
+ * @values: (array length=n_keyframes): the values of the keyframes, between
+ * 0.0 and 1.0 as for any #GstDirectControlBinding
+ * @n_keyframes: the number of keyframes
+ *
+ * Replaces all the keyframes of @property_name with the given ones. If the
+ * property is not controlled yet, a linear #GstInterpolationControlSource
+ * is bound to it as with #ges_track_element_set_control_source.
+ *
+ * Keyframes with an invalid timestamp or a NaN value are skipped, and
+ * values out of [0.0, 1.0] are clamped, a warning being logged for each of
+ * them. The other keyframes are set in any case.
+ *
+ * Returns: %TRUE if all the keyframes have been set as given, %FALSE if
+ * @property_name can not be controlled or if some keyframes were skipped
+ * or clamped.
+ */
+gboolean
+ges_track_element_set_keyframes (GESTrackElement * object,
+    const gchar * property_name, const GstClockTime * timestamps,
+    const gdouble * values, guint n_keyframes)
+{
+  gboolean ret;
+  GstControlSource *source;
+  GstControlBinding *binding;
+
+  g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
+  g_return_val_if_fail (property_name, FALSE);
+  g_return_val_if_fail (n_keyframes == 0 || (timestamps && values), FALSE);
+
+  binding = ges_track_element_get_control_binding (object, property_name);
+  if (binding) {
+    g_object_get (binding, "control_source", &source, NULL);
+    if (!GST_IS_TIMED_VALUE_CONTROL_SOURCE (source)) {
+      GST_WARNING_OBJECT (object, "%s is not controlled by a timed value "
+          "control source", property_name);
+      if (source)
+        gst_object_unref (source);
+
+      return FALSE;
+    }
+
+    ret = ges_control_source_set_keyframes (GST_TIMED_VALUE_CONTROL_SOURCE
+        (source), timestamps, values, n_keyframes);
+    gst_object_unref (source);
+
+    return ret;
+  }
+
+  source = gst_interpolation_control_source_new ();
+  g_object_set (source, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+  ret = ges_control_source_set_keyframes (GST_TIMED_VALUE_CONTROL_SOURCE
+      (source), timestamps, values, n_keyframes);
+  if (!ges_track_element_set_control_source (object, source, property_name,
+          "direct"))
+    ret = FALSE;
+  gst_object_unref (source);
+
+  return ret;
+}
+
+/**
+ * ges_track_element_get_keyframes:
+ * @object: the #GESTrackElement to get the keyframes from
+ * @property_name: the controlled child property
+ * @timestamps: (out) (array length=n_keyframes) (transfer full): return
+ * location for the timestamps of the keyframes
+ * @values: (out) (array length=n_keyframes) (transfer full): return
+ * location for the values of the keyframes
+ * @n_keyframes: (out): return location for the number of keyframes
+ *
+ * Gets all the keyframes of @property_name at once, sorted by timestamp.
+ * Free @timestamps and @values with g_free() after usage.
+ *
+ * Returns: %TRUE if @property_name is controlled by a
+ * #GstTimedValueControlSource, %FALSE otherwise.
+ */
+gboolean
+ges_track_element_get_keyframes (GESTrackElement * object,
+    const gchar * property_name, GstClockTime ** timestamps,
+    gdouble ** values, guint * n_keyframes)
+{
+  GstControlSource *source;
+  GstControlBinding *binding;
+
+  g_return_val_if_fail (GES_IS_TRACK_ELEMENT (object), FALSE);
+  g_return_val_if_fail (property_name, FALSE);
+  g_return_val_if_fail (timestamps && values && n_keyframes, FALSE);
+
+  binding = ges_track_element_get_control_binding (object, property_name);
+  if (binding == NULL)
+    return FALSE;
+
+  g_object_get (binding, "control_source", &source, NULL);
+  if (!GST_IS_TIMED_VALUE_CONTROL_SOURCE (source)) {
+    if (source)
+      gst_object_unref (source);
+
+    return FALSE;
+  }
+
+  ges_control_source_get_keyframes (GST_TIMED_VALUE_CONTROL_SOURCE (source),
+      timestamps, values, n_keyframes);
+  gst_object_unref (source);
+
+  return TRUE;
+}
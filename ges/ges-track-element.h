@@ -135,6 +135,10 @@ gboolean ges_track_element_lookup_child        (GESTrackElement *object,
                                                GstElement **element,
                                                GParamSpec **pspec);
 
+GParamSpec *
+ges_track_element_lookup_child_pspec           (GESTrackElement *object,
+                                               const gchar *prop_name);
+
 void
 ges_track_element_get_child_property_by_pspec (GESTrackElement * object,
                                               GParamSpec * pspec,
@@ -185,6 +189,20 @@ ges_track_element_set_control_source          (GESTrackElement *object,
 GstControlBinding *
 ges_track_element_get_control_binding         (GESTrackElement *object,
                                                const gchar *property_name);
+
+gboolean
+ges_track_element_set_keyframes               (GESTrackElement *object,
+                                               const gchar *property_name,
+                                               const GstClockTime *timestamps,
+                                               const gdouble *values,
+                                               guint n_keyframes);
+
+gboolean
+ges_track_element_get_keyframes               (GESTrackElement *object,
+                                               const gchar *property_name,
+                                               GstClockTime **timestamps,
+                                               gdouble **values,
+                                               guint *n_keyframes);
 void
 ges_track_element_add_children_props          (GESTrackElement *self,
                                                GstElement *element,
@@ -29,12 +29,24 @@
  * Wraps GNonLin's 'gnlcomposition' element.
  */
 
+#include <string.h>
+
 #include "ges-internal.h"
 #include "ges-track.h"
 #include "ges-track-element.h"
 #include "ges-meta-container.h"
 #include "ges-video-track.h"
 #include "ges-audio-track.h"
+#include "ges-video-uri-source.h"
+#include "ges-audio-uri-source.h"
+#include "ges-uri-clip.h"
+
+/* Maximum time spent warming up the caches for a source */
+#define WARM_UP_TIMEOUT (10 * GST_SECOND)
+/* How often a cache warm-up checks whether it has been cancelled */
+#define WARM_UP_POLL_INTERVAL (100 * GST_MSECOND)
+/* Maximum number of warm-ups waiting for a worker, for all the tracks */
+#define WARM_UP_MAX_QUEUED 8
 
 G_DEFINE_TYPE_WITH_CODE (GESTrack, ges_track, GST_TYPE_BIN,
     G_IMPLEMENT_INTERFACE (GES_TYPE_META_CONTAINER, NULL));
@@ -74,8 +86,41 @@ struct _GESTrackPrivate
 
   /* Virtual method to create GstElement that fill gaps */
   GESCreateElementForGapFunc create_element_for_gaps;
+
+  /* Lookahead of the upcoming sources, position, last_check,
+   * warm_up_reset and warm_up_cancellable are protected by the object
+   * lock as they are set from the streaming thread */
+  guint warm_up_count;
+  GstClockTime warm_up_window;
+  GstClockTime position;
+  GstClockTime last_check;
+  gboolean warm_up_reset;
+  guint warm_up_idle_id;
+  /* Cancelled, and replaced, on flushing seeks */
+  GCancellable *warm_up_cancellable;
+
+  /* All the elements starting before warmed_up_until have been looked
+   * at, warmed_up holds the ones starting at warmed_up_until that
+   * have */
+  GstClockTime warmed_up_until;
+  GHashTable *warmed_up;
+
+  /* Statistics, see ges_track_get_statistics() */
+  GESLatencyStats commit_stats;
+  guint64 gap_updates;
 };
 
+typedef struct
+{
+  gchar *uri;
+  GstCaps *caps;
+  GstClockTime inpoint;
+  GCancellable *cancellable;
+} WarmUpJob;
+
+static GThreadPool *warm_up_pool = NULL;
+G_LOCK_DEFINE_STATIC (warm_up_pool_lock);
+
 enum
 {
   ARG_0,
@@ -83,6 +128,8 @@ enum
   ARG_RESTRICTION_CAPS,
   ARG_TYPE,
   ARG_DURATION,
+  ARG_CACHE_WARMING_COUNT,
+  ARG_CACHE_WARMING_WINDOW,
   ARG_LAST,
   TRACK_ELEMENT_ADDED,
   TRACK_ELEMENT_REMOVED,
@@ -183,6 +230,7 @@ update_gaps (GESTrack * track)
 
   GESTrackElement *trackelement;
   GstClockTime start, end, duration = 0, timeline_duration;
+  gint64 trace;
 
   GESTrackPrivate *priv = track->priv;
 
@@ -192,6 +240,9 @@ update_gaps (GESTrack * track)
     return;
   }
 
+  trace = GES_TRACE_BEGIN ();
+  priv->gap_updates++;
+
   gaps = priv->gaps;
   priv->gaps = NULL;
 
@@ -231,6 +282,7 @@ update_gaps (GESTrack * track)
 
   /* 4- Remove old gaps */
   g_list_free_full (gaps, (GDestroyNotify) free_gap);
+  GES_TRACE_END (trace, "update_gaps");
 }
 
 static inline void
@@ -249,8 +301,292 @@ static void
 sort_track_elements_cb (GESTrackElement * child,
     GParamSpec * arg G_GNUC_UNUSED, GESTrack * track)
 {
-  g_sequence_sort (track->priv->trackelements_by_start,
-      (GCompareDataFunc) element_start_compare, NULL);
+  GSequenceIter *iter =
+      g_hash_table_lookup (track->priv->trackelements_iter, child);
+
+  if (G_LIKELY (iter))
+    g_sequence_sort_changed (iter, (GCompareDataFunc) element_start_compare,
+        NULL);
+}
+
+/* Cache warming for the upcoming sources.
+ *
+ * This is not a prefetch of the sources: the composition builds its own
+ * stack at each edit point and can not be handed decoders we created. We
+ * open and pre-roll the media around its inpoint a bit before it is needed
+ * and throw everything away, so that the index, headers and first GOP are
+ * in the OS and network caches by the time the composition opens it */
+static void
+_free_warm_up_job (WarmUpJob * job)
+{
+  g_free (job->uri);
+  if (job->caps)
+    gst_caps_unref (job->caps);
+  g_object_unref (job->cancellable);
+  g_slice_free (WarmUpJob, job);
+}
+
+static void
+_warm_up_pad_added_cb (GstElement * decodebin, GstPad * pad,
+    GstElement * pipeline)
+{
+  GstPad *sinkpad;
+  GstElement *sink = gst_element_factory_make ("fakesink", NULL);
+
+  g_object_set (sink, "sync", FALSE, NULL);
+  gst_bin_add (GST_BIN (pipeline), sink);
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (sinkpad);
+  gst_element_sync_state_with_parent (sink);
+}
+
+/* Returns %FALSE if the pre-roll failed, timed out or got cancelled */
+static gboolean
+_warm_up_wait_preroll (WarmUpJob * job, GstBus * bus)
+{
+  gboolean ret;
+  GstMessage *msg = NULL;
+  GstClockTime waited;
+
+  for (waited = 0; msg == NULL && waited < WARM_UP_TIMEOUT;
+      waited += WARM_UP_POLL_INTERVAL) {
+    if (g_cancellable_is_cancelled (job->cancellable))
+      return FALSE;
+
+    msg = gst_bus_timed_pop_filtered (bus, WARM_UP_POLL_INTERVAL,
+        GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR);
+  }
+
+  if (msg == NULL)
+    return FALSE;
+
+  ret = GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ASYNC_DONE;
+  gst_message_unref (msg);
+
+  return ret;
+}
+
+/* Cache warming thread */
+static void
+_warm_up (WarmUpJob * job, gpointer unused)
+{
+  GstBus *bus;
+  GstElement *pipeline, *decodebin;
+
+  if (g_cancellable_is_cancelled (job->cancellable)) {
+    GST_DEBUG ("Warming up the caches for %s cancelled", job->uri);
+    _free_warm_up_job (job);
+    return;
+  }
+
+  GST_DEBUG ("Warming up the caches for %s at %" GST_TIME_FORMAT, job->uri,
+      GST_TIME_ARGS (job->inpoint));
+
+  pipeline = gst_pipeline_new (NULL);
+  decodebin = gst_element_factory_make ("uridecodebin", NULL);
+  g_object_set (decodebin, "uri", job->uri, "expose-all-streams", FALSE,
+      NULL);
+  if (job->caps)
+    g_object_set (decodebin, "caps", job->caps, NULL);
+  g_signal_connect (decodebin, "pad-added",
+      G_CALLBACK (_warm_up_pad_added_cb), pipeline);
+  gst_bin_add (GST_BIN (pipeline), decodebin);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  if (_warm_up_wait_preroll (job, bus) && job->inpoint > 0 &&
+      gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT, job->inpoint))
+    _warm_up_wait_preroll (job, bus);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+  _free_warm_up_job (job);
+}
+
+static const gchar *
+_get_source_uri (GESTrackElement * element)
+{
+  if (GES_IS_VIDEO_URI_SOURCE (element)) {
+    const gchar *uri = GES_VIDEO_URI_SOURCE (element)->uri;
+    GESAsset *clip_asset = ges_asset_cache_lookup (GES_TYPE_URI_CLIP, uri);
+
+    /* Warm up for what will actually be decoded */
+    if (clip_asset && GES_IS_URI_CLIP_ASSET (clip_asset))
+      return ges_uri_clip_asset_get_active_uri (GES_URI_CLIP_ASSET
+          (clip_asset));
+
+    return uri;
+  } else if (GES_IS_AUDIO_URI_SOURCE (element)) {
+    return GES_AUDIO_URI_SOURCE (element)->uri;
+  }
+
+  return NULL;
+}
+
+static gint
+_compare_start_to_position (GESTrackElement * element, GstClockTime * position,
+    gpointer unused)
+{
+  /* Never equal so that we land before the first element starting at
+   * @position */
+  return _START (element) < *position ? -1 : 1;
+}
+
+/* Returns the first element starting at or after @position */
+static GSequenceIter *
+_first_element_from (GESTrack * track, GstClockTime position)
+{
+  return g_sequence_search (track->priv->trackelements_by_start, &position,
+      (GCompareDataFunc) _compare_start_to_position, NULL);
+}
+
+static gboolean
+_warm_up_in_idle (GESTrack * track)
+{
+  GSequenceIter *it;
+  GCancellable *cancellable;
+  GstClockTime position, limit;
+  gboolean reset;
+  guint n_queued = 0;
+  GESTrackPrivate *priv = track->priv;
+
+  GST_OBJECT_LOCK (track);
+  position = priv->position;
+  reset = priv->warm_up_reset || priv->last_check > position;
+  priv->warm_up_reset = FALSE;
+  priv->warm_up_idle_id = 0;
+  cancellable = g_object_ref (priv->warm_up_cancellable);
+  GST_OBJECT_UNLOCK (track);
+
+  /* We seeked, start over from there */
+  if (reset || !GST_CLOCK_TIME_IS_VALID (priv->warmed_up_until) ||
+      priv->warmed_up_until < position) {
+    priv->warmed_up_until = position;
+    g_hash_table_remove_all (priv->warmed_up);
+  }
+
+  G_LOCK (warm_up_pool_lock);
+  if (warm_up_pool == NULL)
+    warm_up_pool = g_thread_pool_new ((GFunc) _warm_up, NULL, 2, FALSE,
+        NULL);
+  G_UNLOCK (warm_up_pool_lock);
+
+  limit = position + priv->warm_up_window;
+  for (it = _first_element_from (track, priv->warmed_up_until);
+      !g_sequence_iter_is_end (it) && n_queued < priv->warm_up_count;
+      it = g_sequence_iter_next (it)) {
+    WarmUpJob *job;
+    const gchar *uri;
+    GESTrackElement *element = g_sequence_get (it);
+
+    if (_START (element) > limit)
+      break;
+
+    if (g_thread_pool_unprocessed (warm_up_pool) >= WARM_UP_MAX_QUEUED) {
+      GST_DEBUG_OBJECT (track, "Too many pending warm-ups, trying later");
+      break;
+    }
+
+    if (_START (element) > priv->warmed_up_until) {
+      priv->warmed_up_until = _START (element);
+      g_hash_table_remove_all (priv->warmed_up);
+    } else if (g_hash_table_contains (priv->warmed_up, element)) {
+      continue;
+    }
+    g_hash_table_add (priv->warmed_up, element);
+
+    if (!ges_track_element_is_active (element) ||
+        (uri = _get_source_uri (element)) == NULL)
+      continue;
+
+    job = g_slice_new0 (WarmUpJob);
+    job->uri = g_strdup (uri);
+    job->caps = priv->caps ? gst_caps_ref (priv->caps) : NULL;
+    job->inpoint = _INPOINT (element);
+    job->cancellable = g_object_ref (cancellable);
+
+    g_thread_pool_push (warm_up_pool, job, NULL);
+    n_queued++;
+  }
+  g_object_unref (cancellable);
+
+  GST_OBJECT_LOCK (track);
+  priv->last_check = position;
+  GST_OBJECT_UNLOCK (track);
+
+  return FALSE;
+}
+
+/* Must be called with the object lock */
+static void
+_cancel_warm_up_unlocked (GESTrack * track)
+{
+  GESTrackPrivate *priv = track->priv;
+
+  g_cancellable_cancel (priv->warm_up_cancellable);
+  g_object_unref (priv->warm_up_cancellable);
+  priv->warm_up_cancellable = g_cancellable_new ();
+  priv->warm_up_reset = TRUE;
+  priv->last_check = GST_CLOCK_TIME_NONE;
+}
+
+/* Streaming thread */
+static GstPadProbeReturn
+_track_position_probe (GstPad * pad, GstPadProbeInfo * info, GESTrack * track)
+{
+  GstEvent *event;
+  GstBuffer *buffer;
+  const GstSegment *segment;
+  GstClockTime position;
+  GESTrackPrivate *priv = track->priv;
+
+  if (priv->warm_up_count == 0)
+    return GST_PAD_PROBE_OK;
+
+  /* What was being warmed up for is not upcoming anymore */
+  if (info->type & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+    if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) ==
+        GST_EVENT_FLUSH_STOP) {
+      GST_OBJECT_LOCK (track);
+      _cancel_warm_up_unlocked (track);
+      GST_OBJECT_UNLOCK (track);
+    }
+
+    return GST_PAD_PROBE_OK;
+  }
+
+  buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+  if (!GST_BUFFER_PTS_IS_VALID (buffer))
+    return GST_PAD_PROBE_OK;
+
+  event = gst_pad_get_sticky_event (pad, GST_EVENT_SEGMENT, 0);
+  if (event == NULL)
+    return GST_PAD_PROBE_OK;
+
+  gst_event_parse_segment (event, &segment);
+  position = gst_segment_to_stream_time (segment, GST_FORMAT_TIME,
+      GST_BUFFER_PTS (buffer));
+  gst_event_unref (event);
+
+  if (!GST_CLOCK_TIME_IS_VALID (position))
+    return GST_PAD_PROBE_OK;
+
+  /* Look ahead a few times per window, and right away after seeks */
+  GST_OBJECT_LOCK (track);
+  priv->position = position;
+  if (priv->warm_up_idle_id == 0 &&
+      (!GST_CLOCK_TIME_IS_VALID (priv->last_check) ||
+          position < priv->last_check ||
+          position >= priv->last_check + priv->warm_up_window / 4))
+    priv->warm_up_idle_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+        (GSourceFunc) _warm_up_in_idle, gst_object_ref (track),
+        gst_object_unref);
+  GST_OBJECT_UNLOCK (track);
+
+  return GST_PAD_PROBE_OK;
 }
 
 static void
@@ -386,6 +722,12 @@ ges_track_get_property (GObject * object, guint property_id,
     case ARG_RESTRICTION_CAPS:
       gst_value_set_caps (value, track->priv->restriction_caps);
       break;
+    case ARG_CACHE_WARMING_COUNT:
+      g_value_set_uint (value, track->priv->warm_up_count);
+      break;
+    case ARG_CACHE_WARMING_WINDOW:
+      g_value_set_uint64 (value, track->priv->warm_up_window);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -407,6 +749,17 @@ ges_track_set_property (GObject * object, guint property_id,
     case ARG_RESTRICTION_CAPS:
       ges_track_set_restriction_caps (track, gst_value_get_caps (value));
       break;
+    case ARG_CACHE_WARMING_COUNT:
+      track->priv->warm_up_count = g_value_get_uint (value);
+      if (track->priv->warm_up_count == 0) {
+        GST_OBJECT_LOCK (track);
+        _cancel_warm_up_unlocked (track);
+        GST_OBJECT_UNLOCK (track);
+      }
+      break;
+    case ARG_CACHE_WARMING_WINDOW:
+      track->priv->warm_up_window = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -444,6 +797,12 @@ ges_track_dispose (GObject * object)
 static void
 ges_track_finalize (GObject * object)
 {
+  GESTrackPrivate *priv = GES_TRACK (object)->priv;
+
+  g_cancellable_cancel (priv->warm_up_cancellable);
+  g_object_unref (priv->warm_up_cancellable);
+  g_hash_table_unref (priv->warmed_up);
+
   G_OBJECT_CLASS (ges_track_parent_class)->finalize (object);
 }
 
@@ -562,6 +921,42 @@ ges_track_class_init (GESTrackClass * klass)
   g_object_class_install_property (object_class, ARG_TYPE,
       properties[ARG_TYPE]);
 
+  /**
+   * GESTrack:cache-warming-count:
+   *
+   * Maximum number of upcoming sources to warm the caches up for each
+   * time the playback position is checked, 0 disables it. The media of
+   * the sources starting within #GESTrack:cache-warming-window are opened
+   * and pre-rolled around their inpoint in the background, then thrown
+   * away, so that their headers and first frames are already in the OS
+   * and network caches when the composition reaches them. This avoids
+   * stalling at edit points on slow (network) storage, but the sources
+   * are still opened and decoded again by the composition.
+   *
+   * Default value: 0
+   */
+  properties[ARG_CACHE_WARMING_COUNT] =
+      g_param_spec_uint ("cache-warming-count", "Cache warming count",
+      "Number of upcoming sources to warm the caches up for", 0, G_MAXUINT, 0,
+      G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_CACHE_WARMING_COUNT,
+      properties[ARG_CACHE_WARMING_COUNT]);
+
+  /**
+   * GESTrack:cache-warming-window:
+   *
+   * How long (in nanoseconds) before their start the caches are warmed
+   * up for sources, see #GESTrack:cache-warming-count.
+   *
+   * Default value: 5 seconds
+   */
+  properties[ARG_CACHE_WARMING_WINDOW] =
+      g_param_spec_uint64 ("cache-warming-window", "Cache warming window",
+      "How long before their start the caches are warmed up for sources", 0,
+      G_MAXUINT64, 5 * GST_SECOND, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_CACHE_WARMING_WINDOW,
+      properties[ARG_CACHE_WARMING_WINDOW]);
+
   /**
    * GESTrack::track-element-added:
    * @object: the #GESTrack
@@ -592,6 +987,8 @@ ges_track_class_init (GESTrackClass * klass)
 static void
 ges_track_init (GESTrack * self)
 {
+  GstPad *pad;
+
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
       GES_TYPE_TRACK, GESTrackPrivate);
 
@@ -605,6 +1002,15 @@ ges_track_init (GESTrack * self)
   self->priv->gaps = NULL;
   self->priv->mixing = TRUE;
   self->priv->restriction_caps = NULL;
+  self->priv->warm_up_count = 0;
+  self->priv->warm_up_window = 5 * GST_SECOND;
+  self->priv->position = GST_CLOCK_TIME_NONE;
+  self->priv->last_check = GST_CLOCK_TIME_NONE;
+  self->priv->warmed_up_until = GST_CLOCK_TIME_NONE;
+  self->priv->warmed_up = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->priv->warm_up_reset = FALSE;
+  self->priv->warm_up_idle_id = 0;
+  self->priv->warm_up_cancellable = g_cancellable_new ();
 
   g_signal_connect (G_OBJECT (self->priv->composition), "notify::duration",
       G_CALLBACK (composition_duration_cb), self);
@@ -612,6 +1018,12 @@ ges_track_init (GESTrack * self)
       (GCallback) pad_added_cb, self);
   g_signal_connect (self->priv->composition, "pad-removed",
       (GCallback) pad_removed_cb, self);
+
+  pad = gst_element_get_static_pad (self->priv->capsfilter, "src");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_EVENT_FLUSH | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      (GstPadProbeCallback) _track_position_probe, self, NULL);
+  gst_object_unref (pad);
 }
 
 /**
@@ -894,6 +1306,7 @@ ges_track_remove_element (GESTrack * track, GESTrackElement * object)
 
   it = g_hash_table_lookup (priv->trackelements_iter, object);
   g_sequence_remove (it);
+  g_hash_table_remove (priv->warmed_up, object);
   resort_and_fill_gaps (track);
 
   if (remove_object_internal (track, object) == TRUE) {
@@ -976,15 +1389,91 @@ gboolean
 ges_track_commit (GESTrack * track)
 {
   gboolean ret;
+  gint64 start, trace;
 
   g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
 
+  start = g_get_monotonic_time ();
+  trace = GES_TRACE_BEGIN ();
   resort_and_fill_gaps (track);
   g_signal_emit_by_name (track->priv->composition, "commit", TRUE, &ret);
+  GES_TRACE_END (trace, "ges_track_commit");
+
+  ges_latency_stats_add (&track->priv->commit_stats,
+      (g_get_monotonic_time () - start) * GST_USECOND);
 
   return ret;
 }
 
+/**
+ * ges_track_get_statistics:
+ * @track: a #GESTrack
+ *
+ * Gets statistics about @track, in a #GstStructure named
+ * "ges-track-statistics" with the following fields:
+ *
+ * <itemizedlist>
+ * <listitem>"n-elements" #G_TYPE_UINT: the number of #GESTrackElement-s
+ * in @track</listitem>
+ * <listitem>"n-gaps" #G_TYPE_UINT: the number of gaps that are currently
+ * filled</listitem>
+ * <listitem>"n-composition-objects" #G_TYPE_UINT: the number of objects
+ * in the underlying #GnlComposition</listitem>
+ * <listitem>"gap-updates" #G_TYPE_UINT64: how many times the gaps have
+ * been recomputed</listitem>
+ * <listitem>"commit-count", "commit-last", "commit-max" and
+ * "commit-average" #G_TYPE_UINT64: the number of commits and their
+ * durations in nanoseconds</listitem>
+ * <listitem>"commit-histogram" #GST_TYPE_ARRAY of #G_TYPE_UINT64: the
+ * number of commits that took less than 1, 2, 4 ... 512 milliseconds,
+ * the last value counts the longer ones</listitem>
+ * </itemizedlist>
+ *
+ * The counters are reset by ges_track_reset_statistics().
+ *
+ * Returns: (transfer full): The statistics of @track
+ */
+GstStructure *
+ges_track_get_statistics (GESTrack * track)
+{
+  guint n_objects;
+  GstStructure *stats;
+  GESTrackPrivate *priv;
+
+  g_return_val_if_fail (GES_IS_TRACK (track), NULL);
+
+  priv = track->priv;
+
+  GST_OBJECT_LOCK (priv->composition);
+  n_objects = GST_BIN_NUMCHILDREN (priv->composition);
+  GST_OBJECT_UNLOCK (priv->composition);
+
+  stats = gst_structure_new ("ges-track-statistics",
+      "n-elements", G_TYPE_UINT,
+      g_sequence_get_length (priv->trackelements_by_start),
+      "n-gaps", G_TYPE_UINT, g_list_length (priv->gaps),
+      "n-composition-objects", G_TYPE_UINT, n_objects,
+      "gap-updates", G_TYPE_UINT64, priv->gap_updates, NULL);
+  ges_latency_stats_fill (&priv->commit_stats, stats, "commit");
+
+  return stats;
+}
+
+/**
+ * ges_track_reset_statistics:
+ * @track: a #GESTrack
+ *
+ * Resets the counters reported by ges_track_get_statistics().
+ */
+void
+ges_track_reset_statistics (GESTrack * track)
+{
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  memset (&track->priv->commit_stats, 0, sizeof (GESLatencyStats));
+  track->priv->gap_updates = 0;
+}
+
 
 /**
  * ges_track_set_create_element_for_gap_func:
@@ -92,6 +92,8 @@ void               ges_track_set_create_element_for_gap_func (GESTrack *track, G
 void               ges_track_set_mixing                      (GESTrack *track, gboolean mixing);
 gboolean           ges_track_get_mixing                      (GESTrack *track);
 void               ges_track_set_restriction_caps            (GESTrack *track, const GstCaps *caps);
+GstStructure*      ges_track_get_statistics                  (GESTrack *track);
+void               ges_track_reset_statistics                (GESTrack *track);
 
 /* standard methods */
 GType              ges_track_get_type                        (void);
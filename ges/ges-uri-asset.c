@@ -52,6 +52,9 @@ enum
 {
   PROP_0,
   PROP_DURATION,
+  PROP_MEDIA_CACHE_READY,
+  PROP_PROXY_URI,
+  PROP_USE_PROXY,
   PROP_LAST
 };
 static GParamSpec *properties[PROP_LAST];
@@ -66,6 +69,11 @@ struct _GESUriClipAssetPrivate
   gboolean is_image;
 
   GList *asset_trackfilesources;
+
+  GESMediaCache *media_cache;
+  gboolean media_cache_ready;
+
+  gboolean use_proxy;
 };
 
 struct _GESUriSourceAssetPrivate
@@ -87,6 +95,16 @@ ges_uri_clip_asset_get_property (GObject * object, guint property_id,
     case PROP_DURATION:
       g_value_set_uint64 (value, priv->duration);
       break;
+    case PROP_MEDIA_CACHE_READY:
+      g_value_set_boolean (value, priv->media_cache_ready);
+      break;
+    case PROP_PROXY_URI:
+      g_value_set_string (value,
+          ges_uri_clip_asset_get_proxy_uri (GES_URI_CLIP_ASSET (object)));
+      break;
+    case PROP_USE_PROXY:
+      g_value_set_boolean (value, priv->use_proxy);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -102,11 +120,25 @@ ges_uri_clip_asset_set_property (GObject * object, guint property_id,
     case PROP_DURATION:
       priv->duration = g_value_get_uint64 (value);
       break;
+    case PROP_USE_PROXY:
+      priv->use_proxy = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
 }
 
+static void
+ges_uri_clip_asset_finalize (GObject * object)
+{
+  GESUriClipAssetPrivate *priv = GES_URI_CLIP_ASSET (object)->priv;
+
+  if (priv->media_cache)
+    ges_media_cache_free (priv->media_cache);
+
+  G_OBJECT_CLASS (ges_uri_clip_asset_parent_class)->finalize (object);
+}
+
 static GESAssetLoadingReturn
 _start_loading (GESAsset * asset, GError ** error)
 {
@@ -118,6 +150,7 @@ _start_loading (GESAsset * asset, GError ** error)
 
   uri = ges_asset_get_id (asset);
 
+  GES_TRACE_ASYNC_BEGIN ("asset_discovery", asset);
   ret = gst_discoverer_discover_uri_async (class->discoverer, uri);
   if (ret)
     return GES_ASSET_LOADING_ASYNC;
@@ -186,6 +219,7 @@ ges_uri_clip_asset_class_init (GESUriClipAssetClass * klass)
 
   object_class->get_property = ges_uri_clip_asset_get_property;
   object_class->set_property = ges_uri_clip_asset_set_property;
+  object_class->finalize = ges_uri_clip_asset_finalize;
 
   GES_ASSET_CLASS (klass)->start_loading = _start_loading;
   GES_ASSET_CLASS (klass)->request_id_update = _request_id_update;
@@ -203,6 +237,47 @@ ges_uri_clip_asset_class_init (GESUriClipAssetClass * klass)
   g_object_class_install_property (object_class, PROP_DURATION,
       properties[PROP_DURATION]);
 
+  /**
+   * GESUriClipAsset:media-cache-ready:
+   *
+   * Whether the audio peaks and thumbnails of the media file are available,
+   * see #ges_uri_clip_asset_class_set_media_cache_enabled
+   */
+  properties[PROP_MEDIA_CACHE_READY] =
+      g_param_spec_boolean ("media-cache-ready", "Media cache ready",
+      "Whether the audio peaks and thumbnails are available", FALSE,
+      G_PARAM_READABLE);
+  g_object_class_install_property (object_class, PROP_MEDIA_CACHE_READY,
+      properties[PROP_MEDIA_CACHE_READY]);
+
+  /**
+   * GESUriClipAsset:proxy-uri:
+   *
+   * The URI of the low resolution proxy of the media file, %NULL until
+   * it has been created with #ges_uri_clip_asset_create_proxy
+   */
+  properties[PROP_PROXY_URI] =
+      g_param_spec_string ("proxy-uri", "Proxy URI",
+      "The URI of the low resolution proxy of the media", NULL,
+      G_PARAM_READABLE);
+  g_object_class_install_property (object_class, PROP_PROXY_URI,
+      properties[PROP_PROXY_URI]);
+
+  /**
+   * GESUriClipAsset:use-proxy:
+   *
+   * Whether the video sources extracted from the asset should decode
+   * its proxy, when it is available, instead of the media file itself.
+   * Running sources switch right away. The original media is always used
+   * when the timeline is rendered by a #GESPipeline.
+   */
+  properties[PROP_USE_PROXY] =
+      g_param_spec_boolean ("use-proxy", "Use proxy",
+      "Whether to decode the proxy of the media when available", FALSE,
+      G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_USE_PROXY,
+      properties[PROP_USE_PROXY]);
+
   klass->discoverer = gst_discoverer_new (GST_SECOND, NULL);
   klass->sync_discoverer = gst_discoverer_new (GST_SECOND, NULL);
   g_signal_connect (klass->discoverer, "discovered",
@@ -227,6 +302,71 @@ ges_uri_clip_asset_init (GESUriClipAsset * self)
   priv->info = NULL;
   priv->duration = GST_CLOCK_TIME_NONE;
   priv->is_image = FALSE;
+  priv->media_cache = NULL;
+  priv->media_cache_ready = FALSE;
+  priv->use_proxy = FALSE;
+}
+
+static GESMediaCache *
+_get_media_cache (GESUriClipAsset * self)
+{
+  if (self->priv->media_cache == NULL)
+    self->priv->media_cache =
+        ges_media_cache_new (ges_asset_get_id (GES_ASSET (self)));
+
+  return self->priv->media_cache;
+}
+
+static gboolean
+_can_be_cached (GESUriClipAsset * self)
+{
+  const gchar *uri = ges_asset_get_id (GES_ASSET (self));
+
+  return !self->priv->is_image &&
+      !g_str_has_prefix (uri, GES_MULTI_FILE_URI_PREFIX) &&
+      !g_str_has_prefix (uri, "imagesequence");
+}
+
+static void
+_media_cache_ready_cb (GESMediaCache * cache, gboolean loaded,
+    GESUriClipAsset * self)
+{
+  if (loaded) {
+    self->priv->media_cache_ready = TRUE;
+    g_object_notify_by_pspec (G_OBJECT (self),
+        properties[PROP_MEDIA_CACHE_READY]);
+  }
+
+  g_object_unref (self);
+}
+
+static void
+_ensure_media_cache (GESUriClipAsset * self)
+{
+  gboolean has_audio, has_video;
+  GESUriClipAssetPrivate *priv = self->priv;
+  GESTrackType formats =
+      ges_clip_asset_get_supported_formats (GES_CLIP_ASSET (self));
+
+  if (!GES_URI_CLIP_ASSET_GET_CLASS (self)->media_cache_enabled ||
+      priv->media_cache_ready || !_can_be_cached (self))
+    return;
+
+  has_audio = ! !(formats & GES_TRACK_TYPE_AUDIO);
+  has_video = ! !(formats & GES_TRACK_TYPE_VIDEO);
+  if (!has_audio && !has_video)
+    return;
+
+  if (ges_media_cache_load (_get_media_cache (self), has_audio, has_video)) {
+    GST_DEBUG_OBJECT (self, "Media cache found on disk");
+    priv->media_cache_ready = TRUE;
+
+    return;
+  }
+
+  GST_DEBUG_OBJECT (self, "Populating media cache in the background");
+  ges_media_cache_populate_async (priv->media_cache, has_audio, has_video,
+      (GESMediaCacheReadyFunc) _media_cache_ready_cb, g_object_ref (self));
 }
 
 static void
@@ -311,6 +451,8 @@ ges_uri_clip_asset_set_info (GESUriClipAsset * self, GstDiscovererInfo * info)
   /* else we keep #GST_CLOCK_TIME_NONE */
 
   priv->info = gst_object_ref (info);
+
+  _ensure_media_cache (self);
 }
 
 static void
@@ -340,6 +482,7 @@ discoverer_discovered_cb (GstDiscoverer * discoverer,
 
   if (err == NULL)
     ges_uri_clip_asset_set_info (mfs, info);
+  GES_TRACE_ASYNC_END ("asset_discovery", mfs);
   ges_asset_cache_set_loaded (GES_TYPE_URI_CLIP, uri, err);
 }
 
@@ -521,6 +664,229 @@ ges_uri_clip_asset_class_set_timeout (GESUriClipAssetClass * klass,
   g_object_set (klass->sync_discoverer, "timeout", timeout, NULL);
 }
 
+/**
+ * ges_uri_clip_asset_class_set_media_cache_enabled:
+ * @klass: The #GESUriClipAssetClass
+ * @enabled: Whether to build media caches
+ *
+ * Sets whether #GESUriClipAsset-s should compute audio peaks and video
+ * thumbnails the first time they are discovered. Those are computed in a
+ * background thread, stored on disk in the user cache directory, and are
+ * then reused for the same files in later sessions.
+ *
+ * The #GESUriClipAsset:media-cache-ready property is set once they are
+ * available. This is disabled by default.
+ */
+void
+ges_uri_clip_asset_class_set_media_cache_enabled (GESUriClipAssetClass *
+    klass, gboolean enabled)
+{
+  g_return_if_fail (GES_IS_URI_CLIP_ASSET_CLASS (klass));
+
+  klass->media_cache_enabled = enabled;
+}
+
+/**
+ * ges_uri_clip_asset_get_audio_peaks:
+ * @self: A #GESUriClipAsset
+ * @level: The zoom level, 0 being the most detailed
+ * @interval: (out) (allow-none): The duration each peak represents
+ * @n_peaks: (out) (allow-none): The number of peaks
+ *
+ * Gets the maximum absolute amplitude of the (downmixed) audio of @self
+ * per @interval, each zoom level being four times coarser than the previous
+ * one. The media cache has to be ready, see
+ * #GESUriClipAsset:media-cache-ready.
+ *
+ * Returns: (transfer none) (array length=n_peaks): The peaks, or %NULL if
+ * not available
+ */
+const gfloat *
+ges_uri_clip_asset_get_audio_peaks (GESUriClipAsset * self, guint level,
+    GstClockTime * interval, guint * n_peaks)
+{
+  g_return_val_if_fail (GES_IS_URI_CLIP_ASSET (self), NULL);
+
+  if (!self->priv->media_cache_ready)
+    return NULL;
+
+  return ges_media_cache_get_peaks (self->priv->media_cache, level, interval,
+      n_peaks);
+}
+
+/**
+ * ges_uri_clip_asset_get_thumbnail:
+ * @self: A #GESUriClipAsset
+ * @position: The position in the media file
+ *
+ * Gets the cached thumbnail for @position, thumbnails are JPEG encoded
+ * and available every second of the media. The media cache has to be
+ * ready, see #GESUriClipAsset:media-cache-ready.
+ *
+ * Returns: (transfer full): A #GstSample, or %NULL if not available
+ */
+GstSample *
+ges_uri_clip_asset_get_thumbnail (GESUriClipAsset * self,
+    GstClockTime position)
+{
+  g_return_val_if_fail (GES_IS_URI_CLIP_ASSET (self), NULL);
+
+  if (!self->priv->media_cache_ready)
+    return NULL;
+
+  return ges_media_cache_get_thumbnail (self->priv->media_cache, position);
+}
+
+static void
+_proxy_ready_cb (GESMediaCache * cache, gboolean created,
+    GESUriClipAsset * self)
+{
+  if (created) {
+    GST_DEBUG_OBJECT (self, "Proxy created: %s",
+        ges_media_cache_get_proxy_uri (cache));
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PROXY_URI]);
+  }
+
+  g_object_unref (self);
+}
+
+/**
+ * ges_uri_clip_asset_create_proxy:
+ * @self: a #GESUriClipAsset
+ *
+ * Starts transcoding a low resolution, intra-frame only, proxy of the video
+ * of @self in the background, next to its media cache. Once done, the
+ * #GESUriClipAsset:proxy-uri property is notified and, if
+ * #GESUriClipAsset:use-proxy is set, video sources will decode it instead
+ * of the media file itself. The proxy keeps the timestamps of the original
+ * media so the in-points of the clips stay valid.
+ *
+ * Returns: %TRUE if the proxy already exists or is being created, %FALSE
+ * if @self has no video or no proxy can be created for it
+ */
+gboolean
+ges_uri_clip_asset_create_proxy (GESUriClipAsset * self)
+{
+  GESMediaCache *cache;
+
+  g_return_val_if_fail (GES_IS_URI_CLIP_ASSET (self), FALSE);
+
+  if (!_can_be_cached (self) ||
+      !(ges_clip_asset_get_supported_formats (GES_CLIP_ASSET (self)) &
+          GES_TRACK_TYPE_VIDEO))
+    return FALSE;
+
+  cache = _get_media_cache (self);
+  if (ges_media_cache_get_proxy_uri (cache))
+    return TRUE;
+
+  GST_DEBUG_OBJECT (self, "Creating proxy in the background");
+  if (!ges_media_cache_create_proxy_async (cache,
+          (GESMediaCacheReadyFunc) _proxy_ready_cb, g_object_ref (self))) {
+    /* Either already being created or the cache directory is not usable,
+     * in which case there is nothing we can do */
+    g_object_unref (self);
+  }
+
+  return TRUE;
+}
+
+/**
+ * ges_uri_clip_asset_get_proxy_uri:
+ * @self: a #GESUriClipAsset
+ *
+ * Returns: (transfer none): The URI of the proxy of @self, or %NULL if it has
+ * not been created
+ */
+const gchar *
+ges_uri_clip_asset_get_proxy_uri (GESUriClipAsset * self)
+{
+  g_return_val_if_fail (GES_IS_URI_CLIP_ASSET (self), NULL);
+
+  if (!_can_be_cached (self))
+    return NULL;
+
+  return ges_media_cache_get_proxy_uri (_get_media_cache (self));
+}
+
+/* The URI sources extracted from @self should decode */
+const gchar *
+ges_uri_clip_asset_get_active_uri (GESUriClipAsset * self)
+{
+  const gchar *proxy_uri = NULL;
+
+  if (self->priv->use_proxy)
+    proxy_uri = ges_uri_clip_asset_get_proxy_uri (self);
+
+  return proxy_uri ? proxy_uri : ges_asset_get_id (GES_ASSET (self));
+}
+
+/* Whether every frame of a stream with @caps can be decoded on its own, the
+ * discoverer does not tell us about the actual GOP structure */
+static gboolean
+_is_intra_only (GstCaps * caps)
+{
+  guint i;
+  const gchar *name, *profile;
+  GstStructure *structure;
+  static const gchar *intra_only_formats[] = {
+    "video/x-raw", "image/jpeg", "image/png", "video/x-dv", "video/x-prores",
+    "video/x-dnxhd", "video/x-huffyuv", "video/x-ffv", "image/x-j2c",
+    "image/x-jpc", NULL
+  };
+
+  if (caps == NULL || gst_caps_is_empty (caps))
+    return FALSE;
+
+  structure = gst_caps_get_structure (caps, 0);
+  name = gst_structure_get_name (structure);
+  for (i = 0; intra_only_formats[i]; i++) {
+    if (g_strcmp0 (intra_only_formats[i], name) == 0)
+      return TRUE;
+  }
+
+  /* The H.264 intra profiles */
+  profile = gst_structure_get_string (structure, "profile");
+
+  return profile && g_str_has_suffix (profile, "-intra");
+}
+
+/* Whether decoding the video of @self is expensive enough to deserve
+ * a proxy: it has more pixels than full HD, or seeking in it means
+ * decoding from the previous keyframe */
+gboolean
+ges_uri_clip_asset_needs_proxy (GESUriClipAsset * self)
+{
+  GList *tmp, *streams;
+  gboolean ret = FALSE;
+
+  if (self->priv->info == NULL || !_can_be_cached (self))
+    return FALSE;
+
+  streams = gst_discoverer_info_get_video_streams (self->priv->info);
+  for (tmp = streams; tmp; tmp = tmp->next) {
+    GstDiscovererVideoInfo *vinfo = tmp->data;
+    GstCaps *caps =
+        gst_discoverer_stream_info_get_caps (GST_DISCOVERER_STREAM_INFO
+        (vinfo));
+
+    if (gst_discoverer_video_info_get_width (vinfo) *
+        gst_discoverer_video_info_get_height (vinfo) > 1920 * 1080)
+      ret = TRUE;
+    else if (!gst_discoverer_video_info_is_image (vinfo))
+      ret = !_is_intra_only (caps);
+
+    if (caps)
+      gst_caps_unref (caps);
+
+    if (ret)
+      break;
+  }
+  gst_discoverer_stream_info_list_free (streams);
+
+  return ret;
+}
+
 /**
  * ges_uri_clip_asset_get_stream_assets:
  * @self: A #GESUriClipAsset
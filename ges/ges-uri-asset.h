@@ -63,8 +63,9 @@ struct _GESUriClipAssetClass
   /* <private> */
   GstDiscoverer *discoverer;
   GstDiscoverer *sync_discoverer;
+  gboolean media_cache_enabled;
 
-  gpointer _ges_reserved[GES_PADDING];
+  gpointer _ges_reserved[GES_PADDING - 1];
 };
 
 GstDiscovererInfo *ges_uri_clip_asset_get_info      (const GESUriClipAsset * self);
@@ -78,6 +79,16 @@ GESUriClipAsset* ges_uri_clip_asset_request_sync    (const gchar *uri, GError **
 void ges_uri_clip_asset_class_set_timeout           (GESUriClipAssetClass *klass,
                                                      GstClockTime timeout);
 const GList * ges_uri_clip_asset_get_stream_assets  (GESUriClipAsset *self);
+void ges_uri_clip_asset_class_set_media_cache_enabled (GESUriClipAssetClass *klass,
+                                                       gboolean enabled);
+const gfloat * ges_uri_clip_asset_get_audio_peaks   (GESUriClipAsset *self,
+                                                     guint level,
+                                                     GstClockTime *interval,
+                                                     guint *n_peaks);
+GstSample * ges_uri_clip_asset_get_thumbnail        (GESUriClipAsset *self,
+                                                     GstClockTime position);
+gboolean ges_uri_clip_asset_create_proxy            (GESUriClipAsset *self);
+const gchar * ges_uri_clip_asset_get_proxy_uri      (GESUriClipAsset *self);
 
 #define GES_TYPE_URI_SOURCE_ASSET ges_uri_source_asset_get_type()
 #define GES_URI_SOURCE_ASSET(obj) \
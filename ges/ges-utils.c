@@ -122,3 +122,61 @@ ges_pspec_hash (gconstpointer key_spec)
 
   return h;
 }
+
+void
+ges_latency_stats_add (GESLatencyStats * stats, GstClockTime duration)
+{
+  guint bucket = 0;
+  GstClockTime limit = GST_MSECOND;
+
+  while (bucket < GES_LATENCY_N_BUCKETS - 1 && duration >= limit) {
+    limit *= 2;
+    bucket++;
+  }
+
+  stats->count++;
+  stats->last = duration;
+  stats->total += duration;
+  stats->max = MAX (stats->max, duration);
+  stats->buckets[bucket]++;
+}
+
+/* Sets the @name-count, @name-last, @name-max, @name-average and
+ * @name-histogram fields of @structure, durations are in nanoseconds */
+void
+ges_latency_stats_fill (GESLatencyStats * stats, GstStructure * structure,
+    const gchar * name)
+{
+  guint i;
+  gchar *field;
+  GValue histogram = G_VALUE_INIT, count = G_VALUE_INIT;
+
+  field = g_strdup_printf ("%s-count", name);
+  gst_structure_set (structure, field, G_TYPE_UINT64, stats->count, NULL);
+  g_free (field);
+
+  field = g_strdup_printf ("%s-last", name);
+  gst_structure_set (structure, field, G_TYPE_UINT64, stats->last, NULL);
+  g_free (field);
+
+  field = g_strdup_printf ("%s-max", name);
+  gst_structure_set (structure, field, G_TYPE_UINT64, stats->max, NULL);
+  g_free (field);
+
+  field = g_strdup_printf ("%s-average", name);
+  gst_structure_set (structure, field, G_TYPE_UINT64,
+      stats->count ? stats->total / stats->count : 0, NULL);
+  g_free (field);
+
+  g_value_init (&histogram, GST_TYPE_ARRAY);
+  g_value_init (&count, G_TYPE_UINT64);
+  for (i = 0; i < GES_LATENCY_N_BUCKETS; i++) {
+    g_value_set_uint64 (&count, stats->buckets[i]);
+    gst_value_array_append_value (&histogram, &count);
+  }
+  g_value_unset (&count);
+
+  field = g_strdup_printf ("%s-histogram", name);
+  gst_structure_take_value (structure, field, &histogram);
+  g_free (field);
+}
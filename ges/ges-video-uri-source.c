@@ -29,12 +29,15 @@
 #include "ges-internal.h"
 #include "ges-track-element.h"
 #include "ges-video-uri-source.h"
+#include "ges-uri-clip.h"
 #include "ges-uri-asset.h"
 #include "ges-extractable.h"
 
 struct _GESVideoUriSourcePrivate
 {
-  void *nothing;
+  /* The clip asset we decode, used to switch to its proxy */
+  GESUriClipAsset *clip_asset;
+  GstElement *decodebin;
 };
 
 enum
@@ -43,6 +46,77 @@ enum
   PROP_URI
 };
 
+/* The uri we should decode, the proxy of the media when the asset uses one,
+ * unless the timeline is being rendered */
+static const gchar *
+_get_active_uri (GESVideoUriSource * self)
+{
+  GESTrack *track = ges_track_element_get_track (GES_TRACK_ELEMENT (self));
+  GESTimeline *timeline =
+      track ? (GESTimeline *) ges_track_get_timeline (track) : NULL;
+
+  if (self->priv->clip_asset == NULL ||
+      (timeline && timeline_get_rendering (timeline)))
+    return self->uri;
+
+  return ges_uri_clip_asset_get_active_uri (self->priv->clip_asset);
+}
+
+/* Makes the decodebin decode the active uri. It only reads its uri when
+ * going to PAUSED, so when it is running our gnlobject is taken out of the
+ * composition while the uri changes: the composition shuts the decodebin
+ * down, and brings it back to the current position itself once the
+ * gnlobject is active again */
+void
+ges_video_uri_source_update_uri (GESVideoUriSource * self)
+{
+  gchar *current;
+  const gchar *uri;
+  gboolean active;
+  GESTrack *track;
+  GstElement *gnlobject, *decodebin = self->priv->decodebin;
+
+  if (decodebin == NULL)
+    return;
+
+  uri = _get_active_uri (self);
+  g_object_get (decodebin, "uri", &current, NULL);
+  if (g_strcmp0 (current, uri) == 0) {
+    g_free (current);
+    return;
+  }
+  g_free (current);
+
+  GST_DEBUG_OBJECT (self, "Now decoding %s", uri);
+  track = ges_track_element_get_track (GES_TRACK_ELEMENT (self));
+  gnlobject = ges_track_element_get_gnlobject (GES_TRACK_ELEMENT (self));
+  if (track == NULL || gnlobject == NULL ||
+      (GST_STATE (decodebin) <= GST_STATE_READY &&
+          GST_STATE_PENDING (decodebin) == GST_STATE_VOID_PENDING)) {
+    g_object_set (decodebin, "uri", uri, NULL);
+    return;
+  }
+
+  g_object_get (gnlobject, "active", &active, NULL);
+  g_object_set (gnlobject, "active", FALSE, NULL);
+  ges_track_commit (track);
+
+  if (GST_STATE (decodebin) > GST_STATE_READY)
+    GST_WARNING_OBJECT (self, "Still decoding, %s will only be used once "
+        "the composition restarts us", uri);
+  g_object_set (decodebin, "uri", uri, NULL);
+
+  g_object_set (gnlobject, "active", active, NULL);
+  ges_track_commit (track);
+}
+
+static void
+_active_uri_changed_cb (GESUriClipAsset * asset, GParamSpec * arg,
+    GESVideoUriSource * self)
+{
+  ges_video_uri_source_update_uri (self);
+}
+
 /* GESSource VMethod */
 static GstElement *
 ges_video_uri_source_create_source (GESTrackElement * trksrc)
@@ -50,6 +124,7 @@ ges_video_uri_source_create_source (GESTrackElement * trksrc)
   GESVideoUriSource *self;
   GESTrack *track;
   GstElement *decodebin;
+  GESAsset *clip_asset;
 
   self = (GESVideoUriSource *) trksrc;
 
@@ -57,8 +132,20 @@ ges_video_uri_source_create_source (GESTrackElement * trksrc)
 
   decodebin = gst_element_factory_make ("uridecodebin", NULL);
 
+  clip_asset = ges_asset_cache_lookup (GES_TYPE_URI_CLIP, self->uri);
+  if (clip_asset && GES_IS_URI_CLIP_ASSET (clip_asset)) {
+    GESVideoUriSourcePrivate *priv = self->priv;
+
+    priv->clip_asset = gst_object_ref (clip_asset);
+    priv->decodebin = gst_object_ref (decodebin);
+    g_signal_connect (clip_asset, "notify::use-proxy",
+        G_CALLBACK (_active_uri_changed_cb), self);
+    g_signal_connect (clip_asset, "notify::proxy-uri",
+        G_CALLBACK (_active_uri_changed_cb), self);
+  }
+
   g_object_set (decodebin, "caps", ges_track_get_caps (track),
-      "expose-all-streams", FALSE, "uri", self->uri, NULL);
+      "expose-all-streams", FALSE, "uri", _get_active_uri (self), NULL);
 
   return decodebin;
 }
@@ -139,9 +226,23 @@ static void
 ges_video_uri_source_dispose (GObject * object)
 {
   GESVideoUriSource *uriclip = GES_VIDEO_URI_SOURCE (object);
+  GESVideoUriSourcePrivate *priv = uriclip->priv;
 
   if (uriclip->uri)
     g_free (uriclip->uri);
+  uriclip->uri = NULL;
+
+  if (priv->clip_asset) {
+    g_signal_handlers_disconnect_by_func (priv->clip_asset,
+        _active_uri_changed_cb, uriclip);
+    gst_object_unref (priv->clip_asset);
+    priv->clip_asset = NULL;
+  }
+
+  if (priv->decodebin) {
+    gst_object_unref (priv->decodebin);
+    priv->decodebin = NULL;
+  }
 
   G_OBJECT_CLASS (ges_video_uri_source_parent_class)->dispose (object);
 }
@@ -115,6 +115,8 @@ ges_init (void)
     return TRUE;
   }
 
+  ges_tracing_init ();
+
   /* register clip classes with the system */
 
   GES_TYPE_TEST_CLIP;
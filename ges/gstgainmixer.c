@@ -0,0 +1,803 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Audio mixer applying a gain to each of its inputs while summing them, in
+ * a single pass over the samples of each input. The gain of an input is the
+ * "volume" property of its pad, which can be controlled: the control
+ * bindings are then evaluated for every frame, not once per buffer.
+ *
+ * Pads can also be given a fade in or out, linear or constant power, for
+ * which the gain of every frame is computed once, when the duration or the
+ * rate changes. When two inputs have varying gains, as in a crossfade,
+ * they are mixed together in a single pass.
+ *
+ * It only mixes interleaved native endian F32, every input has to come in
+ * the same format, which the GES audio tracks make sure of.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+
+#if defined (__SSE__) || defined (_M_X64)
+#include <xmmintrin.h>
+#define GAIN_MIXER_SSE 1
+#elif defined (__ARM_NEON__) || defined (__ARM_NEON)
+#include <arm_neon.h>
+#define GAIN_MIXER_NEON 1
+#endif
+
+#include "ges-internal.h"
+#include "gstgainmixer.h"
+
+#define DEFAULT_VOLUME 1.0
+#define MAX_VOLUME     10.0
+
+#define CAPS "audio/x-raw, format = (string) " GST_AUDIO_NE (F32) \
+    ", layout = (string) interleaved, rate = " GST_AUDIO_RATE_RANGE \
+    ", channels = " GST_AUDIO_CHANNELS_RANGE
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (CAPS)
+    );
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink_%u",
+    GST_PAD_SINK,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS (CAPS)
+    );
+
+enum
+{
+  PROP_PAD_0,
+  PROP_PAD_VOLUME,
+};
+
+G_DEFINE_TYPE (GstGainMixerPad, gst_gain_mixer_pad, GST_TYPE_PAD);
+G_DEFINE_TYPE (GstGainMixer, gst_gain_mixer, GST_TYPE_ELEMENT);
+
+/****************************************************
+ *                Mixing functions                  *
+ ****************************************************/
+/* dest[i] += src[i] * gain */
+static void
+_mix_constant (gfloat * dest, const gfloat * src, gfloat gain, guint n)
+{
+  guint i = 0;
+
+#if defined (GAIN_MIXER_SSE)
+  __m128 g = _mm_set1_ps (gain);
+
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps (dest + i, _mm_add_ps (_mm_loadu_ps (dest + i),
+            _mm_mul_ps (_mm_loadu_ps (src + i), g)));
+#elif defined (GAIN_MIXER_NEON)
+  float32x4_t g = vdupq_n_f32 (gain);
+
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32 (dest + i, vmlaq_f32 (vld1q_f32 (dest + i), vld1q_f32 (src + i),
+            g));
+#endif
+
+  for (; i < n; i++)
+    dest[i] += src[i] * gain;
+}
+
+/* dest[i] += src[i] * gains[i] */
+static void
+_mix_ramp (gfloat * dest, const gfloat * src, const gfloat * gains, guint n)
+{
+  guint i = 0;
+
+#if defined (GAIN_MIXER_SSE)
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps (dest + i, _mm_add_ps (_mm_loadu_ps (dest + i),
+            _mm_mul_ps (_mm_loadu_ps (src + i), _mm_loadu_ps (gains + i))));
+#elif defined (GAIN_MIXER_NEON)
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32 (dest + i, vmlaq_f32 (vld1q_f32 (dest + i), vld1q_f32 (src + i),
+            vld1q_f32 (gains + i)));
+#endif
+
+  for (; i < n; i++)
+    dest[i] += src[i] * gains[i];
+}
+
+/* dest[i] = a[i] * again[i] + b[i] * bgain[i] */
+static void
+_mix2_ramp (gfloat * dest, const gfloat * a, const gfloat * again,
+    const gfloat * b, const gfloat * bgain, guint n)
+{
+  guint i = 0;
+
+#if defined (GAIN_MIXER_SSE)
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps (dest + i, _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (a + i),
+                _mm_loadu_ps (again + i)), _mm_mul_ps (_mm_loadu_ps (b + i),
+                _mm_loadu_ps (bgain + i))));
+#elif defined (GAIN_MIXER_NEON)
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32 (dest + i, vmlaq_f32 (vmulq_f32 (vld1q_f32 (a + i),
+                vld1q_f32 (again + i)), vld1q_f32 (b + i),
+            vld1q_f32 (bgain + i)));
+#endif
+
+  for (; i < n; i++)
+    dest[i] = a[i] * again[i] + b[i] * bgain[i];
+}
+
+/****************************************************
+ *                 GstGainMixerPad                  *
+ ****************************************************/
+static void
+gst_gain_mixer_pad_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstGainMixerPad *pad = GST_GAIN_MIXER_PAD (object);
+
+  switch (property_id) {
+    case PROP_PAD_VOLUME:
+      GST_OBJECT_LOCK (pad);
+      g_value_set_double (value, pad->volume);
+      GST_OBJECT_UNLOCK (pad);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+}
+
+static void
+gst_gain_mixer_pad_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstGainMixerPad *pad = GST_GAIN_MIXER_PAD (object);
+
+  switch (property_id) {
+    case PROP_PAD_VOLUME:
+      GST_OBJECT_LOCK (pad);
+      pad->volume = g_value_get_double (value);
+      GST_OBJECT_UNLOCK (pad);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+}
+
+static void
+gst_gain_mixer_pad_finalize (GObject * object)
+{
+  GstGainMixerPad *pad = GST_GAIN_MIXER_PAD (object);
+
+  g_free (pad->values);
+  g_free (pad->gains);
+  g_free (pad->table);
+
+  G_OBJECT_CLASS (gst_gain_mixer_pad_parent_class)->finalize (object);
+}
+
+static void
+gst_gain_mixer_pad_class_init (GstGainMixerPadClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->get_property = gst_gain_mixer_pad_get_property;
+  gobject_class->set_property = gst_gain_mixer_pad_set_property;
+  gobject_class->finalize = gst_gain_mixer_pad_finalize;
+
+  g_object_class_install_property (gobject_class, PROP_PAD_VOLUME,
+      g_param_spec_double ("volume", "Volume", "Gain applied to the input",
+          0.0, MAX_VOLUME, DEFAULT_VOLUME,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE |
+          G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gst_gain_mixer_pad_init (GstGainMixerPad * pad)
+{
+  pad->volume = DEFAULT_VOLUME;
+  pad->values = NULL;
+  pad->n_values = 0;
+  pad->gains = NULL;
+  pad->n_gains = 0;
+  pad->fade = GST_GAIN_MIXER_FADE_NONE;
+  pad->table = NULL;
+  pad->table_valid = FALSE;
+}
+
+/* Makes @pad fade in or out over @duration from the start of its stream,
+ * the gains then do not depend on its volume anymore */
+void
+gst_gain_mixer_pad_set_fade (GstGainMixerPad * pad, GstGainMixerFade fade,
+    gboolean constant_power, GstClockTime duration)
+{
+  GST_OBJECT_LOCK (pad);
+  pad->fade = fade;
+  pad->constant_power = constant_power;
+  pad->fade_duration = duration;
+  pad->table_valid = FALSE;
+  GST_OBJECT_UNLOCK (pad);
+}
+
+/* Called from the streaming thread */
+static void
+_ensure_fade_table (GstGainMixerPad * pad, gint rate)
+{
+  guint i;
+  gboolean constant_power;
+  GstGainMixerFade fade;
+  GstClockTime duration;
+
+  GST_OBJECT_LOCK (pad);
+  if (pad->table_valid && pad->table_rate == rate) {
+    GST_OBJECT_UNLOCK (pad);
+    return;
+  }
+
+  fade = pad->fade;
+  constant_power = pad->constant_power;
+  duration = pad->fade_duration;
+  pad->table_valid = TRUE;
+  GST_OBJECT_UNLOCK (pad);
+
+  pad->table_rate = rate;
+  pad->table_frames = GST_CLOCK_TIME_IS_VALID (duration) ?
+      gst_util_uint64_scale_round (duration, rate, GST_SECOND) + 1 : 1;
+  pad->table = g_renew (gfloat, pad->table, pad->table_frames);
+
+  for (i = 0; i < pad->table_frames; i++) {
+    gdouble x = pad->table_frames > 1 ?
+        (gdouble) i / (pad->table_frames - 1) : 1.0;
+
+    if (fade == GST_GAIN_MIXER_FADE_OUT)
+      x = 1.0 - x;
+
+    /* sin^2 + cos^2 = 1: the power of the sum of two uncorrelated inputs
+     * fading in and out that way stays the same */
+    pad->table[i] = constant_power ? sin (x * G_PI_2) : x;
+  }
+}
+
+/****************************************************
+ *                  GstGainMixer                    *
+ ****************************************************/
+static void
+_reset (GstGainMixer * self)
+{
+  gst_segment_init (&self->segment, GST_FORMAT_TIME);
+  self->have_segment = FALSE;
+  self->new_segment_pending = TRUE;
+  self->base_ts = GST_CLOCK_TIME_NONE;
+  self->offset = 0;
+}
+
+/* Stream time of the input of @cdata at the output position @pts, each
+ * input having its own segment */
+static GstClockTime
+_input_stream_time (GstGainMixer * self, GstCollectData * cdata,
+    GstClockTime pts)
+{
+  GstClockTime running_time, position;
+
+  if (cdata->segment.format != GST_FORMAT_TIME)
+    return GST_CLOCK_TIME_NONE;
+
+  running_time = gst_segment_to_running_time (&self->segment, GST_FORMAT_TIME,
+      pts);
+  if (!GST_CLOCK_TIME_IS_VALID (running_time))
+    return GST_CLOCK_TIME_NONE;
+
+  position = gst_segment_to_position (&cdata->segment, GST_FORMAT_TIME,
+      running_time);
+
+  return gst_segment_to_stream_time (&cdata->segment, GST_FORMAT_TIME,
+      position);
+}
+
+/* Returns the gains to apply to each sample of @pad from @stream_time, or
+ * %NULL if the gain is constant, in which case it is set in @gain */
+static const gfloat *
+_get_gains (GstGainMixer * self, GstGainMixerPad * pad,
+    GstClockTime stream_time, guint frames, gfloat * gain)
+{
+  GstGainMixerFade fade;
+  guint i, j, channels = GST_AUDIO_INFO_CHANNELS (&self->info);
+  gint rate = GST_AUDIO_INFO_RATE (&self->info);
+
+  if (pad->n_gains < frames * channels) {
+    pad->gains = g_renew (gfloat, pad->gains, frames * channels);
+    pad->n_gains = frames * channels;
+  }
+
+  GST_OBJECT_LOCK (pad);
+  fade = pad->fade;
+  GST_OBJECT_UNLOCK (pad);
+
+  if (fade != GST_GAIN_MIXER_FADE_NONE &&
+      GST_CLOCK_TIME_IS_VALID (stream_time)) {
+    guint64 first = gst_util_uint64_scale_round (stream_time, rate,
+        GST_SECOND);
+
+    _ensure_fade_table (pad, rate);
+
+    /* The gain stays constant after the fade */
+    if (first >= pad->table_frames) {
+      *gain = pad->table[pad->table_frames - 1];
+
+      return NULL;
+    }
+
+    for (i = 0; i < frames; i++) {
+      gfloat value = pad->table[MIN (first + i, pad->table_frames - 1)];
+
+      for (j = 0; j < channels; j++)
+        pad->gains[i * channels + j] = value;
+    }
+
+    return pad->gains;
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (stream_time) &&
+      gst_object_has_active_control_bindings (GST_OBJECT (pad))) {
+    if (pad->n_values < frames) {
+      pad->values = g_renew (gdouble, pad->values, frames);
+      pad->n_values = frames;
+    }
+
+    if (gst_object_get_value_array (GST_OBJECT (pad), "volume", stream_time,
+            GST_SECOND / rate, frames, pad->values)) {
+      for (i = 0; i < frames; i++)
+        for (j = 0; j < channels; j++)
+          pad->gains[i * channels + j] = pad->values[i];
+
+      return pad->gains;
+    }
+
+    gst_object_sync_values (GST_OBJECT (pad), stream_time);
+  }
+
+  GST_OBJECT_LOCK (pad);
+  *gain = pad->volume;
+  GST_OBJECT_UNLOCK (pad);
+
+  return NULL;
+}
+
+typedef struct
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  const gfloat *gains;
+  gfloat gain;
+  guint n;
+} MixInput;
+
+static GstFlowReturn
+_collected (GstCollectPads * pads, GstGainMixer * self)
+{
+  GSList *tmp;
+  guint i, n_inputs = 0;
+  MixInput *inputs, *a, *b;
+  GstBuffer *outbuf;
+  GstMapInfo outmap;
+  GstClockTime pts;
+  guint outsize, frames, bpf = GST_AUDIO_INFO_BPF (&self->info);
+  gboolean mixed = FALSE;
+
+  outsize = gst_collect_pads_available (pads);
+  if (outsize == 0 || bpf == 0)
+    goto eos;
+  outsize -= outsize % bpf;
+  if (outsize == 0)
+    return GST_FLOW_OK;
+  frames = outsize / bpf;
+
+  if (self->new_segment_pending) {
+    GstEvent *event = gst_event_new_segment (&self->segment);
+
+    self->new_segment_pending = FALSE;
+    gst_pad_push_event (self->srcpad, event);
+  }
+
+  /* Output buffers follow each other from the first input timestamp */
+  if (!GST_CLOCK_TIME_IS_VALID (self->base_ts)) {
+    for (tmp = pads->data; tmp; tmp = tmp->next) {
+      GstBuffer *buf = gst_collect_pads_peek (pads, tmp->data);
+
+      if (buf) {
+        self->base_ts = GST_BUFFER_PTS (buf);
+        gst_buffer_unref (buf);
+        if (GST_CLOCK_TIME_IS_VALID (self->base_ts))
+          break;
+      }
+    }
+
+    if (!GST_CLOCK_TIME_IS_VALID (self->base_ts))
+      self->base_ts = self->segment.start;
+  }
+
+  pts = self->base_ts + gst_util_uint64_scale_int (self->offset, GST_SECOND,
+      GST_AUDIO_INFO_RATE (&self->info));
+
+  outbuf = gst_buffer_new_allocate (NULL, outsize, NULL);
+  gst_buffer_map (outbuf, &outmap, GST_MAP_WRITE);
+  memset (outmap.data, 0, outsize);
+
+  inputs = g_newa (MixInput, g_slist_length (pads->data));
+  for (tmp = pads->data; tmp; tmp = tmp->next) {
+    MixInput *input = &inputs[n_inputs];
+    GstCollectData *cdata = tmp->data;
+    GstBuffer *inbuf = gst_collect_pads_take_buffer (pads, cdata, outsize);
+
+    if (inbuf == NULL)
+      continue;
+
+    if (GST_BUFFER_FLAG_IS_SET (inbuf, GST_BUFFER_FLAG_GAP)) {
+      gst_buffer_unref (inbuf);
+      continue;
+    }
+
+    input->buffer = inbuf;
+    gst_buffer_map (inbuf, &input->map, GST_MAP_READ);
+    input->n = MIN (input->map.size, outsize) / bpf;
+    input->gains = _get_gains (self, GST_GAIN_MIXER_PAD (cdata->pad),
+        _input_stream_time (self, cdata, pts), input->n, &input->gain);
+    input->n *= GST_AUDIO_INFO_CHANNELS (&self->info);
+
+    if (input->gains == NULL && input->gain == 0.0) {
+      gst_buffer_unmap (inbuf, &input->map);
+      gst_buffer_unref (inbuf);
+      continue;
+    }
+
+    n_inputs++;
+  }
+
+  a = &inputs[0];
+  b = &inputs[1];
+  if (n_inputs == 2 && a->gains && b->gains && a->n == b->n) {
+    /* Crossfade: both inputs are ramped and written in a single pass */
+    _mix2_ramp ((gfloat *) outmap.data, (const gfloat *) a->map.data,
+        a->gains, (const gfloat *) b->map.data, b->gains, a->n);
+  } else {
+    for (i = 0; i < n_inputs; i++) {
+      if (inputs[i].gains)
+        _mix_ramp ((gfloat *) outmap.data,
+            (const gfloat *) inputs[i].map.data, inputs[i].gains, inputs[i].n);
+      else
+        _mix_constant ((gfloat *) outmap.data,
+            (const gfloat *) inputs[i].map.data, inputs[i].gain, inputs[i].n);
+    }
+  }
+  mixed = n_inputs > 0;
+
+  for (i = 0; i < n_inputs; i++) {
+    gst_buffer_unmap (inputs[i].buffer, &inputs[i].map);
+    gst_buffer_unref (inputs[i].buffer);
+  }
+  gst_buffer_unmap (outbuf, &outmap);
+
+  if (!mixed)
+    GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_GAP);
+  GST_BUFFER_PTS (outbuf) = pts;
+  GST_BUFFER_OFFSET (outbuf) = self->offset;
+  self->offset += frames;
+  GST_BUFFER_OFFSET_END (outbuf) = self->offset;
+  GST_BUFFER_DURATION (outbuf) = self->base_ts +
+      gst_util_uint64_scale_int (self->offset, GST_SECOND,
+      GST_AUDIO_INFO_RATE (&self->info)) - pts;
+
+  return gst_pad_push (self->srcpad, outbuf);
+
+eos:
+  {
+    GST_DEBUG_OBJECT (self, "No more data, sending EOS");
+    gst_pad_push_event (self->srcpad, gst_event_new_eos ());
+
+    return GST_FLOW_EOS;
+  }
+}
+
+/* All the inputs convert to the restriction caps of the track, so when
+ * those change every input comes with the new caps and we switch to them */
+static gboolean
+_set_caps (GstGainMixer * self, GstCaps * caps)
+{
+  GstAudioInfo info;
+  GstCaps *current;
+
+  if (!gst_audio_info_from_caps (&info, caps))
+    return FALSE;
+
+  current = gst_pad_get_current_caps (self->srcpad);
+  if (current) {
+    gboolean equal = gst_caps_is_equal (caps, current);
+
+    gst_caps_unref (current);
+    if (equal)
+      return TRUE;
+
+    GST_INFO_OBJECT (self, "Renegotiating to %" GST_PTR_FORMAT, caps);
+  }
+
+  GST_COLLECT_PADS_STREAM_LOCK (self->collect);
+  /* Timestamps go on from the current position at the new rate */
+  if (GST_CLOCK_TIME_IS_VALID (self->base_ts) &&
+      GST_AUDIO_INFO_RATE (&self->info) > 0) {
+    self->base_ts += gst_util_uint64_scale_int (self->offset, GST_SECOND,
+        GST_AUDIO_INFO_RATE (&self->info));
+    self->offset = 0;
+  }
+  self->info = info;
+  GST_COLLECT_PADS_STREAM_UNLOCK (self->collect);
+
+  return gst_pad_set_caps (self->srcpad, caps);
+}
+
+static gboolean
+_sink_event (GstCollectPads * pads, GstCollectData * cdata, GstEvent * event,
+    GstGainMixer * self)
+{
+  gboolean res = TRUE;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_STREAM_START:
+      if (self->send_stream_start) {
+        self->send_stream_start = FALSE;
+        gst_pad_push_event (self->srcpad, gst_event_ref (event));
+      }
+      gst_event_unref (event);
+      return TRUE;
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps;
+
+      gst_event_parse_caps (event, &caps);
+      res = _set_caps (self, caps);
+      gst_event_unref (event);
+
+      return res;
+    }
+    case GST_EVENT_SEGMENT:
+    {
+      const GstSegment *segment;
+
+      gst_event_parse_segment (event, &segment);
+      if (segment->format != GST_FORMAT_TIME) {
+        GST_ERROR_OBJECT (self, "Only TIME segments are supported");
+        gst_event_unref (event);
+
+        return FALSE;
+      }
+
+      GST_COLLECT_PADS_STREAM_LOCK (pads);
+      if (!self->have_segment) {
+        gst_segment_copy_into (segment, &self->segment);
+        self->have_segment = TRUE;
+      }
+      GST_COLLECT_PADS_STREAM_UNLOCK (pads);
+      break;
+    }
+    case GST_EVENT_FLUSH_START:
+      /* Forward a single flush for all the inputs */
+      if (g_atomic_int_compare_and_exchange (&self->flushing, FALSE, TRUE))
+        gst_pad_push_event (self->srcpad, gst_event_ref (event));
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      if (g_atomic_int_compare_and_exchange (&self->flushing, TRUE, FALSE)) {
+        GST_COLLECT_PADS_STREAM_LOCK (pads);
+        _reset (self);
+        GST_COLLECT_PADS_STREAM_UNLOCK (pads);
+        gst_pad_push_event (self->srcpad, gst_event_ref (event));
+      }
+      break;
+    case GST_EVENT_TAG:
+      break;
+    default:
+      return gst_collect_pads_event_default (pads, cdata, event, FALSE);
+  }
+
+  /* Let collectpads update the state of the pad, we forwarded what had to
+   * be */
+  return gst_collect_pads_event_default (pads, cdata, event, TRUE) && res;
+}
+
+static gboolean
+_sink_query (GstCollectPads * pads, GstCollectData * cdata, GstQuery * query,
+    GstGainMixer * self)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_CAPS) {
+    GstCaps *filter, *caps, *tmp;
+
+    /* Not our current caps, so that the inputs can renegotiate to what
+     * downstream accepts now */
+    gst_query_parse_caps (query, &filter);
+    tmp = gst_pad_get_pad_template_caps (cdata->pad);
+    caps = gst_pad_peer_query_caps (self->srcpad, tmp);
+    gst_caps_unref (tmp);
+
+    if (filter) {
+      tmp = gst_caps_intersect_full (filter, caps, GST_CAPS_INTERSECT_FIRST);
+      gst_caps_unref (caps);
+      caps = tmp;
+    }
+
+    gst_query_set_caps_result (query, caps);
+    gst_caps_unref (caps);
+
+    return TRUE;
+  }
+
+  return gst_collect_pads_query_default (pads, cdata, query, FALSE);
+}
+
+static gboolean
+_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstGainMixer *self = GST_GAIN_MIXER (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_QOS:
+    case GST_EVENT_NAVIGATION:
+      gst_event_unref (event);
+      return FALSE;
+    case GST_EVENT_SEEK:
+    {
+      GstSeekFlags flags;
+
+      gst_event_parse_seek (event, NULL, NULL, &flags, NULL, NULL, NULL, NULL);
+      if (flags & GST_SEEK_FLAG_FLUSH) {
+        /* Stop collecting right away, the flush events coming back from the
+         * inputs reset us */
+        gst_collect_pads_set_flushing (self->collect, TRUE);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+
+  /* Sent to all the inputs */
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static GstPad *
+_request_new_pad (GstElement * element, GstPadTemplate * templ,
+    const gchar * name, const GstCaps * caps)
+{
+  gchar *padname;
+  GstPad *pad;
+  GstGainMixer *self = GST_GAIN_MIXER (element);
+
+  padname = g_strdup_printf ("sink_%u",
+      g_atomic_int_add (&self->padcount, 1));
+  pad = g_object_new (GST_TYPE_GAIN_MIXER_PAD, "name", padname, "direction",
+      GST_PAD_TEMPLATE_DIRECTION (templ), "template", templ, NULL);
+  g_free (padname);
+
+  gst_collect_pads_add_pad (self->collect, pad, sizeof (GstCollectData),
+      NULL, TRUE);
+
+  gst_pad_set_active (pad, TRUE);
+  if (!gst_element_add_pad (element, pad)) {
+    gst_collect_pads_remove_pad (self->collect, pad);
+    gst_object_unref (pad);
+
+    return NULL;
+  }
+
+  return pad;
+}
+
+static void
+_release_pad (GstElement * element, GstPad * pad)
+{
+  GstGainMixer *self = GST_GAIN_MIXER (element);
+
+  gst_collect_pads_remove_pad (self->collect, pad);
+  gst_element_remove_pad (element, pad);
+}
+
+static GstStateChangeReturn
+_change_state (GstElement * element, GstStateChange transition)
+{
+  GstGainMixer *self = GST_GAIN_MIXER (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      _reset (self);
+      self->send_stream_start = TRUE;
+      g_atomic_int_set (&self->flushing, FALSE);
+      gst_collect_pads_start (self->collect);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* Stop before chaining up to unblock the streaming thread */
+      gst_collect_pads_stop (self->collect);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (gst_gain_mixer_parent_class)->change_state (element,
+      transition);
+
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY)
+    gst_pad_set_caps (self->srcpad, NULL);
+
+  return ret;
+}
+
+static void
+gst_gain_mixer_finalize (GObject * object)
+{
+  GstGainMixer *self = GST_GAIN_MIXER (object);
+
+  gst_object_unref (self->collect);
+
+  G_OBJECT_CLASS (gst_gain_mixer_parent_class)->finalize (object);
+}
+
+static void
+gst_gain_mixer_class_init (GstGainMixerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  gobject_class->finalize = gst_gain_mixer_finalize;
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&src_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&sink_template));
+
+  element_class->request_new_pad = GST_DEBUG_FUNCPTR (_request_new_pad);
+  element_class->release_pad = GST_DEBUG_FUNCPTR (_release_pad);
+  element_class->change_state = GST_DEBUG_FUNCPTR (_change_state);
+
+  gst_element_class_set_static_metadata (element_class, "Gain mixer",
+      "Generic/Audio",
+      "Mixes raw float audio streams, applying a gain to each of them",
+      "GStreamer Editing Services contributors");
+}
+
+static void
+gst_gain_mixer_init (GstGainMixer * self)
+{
+  self->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  gst_pad_set_event_function (self->srcpad, GST_DEBUG_FUNCPTR (_src_event));
+  gst_pad_use_fixed_caps (self->srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  gst_audio_info_init (&self->info);
+  self->padcount = 0;
+  _reset (self);
+
+  self->collect = gst_collect_pads_new ();
+  gst_collect_pads_set_function (self->collect,
+      (GstCollectPadsFunction) GST_DEBUG_FUNCPTR (_collected), self);
+  gst_collect_pads_set_event_function (self->collect,
+      (GstCollectPadsEventFunction) GST_DEBUG_FUNCPTR (_sink_event), self);
+  gst_collect_pads_set_query_function (self->collect,
+      (GstCollectPadsQueryFunction) GST_DEBUG_FUNCPTR (_sink_query), self);
+}
@@ -0,0 +1,122 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _GST_GAIN_MIXER_H_
+#define _GST_GAIN_MIXER_H_
+
+#include <gst/gst.h>
+#include <gst/base/gstcollectpads.h>
+#include <gst/audio/audio.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_GAIN_MIXER   (gst_gain_mixer_get_type())
+#define GST_GAIN_MIXER(obj)   (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_GAIN_MIXER,GstGainMixer))
+#define GST_GAIN_MIXER_CLASS(klass)   (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_GAIN_MIXER,GstGainMixerClass))
+#define GST_IS_GAIN_MIXER(obj)   (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_GAIN_MIXER))
+#define GST_IS_GAIN_MIXER_CLASS(klass)   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_GAIN_MIXER))
+
+#define GST_TYPE_GAIN_MIXER_PAD   (gst_gain_mixer_pad_get_type())
+#define GST_GAIN_MIXER_PAD(obj)   (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_GAIN_MIXER_PAD,GstGainMixerPad))
+#define GST_IS_GAIN_MIXER_PAD(obj)   (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_GAIN_MIXER_PAD))
+
+/* Gain curves precomputed by the pads */
+typedef enum
+{
+  GST_GAIN_MIXER_FADE_NONE,
+  GST_GAIN_MIXER_FADE_IN,
+  GST_GAIN_MIXER_FADE_OUT
+} GstGainMixerFade;
+
+typedef struct _GstGainMixer GstGainMixer;
+typedef struct _GstGainMixerClass GstGainMixerClass;
+typedef struct _GstGainMixerPad GstGainMixerPad;
+typedef struct _GstGainMixerPadClass GstGainMixerPadClass;
+
+struct _GstGainMixer
+{
+  GstElement parent;
+
+  GstPad *srcpad;
+  GstCollectPads *collect;
+  gint padcount;
+
+  /* The negotiated format, always interleaved native endian F32 */
+  GstAudioInfo info;
+
+  /* The segment of the first input, used as output segment, and the
+   * timestamp of the first output buffer in it. The gains of each input are
+   * computed in its own segment */
+  GstSegment segment;
+  gboolean have_segment;
+  gboolean new_segment_pending;
+  GstClockTime base_ts;
+  guint64 offset;
+
+  gboolean send_stream_start;
+  gint flushing;
+
+  /*  This should never be made public, no padding needed */
+};
+
+struct _GstGainMixerClass
+{
+  GstElementClass parent_class;
+};
+
+struct _GstGainMixerPad
+{
+  GstPad parent;
+
+  /* Protected by the object lock */
+  gdouble volume;
+  GstGainMixerFade fade;
+  gboolean constant_power;
+  GstClockTime fade_duration;
+  gboolean table_valid;
+
+  /* Streaming thread only: the fade gains, one per frame from the start of
+   * the stream, computed once for the negotiated rate */
+  gfloat *table;
+  guint table_frames;
+  gint table_rate;
+
+  /* Values of the volume control bindings, one per frame */
+  gdouble *values;
+  guint n_values;
+
+  /* Per sample gains of the buffer being mixed */
+  gfloat *gains;
+  guint n_gains;
+};
+
+struct _GstGainMixerPadClass
+{
+  GstPadClass parent_class;
+};
+
+GType gst_gain_mixer_get_type (void);
+GType gst_gain_mixer_pad_get_type (void);
+
+void gst_gain_mixer_pad_set_fade (GstGainMixerPad *pad, GstGainMixerFade fade,
+                                  gboolean constant_power, GstClockTime duration);
+
+G_END_DECLS
+
+#endif
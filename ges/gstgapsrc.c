@@ -0,0 +1,478 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2013 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Source filling the gaps of raw audio and video tracks with silence or
+ * black frames. The content of the stream never changes, so we render a
+ * single buffer per caps, share it between all the gaps of the process
+ * and push references to it. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <gst/audio/audio.h>
+
+#include "ges-internal.h"
+#include "gstgapsrc.h"
+
+#define DEFAULT_WIDTH  320
+#define DEFAULT_HEIGHT 240
+#define DEFAULT_FPS_N  30
+#define DEFAULT_FPS_D  1
+#define DEFAULT_RATE   44100
+#define DEFAULT_SAMPLES_PER_BUFFER 1024
+
+/* Number of different buffers kept around for all the gaps */
+#define MAX_SHARED_BUFFERS 8
+
+#define VIDEO_CAPS GST_VIDEO_CAPS_MAKE ("{ AYUV, I420, YV12, Y42B, Y444, " \
+    "YUY2, UYVY, NV12, NV21, ARGB, BGRA, RGBA, ABGR, xRGB, BGRx, RGBx, " \
+    "xBGR, RGB, BGR }")
+
+#define AUDIO_CAPS "audio/x-raw, format = (string) { " GST_AUDIO_NE (S16) \
+    ", " GST_AUDIO_NE (S32) ", " GST_AUDIO_NE (F32) ", " GST_AUDIO_NE (F64) \
+    " }, layout = (string) interleaved, rate = " GST_AUDIO_RATE_RANGE \
+    ", channels = " GST_AUDIO_CHANNELS_RANGE
+
+static GstStaticPadTemplate gst_gap_src_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (VIDEO_CAPS ";" AUDIO_CAPS)
+    );
+
+static GstStaticCaps video_caps = GST_STATIC_CAPS (VIDEO_CAPS);
+static GstStaticCaps audio_caps = GST_STATIC_CAPS (AUDIO_CAPS);
+
+typedef struct
+{
+  GstCaps *caps;
+  GstBuffer *buffer;
+} SharedBuffer;
+
+/* Most recently used first */
+static GList *shared_buffers = NULL;
+G_LOCK_DEFINE_STATIC (shared_buffers_lock);
+
+G_DEFINE_TYPE (GstGapSrc, gst_gap_src, GST_TYPE_PUSH_SRC);
+
+/* Renders a black frame, going through the unpack format of @info so we do
+ * not have to know about the memory layout of every format */
+static GstBuffer *
+_create_black_frame (GstVideoInfo * info)
+{
+  gint i, y;
+  guint8 *line;
+  GstMapInfo map;
+  GstBuffer *buffer;
+  gpointer planes[GST_VIDEO_MAX_PLANES];
+  gint strides[GST_VIDEO_MAX_PLANES];
+  const GstVideoFormatInfo *finfo = info->finfo;
+  gint width = GST_VIDEO_INFO_WIDTH (info);
+  gint height = GST_VIDEO_INFO_HEIGHT (info);
+  gboolean is_yuv = GST_VIDEO_FORMAT_INFO_IS_YUV (finfo);
+  gboolean wide = finfo->unpack_format == GST_VIDEO_FORMAT_AYUV64 ||
+      finfo->unpack_format == GST_VIDEO_FORMAT_ARGB64;
+  gint pstride = wide ? 8 : 4;
+
+  buffer = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (info), NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+
+  line = g_malloc (width * pstride * finfo->pack_lines);
+  for (i = 0; i < width * finfo->pack_lines; i++) {
+    if (wide) {
+      guint16 *p = (guint16 *) (line + i * pstride);
+
+      p[0] = 0xffff;
+      p[1] = is_yuv ? 16 << 8 : 0;
+      p[2] = p[3] = is_yuv ? 128 << 8 : 0;
+    } else {
+      guint8 *p = line + i * pstride;
+
+      p[0] = 0xff;
+      p[1] = is_yuv ? 16 : 0;
+      p[2] = p[3] = is_yuv ? 128 : 0;
+    }
+  }
+
+  for (i = 0; i < GST_VIDEO_INFO_N_PLANES (info); i++) {
+    planes[i] = map.data + GST_VIDEO_INFO_PLANE_OFFSET (info, i);
+    strides[i] = GST_VIDEO_INFO_PLANE_STRIDE (info, i);
+  }
+
+  for (y = 0; y < height; y += finfo->pack_lines)
+    finfo->pack_func (finfo, GST_VIDEO_PACK_FLAG_NONE, line,
+        width * pstride, planes, strides, GST_VIDEO_CHROMA_SITE_UNKNOWN, y,
+        width);
+
+  g_free (line);
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
+/* All the formats we accept are signed or float, so silence is all zeros */
+static GstBuffer *
+_create_silence (gint bpf, guint samples)
+{
+  GstBuffer *buffer = gst_buffer_new_allocate (NULL, bpf * samples, NULL);
+
+  gst_buffer_memset (buffer, 0, 0, bpf * samples);
+
+  return buffer;
+}
+
+static GstBuffer *
+_lookup_shared_buffer (GstCaps * caps)
+{
+  GList *tmp;
+  GstBuffer *ret = NULL;
+
+  G_LOCK (shared_buffers_lock);
+  for (tmp = shared_buffers; tmp; tmp = tmp->next) {
+    SharedBuffer *shared = tmp->data;
+
+    if (gst_caps_is_equal (shared->caps, caps)) {
+      ret = gst_buffer_ref (shared->buffer);
+      shared_buffers = g_list_remove_link (shared_buffers, tmp);
+      shared_buffers = g_list_concat (tmp, shared_buffers);
+      break;
+    }
+  }
+  G_UNLOCK (shared_buffers_lock);
+
+  return ret;
+}
+
+static void
+_add_shared_buffer (GstCaps * caps, GstBuffer * buffer)
+{
+  GList *last;
+  SharedBuffer *shared = g_slice_new (SharedBuffer);
+
+  shared->caps = gst_caps_ref (caps);
+  shared->buffer = gst_buffer_ref (buffer);
+
+  G_LOCK (shared_buffers_lock);
+  shared_buffers = g_list_prepend (shared_buffers, shared);
+  if (g_list_length (shared_buffers) > MAX_SHARED_BUFFERS) {
+    last = g_list_last (shared_buffers);
+    shared = last->data;
+    shared_buffers = g_list_delete_link (shared_buffers, last);
+    gst_caps_unref (shared->caps);
+    gst_buffer_unref (shared->buffer);
+    g_slice_free (SharedBuffer, shared);
+  }
+  G_UNLOCK (shared_buffers_lock);
+}
+
+/* Time of the frame or sample @offset in the current caps */
+static GstClockTime
+_offset_to_time (GstGapSrc * self, guint64 offset)
+{
+  if (self->track_type == GES_TRACK_TYPE_AUDIO)
+    return gst_util_uint64_scale (offset, GST_SECOND, self->rate);
+
+  return gst_util_uint64_scale (offset, self->fps_d * GST_SECOND, self->fps_n);
+}
+
+/* First frame or sample of the current caps starting at or after @time, if
+ * @round_up, else the one containing @time */
+static guint64
+_time_to_offset (GstGapSrc * self, GstClockTime time, gboolean round_up)
+{
+  if (self->track_type == GES_TRACK_TYPE_AUDIO)
+    return round_up ? gst_util_uint64_scale_ceil (time, self->rate, GST_SECOND)
+        : gst_util_uint64_scale (time, self->rate, GST_SECOND);
+
+  return round_up ? gst_util_uint64_scale_ceil (time, self->fps_n,
+      self->fps_d * GST_SECOND) : gst_util_uint64_scale (time, self->fps_n,
+      self->fps_d * GST_SECOND);
+}
+
+static GstCaps *
+gst_gap_src_get_caps (GstBaseSrc * bsrc, GstCaps * filter)
+{
+  GstCaps *caps, *restriction = NULL, *tmp;
+  GstGapSrc *self = GST_GAP_SRC (bsrc);
+
+  if (self->track_type == GES_TRACK_TYPE_AUDIO)
+    caps = gst_static_caps_get (&audio_caps);
+  else
+    caps = gst_static_caps_get (&video_caps);
+
+  if (self->track)
+    g_object_get (self->track, "restriction-caps", &restriction, NULL);
+
+  if (restriction) {
+    tmp = gst_caps_intersect (caps, restriction);
+    if (!gst_caps_is_empty (tmp)) {
+      gst_caps_unref (caps);
+      caps = tmp;
+    } else {
+      gst_caps_unref (tmp);
+    }
+    gst_caps_unref (restriction);
+  }
+
+  if (filter) {
+    tmp = gst_caps_intersect_full (filter, caps, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (caps);
+    caps = tmp;
+  }
+
+  return caps;
+}
+
+static GstCaps *
+gst_gap_src_fixate (GstBaseSrc * bsrc, GstCaps * caps)
+{
+  GstStructure *structure;
+
+  caps = gst_caps_make_writable (caps);
+  caps = gst_caps_truncate (caps);
+  structure = gst_caps_get_structure (caps, 0);
+
+  if (gst_structure_has_name (structure, "video/x-raw")) {
+    gst_structure_fixate_field_nearest_int (structure, "width", DEFAULT_WIDTH);
+    gst_structure_fixate_field_nearest_int (structure, "height",
+        DEFAULT_HEIGHT);
+    gst_structure_fixate_field_nearest_fraction (structure, "framerate",
+        DEFAULT_FPS_N, DEFAULT_FPS_D);
+    if (gst_structure_has_field (structure, "pixel-aspect-ratio"))
+      gst_structure_fixate_field_nearest_fraction (structure,
+          "pixel-aspect-ratio", 1, 1);
+  } else {
+    gst_structure_fixate_field_nearest_int (structure, "rate", DEFAULT_RATE);
+    gst_structure_fixate_field_nearest_int (structure, "channels", 1);
+  }
+
+  return GST_BASE_SRC_CLASS (gst_gap_src_parent_class)->fixate (bsrc, caps);
+}
+
+static gboolean
+gst_gap_src_set_caps (GstBaseSrc * bsrc, GstCaps * caps)
+{
+  GstBuffer *buffer;
+  GstClockTime position = GST_CLOCK_TIME_NONE;
+  GstGapSrc *self = GST_GAP_SRC (bsrc);
+  GstStructure *structure = gst_caps_get_structure (caps, 0);
+
+  /* The offset counts frames or samples in the previous caps, remember where
+   * we are in time to carry on from there with the new ones */
+  if (self->buffer)
+    position = _offset_to_time (self, self->offset);
+
+  if (gst_structure_has_name (structure, "video/x-raw")) {
+    GstVideoInfo info;
+
+    if (!gst_video_info_from_caps (&info, caps))
+      goto invalid_caps;
+
+    self->fps_n = GST_VIDEO_INFO_FPS_N (&info);
+    self->fps_d = GST_VIDEO_INFO_FPS_D (&info);
+    if (self->fps_n == 0) {
+      self->fps_n = DEFAULT_FPS_N;
+      self->fps_d = DEFAULT_FPS_D;
+    }
+
+    buffer = _lookup_shared_buffer (caps);
+    if (buffer == NULL) {
+      buffer = _create_black_frame (&info);
+      _add_shared_buffer (caps, buffer);
+    }
+  } else {
+    gint channels;
+    const gchar *format;
+    gint bps = 0;
+
+    format = gst_structure_get_string (structure, "format");
+    if (!format || !gst_structure_get_int (structure, "rate", &self->rate) ||
+        !gst_structure_get_int (structure, "channels", &channels))
+      goto invalid_caps;
+
+    if (g_str_has_prefix (format, "S16"))
+      bps = 2;
+    else if (g_str_has_prefix (format, "S32") ||
+        g_str_has_prefix (format, "F32"))
+      bps = 4;
+    else if (g_str_has_prefix (format, "F64"))
+      bps = 8;
+    else
+      goto invalid_caps;
+
+    buffer = _lookup_shared_buffer (caps);
+    if (buffer == NULL) {
+      buffer = _create_silence (bps * channels, self->samples_per_buffer);
+      _add_shared_buffer (caps, buffer);
+    }
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (position))
+    self->offset = _time_to_offset (self, position, TRUE);
+
+  GST_DEBUG_OBJECT (self, "Filling gaps with %" GST_PTR_FORMAT, caps);
+  gst_buffer_replace (&self->buffer, buffer);
+  gst_buffer_unref (buffer);
+
+  return TRUE;
+
+invalid_caps:
+  {
+    GST_WARNING_OBJECT (self, "Can not fill gaps with %" GST_PTR_FORMAT, caps);
+
+    return FALSE;
+  }
+}
+
+static gboolean
+gst_gap_src_is_seekable (GstBaseSrc * bsrc)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_gap_src_do_seek (GstBaseSrc * bsrc, GstSegment * segment)
+{
+  GstGapSrc *self = GST_GAP_SRC (bsrc);
+
+  segment->time = segment->start;
+
+  /* Stay aligned on the frame/sample grid of the timeline */
+  self->offset = _time_to_offset (self, segment->start, FALSE);
+
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_gap_src_create (GstPushSrc * psrc, GstBuffer ** buf)
+{
+  guint64 next_offset;
+  GstClockTime pts, next_pts;
+  GstGapSrc *self = GST_GAP_SRC (psrc);
+  GstSegment *segment = &GST_BASE_SRC (psrc)->segment;
+
+  if (G_UNLIKELY (self->buffer == NULL))
+    return GST_FLOW_NOT_NEGOTIATED;
+
+  if (self->track_type == GES_TRACK_TYPE_AUDIO)
+    next_offset = self->offset + self->samples_per_buffer;
+  else
+    next_offset = self->offset + 1;
+  pts = _offset_to_time (self, self->offset);
+  next_pts = _offset_to_time (self, next_offset);
+
+  if (GST_CLOCK_TIME_IS_VALID (segment->stop) && pts >= segment->stop)
+    return GST_FLOW_EOS;
+
+  /* Only the metadata is copied, the memory is shared */
+  *buf = gst_buffer_copy (self->buffer);
+  GST_BUFFER_PTS (*buf) = GST_BUFFER_DTS (*buf) = pts;
+  GST_BUFFER_DURATION (*buf) = next_pts - pts;
+  GST_BUFFER_OFFSET (*buf) = self->offset;
+  GST_BUFFER_OFFSET_END (*buf) = next_offset;
+  self->offset = next_offset;
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+gst_gap_src_stop (GstBaseSrc * bsrc)
+{
+  GstGapSrc *self = GST_GAP_SRC (bsrc);
+
+  gst_buffer_replace (&self->buffer, NULL);
+  self->offset = 0;
+
+  return TRUE;
+}
+
+static void
+gst_gap_src_dispose (GObject * object)
+{
+  GstGapSrc *self = GST_GAP_SRC (object);
+
+  if (self->track) {
+    g_object_remove_weak_pointer (G_OBJECT (self->track),
+        (gpointer *) & self->track);
+    self->track = NULL;
+  }
+
+  gst_buffer_replace (&self->buffer, NULL);
+
+  G_OBJECT_CLASS (gst_gap_src_parent_class)->dispose (object);
+}
+
+static void
+gst_gap_src_class_init (GstGapSrcClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstBaseSrcClass *base_src_class = GST_BASE_SRC_CLASS (klass);
+  GstPushSrcClass *push_src_class = GST_PUSH_SRC_CLASS (klass);
+
+  gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
+      gst_static_pad_template_get (&gst_gap_src_src_template));
+
+  gobject_class->dispose = gst_gap_src_dispose;
+
+  base_src_class->get_caps = GST_DEBUG_FUNCPTR (gst_gap_src_get_caps);
+  base_src_class->fixate = GST_DEBUG_FUNCPTR (gst_gap_src_fixate);
+  base_src_class->set_caps = GST_DEBUG_FUNCPTR (gst_gap_src_set_caps);
+  base_src_class->is_seekable = GST_DEBUG_FUNCPTR (gst_gap_src_is_seekable);
+  base_src_class->do_seek = GST_DEBUG_FUNCPTR (gst_gap_src_do_seek);
+  base_src_class->stop = GST_DEBUG_FUNCPTR (gst_gap_src_stop);
+  push_src_class->create = GST_DEBUG_FUNCPTR (gst_gap_src_create);
+
+  gst_element_class_set_static_metadata (GST_ELEMENT_CLASS (klass),
+      "Gap filler", "Source/Audio/Video",
+      "Fills the gaps of a GESTrack with silence or black frames",
+      "GStreamer Editing Services contributors");
+}
+
+static void
+gst_gap_src_init (GstGapSrc * self)
+{
+  self->track = NULL;
+  self->track_type = GES_TRACK_TYPE_VIDEO;
+  self->buffer = NULL;
+  self->fps_n = DEFAULT_FPS_N;
+  self->fps_d = DEFAULT_FPS_D;
+  self->rate = DEFAULT_RATE;
+  self->samples_per_buffer = DEFAULT_SAMPLES_PER_BUFFER;
+  self->offset = 0;
+
+  gst_base_src_set_format (GST_BASE_SRC (self), GST_FORMAT_TIME);
+}
+
+/* Creates a source filling the gaps of @track, following its
+ * restriction caps */
+GstElement *
+ges_gap_src_new (GESTrack * track)
+{
+  GstGapSrc *self = g_object_new (GST_TYPE_GAP_SRC, NULL);
+
+  self->track = track;
+  self->track_type = track->type;
+  g_object_add_weak_pointer (G_OBJECT (track), (gpointer *) & self->track);
+
+  return GST_ELEMENT (self);
+}
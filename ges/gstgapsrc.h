@@ -0,0 +1,70 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2013 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _GST_GAP_SRC_H_
+#define _GST_GAP_SRC_H_
+
+#include <gst/base/gstpushsrc.h>
+#include <ges/ges-track.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_GAP_SRC   (gst_gap_src_get_type())
+#define GST_GAP_SRC(obj)   (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_GAP_SRC,GstGapSrc))
+#define GST_GAP_SRC_CLASS(klass)   (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_GAP_SRC,GstGapSrcClass))
+#define GST_IS_GAP_SRC(obj)   (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_GAP_SRC))
+#define GST_IS_GAP_SRC_CLASS(klass)   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_GAP_SRC))
+
+typedef struct _GstGapSrc GstGapSrc;
+typedef struct _GstGapSrcClass GstGapSrcClass;
+
+struct _GstGapSrc
+{
+  GstPushSrc parent;
+
+  /* The track we fill gaps of, we only use its restriction caps when
+   * negotiating */
+  GESTrack *track;
+  GESTrackType track_type;
+
+  /* The black frame or silence we push over and over */
+  GstBuffer *buffer;
+
+  /* Video: frame duration, audio: rate */
+  gint fps_n;
+  gint fps_d;
+  gint rate;
+  guint samples_per_buffer;
+
+  /* Frames or samples produced since the last seek */
+  guint64 offset;
+
+  /*  This should never be made public, no padding needed */
+};
+
+struct _GstGapSrcClass
+{
+  GstPushSrcClass parent_class;
+};
+
+GType gst_gap_src_get_type (void);
+
+G_END_DECLS
+
+#endif
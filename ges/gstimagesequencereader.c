@@ -0,0 +1,646 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Source reading and decoding a sequence of image files, one per frame.
+ *
+ * Image sequences are usually made of big, independently coded frames, so
+ * instead of reading and decoding them one after the other we keep up to
+ * cache_size frames after the current position decoded in advance by a
+ * pool of workers. The files are memory mapped and handed over to the
+ * decoders without copying them.
+ *
+ * Each worker decodes with a small "appsrc ! decoder ! videoconvert !
+ * videoscale ! capsfilter ! appsink" pipeline, prerolling it on one file at
+ * a time. Frames are converted to the same caps as the still images of the
+ * image cache, so that frames already decoded there are reused. Those pipelines are kept around and
+ * reused by any worker. Decoded frames are stored by index and pushed in
+ * order; the ones that fall out of the window after a seek are dropped. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/base/gsttypefindhelper.h>
+
+#include "ges-internal.h"
+#include "gstimagesequencereader.h"
+
+/* Maximum number of frames decoded at the same time */
+#define MAX_WORKERS 8
+
+/* How long a frame can take to decode, so that a stuck decoder does not
+ * block a worker forever */
+#define DECODE_TIMEOUT (5 * GST_SECOND)
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-raw")
+    );
+
+typedef struct
+{
+  GstElement *pipeline;
+  GstElement *src;
+  GstElement *sink;
+} FrameDecoder;
+
+G_DEFINE_TYPE (GstImageSequenceReader, gst_image_sequence_reader,
+    GST_TYPE_PUSH_SRC);
+
+static void
+_free_decoder (FrameDecoder * decoder)
+{
+  gst_element_set_state (decoder->pipeline, GST_STATE_NULL);
+  gst_object_unref (decoder->pipeline);
+  g_slice_free (FrameDecoder, decoder);
+}
+
+static void
+_unref_sample (GstSample * sample)
+{
+  /* Frames that could not be decoded are stored as NULL */
+  if (sample)
+    gst_sample_unref (sample);
+}
+
+static GstElementFactory *
+_find_decoder (GstCaps * caps)
+{
+  GList *factories, *decoders;
+  GstElementFactory *factory = NULL;
+
+  factories =
+      gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_DECODER,
+      GST_RANK_MARGINAL);
+  decoders = gst_element_factory_list_filter (factories, caps, GST_PAD_SINK,
+      FALSE);
+  decoders = g_list_sort (decoders, gst_plugin_feature_rank_compare_func);
+
+  if (decoders)
+    factory = gst_object_ref (decoders->data);
+
+  gst_plugin_feature_list_free (decoders);
+  gst_plugin_feature_list_free (factories);
+
+  return factory;
+}
+
+static FrameDecoder *
+_create_decoder (GstImageSequenceReader * self)
+{
+  GstElement *decoder, *convert, *scale, *filter;
+  FrameDecoder *ret = g_slice_new0 (FrameDecoder);
+
+  ret->pipeline = gst_pipeline_new (NULL);
+  ret->src = gst_element_factory_make ("appsrc", NULL);
+  decoder = gst_element_factory_create (self->decoder_factory, NULL);
+  convert = gst_element_factory_make ("videoconvert", NULL);
+  scale = gst_element_factory_make ("videoscale", NULL);
+  filter = gst_element_factory_make ("capsfilter", NULL);
+  ret->sink = gst_element_factory_make ("appsink", NULL);
+
+  if (!ret->src || !decoder || !convert || !scale || !filter || !ret->sink) {
+    GST_WARNING_OBJECT (self, "Could not create a decoder");
+    gst_object_unref (ret->pipeline);
+    if (ret->src)
+      gst_object_unref (ret->src);
+    if (decoder)
+      gst_object_unref (decoder);
+    if (convert)
+      gst_object_unref (convert);
+    if (scale)
+      gst_object_unref (scale);
+    if (filter)
+      gst_object_unref (filter);
+    if (ret->sink)
+      gst_object_unref (ret->sink);
+    g_slice_free (FrameDecoder, ret);
+
+    return NULL;
+  }
+
+  g_object_set (ret->src, "caps", self->input_caps, NULL);
+  /* Same conversion as the image cache */
+  g_object_set (scale, "add-borders", TRUE, NULL);
+  if (self->target_caps)
+    g_object_set (filter, "caps", self->target_caps, NULL);
+  g_object_set (ret->sink, "sync", FALSE, NULL);
+
+  gst_bin_add_many (GST_BIN (ret->pipeline), ret->src, decoder, convert,
+      scale, filter, ret->sink, NULL);
+  if (!gst_element_link_many (ret->src, decoder, convert, scale, filter,
+          ret->sink, NULL)) {
+    GST_WARNING_OBJECT (self, "Could not link %" GST_PTR_FORMAT, decoder);
+    _free_decoder (ret);
+
+    return NULL;
+  }
+
+  return ret;
+}
+
+/* The decoder pipeline prerolls on the decoded frame */
+static GstSample *
+_decode (FrameDecoder * decoder, GstBuffer * buffer)
+{
+  GstFlowReturn ret;
+  GstSample *sample = NULL;
+
+  gst_element_set_state (decoder->pipeline, GST_STATE_READY);
+  gst_element_set_state (decoder->pipeline, GST_STATE_PAUSED);
+
+  g_signal_emit_by_name (decoder->src, "push-buffer", buffer, &ret);
+  g_signal_emit_by_name (decoder->src, "end-of-stream", &ret);
+
+  switch (gst_element_get_state (decoder->pipeline, NULL, NULL,
+          DECODE_TIMEOUT)) {
+    case GST_STATE_CHANGE_SUCCESS:
+      g_signal_emit_by_name (decoder->sink, "pull-preroll", &sample);
+      break;
+    case GST_STATE_CHANGE_ASYNC:
+      GST_WARNING ("Timed out decoding a frame");
+      break;
+    default:
+      break;
+  }
+
+  return sample;
+}
+
+/* Wraps the content of @filename without copying it */
+static GstBuffer *
+_map_file (GstImageSequenceReader * self, const gchar * filename)
+{
+  gsize size;
+  GError *err = NULL;
+  GMappedFile *mapped = g_mapped_file_new (filename, FALSE, &err);
+
+  if (mapped == NULL) {
+    GST_WARNING_OBJECT (self, "Could not map %s: %s", filename, err->message);
+    g_clear_error (&err);
+
+    return NULL;
+  }
+
+  size = g_mapped_file_get_length (mapped);
+  if (size == 0) {
+    GST_WARNING_OBJECT (self, "%s is empty", filename);
+    g_mapped_file_unref (mapped);
+
+    return NULL;
+  }
+
+  return gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      g_mapped_file_get_contents (mapped), size, 0, size, mapped,
+      (GDestroyNotify) g_mapped_file_unref);
+}
+
+/* Called with the lock taken */
+static gboolean
+_in_window (GstImageSequenceReader * self, guint index)
+{
+  return index >= self->position && index < self->position + self->cache_size;
+}
+
+static gboolean
+_outside_window (gpointer key, gpointer value, GstImageSequenceReader * self)
+{
+  return !_in_window (self, GPOINTER_TO_UINT (key));
+}
+
+/* Called with the lock taken, queues the decoding of the frames of the
+ * window that are neither decoded nor being decoded */
+static void
+_schedule (GstImageSequenceReader * self)
+{
+  guint64 i, end = MIN (self->position + self->cache_size, self->n_files);
+
+  for (i = self->position; i < end; i++) {
+    gpointer key = GUINT_TO_POINTER (i);
+
+    if (g_hash_table_contains (self->frames, key) ||
+        g_hash_table_contains (self->pending, key))
+      continue;
+
+    g_hash_table_add (self->pending, key);
+    /* Tasks can not be NULL */
+    g_thread_pool_push (self->workers, GUINT_TO_POINTER (i + 1), NULL);
+  }
+}
+
+static void
+_decode_frame (gpointer data, GstImageSequenceReader * self)
+{
+  gboolean wanted;
+  GstBuffer *buffer;
+  GstSample *sample = NULL;
+  FrameDecoder *decoder;
+  guint index = GPOINTER_TO_UINT (data) - 1;
+
+  g_mutex_lock (&self->lock);
+  wanted = !self->flushing && _in_window (self, index);
+  g_mutex_unlock (&self->lock);
+
+  /* The frame might be used as a still image somewhere else */
+  if (wanted) {
+    gchar *uri = gst_filename_to_uri (self->filenames[index], NULL);
+
+    if (uri)
+      sample = ges_image_cache_peek (uri, self->target_caps);
+    g_free (uri);
+  }
+
+  if (wanted && sample == NULL &&
+      (buffer = _map_file (self, self->filenames[index]))) {
+    decoder = g_async_queue_try_pop (self->idle_decoders);
+    if (decoder == NULL)
+      decoder = _create_decoder (self);
+
+    if (decoder) {
+      sample = _decode (decoder, buffer);
+      g_async_queue_push (self->idle_decoders, decoder);
+    }
+
+    gst_buffer_unref (buffer);
+  }
+
+  g_mutex_lock (&self->lock);
+  g_hash_table_remove (self->pending, GUINT_TO_POINTER (index));
+  /* We might have seeked away in the meantime */
+  if (wanted && _in_window (self, index)) {
+    if (sample == NULL)
+      GST_WARNING_OBJECT (self, "Could not decode %s", self->filenames[index]);
+    g_hash_table_insert (self->frames, GUINT_TO_POINTER (index), sample);
+  } else if (sample) {
+    gst_sample_unref (sample);
+  }
+  g_cond_broadcast (&self->cond);
+  g_mutex_unlock (&self->lock);
+}
+
+static GstCaps *
+_frame_caps (GstImageSequenceReader * self, GstCaps * caps)
+{
+  caps = gst_caps_copy (caps);
+  gst_caps_set_simple (caps, "framerate", GST_TYPE_FRACTION, self->fps_n,
+      self->fps_d, NULL);
+
+  return caps;
+}
+
+static gboolean
+gst_image_sequence_reader_start (GstBaseSrc * bsrc)
+{
+  guint n_workers;
+  GstBuffer *buffer;
+  GESTrackElement *track_element;
+  GstImageSequenceReader *self = GST_IMAGE_SEQUENCE_READER (bsrc);
+
+  if (self->n_files == 0) {
+    GST_ELEMENT_ERROR (self, RESOURCE, NOT_FOUND, (NULL),
+        ("No image to read"));
+
+    return FALSE;
+  }
+
+  /* All the files are expected to be in the same format */
+  buffer = _map_file (self, self->filenames[0]);
+  if (buffer == NULL) {
+    GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ, (NULL),
+        ("Could not read %s", self->filenames[0]));
+
+    return FALSE;
+  }
+
+  self->input_caps = gst_type_find_helper_for_buffer (GST_OBJECT (self),
+      buffer, NULL);
+  gst_buffer_unref (buffer);
+  if (self->input_caps == NULL) {
+    GST_ELEMENT_ERROR (self, STREAM, TYPE_NOT_FOUND, (NULL),
+        ("Could not find the type of %s", self->filenames[0]));
+
+    return FALSE;
+  }
+
+  self->decoder_factory = _find_decoder (self->input_caps);
+  if (self->decoder_factory == NULL) {
+    GST_ELEMENT_ERROR (self, STREAM, CODEC_NOT_FOUND, (NULL),
+        ("No decoder for %" GST_PTR_FORMAT, self->input_caps));
+    gst_caps_replace (&self->input_caps, NULL);
+
+    return FALSE;
+  }
+
+  track_element = g_weak_ref_get (&self->track_element);
+  self->target_caps = ges_image_cache_get_target_caps (track_element);
+  if (track_element)
+    gst_object_unref (track_element);
+
+#if GLIB_CHECK_VERSION (2, 36, 0)
+  n_workers = MIN (g_get_num_processors (), MAX_WORKERS);
+#else
+  n_workers = MAX_WORKERS / 2;
+#endif
+  n_workers = CLAMP (n_workers, 1, self->cache_size);
+
+  GST_DEBUG_OBJECT (self, "Decoding %" GST_PTR_FORMAT " with %s to %"
+      GST_PTR_FORMAT ", %u frames ahead on %u threads", self->input_caps,
+      GST_OBJECT_NAME (self->decoder_factory), self->target_caps,
+      self->cache_size, n_workers);
+
+  self->idle_decoders =
+      g_async_queue_new_full ((GDestroyNotify) _free_decoder);
+  self->workers = g_thread_pool_new ((GFunc) _decode_frame, self, n_workers,
+      FALSE, NULL);
+  self->position = 0;
+  self->flushing = FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+gst_image_sequence_reader_stop (GstBaseSrc * bsrc)
+{
+  GstImageSequenceReader *self = GST_IMAGE_SEQUENCE_READER (bsrc);
+
+  g_mutex_lock (&self->lock);
+  self->flushing = TRUE;
+  g_cond_broadcast (&self->cond);
+  g_mutex_unlock (&self->lock);
+
+  /* Drops the frames not being decoded yet */
+  if (self->workers)
+    g_thread_pool_free (self->workers, TRUE, TRUE);
+  self->workers = NULL;
+
+  if (self->idle_decoders)
+    g_async_queue_unref (self->idle_decoders);
+  self->idle_decoders = NULL;
+
+  g_hash_table_remove_all (self->frames);
+  g_hash_table_remove_all (self->pending);
+
+  gst_caps_replace (&self->input_caps, NULL);
+  gst_caps_replace (&self->target_caps, NULL);
+  gst_caps_replace (&self->caps, NULL);
+  if (self->decoder_factory)
+    gst_object_unref (self->decoder_factory);
+  self->decoder_factory = NULL;
+
+  return TRUE;
+}
+
+/* The caps are the ones of the decoded frames, set when pushing them */
+static gboolean
+gst_image_sequence_reader_negotiate (GstBaseSrc * bsrc)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_image_sequence_reader_is_seekable (GstBaseSrc * bsrc)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_image_sequence_reader_do_seek (GstBaseSrc * bsrc, GstSegment * segment)
+{
+  GstImageSequenceReader *self = GST_IMAGE_SEQUENCE_READER (bsrc);
+
+  segment->time = segment->start;
+
+  g_mutex_lock (&self->lock);
+  self->position = gst_util_uint64_scale (segment->start, self->fps_n,
+      self->fps_d * GST_SECOND);
+  g_hash_table_foreach_remove (self->frames, (GHRFunc) _outside_window, self);
+  g_mutex_unlock (&self->lock);
+
+  return TRUE;
+}
+
+static gboolean
+gst_image_sequence_reader_unlock (GstBaseSrc * bsrc)
+{
+  GstImageSequenceReader *self = GST_IMAGE_SEQUENCE_READER (bsrc);
+
+  g_mutex_lock (&self->lock);
+  self->flushing = TRUE;
+  g_cond_broadcast (&self->cond);
+  g_mutex_unlock (&self->lock);
+
+  return TRUE;
+}
+
+static gboolean
+gst_image_sequence_reader_unlock_stop (GstBaseSrc * bsrc)
+{
+  GstImageSequenceReader *self = GST_IMAGE_SEQUENCE_READER (bsrc);
+
+  g_mutex_lock (&self->lock);
+  self->flushing = FALSE;
+  g_mutex_unlock (&self->lock);
+
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_image_sequence_reader_create (GstPushSrc * psrc, GstBuffer ** buf)
+{
+  guint64 index;
+  GstCaps *caps;
+  GstSample *sample;
+  GstClockTime pts, next_pts;
+  GstImageSequenceReader *self = GST_IMAGE_SEQUENCE_READER (psrc);
+  GstSegment *segment = &GST_BASE_SRC (psrc)->segment;
+
+  g_mutex_lock (&self->lock);
+  index = self->position;
+  pts = gst_util_uint64_scale (index, self->fps_d * GST_SECOND, self->fps_n);
+  if (index >= self->n_files || (GST_CLOCK_TIME_IS_VALID (segment->stop) &&
+          pts >= segment->stop)) {
+    g_mutex_unlock (&self->lock);
+
+    return GST_FLOW_EOS;
+  }
+
+  _schedule (self);
+  while (!self->flushing && !g_hash_table_lookup_extended (self->frames,
+          GUINT_TO_POINTER (index), NULL, (gpointer *) & sample))
+    g_cond_wait (&self->cond, &self->lock);
+
+  if (self->flushing) {
+    g_mutex_unlock (&self->lock);
+
+    return GST_FLOW_FLUSHING;
+  }
+
+  g_hash_table_steal (self->frames, GUINT_TO_POINTER (index));
+  self->position++;
+  _schedule (self);
+  g_mutex_unlock (&self->lock);
+
+  if (sample == NULL) {
+    GST_ELEMENT_ERROR (self, STREAM, DECODE, (NULL),
+        ("Could not decode %s", self->filenames[index]));
+
+    return GST_FLOW_ERROR;
+  }
+
+  caps = _frame_caps (self, gst_sample_get_caps (sample));
+  if (self->caps == NULL || !gst_caps_is_equal (caps, self->caps)) {
+    GST_DEBUG_OBJECT (self, "Frames are now %" GST_PTR_FORMAT, caps);
+    gst_caps_replace (&self->caps, caps);
+    if (!gst_base_src_set_caps (GST_BASE_SRC (self), caps)) {
+      gst_caps_unref (caps);
+      gst_sample_unref (sample);
+
+      return GST_FLOW_NOT_NEGOTIATED;
+    }
+  }
+  gst_caps_unref (caps);
+
+  *buf = gst_buffer_ref (gst_sample_get_buffer (sample));
+  gst_sample_unref (sample);
+  *buf = gst_buffer_make_writable (*buf);
+
+  next_pts = gst_util_uint64_scale (index + 1, self->fps_d * GST_SECOND,
+      self->fps_n);
+  GST_BUFFER_PTS (*buf) = GST_BUFFER_DTS (*buf) = pts;
+  GST_BUFFER_DURATION (*buf) = next_pts - pts;
+  GST_BUFFER_OFFSET (*buf) = index;
+  GST_BUFFER_OFFSET_END (*buf) = index + 1;
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_image_sequence_reader_finalize (GObject * object)
+{
+  GstImageSequenceReader *self = GST_IMAGE_SEQUENCE_READER (object);
+
+  g_strfreev (self->filenames);
+  g_weak_ref_clear (&self->track_element);
+  g_hash_table_unref (self->frames);
+  g_hash_table_unref (self->pending);
+  g_mutex_clear (&self->lock);
+  g_cond_clear (&self->cond);
+
+  G_OBJECT_CLASS (gst_image_sequence_reader_parent_class)->finalize (object);
+}
+
+static void
+gst_image_sequence_reader_class_init (GstImageSequenceReaderClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstBaseSrcClass *base_src_class = GST_BASE_SRC_CLASS (klass);
+  GstPushSrcClass *push_src_class = GST_PUSH_SRC_CLASS (klass);
+
+  gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
+      gst_static_pad_template_get (&src_template));
+
+  gobject_class->finalize = gst_image_sequence_reader_finalize;
+
+  base_src_class->start = GST_DEBUG_FUNCPTR (gst_image_sequence_reader_start);
+  base_src_class->stop = GST_DEBUG_FUNCPTR (gst_image_sequence_reader_stop);
+  base_src_class->negotiate =
+      GST_DEBUG_FUNCPTR (gst_image_sequence_reader_negotiate);
+  base_src_class->is_seekable =
+      GST_DEBUG_FUNCPTR (gst_image_sequence_reader_is_seekable);
+  base_src_class->do_seek =
+      GST_DEBUG_FUNCPTR (gst_image_sequence_reader_do_seek);
+  base_src_class->unlock = GST_DEBUG_FUNCPTR (gst_image_sequence_reader_unlock);
+  base_src_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_image_sequence_reader_unlock_stop);
+  push_src_class->create =
+      GST_DEBUG_FUNCPTR (gst_image_sequence_reader_create);
+
+  gst_element_class_set_static_metadata (GST_ELEMENT_CLASS (klass),
+      "Image sequence reader", "Source/Video",
+      "Reads and decodes a sequence of images ahead of playback",
+      "GStreamer Editing Services contributors");
+}
+
+static void
+gst_image_sequence_reader_init (GstImageSequenceReader * self)
+{
+  self->filenames = NULL;
+  self->n_files = 0;
+  self->fps_n = 25;
+  self->fps_d = 1;
+  self->cache_size = GST_IMAGE_SEQUENCE_READER_DEFAULT_CACHE_SIZE;
+  g_weak_ref_init (&self->track_element, NULL);
+
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->cond);
+  self->frames = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+      (GDestroyNotify) _unref_sample);
+  self->pending = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  gst_base_src_set_format (GST_BASE_SRC (self), GST_FORMAT_TIME);
+}
+
+/* Creates a source for @track_element pushing @filenames decoded, one per
+ * frame at @fps_n/@fps_d, decoding up to @cache_size frames in advance */
+GstElement *
+ges_image_sequence_reader_new (GESTrackElement * track_element,
+    gchar ** filenames, gint fps_n, gint fps_d, guint cache_size)
+{
+  GstImageSequenceReader *self =
+      g_object_new (GST_TYPE_IMAGE_SEQUENCE_READER, NULL);
+
+  g_weak_ref_set (&self->track_element, track_element);
+  self->filenames = g_strdupv (filenames);
+  self->n_files = filenames ? g_strv_length (filenames) : 0;
+  if (fps_n > 0 && fps_d > 0) {
+    self->fps_n = fps_n;
+    self->fps_d = fps_d;
+  }
+  self->cache_size = MAX (cache_size, 1);
+
+  return GST_ELEMENT (self);
+}
+
+/* The number of frames to decode in advance for @element, from the asset
+ * of the element or of its clip */
+guint
+ges_image_sequence_reader_get_cache_size (GESTrackElement * element)
+{
+  GESAsset *asset;
+  GESTimelineElement *parent;
+  guint cache_size = GST_IMAGE_SEQUENCE_READER_DEFAULT_CACHE_SIZE;
+
+  asset = ges_extractable_get_asset (GES_EXTRACTABLE (element));
+  if (asset && ges_meta_container_get_uint (GES_META_CONTAINER (asset),
+          GES_META_IMAGE_SEQUENCE_CACHE_SIZE, &cache_size))
+    return cache_size;
+
+  parent = ges_timeline_element_get_parent (GES_TIMELINE_ELEMENT (element));
+  if (parent) {
+    asset = ges_extractable_get_asset (GES_EXTRACTABLE (parent));
+    if (asset)
+      ges_meta_container_get_uint (GES_META_CONTAINER (asset),
+          GES_META_IMAGE_SEQUENCE_CACHE_SIZE, &cache_size);
+    gst_object_unref (parent);
+  }
+
+  return cache_size;
+}
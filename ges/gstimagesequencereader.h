@@ -0,0 +1,85 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _GST_IMAGE_SEQUENCE_READER_H_
+#define _GST_IMAGE_SEQUENCE_READER_H_
+
+#include <gst/base/gstpushsrc.h>
+#include <ges/ges-types.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_IMAGE_SEQUENCE_READER   (gst_image_sequence_reader_get_type())
+#define GST_IMAGE_SEQUENCE_READER(obj)   (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_IMAGE_SEQUENCE_READER,GstImageSequenceReader))
+#define GST_IMAGE_SEQUENCE_READER_CLASS(klass)   (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_IMAGE_SEQUENCE_READER,GstImageSequenceReaderClass))
+#define GST_IS_IMAGE_SEQUENCE_READER(obj)   (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_IMAGE_SEQUENCE_READER))
+#define GST_IS_IMAGE_SEQUENCE_READER_CLASS(klass)   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_IMAGE_SEQUENCE_READER))
+
+/* Number of frames decoded ahead by default */
+#define GST_IMAGE_SEQUENCE_READER_DEFAULT_CACHE_SIZE 8
+
+typedef struct _GstImageSequenceReader GstImageSequenceReader;
+typedef struct _GstImageSequenceReaderClass GstImageSequenceReaderClass;
+
+struct _GstImageSequenceReader
+{
+  GstPushSrc parent;
+
+  /* Set before starting */
+  gchar **filenames;
+  guint n_files;
+  gint fps_n;
+  gint fps_d;
+  guint cache_size;
+
+  /* The track element we are the source of, frames are converted to the
+   * restriction caps of its track as still images are */
+  GWeakRef track_element;
+
+  /* Caps of the encoded files, the ones frames are converted to (%NULL to
+   * keep their format) and of the decoded frames */
+  GstCaps *input_caps;
+  GstCaps *target_caps;
+  GstCaps *caps;
+  GstElementFactory *decoder_factory;
+
+  GThreadPool *workers;
+  GAsyncQueue *idle_decoders;
+
+  /* Protected by lock */
+  GMutex lock;
+  GCond cond;
+  GHashTable *frames;           /* index -> GstSample, decoded */
+  GHashTable *pending;          /* indices being decoded */
+  guint64 position;             /* index of the next frame to push */
+  gboolean flushing;
+
+  /*  This should never be made public, no padding needed */
+};
+
+struct _GstImageSequenceReaderClass
+{
+  GstPushSrcClass parent_class;
+};
+
+GType gst_image_sequence_reader_get_type (void);
+
+G_END_DECLS
+
+#endif
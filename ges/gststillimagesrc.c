@@ -0,0 +1,331 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Source pushing a still image as a video stream. The image is taken from
+ * the image cache, decoded once to the size and format the track restricts
+ * to, and every frame we push shares its memory. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+
+#include "ges-internal.h"
+#include "gststillimagesrc.h"
+
+#define DEFAULT_FPS_N  30
+#define DEFAULT_FPS_D  1
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-raw")
+    );
+
+G_DEFINE_TYPE (GstStillImageSrc, gst_still_image_src, GST_TYPE_PUSH_SRC);
+
+/* Called with the object lock taken */
+static GstCaps *
+_get_restriction_caps (GstStillImageSrc * self)
+{
+  GESTrack *track;
+  GESTrackElement *track_element;
+  GstCaps *restriction = NULL;
+
+  track_element = g_weak_ref_get (&self->track_element);
+  if (track_element == NULL)
+    return NULL;
+
+  track = ges_track_element_get_track (track_element);
+  if (track)
+    g_object_get (track, "restriction-caps", &restriction, NULL);
+  gst_object_unref (track_element);
+
+  if (restriction && (gst_caps_is_empty (restriction) ||
+          gst_caps_is_any (restriction))) {
+    gst_caps_unref (restriction);
+    restriction = NULL;
+  }
+
+  return restriction;
+}
+
+static GstCaps *
+_get_target_caps (GstStillImageSrc * self)
+{
+  GstCaps *caps;
+  GESTrackElement *track_element = g_weak_ref_get (&self->track_element);
+
+  caps = ges_image_cache_get_target_caps (track_element);
+  if (track_element)
+    gst_object_unref (track_element);
+
+  return caps;
+}
+
+static gboolean
+gst_still_image_src_start (GstBaseSrc * bsrc)
+{
+  GstCaps *caps;
+  GstSample *image;
+  GstStillImageSrc *self = GST_STILL_IMAGE_SRC (bsrc);
+
+  if (self->uri == NULL) {
+    GST_ELEMENT_ERROR (self, RESOURCE, NOT_FOUND, (NULL), ("No uri set"));
+
+    return FALSE;
+  }
+
+  caps = _get_target_caps (self);
+  image = ges_image_cache_lookup (self->uri, caps);
+  if (caps)
+    gst_caps_unref (caps);
+
+  if (image == NULL) {
+    GST_ELEMENT_ERROR (self, STREAM, DECODE, (NULL),
+        ("Could not decode %s", self->uri));
+
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (self, "Showing %s as %" GST_PTR_FORMAT, self->uri,
+      gst_sample_get_caps (image));
+
+  GST_OBJECT_LOCK (self);
+  self->image = image;
+  self->offset = 0;
+  GST_OBJECT_UNLOCK (self);
+
+  return TRUE;
+}
+
+static gboolean
+gst_still_image_src_stop (GstBaseSrc * bsrc)
+{
+  GstStillImageSrc *self = GST_STILL_IMAGE_SRC (bsrc);
+
+  GST_OBJECT_LOCK (self);
+  if (self->image)
+    gst_sample_unref (self->image);
+  self->image = NULL;
+  self->offset = 0;
+  GST_OBJECT_UNLOCK (self);
+
+  return TRUE;
+}
+
+static GstCaps *
+gst_still_image_src_get_caps (GstBaseSrc * bsrc, GstCaps * filter)
+{
+  GstCaps *caps, *restriction, *tmp;
+  GstStillImageSrc *self = GST_STILL_IMAGE_SRC (bsrc);
+
+  GST_OBJECT_LOCK (self);
+  if (self->image == NULL) {
+    GST_OBJECT_UNLOCK (self);
+
+    return GST_BASE_SRC_CLASS (gst_still_image_src_parent_class)->get_caps
+        (bsrc, filter);
+  }
+
+  /* We can push the image at any framerate */
+  caps = gst_caps_copy (gst_sample_get_caps (self->image));
+  gst_caps_set_simple (caps, "framerate", GST_TYPE_FRACTION_RANGE, 0, 1,
+      G_MAXINT, 1, NULL);
+
+  restriction = _get_restriction_caps (self);
+  GST_OBJECT_UNLOCK (self);
+
+  if (restriction) {
+    tmp = gst_caps_intersect (caps, restriction);
+    if (!gst_caps_is_empty (tmp)) {
+      gst_caps_unref (caps);
+      caps = tmp;
+    } else {
+      gst_caps_unref (tmp);
+    }
+    gst_caps_unref (restriction);
+  }
+
+  if (filter) {
+    tmp = gst_caps_intersect_full (filter, caps, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (caps);
+    caps = tmp;
+  }
+
+  return caps;
+}
+
+static GstCaps *
+gst_still_image_src_fixate (GstBaseSrc * bsrc, GstCaps * caps)
+{
+  GstStructure *structure;
+
+  caps = gst_caps_make_writable (caps);
+  caps = gst_caps_truncate (caps);
+  structure = gst_caps_get_structure (caps, 0);
+
+  gst_structure_fixate_field_nearest_fraction (structure, "framerate",
+      DEFAULT_FPS_N, DEFAULT_FPS_D);
+
+  return GST_BASE_SRC_CLASS (gst_still_image_src_parent_class)->fixate (bsrc,
+      caps);
+}
+
+static gboolean
+gst_still_image_src_set_caps (GstBaseSrc * bsrc, GstCaps * caps)
+{
+  GstStillImageSrc *self = GST_STILL_IMAGE_SRC (bsrc);
+  GstStructure *structure = gst_caps_get_structure (caps, 0);
+
+  if (!gst_structure_get_fraction (structure, "framerate", &self->fps_n,
+          &self->fps_d) || self->fps_n <= 0) {
+    self->fps_n = DEFAULT_FPS_N;
+    self->fps_d = DEFAULT_FPS_D;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_still_image_src_is_seekable (GstBaseSrc * bsrc)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_still_image_src_do_seek (GstBaseSrc * bsrc, GstSegment * segment)
+{
+  GstStillImageSrc *self = GST_STILL_IMAGE_SRC (bsrc);
+
+  segment->time = segment->start;
+  self->offset = gst_util_uint64_scale (segment->start, self->fps_n,
+      self->fps_d * GST_SECOND);
+
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_still_image_src_create (GstPushSrc * psrc, GstBuffer ** buf)
+{
+  guint64 next_offset;
+  GstClockTime pts, next_pts;
+  GstStillImageSrc *self = GST_STILL_IMAGE_SRC (psrc);
+  GstSegment *segment = &GST_BASE_SRC (psrc)->segment;
+
+  if (G_UNLIKELY (self->image == NULL))
+    return GST_FLOW_NOT_NEGOTIATED;
+
+  next_offset = self->offset + 1;
+  pts = gst_util_uint64_scale (self->offset, self->fps_d * GST_SECOND,
+      self->fps_n);
+  next_pts = gst_util_uint64_scale (next_offset, self->fps_d * GST_SECOND,
+      self->fps_n);
+
+  if (GST_CLOCK_TIME_IS_VALID (segment->stop) && pts >= segment->stop)
+    return GST_FLOW_EOS;
+
+  /* Only the metadata is copied, the memory stays the one of the cache */
+  *buf = gst_buffer_copy (gst_sample_get_buffer (self->image));
+  GST_BUFFER_PTS (*buf) = GST_BUFFER_DTS (*buf) = pts;
+  GST_BUFFER_DURATION (*buf) = next_pts - pts;
+  GST_BUFFER_OFFSET (*buf) = self->offset;
+  GST_BUFFER_OFFSET_END (*buf) = next_offset;
+  self->offset = next_offset;
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_still_image_src_dispose (GObject * object)
+{
+  GstStillImageSrc *self = GST_STILL_IMAGE_SRC (object);
+
+  if (self->image)
+    gst_sample_unref (self->image);
+  self->image = NULL;
+
+  G_OBJECT_CLASS (gst_still_image_src_parent_class)->dispose (object);
+}
+
+static void
+gst_still_image_src_finalize (GObject * object)
+{
+  GstStillImageSrc *self = GST_STILL_IMAGE_SRC (object);
+
+  g_free (self->uri);
+  g_weak_ref_clear (&self->track_element);
+
+  G_OBJECT_CLASS (gst_still_image_src_parent_class)->finalize (object);
+}
+
+static void
+gst_still_image_src_class_init (GstStillImageSrcClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstBaseSrcClass *base_src_class = GST_BASE_SRC_CLASS (klass);
+  GstPushSrcClass *push_src_class = GST_PUSH_SRC_CLASS (klass);
+
+  gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
+      gst_static_pad_template_get (&src_template));
+
+  gobject_class->dispose = gst_still_image_src_dispose;
+  gobject_class->finalize = gst_still_image_src_finalize;
+
+  base_src_class->start = GST_DEBUG_FUNCPTR (gst_still_image_src_start);
+  base_src_class->stop = GST_DEBUG_FUNCPTR (gst_still_image_src_stop);
+  base_src_class->get_caps = GST_DEBUG_FUNCPTR (gst_still_image_src_get_caps);
+  base_src_class->fixate = GST_DEBUG_FUNCPTR (gst_still_image_src_fixate);
+  base_src_class->set_caps = GST_DEBUG_FUNCPTR (gst_still_image_src_set_caps);
+  base_src_class->is_seekable =
+      GST_DEBUG_FUNCPTR (gst_still_image_src_is_seekable);
+  base_src_class->do_seek = GST_DEBUG_FUNCPTR (gst_still_image_src_do_seek);
+  push_src_class->create = GST_DEBUG_FUNCPTR (gst_still_image_src_create);
+
+  gst_element_class_set_static_metadata (GST_ELEMENT_CLASS (klass),
+      "Still image source", "Source/Video",
+      "Pushes a decoded image shared with all the sources showing it",
+      "GStreamer Editing Services contributors");
+}
+
+static void
+gst_still_image_src_init (GstStillImageSrc * self)
+{
+  self->uri = NULL;
+  g_weak_ref_init (&self->track_element, NULL);
+  self->image = NULL;
+  self->fps_n = DEFAULT_FPS_N;
+  self->fps_d = DEFAULT_FPS_D;
+  self->offset = 0;
+
+  gst_base_src_set_format (GST_BASE_SRC (self), GST_FORMAT_TIME);
+}
+
+/* Creates a source showing the image at @uri for @track_element */
+GstElement *
+ges_still_image_src_new (GESTrackElement * track_element, const gchar * uri)
+{
+  GstStillImageSrc *self = g_object_new (GST_TYPE_STILL_IMAGE_SRC, NULL);
+
+  self->uri = g_strdup (uri);
+  g_weak_ref_set (&self->track_element, track_element);
+
+  return GST_ELEMENT (self);
+}
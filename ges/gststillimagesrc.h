@@ -0,0 +1,68 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _GST_STILL_IMAGE_SRC_H_
+#define _GST_STILL_IMAGE_SRC_H_
+
+#include <gst/base/gstpushsrc.h>
+#include <ges/ges-track-element.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_STILL_IMAGE_SRC   (gst_still_image_src_get_type())
+#define GST_STILL_IMAGE_SRC(obj)   (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_STILL_IMAGE_SRC,GstStillImageSrc))
+#define GST_STILL_IMAGE_SRC_CLASS(klass)   (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_STILL_IMAGE_SRC,GstStillImageSrcClass))
+#define GST_IS_STILL_IMAGE_SRC(obj)   (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_STILL_IMAGE_SRC))
+#define GST_IS_STILL_IMAGE_SRC_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_STILL_IMAGE_SRC))
+
+typedef struct _GstStillImageSrc GstStillImageSrc;
+typedef struct _GstStillImageSrcClass GstStillImageSrcClass;
+
+struct _GstStillImageSrc
+{
+  GstPushSrc parent;
+
+  gchar *uri;
+
+  /* The track element we are the source of, we use the restriction caps of
+   * its track to decide what to decode the image to */
+  GWeakRef track_element;
+
+  /* The decoded image, shared with all the sources showing it */
+  GstSample *image;
+
+  gint fps_n;
+  gint fps_d;
+
+  /* Frames produced since the last seek */
+  guint64 offset;
+
+  /*  This should never be made public, no padding needed */
+};
+
+struct _GstStillImageSrcClass
+{
+  GstPushSrcClass parent_class;
+};
+
+GType gst_still_image_src_get_type (void);
+
+G_END_DECLS
+
+#endif
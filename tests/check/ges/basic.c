@@ -706,6 +706,252 @@ GST_START_TEST (test_ges_pipeline_change_state)
 
 GST_END_TEST;
 
+GST_START_TEST (test_ges_pipeline_profiling)
+{
+  gchar *report;
+  const gchar *name;
+  GstBus *bus;
+  GESClip *clip;
+  GESAsset *asset;
+  GESLayer *layer;
+  GstMessage *message;
+  GESTimeline *timeline;
+  GESPipeline *pipeline;
+  GESTrackElement *effect;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  ges_timeline_add_track (timeline, GES_TRACK (ges_video_track_new ()));
+  layer = ges_timeline_append_layer (timeline);
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = ges_layer_add_asset (layer, asset, 0, 0, GST_SECOND / 2,
+      GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+  fail_unless (clip != NULL);
+
+  effect = GES_TRACK_ELEMENT (ges_effect_new ("agingtv"));
+  fail_unless (ges_container_add (GES_CONTAINER (clip),
+          GES_TIMELINE_ELEMENT (effect)));
+  ges_timeline_commit (timeline);
+
+  pipeline = ges_test_create_pipeline (timeline);
+  fail_unless (ges_pipeline_get_profiling_report (pipeline) == NULL);
+
+  /* Run the timeline to the end with profiling enabled */
+  g_object_set (pipeline, "profiling", TRUE, NULL);
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PLAYING)
+      == GST_STATE_CHANGE_FAILURE);
+  message = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message != NULL, "No EOS after 10 seconds");
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ERROR)
+    fail_error_message (message);
+  gst_message_unref (message);
+  ASSERT_SET_STATE (GST_ELEMENT (pipeline), GST_STATE_READY,
+      GST_STATE_CHANGE_SUCCESS);
+
+  /* The report is still available once streaming stopped and lists the
+   * clip and its effect */
+  report = ges_pipeline_get_profiling_report (pipeline);
+  fail_unless (report != NULL);
+  fail_unless (g_strrstr (report, "Clips by processing time") != NULL);
+  fail_unless (g_strrstr (report,
+          "Track elements by processing time") != NULL);
+
+  name = GES_TIMELINE_ELEMENT_NAME (clip);
+  fail_unless (g_strrstr (report, name) != NULL, "%s not in report:\n%s",
+      name, report);
+  name = GES_TIMELINE_ELEMENT_NAME (effect);
+  fail_unless (g_strrstr (report, name) != NULL, "%s not in report:\n%s",
+      name, report);
+  g_free (report);
+
+  ASSERT_SET_STATE (GST_ELEMENT (pipeline), GST_STATE_NULL,
+      GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+static guint
+get_uint_field (const GstStructure * stats, const gchar * field)
+{
+  guint value;
+
+  fail_unless (gst_structure_get_uint (stats, field, &value),
+      "No %s field", field);
+
+  return value;
+}
+
+static guint64
+get_uint64_field (const GstStructure * stats, const gchar * field)
+{
+  const GValue *value = gst_structure_get_value (stats, field);
+
+  fail_unless (value != NULL && G_VALUE_HOLDS_UINT64 (value),
+      "No %s field", field);
+
+  return g_value_get_uint64 (value);
+}
+
+/* Checks that the commit histogram of @stats accounts for all the commits */
+static void
+check_commit_histogram (const GstStructure * stats)
+{
+  guint i;
+  guint64 total = 0;
+  const GValue *histogram = gst_structure_get_value (stats,
+      "commit-histogram");
+
+  fail_unless (histogram != NULL && GST_VALUE_HOLDS_ARRAY (histogram));
+  for (i = 0; i < gst_value_array_get_size (histogram); i++)
+    total += g_value_get_uint64 (gst_value_array_get_value (histogram, i));
+
+  assert_equals_uint64 (total, get_uint64_field (stats, "commit-count"));
+}
+
+GST_START_TEST (test_ges_timeline_statistics)
+{
+  GList *tmp;
+  GESAsset *asset;
+  GESLayer *layer;
+  GESTimeline *timeline;
+  GstStructure *stats;
+  guint n_gaps = 0, n_objects = 0;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+
+  /* Two clips with a hole in between */
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  fail_unless (ges_layer_add_asset (layer, asset, 0, 0, 10 * GST_SECOND,
+          GES_TRACK_TYPE_UNKNOWN) != NULL);
+  fail_unless (ges_layer_add_asset (layer, asset, 20 * GST_SECOND, 0,
+          10 * GST_SECOND, GES_TRACK_TYPE_UNKNOWN) != NULL);
+  gst_object_unref (asset);
+
+  ges_timeline_reset_statistics (timeline);
+  ges_timeline_commit (timeline);
+
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
+    stats = ges_track_get_statistics (tmp->data);
+    fail_unless (gst_structure_has_name (stats, "ges-track-statistics"));
+
+    assert_equals_int (get_uint_field (stats, "n-elements"), 2);
+    assert_equals_int (get_uint_field (stats, "n-gaps"), 1);
+    fail_unless (get_uint64_field (stats, "gap-updates") >= 1);
+    assert_equals_uint64 (get_uint64_field (stats, "commit-count"), 1);
+    fail_unless (get_uint64_field (stats, "commit-max") >=
+        get_uint64_field (stats, "commit-last"));
+    check_commit_histogram (stats);
+
+    n_gaps += get_uint_field (stats, "n-gaps");
+    n_objects += get_uint_field (stats, "n-composition-objects");
+    gst_structure_free (stats);
+  }
+
+  stats = ges_timeline_get_statistics (timeline);
+  fail_unless (gst_structure_has_name (stats, "ges-timeline-statistics"));
+  assert_equals_int (get_uint_field (stats, "n-layers"), 1);
+  assert_equals_int (get_uint_field (stats, "n-tracks"), 2);
+  assert_equals_int (get_uint_field (stats, "n-track-sources"), 4);
+  assert_equals_int (get_uint_field (stats, "n-auto-transitions"), 0);
+  assert_equals_int (get_uint_field (stats, "n-pending-assets"), 0);
+
+  /* The timeline sums up what its tracks report */
+  assert_equals_int (get_uint_field (stats, "n-gaps"), n_gaps);
+  assert_equals_int (get_uint_field (stats, "n-composition-objects"),
+      n_objects);
+
+  assert_equals_uint64 (get_uint64_field (stats, "transition-updates"), 1);
+  assert_equals_uint64 (get_uint64_field (stats, "commit-count"), 1);
+  assert_equals_uint64 (get_uint64_field (stats, "commit-average"),
+      get_uint64_field (stats, "commit-last"));
+  check_commit_histogram (stats);
+  gst_structure_free (stats);
+
+  /* Resetting clears the counters but not what describes the timeline */
+  ges_timeline_reset_statistics (timeline);
+  stats = ges_timeline_get_statistics (timeline);
+  assert_equals_int (get_uint_field (stats, "n-track-sources"), 4);
+  assert_equals_uint64 (get_uint64_field (stats, "transition-updates"), 0);
+  assert_equals_uint64 (get_uint64_field (stats, "commit-count"), 0);
+  assert_equals_uint64 (get_uint64_field (stats, "commit-average"), 0);
+  check_commit_histogram (stats);
+  gst_structure_free (stats);
+
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
+    stats = ges_track_get_statistics (tmp->data);
+    assert_equals_int (get_uint_field (stats, "n-elements"), 2);
+    assert_equals_uint64 (get_uint64_field (stats, "gap-updates"), 0);
+    assert_equals_uint64 (get_uint64_field (stats, "commit-count"), 0);
+    gst_structure_free (stats);
+  }
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ges_track_cache_warming)
+{
+  guint i, count;
+  gchar *uri;
+  guint64 window;
+  GESAsset *asset;
+  GESLayer *layer;
+  GESTrack *track;
+  GESTimeline *timeline;
+
+  ges_init ();
+
+  track = GES_TRACK (ges_video_track_new ());
+  g_object_get (track, "cache-warming-count", &count,
+      "cache-warming-window", &window, NULL);
+  assert_equals_int (count, 0);
+  assert_equals_uint64 (window, 5 * GST_SECOND);
+
+  g_object_set (track, "cache-warming-count", 2,
+      "cache-warming-window", GST_SECOND, NULL);
+  g_object_get (track, "cache-warming-count", &count,
+      "cache-warming-window", &window, NULL);
+  assert_equals_int (count, 2);
+  assert_equals_uint64 (window, GST_SECOND);
+
+  timeline = gst_object_ref_sink (ges_timeline_new ());
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+
+  /* Play across a few edit points while the caches get warmed up for the
+   * upcoming clips */
+  uri = ges_test_get_audio_video_uri ();
+  asset = GES_ASSET (ges_uri_clip_asset_request_sync (uri, NULL));
+  fail_unless (asset != NULL);
+  g_free (uri);
+  for (i = 0; i < 4; i++)
+    fail_unless (ges_layer_add_asset (layer, asset, i * GST_SECOND / 4,
+            i * GST_SECOND / 8, GST_SECOND / 4,
+            GES_TRACK_TYPE_UNKNOWN) != NULL);
+
+  fail_unless (play_timeline (timeline));
+
+  /* Disabling it cancels what is pending */
+  g_object_set (track, "cache-warming-count", 0, NULL);
+  g_object_get (track, "cache-warming-count", &count, NULL);
+  assert_equals_int (count, 0);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -721,6 +967,9 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_ges_timeline_remove_track);
   tcase_add_test (tc_chain, test_ges_timeline_multiple_tracks);
   tcase_add_test (tc_chain, test_ges_pipeline_change_state);
+  tcase_add_test (tc_chain, test_ges_pipeline_profiling);
+  tcase_add_test (tc_chain, test_ges_timeline_statistics);
+  tcase_add_test (tc_chain, test_ges_track_cache_warming);
 
   return s;
 }
@@ -191,6 +191,113 @@ GST_START_TEST (test_split_object)
 
 GST_END_TEST;
 
+GST_START_TEST (test_split_at_positions)
+{
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESClip *clip;
+  GList *clips, *tmp;
+  guint64 start = 25;
+  GstClockTime positions[] = { 75, 25, 0, 100, 150, 50, 50 };
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+
+  clip = GES_CLIP (ges_test_clip_new ());
+  g_object_set (clip, "start", (guint64) 0, "duration", (guint64) 100,
+      "in-point", (guint64) 10, NULL);
+  fail_unless (ges_layer_add_clip (layer, clip));
+
+  /* Only the positions strictly inside the clip are used, once */
+  clips = ges_clip_split_at_positions (clip, positions,
+      G_N_ELEMENTS (positions));
+  assert_equals_int (g_list_length (clips), 3);
+
+  assert_equals_uint64 (_START (clip), 0);
+  assert_equals_uint64 (_DURATION (clip), 25);
+  assert_equals_uint64 (_INPOINT (clip), 10);
+
+  for (tmp = clips; tmp; tmp = tmp->next) {
+    GESClip *splitclip = tmp->data;
+
+    assert_equals_uint64 (_START (splitclip), start);
+    assert_equals_uint64 (_DURATION (splitclip), 25);
+    assert_equals_uint64 (_INPOINT (splitclip), start + 10);
+    assert_equals_int (g_list_length (GES_CONTAINER_CHILDREN (splitclip)), 2);
+    fail_unless (ges_clip_get_layer (splitclip) == layer);
+    gst_object_unref (layer);
+
+    start += 25;
+  }
+  g_list_free (clips);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_timeline_split_at_positions)
+{
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESAsset *asset;
+  GList *clips, *tmp;
+  guint n_sources = 0, n_transitions = 0;
+  GstClockTime positions[] = { 250, 1250 };
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+  ges_layer_set_auto_transition (layer, TRUE);
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+
+  /*
+   *        500__transition__1000
+   * 0___________src_________1000
+   *        500___________src1_________1500
+   */
+  fail_unless (ges_layer_add_asset (layer, asset, 0, 0, 1000,
+          GES_TRACK_TYPE_UNKNOWN));
+  fail_unless (ges_layer_add_asset (layer, asset, 500, 0, 1000,
+          GES_TRACK_TYPE_UNKNOWN));
+  ges_timeline_commit (timeline);
+
+  clips = ges_timeline_split_at_positions (timeline, positions,
+      G_N_ELEMENTS (positions));
+  assert_equals_int (g_list_length (clips), 2);
+  g_list_free (clips);
+
+  /*
+   *           500__transition__1000
+   * 0__src__250___src_________1000
+   *           500__________src1____1250__src1__1500
+   *
+   * The transitions are not split but follow the sources around them
+   */
+  clips = ges_layer_get_clips (layer);
+  for (tmp = clips; tmp; tmp = tmp->next) {
+    if (GES_IS_TRANSITION_CLIP (tmp->data)) {
+      assert_equals_uint64 (_START (tmp->data), 500);
+      assert_equals_uint64 (_DURATION (tmp->data), 500);
+      n_transitions++;
+    } else {
+      n_sources++;
+    }
+  }
+  g_list_free_full (clips, gst_object_unref);
+
+  assert_equals_int (n_sources, 4);
+  assert_equals_int (n_transitions, 2);
+
+  gst_object_unref (timeline);
+  gst_object_unref (asset);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_clip_group_ungroup)
 {
   GESAsset *asset;
@@ -356,6 +463,76 @@ GST_START_TEST (test_clip_refcount_remove_child)
 
 GST_END_TEST;
 
+static void
+count_cb (GObject * object, gpointer arg, guint * count)
+{
+  *count += 1;
+}
+
+GST_START_TEST (test_clip_add_remove_children)
+{
+  GList *effects, *tmp;
+  GESTrack *track;
+  GESLayer *layer;
+  GESTimeline *timeline;
+  GESContainer *clip;
+  guint n_added = 0, n_removed = 0, n_height = 0;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_layer_new ();
+  track = GES_TRACK (ges_video_track_new ());
+  fail_unless (ges_timeline_add_track (timeline, track));
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  clip = GES_CONTAINER (ges_test_clip_new ());
+  g_object_set (clip, "duration", 10 * GST_SECOND, NULL);
+  fail_unless (ges_layer_add_clip (layer, GES_CLIP (clip)));
+  assert_equals_int (g_list_length (GES_CONTAINER_CHILDREN (clip)), 1);
+  assert_equals_int (GES_CONTAINER_HEIGHT (clip), 1);
+
+  g_signal_connect (clip, "child-added", G_CALLBACK (count_cb), &n_added);
+  g_signal_connect (clip, "child-removed", G_CALLBACK (count_cb), &n_removed);
+  g_signal_connect (clip, "notify::height", G_CALLBACK (count_cb), &n_height);
+
+  effects = g_list_prepend (NULL, ges_effect_new ("agingtv"));
+  effects = g_list_prepend (effects, ges_effect_new ("agingtv"));
+  effects = g_list_prepend (effects, ges_effect_new ("agingtv"));
+  g_list_foreach (effects, (GFunc) gst_object_ref_sink, NULL);
+
+  fail_unless (ges_container_add_children (clip, effects));
+  assert_equals_int (n_added, 3);
+  assert_equals_int (n_height, 1);
+  assert_equals_int (GES_CONTAINER_HEIGHT (clip), 4);
+  assert_equals_int (g_list_length (GES_CONTAINER_CHILDREN (clip)), 4);
+  for (tmp = effects; tmp; tmp = tmp->next) {
+    fail_unless (g_list_find (GES_CONTAINER_CHILDREN (clip), tmp->data));
+    fail_unless (ges_track_element_get_track (tmp->data) == track);
+  }
+
+  n_height = 0;
+  fail_unless (ges_container_remove_children (clip, effects));
+  assert_equals_int (n_removed, 3);
+  assert_equals_int (n_height, 1);
+  assert_equals_int (GES_CONTAINER_HEIGHT (clip), 1);
+  assert_equals_int (g_list_length (GES_CONTAINER_CHILDREN (clip)), 1);
+  for (tmp = effects; tmp; tmp = tmp->next)
+    fail_if (g_list_find (GES_CONTAINER_CHILDREN (clip), tmp->data));
+
+  /* Releasing all the children through our own list works too */
+  n_height = 0;
+  fail_unless (ges_container_remove_children (clip,
+          GES_CONTAINER_CHILDREN (clip)));
+  assert_equals_int (n_removed, 4);
+  assert_equals_int (g_list_length (GES_CONTAINER_CHILDREN (clip)), 0);
+
+  g_list_free_full (effects, gst_object_unref);
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -366,8 +543,11 @@ ges_suite (void)
 
   tcase_add_test (tc_chain, test_object_properties);
   tcase_add_test (tc_chain, test_split_object);
+  tcase_add_test (tc_chain, test_split_at_positions);
+  tcase_add_test (tc_chain, test_timeline_split_at_positions);
   tcase_add_test (tc_chain, test_clip_group_ungroup);
   tcase_add_test (tc_chain, test_clip_refcount_remove_child);
+  tcase_add_test (tc_chain, test_clip_add_remove_children);
 
   return s;
 }
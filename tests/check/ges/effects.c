@@ -420,6 +420,63 @@ GST_START_TEST (test_effect_set_properties)
 
 GST_END_TEST;
 
+GST_START_TEST (test_effect_lookup_child_pspec)
+{
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESTrack *track_video;
+  GESEffectClip *effect_clip;
+  GESTrackElement *effect;
+  GParamSpec *spec;
+  GValue val = { 0 };
+  GValue nval = { 0 };
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_layer_new ();
+  track_video = GES_TRACK (ges_video_track_new ());
+
+  ges_timeline_add_track (timeline, track_video);
+  ges_timeline_add_layer (timeline, layer);
+
+  effect_clip = ges_effect_clip_new ("agingtv", NULL);
+  g_object_set (effect_clip, "duration", 25 * GST_SECOND, NULL);
+  ges_layer_add_clip (layer, (GESClip *) effect_clip);
+
+  effect = GES_TRACK_ELEMENT (ges_effect_new ("agingtv"));
+  fail_unless (ges_container_add (GES_CONTAINER (effect_clip),
+          GES_TIMELINE_ELEMENT (effect)));
+  fail_unless (ges_track_element_get_track (effect) == track_video);
+
+  spec = ges_track_element_lookup_child_pspec (effect, "scratch-lines");
+  fail_unless (spec != NULL);
+  assert_equals_string (spec->name, "scratch-lines");
+  fail_unless (ges_track_element_lookup_child_pspec (effect,
+          "GstAgingTV::scratch-lines") == spec);
+
+  /* Wrong child type and unknown names are not resolved */
+  fail_unless (ges_track_element_lookup_child_pspec (effect,
+          "GstVideoBalance::scratch-lines") == NULL);
+  fail_unless (ges_track_element_lookup_child_pspec (effect,
+          "not-a-child-property") == NULL);
+  fail_unless (ges_track_element_lookup_child_pspec (effect,
+          "GstAgingTV::not-a-child-property") == NULL);
+
+  g_value_init (&val, G_TYPE_UINT);
+  g_value_init (&nval, G_TYPE_UINT);
+  g_value_set_uint (&val, 12);
+  ges_track_element_set_child_property_by_pspec (effect, spec, &val);
+  ges_track_element_get_child_property_by_pspec (effect, spec, &nval);
+  assert_equals_int (g_value_get_uint (&nval), 12);
+
+  ges_layer_remove_clip (layer, (GESClip *) effect_clip);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static void
 effect_added_cb (GESClip * clip, GESBaseEffect * trop, gboolean * effect_added)
 {
@@ -506,6 +563,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_effect_clip);
   tcase_add_test (tc_chain, test_priorities_clip);
   tcase_add_test (tc_chain, test_effect_set_properties);
+  tcase_add_test (tc_chain, test_effect_lookup_child_pspec);
   tcase_add_test (tc_chain, test_clip_signals);
 
   return s;
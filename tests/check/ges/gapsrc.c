@@ -0,0 +1,152 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "test-utils.h"
+#include <ges/ges.h>
+#include <gst/check/gstcheck.h>
+
+/* A timeline with only @track, whose first second is a gap, followed by
+ * half a second of test clip */
+static GESTimeline *
+create_timeline (GESTrack * track)
+{
+  GESClip *clip;
+  GESLayer *layer;
+  GESTimeline *timeline = ges_timeline_new ();
+
+  /* Let the gap buffers through untouched */
+  ges_track_set_mixing (track, FALSE);
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+
+  clip = GES_CLIP (ges_test_clip_new ());
+  g_object_set (clip, "start", GST_SECOND, "duration", GST_SECOND / 2, NULL);
+  fail_unless (ges_layer_add_clip (layer, clip));
+  ges_timeline_commit (timeline);
+
+  return timeline;
+}
+
+GST_START_TEST (test_gap_src_video)
+{
+  guint i = 0;
+  gint width, height;
+  GstCaps *caps;
+  GList *buffers, *tmp;
+  GstStructure *structure;
+  GstMemory *memory = NULL;
+  GESTrack *track;
+
+  ges_init ();
+
+  track = GES_TRACK (ges_video_track_new ());
+  caps = gst_caps_from_string ("video/x-raw,width=64,height=48,"
+      "framerate=10/1");
+  ges_track_set_restriction_caps (track, caps);
+  gst_caps_unref (caps);
+
+  buffers = ges_test_run_source (GST_ELEMENT (create_timeline (track)),
+      &caps, NULL);
+
+  /* The restriction caps of the track are followed */
+  fail_unless (caps != NULL);
+  structure = gst_caps_get_structure (caps, 0);
+  fail_unless (gst_structure_get_int (structure, "width", &width));
+  fail_unless (gst_structure_get_int (structure, "height", &height));
+  assert_equals_int (width, 64);
+  assert_equals_int (height, 48);
+  gst_caps_unref (caps);
+
+  /* Frames are contiguous and all share the same black frame */
+  for (tmp = buffers; tmp; tmp = tmp->next) {
+    GstBuffer *buffer = tmp->data;
+
+    if (GST_BUFFER_PTS (buffer) >= GST_SECOND)
+      break;
+
+    assert_equals_uint64 (GST_BUFFER_PTS (buffer), i * GST_SECOND / 10);
+    assert_equals_uint64 (GST_BUFFER_DURATION (buffer), GST_SECOND / 10);
+
+    if (memory == NULL)
+      memory = gst_buffer_peek_memory (buffer, 0);
+    fail_unless (gst_buffer_peek_memory (buffer, 0) == memory);
+    i++;
+  }
+  assert_equals_int (i, 10);
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gap_src_audio)
+{
+  gint rate;
+  GstCaps *caps;
+  GList *buffers, *tmp;
+  GESTrack *track;
+  GstClockTime next_pts = 0;
+
+  ges_init ();
+
+  track = GES_TRACK (ges_audio_track_new ());
+  caps = gst_caps_from_string ("audio/x-raw,rate=48000,channels=2");
+  ges_track_set_restriction_caps (track, caps);
+  gst_caps_unref (caps);
+
+  buffers = ges_test_run_source (GST_ELEMENT (create_timeline (track)),
+      &caps, NULL);
+
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_get_int (gst_caps_get_structure (caps, 0),
+          "rate", &rate));
+  assert_equals_int (rate, 48000);
+  gst_caps_unref (caps);
+
+  /* Silence is pushed without holes nor overlaps until the clip starts */
+  for (tmp = buffers; tmp && next_pts < GST_SECOND; tmp = tmp->next) {
+    GstBuffer *buffer = tmp->data;
+
+    fail_unless (gst_buffer_get_size (buffer) > 0);
+    assert_equals_uint64 (GST_BUFFER_PTS (buffer), next_pts);
+    next_pts = GST_BUFFER_PTS (buffer) + GST_BUFFER_DURATION (buffer);
+  }
+  fail_unless (next_pts >= GST_SECOND);
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+}
+
+GST_END_TEST;
+
+static Suite *
+ges_suite (void)
+{
+  Suite *s = suite_create ("ges-gap-source");
+  TCase *tc_chain = tcase_create ("gap-source");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_gap_src_video);
+  tcase_add_test (tc_chain, test_gap_src_audio);
+
+  return s;
+}
+
+GST_CHECK_MAIN (ges);
@@ -0,0 +1,132 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "test-utils.h"
+#include <ges/ges.h>
+#include <gst/check/gstcheck.h>
+
+/* The element a #GESImageSequenceSource reads @filenames with at 5 fps,
+ * decoding up to 8 of them in advance */
+static GstElement *
+create_reader (gchar ** filenames)
+{
+  GstElement *reader;
+  GESImageSequenceSource *source =
+      gst_object_ref_sink (ges_image_sequence_source_new ());
+
+  ges_image_sequence_source_set_filenames (source, filenames);
+  ges_image_sequence_source_set_framerate (source, 5, 1);
+  reader = GES_VIDEO_SOURCE_GET_CLASS (source)->create_source
+      (GES_TRACK_ELEMENT (source));
+  fail_unless (GST_IS_ELEMENT (reader));
+  gst_object_unref (source);
+
+  return reader;
+}
+
+static gchar *
+get_image_filename (void)
+{
+  gchar *filename, *uri = ges_test_get_image_uri ();
+
+  filename = g_filename_from_uri (uri, NULL, NULL);
+  g_free (uri);
+
+  return filename;
+}
+
+GST_START_TEST (test_read_sequence)
+{
+  guint i;
+  GList *buffers, *tmp;
+  GstElement *reader;
+  GstMessage *message;
+  gchar *filename = get_image_filename ();
+  gchar *filenames[11];
+
+  ges_init ();
+
+  /* More frames in the sequence than are decoded ahead */
+  for (i = 0; i < 10; i++)
+    filenames[i] = filename;
+  filenames[10] = NULL;
+  reader = create_reader (filenames);
+
+  buffers = ges_test_run_source (reader, NULL, &message);
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ERROR)
+    fail_error_message (message);
+  gst_message_unref (message);
+
+  /* One frame per file, at the given framerate */
+  assert_equals_int (g_list_length (buffers), 10);
+  for (tmp = buffers, i = 0; tmp; tmp = tmp->next, i++) {
+    GstBuffer *buffer = tmp->data;
+
+    assert_equals_uint64 (GST_BUFFER_PTS (buffer), i * GST_SECOND / 5);
+    assert_equals_uint64 (GST_BUFFER_DURATION (buffer), GST_SECOND / 5);
+    assert_equals_uint64 (GST_BUFFER_OFFSET (buffer), i);
+  }
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  g_free (filename);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_read_missing_file)
+{
+  GList *buffers;
+  GstElement *reader;
+  GstMessage *message;
+  gchar *filename = get_image_filename ();
+  gchar *missing = g_strconcat (filename, ".missing", NULL);
+  gchar *filenames[] = { filename, missing, filename, NULL };
+
+  ges_init ();
+
+  /* The frames before the missing one are pushed, then an error posted */
+  reader = create_reader (filenames);
+  buffers = ges_test_run_source (reader, NULL, &message);
+  assert_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_ERROR);
+  gst_message_unref (message);
+  assert_equals_int (g_list_length (buffers), 1);
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  g_free (missing);
+  g_free (filename);
+}
+
+GST_END_TEST;
+
+static Suite *
+ges_suite (void)
+{
+  Suite *s = suite_create ("ges-image-sequence");
+  TCase *tc_chain = tcase_create ("image-sequence");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_read_sequence);
+  tcase_add_test (tc_chain, test_read_missing_file);
+
+  return s;
+}
+
+GST_CHECK_MAIN (ges);
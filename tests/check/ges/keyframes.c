@@ -0,0 +1,161 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "test-utils.h"
+#include <ges/ges.h>
+#include <gst/check/gstcheck.h>
+#include <math.h>
+
+static GESTrackElement *
+create_effect (GESTimeline ** timeline)
+{
+  GESLayer *layer;
+  GESTrackElement *effect;
+  GESEffectClip *effect_clip;
+
+  *timeline = ges_timeline_new ();
+  layer = ges_timeline_append_layer (*timeline);
+  ges_timeline_add_track (*timeline, GES_TRACK (ges_video_track_new ()));
+
+  effect_clip = ges_effect_clip_new ("agingtv", NULL);
+  g_object_set (effect_clip, "duration", 10 * GST_SECOND, NULL);
+  fail_unless (ges_layer_add_clip (layer, GES_CLIP (effect_clip)));
+
+  effect = GES_TRACK_ELEMENT (ges_effect_new ("agingtv"));
+  fail_unless (ges_container_add (GES_CONTAINER (effect_clip),
+          GES_TIMELINE_ELEMENT (effect)));
+  fail_unless (ges_track_element_get_track (effect) != NULL);
+
+  return effect;
+}
+
+GST_START_TEST (test_set_get_keyframes)
+{
+  guint n;
+  gdouble *values;
+  GstClockTime *timestamps;
+  GESTimeline *timeline;
+  GESTrackElement *effect;
+  GstClockTime set_timestamps[] = { 5 * GST_SECOND, 0, 10 * GST_SECOND };
+  gdouble set_values[] = { 0.5, 0.0, 1.0 };
+
+  ges_init ();
+
+  effect = create_effect (&timeline);
+
+  fail_if (ges_track_element_get_keyframes (effect, "scratch-lines",
+          &timestamps, &values, &n));
+
+  /* A control source is created for properties that are not controlled */
+  fail_unless (ges_track_element_set_keyframes (effect, "scratch-lines",
+          set_timestamps, set_values, 3));
+  fail_unless (ges_track_element_get_control_binding (effect,
+          "scratch-lines") != NULL);
+
+  /* The keyframes are returned sorted by timestamp */
+  fail_unless (ges_track_element_get_keyframes (effect, "scratch-lines",
+          &timestamps, &values, &n));
+  assert_equals_int (n, 3);
+  assert_equals_uint64 (timestamps[0], 0);
+  assert_equals_uint64 (timestamps[1], 5 * GST_SECOND);
+  assert_equals_uint64 (timestamps[2], 10 * GST_SECOND);
+  fail_unless (values[0] == 0.0);
+  fail_unless (values[1] == 0.5);
+  fail_unless (values[2] == 1.0);
+  g_free (timestamps);
+  g_free (values);
+
+  /* Setting keyframes again replaces all the previous ones */
+  fail_unless (ges_track_element_set_keyframes (effect, "scratch-lines",
+          set_timestamps, set_values, 1));
+  fail_unless (ges_track_element_get_keyframes (effect, "scratch-lines",
+          &timestamps, &values, &n));
+  assert_equals_int (n, 1);
+  assert_equals_uint64 (timestamps[0], 5 * GST_SECOND);
+  fail_unless (values[0] == 0.5);
+  g_free (timestamps);
+  g_free (values);
+
+  fail_unless (ges_track_element_set_keyframes (effect, "scratch-lines",
+          NULL, NULL, 0));
+  fail_unless (ges_track_element_get_keyframes (effect, "scratch-lines",
+          &timestamps, &values, &n));
+  assert_equals_int (n, 0);
+  g_free (timestamps);
+  g_free (values);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_set_invalid_keyframes)
+{
+  guint n;
+  gdouble *values;
+  GstClockTime *timestamps;
+  GESTimeline *timeline;
+  GESTrackElement *effect;
+  GstClockTime set_timestamps[] = { 0, GST_CLOCK_TIME_NONE, 2 * GST_SECOND,
+    3 * GST_SECOND, 4 * GST_SECOND
+  };
+  gdouble set_values[] = { 0.2, 0.5, NAN, 1.5, -1.0 };
+
+  ges_init ();
+
+  effect = create_effect (&timeline);
+
+  /* Invalid keyframes are skipped, out of range values clamped, and the
+   * other keyframes set anyway */
+  fail_if (ges_track_element_set_keyframes (effect, "scratch-lines",
+          set_timestamps, set_values, G_N_ELEMENTS (set_timestamps)));
+
+  fail_unless (ges_track_element_get_keyframes (effect, "scratch-lines",
+          &timestamps, &values, &n));
+  assert_equals_int (n, 3);
+  assert_equals_uint64 (timestamps[0], 0);
+  assert_equals_uint64 (timestamps[1], 3 * GST_SECOND);
+  assert_equals_uint64 (timestamps[2], 4 * GST_SECOND);
+  fail_unless (values[0] == 0.2);
+  fail_unless (values[1] == 1.0);
+  fail_unless (values[2] == 0.0);
+  g_free (timestamps);
+  g_free (values);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+static Suite *
+ges_suite (void)
+{
+  Suite *s = suite_create ("ges-keyframes");
+  TCase *tc_chain = tcase_create ("keyframes");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_set_get_keyframes);
+  tcase_add_test (tc_chain, test_set_invalid_keyframes);
+
+  return s;
+}
+
+GST_CHECK_MAIN (ges);
@@ -1779,6 +1779,157 @@ GST_START_TEST (test_layer_meta_foreach)
 
 GST_END_TEST;
 
+static void
+count_notify_meta_cb (GESMetaContainer * container, const gchar * key,
+    const GValue * value, guint * count)
+{
+  (*count)++;
+}
+
+GST_START_TEST (test_layer_meta_set_get_metas)
+{
+  GESTimeline *timeline;
+  GESLayer *layer;
+  gchar *string;
+  gint int_value;
+  gdouble double_value;
+  guint n_notifies = 0;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_layer_new ();
+  ges_timeline_add_layer (timeline, layer);
+
+  g_signal_connect (layer, "notify-meta", G_CALLBACK (count_notify_meta_cb),
+      &n_notifies);
+  fail_unless (ges_meta_container_set_metas (GES_META_CONTAINER (layer),
+          "ges-test-string", G_TYPE_STRING, "Hello world!",
+          "ges-test-int", G_TYPE_INT, 42,
+          "ges-test-double", G_TYPE_DOUBLE, 1.5, NULL));
+  assert_equals_int (n_notifies, 3);
+
+  fail_unless (ges_meta_container_get_metas (GES_META_CONTAINER (layer),
+          "ges-test-string", G_TYPE_STRING, &string,
+          "ges-test-int", G_TYPE_INT, &int_value,
+          "ges-test-double", G_TYPE_DOUBLE, &double_value, NULL));
+  assert_equals_string (string, "Hello world!");
+  assert_equals_int (int_value, 42);
+  fail_unless (double_value == 1.5);
+  g_free (string);
+
+  /* The types have to match */
+  fail_if (ges_meta_container_get_metas (GES_META_CONTAINER (layer),
+          "ges-test-int", G_TYPE_UINT, &int_value, NULL));
+  fail_if (ges_meta_container_get_metas (GES_META_CONTAINER (layer),
+          "ges-test-missing", G_TYPE_INT, &int_value, NULL));
+
+  /* Metas that can not be written do not prevent setting the others */
+  fail_unless (ges_meta_container_register_meta_string (GES_META_CONTAINER
+          (layer), GES_META_READABLE, "ges-test-readonly", "Hello world!"));
+  fail_if (ges_meta_container_set_metas (GES_META_CONTAINER (layer),
+          "ges-test-readonly", G_TYPE_STRING, "Bye",
+          "ges-test-int", G_TYPE_INT, 24, NULL));
+  assert_equals_string (ges_meta_container_get_string (GES_META_CONTAINER
+          (layer), "ges-test-readonly"), "Hello world!");
+  fail_unless (ges_meta_container_get_int (GES_META_CONTAINER (layer),
+          "ges-test-int", &int_value));
+  assert_equals_int (int_value, 24);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+#define assert_clips_equal(list, ...)                              \
+G_STMT_START {                                                      \
+  GList *_tmp, *_list = (list);                                     \
+  gpointer _expected[] = { __VA_ARGS__, NULL };                     \
+  guint _i;                                                         \
+                                                                    \
+  for (_tmp = _list, _i = 0; _tmp; _tmp = _tmp->next, _i++)         \
+    fail_unless (_tmp->data == _expected[_i],                       \
+        "Clip %u is %p instead of %p", _i, _tmp->data, _expected[_i]); \
+  fail_unless (_expected[_i] == NULL, "Missing clip %u", _i);       \
+  g_list_free (_list);                                              \
+} G_STMT_END
+
+GST_START_TEST (test_layer_clip_queries)
+{
+  GESAsset *asset;
+  GESLayer *layer;
+  GESTimeline *timeline;
+  GESTimelineElement *c1, *c2, *c3, *c4;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+
+  c1 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset, 0, 0,
+          10 * GST_SECOND, GES_TRACK_TYPE_UNKNOWN));
+  c2 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset,
+          5 * GST_SECOND, 0, 2 * GST_SECOND, GES_TRACK_TYPE_UNKNOWN));
+  c3 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset,
+          20 * GST_SECOND, 0, 10 * GST_SECOND, GES_TRACK_TYPE_UNKNOWN));
+
+  /* Clips overlapping the interval, sorted by start, the end is exclusive */
+  assert_clips_equal (ges_layer_get_clips_in_interval (layer, 6 * GST_SECOND,
+          8 * GST_SECOND), c1, c2);
+  assert_clips_equal (ges_layer_get_clips_in_interval (layer, 0,
+          40 * GST_SECOND), c1, c2, c3);
+  fail_unless (ges_layer_get_clips_in_interval (layer, 10 * GST_SECOND,
+          20 * GST_SECOND) == NULL);
+
+  /* Next clips start at or after the position, previous ones before it */
+  fail_unless (ges_layer_get_next_clip (layer, GST_SECOND) == (GESClip *) c2);
+  fail_unless (ges_layer_get_next_clip (layer, 5 * GST_SECOND) ==
+      (GESClip *) c2);
+  fail_unless (ges_layer_get_next_clip (layer, 21 * GST_SECOND) == NULL);
+  fail_unless (ges_layer_get_previous_clip (layer, 5 * GST_SECOND) ==
+      (GESClip *) c1);
+  fail_unless (ges_layer_get_previous_clip (layer, 0) == NULL);
+  fail_unless (ges_layer_get_previous_clip (layer, 40 * GST_SECOND) ==
+      (GESClip *) c3);
+
+  /* Moving a clip re-sorts it */
+  ges_timeline_element_set_start (c3, 2 * GST_SECOND);
+  fail_unless (ges_layer_get_next_clip (layer, GST_SECOND) == (GESClip *) c3);
+  fail_unless (ges_layer_get_previous_clip (layer, 40 * GST_SECOND) ==
+      (GESClip *) c2);
+  fail_unless (ges_layer_get_clips_in_interval (layer, 12 * GST_SECOND,
+          30 * GST_SECOND) == NULL);
+
+  /* Clips starting together are sorted by priority */
+  c4 = GES_TIMELINE_ELEMENT (ges_layer_add_asset (layer, asset,
+          2 * GST_SECOND, 0, GST_SECOND, GES_TRACK_TYPE_UNKNOWN));
+  ges_timeline_element_set_priority (c3, 2);
+  ges_timeline_element_set_priority (c4, 1);
+  assert_clips_equal (ges_layer_get_clips_in_interval (layer, 2 * GST_SECOND,
+          3 * GST_SECOND), c1, c4, c3);
+  ges_timeline_element_set_priority (c4, 3);
+  assert_clips_equal (ges_layer_get_clips_in_interval (layer, 2 * GST_SECOND,
+          3 * GST_SECOND), c1, c3, c4);
+
+  /* Longer clips are found from positions far after their start */
+  ges_timeline_element_set_duration (c1, 60 * GST_SECOND);
+  assert_clips_equal (ges_layer_get_clips_in_interval (layer, 50 * GST_SECOND,
+          51 * GST_SECOND), c1);
+
+  /* And the others are still found once the longest one is gone */
+  fail_unless (ges_layer_remove_clip (layer, GES_CLIP (c1)));
+  assert_clips_equal (ges_layer_get_clips_in_interval (layer, 6 * GST_SECOND,
+          8 * GST_SECOND), c3, c2);
+  fail_unless (ges_layer_get_clips_in_interval (layer, 50 * GST_SECOND,
+          51 * GST_SECOND) == NULL);
+
+  g_object_unref (asset);
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -1806,6 +1957,8 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_layer_meta_value);
   tcase_add_test (tc_chain, test_layer_meta_register);
   tcase_add_test (tc_chain, test_layer_meta_foreach);
+  tcase_add_test (tc_chain, test_layer_meta_set_get_metas);
+  tcase_add_test (tc_chain, test_layer_clip_queries);
 
   return s;
 }
@@ -23,6 +23,8 @@
 #include <gst/check/gstcheck.h>
 
 #include <ges/ges-smart-adder.h>
+#include <gst/audio/audio.h>
+#include <math.h>
 
 static GMainLoop *main_loop;
 
@@ -194,6 +196,298 @@ done:
 
 GST_END_TEST;
 
+#define GAIN_MIXER_RATE   1000
+#define GAIN_MIXER_FRAMES 100
+
+static void
+gain_mixer_handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    GArray * samples)
+{
+  GstMapInfo map;
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  g_array_append_vals (samples, map.data, map.size / sizeof (gfloat));
+  gst_buffer_unmap (buffer, &map);
+}
+
+/* Links a source of GAIN_MIXER_FRAMES mono samples in @format all set to
+ * @value to @sinkpad */
+static void
+add_gain_mixer_input (GstElement * pipeline, GstPad * sinkpad,
+    const gchar * format, gdouble value)
+{
+  GstCaps *caps;
+  GstPad *srcpad;
+  GstElement *src = gst_element_factory_make ("audiotestsrc", NULL);
+  GstElement *capsfilter = gst_element_factory_make ("capsfilter", NULL);
+
+  /* A square wave of null frequency stays at its volume */
+  g_object_set (src, "wave", 1, "freq", 0.0, "volume", value, "num-buffers",
+      1, "samplesperbuffer", GAIN_MIXER_FRAMES, NULL);
+  caps = gst_caps_new_simple ("audio/x-raw", "format", G_TYPE_STRING,
+      format, "layout", G_TYPE_STRING, "interleaved", "rate",
+      G_TYPE_INT, GAIN_MIXER_RATE, "channels", G_TYPE_INT, 1, NULL);
+  g_object_set (capsfilter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  gst_bin_add_many (GST_BIN (pipeline), src, capsfilter, NULL);
+  fail_unless (gst_element_link (src, capsfilter));
+
+  srcpad = gst_element_get_static_pad (capsfilter, "src");
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (srcpad);
+}
+
+/* Adds an input of samples in @format set to 1.0 to @smart_adder, returns
+ * the pad of its gain mixer the input goes to and sets @ghost to the input
+ * pad of @smart_adder */
+static GstPad *
+add_smart_adder_input (GstElement * pipeline, GstElement * smart_adder,
+    const gchar * format, GstPad ** ghost)
+{
+  GstPad *sinkpad, *pad;
+
+  sinkpad = gst_element_get_request_pad (smart_adder, "sink_%u");
+  fail_unless (GST_IS_GHOST_PAD (sinkpad));
+  pad = gst_ghost_pad_get_target (GST_GHOST_PAD (sinkpad));
+  fail_unless (GST_IS_PAD (pad));
+
+  add_gain_mixer_input (pipeline, sinkpad, format, 1.0);
+
+  /* The smart adder and its gain mixer keep a ref */
+  gst_object_unref (sinkpad);
+  gst_object_unref (pad);
+
+  if (ghost)
+    *ghost = sinkpad;
+
+  return pad;
+}
+
+static GstElement *
+create_gain_mixer_pipeline (GstElement * mixer, GArray * samples)
+{
+  GstCaps *caps;
+  GstElement *pipeline = gst_pipeline_new (NULL);
+  GstElement *capsfilter = gst_element_factory_make ("capsfilter", NULL);
+  GstElement *sink = gst_element_factory_make ("fakesink", NULL);
+
+  caps = gst_caps_new_simple ("audio/x-raw", "format", G_TYPE_STRING,
+      GST_AUDIO_NE (F32), "channels", G_TYPE_INT, 1, NULL);
+  g_object_set (capsfilter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  g_object_set (sink, "signal-handoffs", TRUE, "sync", FALSE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (gain_mixer_handoff_cb),
+      samples);
+
+  gst_bin_add_many (GST_BIN (pipeline), mixer, capsfilter, sink, NULL);
+  fail_unless (gst_element_link_many (mixer, capsfilter, sink, NULL));
+
+  return pipeline;
+}
+
+static void
+run_gain_mixer_pipeline (GstElement * pipeline)
+{
+  GstBus *bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  GstMessage *message;
+
+  fail_if (gst_element_set_state (pipeline, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE);
+  message = gst_bus_timed_pop_filtered (bus, 5 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message != NULL, "No EOS after 5 seconds");
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ERROR)
+    fail_error_message (message);
+  gst_message_unref (message);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+}
+
+#define assert_sample_equals(samples, i, expected)                       \
+G_STMT_START {                                                           \
+  gfloat _sample = g_array_index (samples, gfloat, i);                   \
+  fail_unless (fabs (_sample - (expected)) < 1e-4,                       \
+      "Sample %u is %f instead of %f", i, _sample, (gdouble) (expected)); \
+} G_STMT_END
+
+GST_START_TEST (test_gain_mixer_volumes)
+{
+  guint i;
+  GstPad *pad, *pad1;
+  GstElement *pipeline, *smart_adder;
+  GArray *samples = g_array_new (FALSE, FALSE, sizeof (gfloat));
+
+  smart_adder = ges_smart_adder_new (NULL);
+  pipeline = create_gain_mixer_pipeline (smart_adder, samples);
+  pad = add_smart_adder_input (pipeline, smart_adder, GST_AUDIO_NE (F32),
+      NULL);
+  pad1 = add_smart_adder_input (pipeline, smart_adder, GST_AUDIO_NE (F32),
+      NULL);
+  g_object_set (pad, "volume", 0.5, NULL);
+  g_object_set (pad1, "volume", 0.25, NULL);
+
+  run_gain_mixer_pipeline (pipeline);
+
+  /* Each input is scaled by the volume of its pad before being summed */
+  assert_equals_int (samples->len, GAIN_MIXER_FRAMES);
+  for (i = 0; i < samples->len; i++)
+    assert_sample_equals (samples, i, 0.75);
+
+  g_array_unref (samples);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+/* Checks whether the input of @format to a smart adder got converters in
+ * front of the gain mixer */
+static void
+check_smart_adder_conversion (const gchar * format, gboolean converted)
+{
+  guint i;
+  GstPad *ghost, *pad, *target;
+  GstElement *pipeline, *smart_adder;
+  GArray *samples = g_array_new (FALSE, FALSE, sizeof (gfloat));
+
+  smart_adder = ges_smart_adder_new (NULL);
+  pipeline = create_gain_mixer_pipeline (smart_adder, samples);
+  pad = add_smart_adder_input (pipeline, smart_adder, format, &ghost);
+
+  run_gain_mixer_pipeline (pipeline);
+
+  /* Only the gain mixer and the capsfilter setting the mixing format are
+   * in the smart adder when nothing needs converting */
+  target = gst_ghost_pad_get_target (GST_GHOST_PAD (ghost));
+  if (converted) {
+    fail_unless (target != pad);
+    assert_equals_int (GST_BIN_NUMCHILDREN (smart_adder), 3);
+  } else {
+    fail_unless (target == pad);
+    assert_equals_int (GST_BIN_NUMCHILDREN (smart_adder), 2);
+  }
+  gst_object_unref (target);
+
+  /* The mix is in the mixing format in both cases */
+  assert_equals_int (samples->len, GAIN_MIXER_FRAMES);
+  for (i = 0; i < samples->len; i++)
+    assert_sample_equals (samples, i, 1.0);
+
+  g_array_unref (samples);
+  gst_object_unref (pipeline);
+}
+
+GST_START_TEST (test_smart_adder_mixing_format)
+{
+  check_smart_adder_conversion (GST_AUDIO_NE (F32), FALSE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_smart_adder_conversion)
+{
+  check_smart_adder_conversion (GST_AUDIO_NE (S16), TRUE);
+}
+
+GST_END_TEST;
+
+/* The fades last GAIN_MIXER_FRAMES frames, their last gain is reached on
+ * the last frame */
+#define GAIN_MIXER_FADE_DURATION \
+  ((GAIN_MIXER_FRAMES - 1) * GST_SECOND / GAIN_MIXER_RATE)
+
+/* Runs the crossfade of an audio transition from samples set to @a to
+ * samples set to @b and returns the mixed samples */
+static GArray *
+run_audio_transition (gboolean constant_power, gdouble a, gdouble b)
+{
+  GstPad *pad;
+  GstElement *pipeline, *bin;
+  GESTrackElement *transition;
+  GArray *samples = g_array_new (FALSE, FALSE, sizeof (gfloat));
+
+  transition = GES_TRACK_ELEMENT (ges_audio_transition_new ());
+  g_object_ref_sink (transition);
+  g_object_set (transition, "constant-power", constant_power, NULL);
+  ges_timeline_element_set_duration (GES_TIMELINE_ELEMENT (transition),
+      GAIN_MIXER_FADE_DURATION);
+
+  /* The element the transition puts in its operation */
+  bin = GES_TRACK_ELEMENT_GET_CLASS (transition)->create_element (transition);
+  fail_unless (GST_IS_BIN (bin));
+  pipeline = create_gain_mixer_pipeline (bin, samples);
+
+  pad = gst_element_get_static_pad (bin, "sinka");
+  add_gain_mixer_input (pipeline, pad, GST_AUDIO_NE (F32), a);
+  gst_object_unref (pad);
+  pad = gst_element_get_static_pad (bin, "sinkb");
+  add_gain_mixer_input (pipeline, pad, GST_AUDIO_NE (F32), b);
+  gst_object_unref (pad);
+
+  run_gain_mixer_pipeline (pipeline);
+
+  gst_object_unref (pipeline);
+  g_object_unref (transition);
+
+  return samples;
+}
+
+GST_START_TEST (test_gain_mixer_linear_fade)
+{
+  guint i;
+  GArray *samples;
+
+  /* Fading in from silence, the gain goes from 0 to 1 with a sample
+   * accurate ramp */
+  samples = run_audio_transition (FALSE, 0.0, 1.0);
+
+  assert_equals_int (samples->len, GAIN_MIXER_FRAMES);
+  for (i = 0; i < samples->len; i++)
+    assert_sample_equals (samples, i, (gdouble) i / (GAIN_MIXER_FRAMES - 1));
+
+  g_array_unref (samples);
+}
+
+GST_END_TEST;
+
+static void
+check_crossfade (gboolean constant_power)
+{
+  guint i;
+  GArray *samples = run_audio_transition (constant_power, 1.0, 1.0);
+
+  assert_equals_int (samples->len, GAIN_MIXER_FRAMES);
+  for (i = 0; i < samples->len; i++) {
+    gdouble x = (gdouble) i / (GAIN_MIXER_FRAMES - 1);
+
+    /* Constant power: the gains are sin and cos of the same angle, the sum
+     * of their squares is 1. Linear: the gains sum to 1 */
+    if (constant_power)
+      assert_sample_equals (samples, i, sin ((1.0 - x) * G_PI_2) +
+          sin (x * G_PI_2));
+    else
+      assert_sample_equals (samples, i, 1.0);
+  }
+
+  g_array_unref (samples);
+}
+
+GST_START_TEST (test_gain_mixer_linear_crossfade)
+{
+  check_crossfade (FALSE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gain_mixer_constant_power_crossfade)
+{
+  check_crossfade (TRUE);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -206,6 +500,12 @@ ges_suite (void)
   tcase_add_test (tc_chain, simple_smart_adder_test);
   tcase_add_test (tc_chain, simple_audio_mixed_with_pipeline);
   tcase_add_test (tc_chain, audio_video_mixed_with_pipeline);
+  tcase_add_test (tc_chain, test_gain_mixer_volumes);
+  tcase_add_test (tc_chain, test_smart_adder_mixing_format);
+  tcase_add_test (tc_chain, test_smart_adder_conversion);
+  tcase_add_test (tc_chain, test_gain_mixer_linear_fade);
+  tcase_add_test (tc_chain, test_gain_mixer_linear_crossfade);
+  tcase_add_test (tc_chain, test_gain_mixer_constant_power_crossfade);
 
   return s;
 }
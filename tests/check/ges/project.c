@@ -708,6 +708,87 @@ GST_START_TEST (test_load_xges_and_play)
 GST_END_TEST;
 #endif
 
+GST_START_TEST (test_project_find_assets_by_meta)
+{
+  GList *assets;
+  GESProject *project;
+  GESAsset *aging, *edge, *balance;
+  GValue value = G_VALUE_INIT, dvalue = G_VALUE_INIT;
+
+  ges_init ();
+
+  project = GES_PROJECT (ges_asset_request (GES_TYPE_TIMELINE, NULL, NULL));
+  aging = ges_asset_request (GES_TYPE_EFFECT, "agingtv", NULL);
+  edge = ges_asset_request (GES_TYPE_EFFECT, "edgetv", NULL);
+  balance = ges_asset_request (GES_TYPE_EFFECT, "videobalance", NULL);
+  fail_unless (aging && edge && balance);
+
+  ges_meta_container_set_int (GES_META_CONTAINER (aging), "ges-test-rating",
+      3);
+  ges_meta_container_set_int (GES_META_CONTAINER (edge), "ges-test-rating",
+      5);
+  ges_meta_container_set_double (GES_META_CONTAINER (balance),
+      "ges-test-rating", 4.0);
+  fail_unless (ges_project_add_asset (project, aging));
+  fail_unless (ges_project_add_asset (project, edge));
+  ges_project_add_meta_index (project, "ges-test-rating");
+
+  /* Assets added after the index was built are indexed too */
+  fail_unless (ges_project_add_asset (project, balance));
+
+  g_value_init (&value, G_TYPE_INT);
+  g_value_set_int (&value, 5);
+  assets = ges_project_find_assets_by_meta (project, "ges-test-rating",
+      &value);
+  assert_equals_int (g_list_length (assets), 1);
+  fail_unless (assets->data == edge);
+  g_list_free_full (assets, gst_object_unref);
+
+  /* Values of other types never match */
+  g_value_init (&dvalue, G_TYPE_DOUBLE);
+  g_value_set_double (&dvalue, 5.0);
+  fail_unless (ges_project_find_assets_by_meta (project, "ges-test-rating",
+          &dvalue) == NULL);
+
+  /* But ranges compare all the numbers, sorted by value */
+  g_value_set_int (&value, 4);
+  assets = ges_project_find_assets_by_meta_range (project, "ges-test-rating",
+      &value, NULL);
+  assert_equals_int (g_list_length (assets), 2);
+  fail_unless (assets->data == balance);
+  fail_unless (assets->next->data == edge);
+  g_list_free_full (assets, gst_object_unref);
+
+  assets = ges_project_find_assets_by_meta_range (project, "ges-test-rating",
+      NULL, &dvalue);
+  assert_equals_int (g_list_length (assets), 3);
+  fail_unless (assets->data == aging);
+  g_list_free_full (assets, gst_object_unref);
+
+  /* The index follows the changes of the metas */
+  ges_meta_container_set_int (GES_META_CONTAINER (edge), "ges-test-rating",
+      1);
+  assets = ges_project_find_assets_by_meta_range (project, "ges-test-rating",
+      &value, NULL);
+  assert_equals_int (g_list_length (assets), 1);
+  fail_unless (assets->data == balance);
+  g_list_free_full (assets, gst_object_unref);
+
+  /* And the removal of the assets */
+  fail_unless (ges_project_remove_asset (project, balance));
+  fail_unless (ges_project_find_assets_by_meta_range (project,
+          "ges-test-rating", &value, NULL) == NULL);
+
+  g_value_unset (&value);
+  g_value_unset (&dvalue);
+  gst_object_unref (aging);
+  gst_object_unref (edge);
+  gst_object_unref (balance);
+  gst_object_unref (project);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -724,6 +805,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_project_auto_transition);
   /*tcase_add_test (tc_chain, test_load_xges_and_play); */
   tcase_add_test (tc_chain, test_project_unexistant_effect);
+  tcase_add_test (tc_chain, test_project_find_assets_by_meta);
 
   return s;
 }
@@ -0,0 +1,189 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "test-utils.h"
+#include <ges/ges.h>
+#include <gst/check/gstcheck.h>
+
+/* The image source of a clip showing the test image, in a track restricted
+ * to 320x240 at 10fps */
+static GESTrackElement *
+create_image_source (GESTimeline ** timeline)
+{
+  gchar *uri;
+  GstCaps *caps;
+  GESLayer *layer;
+  GESClip *clip;
+  GESAsset *asset;
+  GESTrack *track = GES_TRACK (ges_video_track_new ());
+
+  caps = gst_caps_from_string ("video/x-raw,width=320,height=240,"
+      "framerate=10/1");
+  ges_track_set_restriction_caps (track, caps);
+  gst_caps_unref (caps);
+
+  *timeline = ges_timeline_new ();
+  ges_timeline_add_track (*timeline, track);
+  layer = ges_timeline_append_layer (*timeline);
+
+  uri = ges_test_get_image_uri ();
+  asset = GES_ASSET (ges_uri_clip_asset_request_sync (uri, NULL));
+  fail_unless (asset != NULL);
+  g_free (uri);
+
+  clip = ges_layer_add_asset (layer, asset, 0, 0, GST_SECOND,
+      GES_TRACK_TYPE_UNKNOWN);
+  fail_unless (clip != NULL);
+  assert_equals_int (g_list_length (GES_CONTAINER_CHILDREN (clip)), 1);
+  fail_unless (GES_IS_IMAGE_SOURCE (GES_CONTAINER_CHILDREN (clip)->data));
+
+  return GES_CONTAINER_CHILDREN (clip)->data;
+}
+
+/* A new element pushing the image of @source, as it would in the
+ * composition */
+static GstElement *
+create_still_image_src (GESTrackElement * source, gint num_buffers)
+{
+  GstElement *src = GES_VIDEO_SOURCE_GET_CLASS (source)->create_source (source);
+
+  fail_unless (GST_IS_ELEMENT (src));
+  g_object_set (src, "num-buffers", num_buffers, NULL);
+
+  return src;
+}
+
+static void
+check_caps (GstCaps * caps, gint expected_width, gint expected_height)
+{
+  gint width, height;
+  GstStructure *structure = gst_caps_get_structure (caps, 0);
+
+  fail_unless (gst_structure_get_int (structure, "width", &width));
+  fail_unless (gst_structure_get_int (structure, "height", &height));
+  assert_equals_int (width, expected_width);
+  assert_equals_int (height, expected_height);
+}
+
+GST_START_TEST (test_still_image_src)
+{
+  guint i;
+  GstCaps *caps;
+  GList *buffers, *tmp;
+  GstElement *src;
+  GESTimeline *timeline;
+  GstMemory *memory = NULL;
+
+  ges_init ();
+
+  src = create_still_image_src (create_image_source (&timeline), 3);
+
+  /* The image is decoded to the size of the track restriction caps and
+   * pushed at its framerate */
+  buffers = ges_test_run_source (src, &caps, NULL);
+  check_caps (caps, 320, 240);
+  gst_caps_unref (caps);
+
+  assert_equals_int (g_list_length (buffers), 3);
+  for (tmp = buffers, i = 0; tmp; tmp = tmp->next, i++) {
+    GstBuffer *buffer = tmp->data;
+
+    assert_equals_uint64 (GST_BUFFER_PTS (buffer), i * GST_SECOND / 10);
+    assert_equals_uint64 (GST_BUFFER_DURATION (buffer), GST_SECOND / 10);
+
+    /* The same decoded image is pushed over and over */
+    if (memory == NULL)
+      memory = gst_buffer_peek_memory (buffer, 0);
+    fail_unless (gst_buffer_peek_memory (buffer, 0) == memory);
+  }
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_still_image_shared)
+{
+  GList *buffers, *buffers1;
+  GESTimeline *timeline;
+  GESTrackElement *source;
+
+  ges_init ();
+
+  source = create_image_source (&timeline);
+
+  /* Sources showing the same image at the same size share its decoding */
+  buffers = ges_test_run_source (create_still_image_src (source, 1), NULL,
+      NULL);
+  buffers1 = ges_test_run_source (create_still_image_src (source, 1), NULL,
+      NULL);
+
+  assert_equals_int (g_list_length (buffers), 1);
+  assert_equals_int (g_list_length (buffers1), 1);
+  fail_unless (gst_buffer_peek_memory (buffers->data, 0) ==
+      gst_buffer_peek_memory (buffers1->data, 0));
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  g_list_free_full (buffers1, (GDestroyNotify) gst_buffer_unref);
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_still_image_without_track_element)
+{
+  GstCaps *caps;
+  GList *buffers;
+  GstElement *src;
+  GESTimeline *timeline;
+
+  ges_init ();
+
+  src = create_still_image_src (create_image_source (&timeline), 1);
+
+  /* Once its track element is gone the image is shown at its own size */
+  gst_object_unref (timeline);
+  buffers = ges_test_run_source (src, &caps, NULL);
+  check_caps (caps, 1920, 1080);
+  gst_caps_unref (caps);
+  assert_equals_int (g_list_length (buffers), 1);
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+}
+
+GST_END_TEST;
+
+static Suite *
+ges_suite (void)
+{
+  Suite *s = suite_create ("ges-still-image");
+  TCase *tc_chain = tcase_create ("still-image");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_still_image_src);
+  tcase_add_test (tc_chain, test_still_image_shared);
+  tcase_add_test (tc_chain, test_still_image_without_track_element);
+
+  return s;
+}
+
+GST_CHECK_MAIN (ges);
@@ -277,3 +277,59 @@ play_timeline (GESTimeline * timeline)
 
   return TRUE;
 }
+
+static void
+collect_buffer_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    GList ** buffers)
+{
+  *buffers = g_list_append (*buffers, gst_buffer_ref (buffer));
+}
+
+/* Runs @src, which is sunk, into a fakesink until EOS or an error and
+ * returns the buffers it pushed. If @caps is not %NULL it is set to the
+ * last negotiated caps. If @message is not %NULL it is set to the message
+ * the run ended with, else the test fails on errors */
+GList *
+ges_test_run_source (GstElement * src, GstCaps ** caps, GstMessage ** message)
+{
+  GstBus *bus;
+  GstMessage *msg;
+  GList *buffers = NULL;
+  GstElement *pipeline = gst_pipeline_new (NULL);
+  GstElement *sink = gst_element_factory_make ("fakesink", NULL);
+
+  g_object_set (sink, "signal-handoffs", TRUE, "sync", FALSE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (collect_buffer_cb),
+      &buffers);
+
+  gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  fail_if (gst_element_set_state (pipeline, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (msg != NULL, "No EOS nor error after 10 seconds");
+
+  if (message) {
+    *message = msg;
+  } else {
+    if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+      fail_error_message (msg);
+    gst_message_unref (msg);
+  }
+
+  if (caps) {
+    GstPad *sinkpad = gst_element_get_static_pad (sink, "sink");
+
+    *caps = gst_pad_get_current_caps (sinkpad);
+    gst_object_unref (sinkpad);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  return buffers;
+}
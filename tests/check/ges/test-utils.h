@@ -46,6 +46,8 @@ ges_generate_test_file_audio_video (const gchar * filedest,
     const gchar * mux, const gchar * video_pattern, const gchar * audio_wave);
 gboolean
 play_timeline (GESTimeline * timeline);
+GList * ges_test_run_source (GstElement *src, GstCaps **caps,
+    GstMessage **message);
 
 #define gnl_object_check(gnlobj, start, duration, mstart, mduration, priority, active) { \
   guint64 pstart, pdur, inpoint, pprio, pact;			\
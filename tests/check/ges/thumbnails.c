@@ -0,0 +1,173 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 GStreamer Editing Services contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "test-utils.h"
+#include <ges/ges.h>
+#include <gst/check/gstcheck.h>
+
+typedef struct
+{
+  GArray *timestamps;
+  guint max_thumbnails;
+} ThumbnailsData;
+
+static gboolean
+thumbnail_cb (GESPipeline * pipeline, GstClockTime timestamp,
+    GstSample * sample, ThumbnailsData * data)
+{
+  gint width, height;
+  GstStructure *structure;
+
+  fail_unless (GST_IS_SAMPLE (sample));
+  fail_unless (gst_sample_get_buffer (sample) != NULL);
+
+  structure = gst_caps_get_structure (gst_sample_get_caps (sample), 0);
+  fail_unless (gst_structure_get_int (structure, "width", &width));
+  fail_unless (gst_structure_get_int (structure, "height", &height));
+  assert_equals_int (width, 64);
+  assert_equals_int (height, 48);
+  assert_equals_string (gst_structure_get_string (structure, "format"), "RGB");
+
+  g_array_append_val (data->timestamps, timestamp);
+
+  return data->timestamps->len < data->max_thumbnails;
+}
+
+static GESPipeline *
+create_thumbnailing_pipeline (void)
+{
+  GESLayer *layer;
+  GESClip *clip;
+  GESPipeline *pipeline;
+  GESTimeline *timeline = ges_timeline_new ();
+
+  ges_timeline_add_track (timeline, GES_TRACK (ges_video_track_new ()));
+  layer = ges_timeline_append_layer (timeline);
+
+  clip = GES_CLIP (ges_test_clip_new ());
+  ges_timeline_element_set_duration (GES_TIMELINE_ELEMENT (clip),
+      2 * GST_SECOND);
+  fail_unless (ges_layer_add_clip (layer, clip));
+
+  pipeline = ges_test_create_pipeline (timeline);
+  fail_unless (ges_pipeline_set_mode (pipeline, GES_PIPELINE_MODE_THUMBNAIL));
+
+  return pipeline;
+}
+
+GST_START_TEST (test_thumbnails_in_order)
+{
+  GError *error = NULL;
+  GESPipeline *pipeline;
+  ThumbnailsData data = { NULL, G_MAXUINT };
+  GstClockTime timestamps[] = { GST_SECOND, 0, GST_SECOND / 2 };
+
+  ges_init ();
+
+  pipeline = create_thumbnailing_pipeline ();
+  data.timestamps = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+
+  fail_unless (ges_pipeline_get_thumbnails (pipeline, timestamps,
+          G_N_ELEMENTS (timestamps), 64, 48,
+          (GESPipelineThumbnailFunc) thumbnail_cb, &data, &error));
+  fail_unless (error == NULL);
+
+  /* The thumbnails are produced in increasing timestamp order */
+  assert_equals_int (data.timestamps->len, 3);
+  assert_equals_uint64 (g_array_index (data.timestamps, GstClockTime, 0), 0);
+  assert_equals_uint64 (g_array_index (data.timestamps, GstClockTime, 1),
+      GST_SECOND / 2);
+  assert_equals_uint64 (g_array_index (data.timestamps, GstClockTime, 2),
+      GST_SECOND);
+
+  g_array_unref (data.timestamps);
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_thumbnails_stop)
+{
+  GError *error = NULL;
+  GESPipeline *pipeline;
+  ThumbnailsData data = { NULL, 1 };
+  GstClockTime timestamps[] = { 0, GST_SECOND / 2, GST_SECOND };
+
+  ges_init ();
+
+  pipeline = create_thumbnailing_pipeline ();
+  data.timestamps = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+
+  fail_unless (ges_pipeline_get_thumbnails (pipeline, timestamps,
+          G_N_ELEMENTS (timestamps), 64, 48,
+          (GESPipelineThumbnailFunc) thumbnail_cb, &data, &error));
+  fail_unless (error == NULL);
+  assert_equals_int (data.timestamps->len, 1);
+
+  g_array_unref (data.timestamps);
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_thumbnails_wrong_mode)
+{
+  GError *error = NULL;
+  GESPipeline *pipeline;
+  ThumbnailsData data = { NULL, G_MAXUINT };
+  GstClockTime timestamp = 0;
+
+  ges_init ();
+
+  pipeline = create_thumbnailing_pipeline ();
+  fail_unless (ges_pipeline_set_mode (pipeline, GES_PIPELINE_MODE_PREVIEW));
+  data.timestamps = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+
+  fail_if (ges_pipeline_get_thumbnails (pipeline, &timestamp, 1, 64, 48,
+          (GESPipelineThumbnailFunc) thumbnail_cb, &data, &error));
+  fail_unless (error != NULL);
+  assert_equals_int (data.timestamps->len, 0);
+
+  g_clear_error (&error);
+  g_array_unref (data.timestamps);
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+static Suite *
+ges_suite (void)
+{
+  Suite *s = suite_create ("ges-thumbnails");
+  TCase *tc_chain = tcase_create ("thumbnails");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_thumbnails_in_order);
+  tcase_add_test (tc_chain, test_thumbnails_stop);
+  tcase_add_test (tc_chain, test_thumbnails_wrong_mode);
+
+  return s;
+}
+
+GST_CHECK_MAIN (ges);
@@ -205,6 +205,131 @@ GST_START_TEST (test_title_source_in_layer)
 
 GST_END_TEST;
 
+#define TITLE_WIDTH  64
+#define TITLE_HEIGHT 48
+
+/* Runs the element @source puts in the composition for 2 frames, in BGRA
+ * at TITLE_WIDTHxTITLE_HEIGHT, and returns them */
+static GList *
+render_title (GESTrackElement * source)
+{
+  GstCaps *caps;
+  GstPad *pad;
+  GstElement *bin, *topbin, *background, *capsfilter;
+
+  topbin = GES_VIDEO_SOURCE_GET_CLASS (source)->create_source (source);
+  background = gst_bin_get_by_name (GST_BIN (topbin), "titlesrc-bg");
+  fail_unless (background != NULL);
+  g_object_set (background, "num-buffers", 2, NULL);
+  gst_object_unref (background);
+
+  capsfilter = gst_element_factory_make ("capsfilter", NULL);
+  caps = gst_caps_new_simple ("video/x-raw", "format", G_TYPE_STRING, "BGRA",
+      "width", G_TYPE_INT, TITLE_WIDTH, "height", G_TYPE_INT, TITLE_HEIGHT,
+      NULL);
+  g_object_set (capsfilter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  bin = gst_bin_new (NULL);
+  gst_bin_add_many (GST_BIN (bin), topbin, capsfilter, NULL);
+  fail_unless (gst_element_link (topbin, capsfilter));
+  pad = gst_element_get_static_pad (capsfilter, "src");
+  gst_element_add_pad (bin, gst_ghost_pad_new ("src", pad));
+  gst_object_unref (pad);
+
+  return ges_test_run_source (bin, NULL, NULL);
+}
+
+/* The number of pixels of @frame that are opaque blue */
+static guint
+count_background_pixels (GstBuffer * frame)
+{
+  guint i, n = 0;
+  GstMapInfo map;
+
+  fail_unless (gst_buffer_map (frame, &map, GST_MAP_READ));
+  fail_unless (map.size >= TITLE_WIDTH * TITLE_HEIGHT * 4);
+  for (i = 0; i < TITLE_WIDTH * TITLE_HEIGHT; i++) {
+    guint8 *pixel = map.data + i * 4;
+
+    if (pixel[0] == 0xff && pixel[1] == 0 && pixel[2] == 0 && pixel[3] == 0xff)
+      n++;
+  }
+  gst_buffer_unmap (frame, &map);
+
+  return n;
+}
+
+static void
+check_title_rendering (gboolean pre_rendered)
+{
+  GList *frames, *tmp;
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESTrack *track;
+  GESClip *clip;
+  GESTitleSource *source;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  track = GES_TRACK (ges_video_track_new ());
+  ges_timeline_add_track (timeline, track);
+  layer = ges_timeline_append_layer (timeline);
+
+  clip = GES_CLIP (ges_title_clip_new ());
+  g_object_set (clip, "duration", (guint64) GST_SECOND, NULL);
+  ges_layer_add_clip (layer, clip);
+  source = GES_TITLE_SOURCE (ges_clip_find_track_element (clip, track,
+          GES_TYPE_TITLE_SOURCE));
+  fail_unless (source != NULL);
+
+  /* Titles are pre-rendered unless told otherwise */
+  fail_unless (ges_title_source_get_pre_rendered (source));
+  ges_title_source_set_pre_rendered (source, pre_rendered);
+  assert_equals_int (ges_title_source_get_pre_rendered (source),
+      pre_rendered);
+
+  /* Without text, the frames are filled with the background color */
+  ges_title_source_set_text (source, NULL);
+  ges_title_source_set_background_color (source, 0xff0000ff);
+  frames = render_title (GES_TRACK_ELEMENT (source));
+  assert_equals_int (g_list_length (frames), 2);
+  for (tmp = frames; tmp; tmp = tmp->next)
+    assert_equals_int (count_background_pixels (tmp->data),
+        TITLE_WIDTH * TITLE_HEIGHT);
+  g_list_free_full (frames, (GDestroyNotify) gst_buffer_unref);
+
+  /* The text is drawn on every frame */
+  ges_title_source_set_text (source, "GES");
+  ges_title_source_set_font_desc (source, "sans 30");
+  frames = render_title (GES_TRACK_ELEMENT (source));
+  assert_equals_int (g_list_length (frames), 2);
+  for (tmp = frames; tmp; tmp = tmp->next) {
+    guint n = count_background_pixels (tmp->data);
+
+    fail_unless (n > 0 && n < TITLE_WIDTH * TITLE_HEIGHT);
+  }
+  g_list_free_full (frames, (GDestroyNotify) gst_buffer_unref);
+
+  gst_object_unref (source);
+  gst_object_unref (timeline);
+}
+
+GST_START_TEST (test_title_source_pre_rendered)
+{
+  check_title_rendering (TRUE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_title_source_not_pre_rendered)
+{
+  check_title_rendering (FALSE);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -216,6 +341,8 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_title_source_basic);
   tcase_add_test (tc_chain, test_title_source_properties);
   tcase_add_test (tc_chain, test_title_source_in_layer);
+  tcase_add_test (tc_chain, test_title_source_pre_rendered);
+  tcase_add_test (tc_chain, test_title_source_not_pre_rendered);
 
   return s;
 }
@@ -266,7 +266,119 @@ GST_START_TEST (test_filesource_images)
 GST_END_TEST;
 
 
-static Suite *
+static static void
+proxy_uri_notified_cb (GESUriClipAsset * asset, GParamSpec * arg,
+    GMainLoop * loop)
+{
+  g_main_loop_quit (loop);
+}
+
+static gboolean
+quit_loop_cb (GMainLoop * loop)
+{
+  g_main_loop_quit (loop);
+
+  return FALSE;
+}
+
+/* The uri read by the uridecodebin of @source */
+static gchar *
+get_decoded_uri (GESTrackElement * source)
+{
+  GstIterator *it;
+  gchar *uri = NULL;
+  GValue item = G_VALUE_INIT;
+
+  it = gst_bin_iterate_recurse (GST_BIN (ges_track_element_get_element
+          (source)));
+  while (uri == NULL && gst_iterator_next (it, &item) == GST_ITERATOR_OK) {
+    GstElement *child = g_value_get_object (&item);
+    GstElementFactory *factory = gst_element_get_factory (child);
+
+    if (factory && g_strcmp0 (GST_OBJECT_NAME (factory), "uridecodebin") == 0)
+      g_object_get (child, "uri", &uri, NULL);
+    g_value_reset (&item);
+  }
+  g_value_unset (&item);
+  gst_iterator_free (it);
+
+  return uri;
+}
+
+GST_START_TEST (test_uri_clip_proxy)
+{
+  gchar *uri;
+  guint timeout;
+  GList *sources;
+  GESLayer *layer;
+  GMainLoop *loop;
+  GESTrack *track;
+  GESTimeline *timeline;
+  const gchar *proxy_uri;
+  GESUriClipAsset *asset;
+
+  ges_init ();
+
+  asset = ges_uri_clip_asset_request_sync (av_uri, NULL);
+  fail_unless (GES_IS_URI_CLIP_ASSET (asset));
+
+  timeline = ges_timeline_new ();
+  track = GES_TRACK (ges_video_track_new ());
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+  fail_unless (ges_layer_add_asset (layer, GES_ASSET (asset), 0, 0,
+          GST_SECOND, GES_TRACK_TYPE_UNKNOWN) != NULL);
+
+  sources = ges_track_get_elements (track);
+  assert_equals_int (g_list_length (sources), 1);
+  fail_unless (GES_IS_VIDEO_URI_SOURCE (sources->data));
+  uri = get_decoded_uri (sources->data);
+  assert_equals_string (uri, av_uri);
+  g_free (uri);
+
+  /* The test file has a theora stream, it can be proxied */
+  fail_unless (ges_uri_clip_asset_create_proxy (asset));
+  if (ges_uri_clip_asset_get_proxy_uri (asset) == NULL) {
+    loop = g_main_loop_new (NULL, FALSE);
+    g_signal_connect (asset, "notify::proxy-uri",
+        G_CALLBACK (proxy_uri_notified_cb), loop);
+    timeout = g_timeout_add_seconds (30, (GSourceFunc) quit_loop_cb, loop);
+    g_main_loop_run (loop);
+    g_source_remove (timeout);
+    g_signal_handlers_disconnect_by_func (asset, proxy_uri_notified_cb, loop);
+    g_main_loop_unref (loop);
+  }
+
+  proxy_uri = ges_uri_clip_asset_get_proxy_uri (asset);
+  fail_unless (proxy_uri != NULL);
+  fail_if (g_strcmp0 (proxy_uri, av_uri) == 0);
+
+  /* Creating it again is a no-op */
+  fail_unless (ges_uri_clip_asset_create_proxy (asset));
+  assert_equals_string (ges_uri_clip_asset_get_proxy_uri (asset), proxy_uri);
+
+  /* The proxy is only decoded when asked to */
+  uri = get_decoded_uri (sources->data);
+  assert_equals_string (uri, av_uri);
+  g_free (uri);
+
+  g_object_set (asset, "use-proxy", TRUE, NULL);
+  uri = get_decoded_uri (sources->data);
+  assert_equals_string (uri, proxy_uri);
+  g_free (uri);
+
+  g_object_set (asset, "use-proxy", FALSE, NULL);
+  uri = get_decoded_uri (sources->data);
+  assert_equals_string (uri, av_uri);
+  g_free (uri);
+
+  g_list_free_full (sources, gst_object_unref);
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+Suite *
 ges_suite (void)
 {
   Suite *s = suite_create ("ges-filesource");
@@ -277,6 +389,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_filesource_basic);
   tcase_add_test (tc_chain, test_filesource_images);
   tcase_add_test (tc_chain, test_filesource_properties);
+  tcase_add_test (tc_chain, test_uri_clip_proxy);
 
   return s;
 }
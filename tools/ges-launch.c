@@ -28,6 +28,7 @@
 #include <glib/gprintf.h>
 #include <ges/ges.h>
 #include <gst/pbutils/encoding-profile.h>
+#include <gst/video/video.h>
 
 #include <locale.h>             /* for LC_ALL */
 #include "ges-validate.h"
@@ -43,6 +44,9 @@ static GMainLoop *mainloop;
 static GHashTable *tried_uris;
 static GESTrackType track_types = GES_TRACK_TYPE_AUDIO | GES_TRACK_TYPE_VIDEO;
 static GESTimeline *timeline;
+static gboolean profile = FALSE;
+static gchar *profile_output = NULL;
+static gdouble thumbinterval = 0;
 
 static gchar *
 ensure_uri (gchar * location)
@@ -83,21 +87,76 @@ parse_track_type (const gchar * option_name, const gchar * value,
 }
 
 static gboolean
-thumbnail_cb (gpointer pipeline)
+save_thumbnail_cb (GESPipeline * pipeline, GstClockTime timestamp,
+    GstSample * sample, guint * n_saved)
 {
-  static int i = 0;
-  GESPipeline *p = (GESPipeline *) pipeline;
+  GstMapInfo map_info;
+  GstSample *jpeg;
+  GstCaps *caps;
   gchar *filename;
-  gboolean res;
+  GError *err = NULL;
+
+  caps = gst_caps_new_empty_simple ("image/jpeg");
+  jpeg = gst_video_convert_sample (sample, caps, GST_SECOND, &err);
+  gst_caps_unref (caps);
 
-  filename = g_strdup_printf ("thumbnail%d.jpg", i++);
+  if (jpeg == NULL) {
+    g_printerr ("Could not encode the thumbnail at %" GST_TIME_FORMAT ": %s\n",
+        GST_TIME_ARGS (timestamp), err ? err->message : "unknown error");
+    g_clear_error (&err);
+    seenerrors = TRUE;
 
-  res = ges_pipeline_save_thumbnail (p, -1, -1,
-      (gchar *) "image/jpeg", filename, NULL);
+    return TRUE;
+  }
 
+  filename = g_strdup_printf ("thumbnail%u.jpg", *n_saved);
+  gst_buffer_map (gst_sample_get_buffer (jpeg), &map_info, GST_MAP_READ);
+  if (!g_file_set_contents (filename, (const gchar *) map_info.data,
+          map_info.size, &err)) {
+    g_printerr ("Could not save thumbnail: %s\n", err->message);
+    g_error_free (err);
+    seenerrors = TRUE;
+  } else {
+    *n_saved += 1;
+  }
+  gst_buffer_unmap (gst_sample_get_buffer (jpeg), &map_info);
+  gst_sample_unref (jpeg);
   g_free (filename);
 
-  return res;
+  return TRUE;
+}
+
+/* Saves a thumbnail every thumbinterval seconds of the timeline, and stops */
+static gboolean
+take_thumbnails (gpointer unused)
+{
+  guint i, n_timestamps, n_saved = 0;
+  GstClockTime *timestamps;
+  GstClockTime interval = MAX (thumbinterval * GST_SECOND, 1);
+  GstClockTime duration = ges_timeline_get_duration (timeline);
+  GError *err = NULL;
+
+  /* Nothing is displayed at the end of the timeline */
+  n_timestamps = duration ? (duration - 1) / interval + 1 : 1;
+  timestamps = g_new (GstClockTime, n_timestamps);
+  for (i = 0; i < n_timestamps; i++)
+    timestamps[i] = i * interval;
+
+  g_printf ("Taking %u thumbnails\n", n_timestamps);
+  if (!ges_pipeline_get_thumbnails (pipeline, timestamps, n_timestamps, -1, -1,
+          (GESPipelineThumbnailFunc) save_thumbnail_cb, &n_saved, &err)) {
+    g_printerr ("Could not take thumbnails: %s\n",
+        err ? err->message : "unknown error");
+    g_clear_error (&err);
+    seenerrors = TRUE;
+  } else {
+    g_printf ("Saved %u thumbnails\n", n_saved);
+  }
+
+  g_free (timestamps);
+  g_main_loop_quit (mainloop);
+
+  return FALSE;
 }
 
 static gchar *
@@ -164,7 +223,9 @@ project_loaded_cb (GESProject * project, GESTimeline * timeline)
     }
   }
 
-  if (gst_element_set_state (GST_ELEMENT (pipeline),
+  if (thumbinterval != 0.0) {
+    g_idle_add (take_thumbnails, NULL);
+  } else if (gst_element_set_state (GST_ELEMENT (pipeline),
           GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
     g_error ("Failed to start the pipeline\n");
   }
@@ -524,6 +585,30 @@ _print_position (void)
   return TRUE;
 }
 
+static void
+_output_profiling_report (void)
+{
+  GError *err = NULL;
+  gchar *report = ges_pipeline_get_profiling_report (pipeline);
+
+  if (report == NULL) {
+    g_printerr ("No profiling report, the timeline was not rendered\n");
+    return;
+  }
+
+  if (profile)
+    g_print ("\n%s", report);
+
+  if (profile_output && !g_file_set_contents (profile_output, report, -1,
+          &err)) {
+    g_printerr ("Could not save the profiling report to %s: %s\n",
+        profile_output, err->message);
+    g_error_free (err);
+  }
+
+  g_free (report);
+}
+
 static GstEncodingProfile *
 _parse_encoding_profile (const gchar * format)
 {
@@ -660,13 +745,13 @@ main (int argc, gchar ** argv)
   static gboolean smartrender = FALSE;
   static gboolean list_transitions = FALSE;
   static gboolean list_patterns = FALSE;
-  static gdouble thumbinterval = 0;
   static gboolean verbose = FALSE;
   gchar *load_path = NULL;
   const gchar *scenario = NULL;
   GOptionEntry options[] = {
     {"thumbnail", 'm', 0.0, G_OPTION_ARG_DOUBLE, &thumbinterval,
-        "Take thumbnails every n seconds (saved in current directory)", "N"},
+        "Take thumbnails every n seconds of the timeline (saved in current "
+          "directory) instead of playing it", "N"},
     {"smartrender", 's', 0, G_OPTION_ARG_NONE, &smartrender,
         "Render to outputuri, and avoid decoding/reencoding", NULL},
     {"outputuri", 'o', 0, G_OPTION_ARG_STRING, &outputuri,
@@ -700,6 +785,12 @@ main (int argc, gchar ** argv)
         "Defines the track types to be created"},
     {"mute", 0, 0, G_OPTION_ARG_NONE, &mute,
         "Mute playback output, which means that we use faksinks"},
+    {"profile", 0, 0, G_OPTION_ARG_NONE, &profile,
+        "Print the processing time of each clip, effect and transition"
+          " at the end", NULL},
+    {"profile-output", 0, 0, G_OPTION_ARG_STRING, &profile_output,
+        "Save the processing time of each clip, effect and transition"
+          " to a file at the end", "<path>"},
     {"set-scenario", 0, 0, G_OPTION_ARG_STRING, &scenario,
         "Specify a GstValidate scenario to run, 'none' means load gst-validate"
           " but run no scenario on it", "<scenario_name>"},
@@ -737,6 +828,11 @@ main (int argc, gchar ** argv)
     exit (1);
   }
 
+  if (thumbinterval < 0.0) {
+    g_printerr ("The thumbnailing interval can not be negative\n");
+    exit (1);
+  }
+
   /* Initialize the GStreamer Editing Services */
   if (!ges_init ()) {
     g_printerr ("Error initializing GES\n");
@@ -805,6 +901,9 @@ main (int argc, gchar ** argv)
     g_free (outputuri);
 
     gst_encoding_profile_unref (prof);
+  } else if (thumbinterval != 0.0) {
+    if (!ges_pipeline_set_mode (pipeline, GES_PIPELINE_MODE_THUMBNAIL))
+      exit (1);
   } else {
     ges_pipeline_set_mode (pipeline, GES_PIPELINE_MODE_PREVIEW);
   }
@@ -816,28 +915,32 @@ main (int argc, gchar ** argv)
         G_CALLBACK (gst_object_default_deep_notify), exclude_list);
   }
 
+  if (profile || profile_output)
+    g_object_set (pipeline, "profiling", TRUE, NULL);
+
   /* Play the pipeline */
   mainloop = g_main_loop_new (NULL, FALSE);
 
-  if (thumbinterval != 0.0) {
-    g_printf ("thumbnailing every %f seconds\n", thumbinterval);
-    g_timeout_add (1000 * thumbinterval, thumbnail_cb, pipeline);
-  }
-
   bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
   gst_bus_add_signal_watch (bus);
   g_signal_connect (bus, "message", G_CALLBACK (bus_message_cb), mainloop);
 
-  if (load_path == NULL && gst_element_set_state (GST_ELEMENT (pipeline),
+  if (load_path == NULL && thumbinterval != 0.0) {
+    g_idle_add (take_thumbnails, NULL);
+  } else if (load_path == NULL && gst_element_set_state (GST_ELEMENT (pipeline),
           GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
     g_error ("Failed to start the pipeline\n");
     return 1;
   }
-  g_timeout_add (100, (GSourceFunc) _print_position, NULL);
+  if (thumbinterval == 0.0)
+    g_timeout_add (100, (GSourceFunc) _print_position, NULL);
   g_main_loop_run (mainloop);
 
   gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
 
+  if (profile || profile_output)
+    _output_profiling_report ();
+
   validate_res = ges_validate_clean (GST_PIPELINE (pipeline));
   if (seenerrors == FALSE)
     seenerrors = validate_res;